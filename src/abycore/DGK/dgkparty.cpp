@@ -112,7 +112,7 @@ DGKParty::~DGKParty() {
  * inputs pre-allocates byte buffers for aMT calculation.
  * numMTs must be the total number of MTs and divisible by 2
  */
-void DGKParty::preCompBench(BYTE * bA, BYTE * bB, BYTE * bC, BYTE * bA1, BYTE * bB1, BYTE * bC1, UINT numMTs, channel* chan) {
+void DGKParty::preCompBench(BYTE * bA, BYTE * bB, BYTE * bC, BYTE * bA1, BYTE * bB1, BYTE * bC1, UINT numMTs, channel* chan, UINT64_T modulus) {
 	struct timespec start, end;
 
 	numMTs = numMTs / 2; // We can be both sender and receiver at the same time.
@@ -206,7 +206,7 @@ void DGKParty::preCompBench(BYTE * bA, BYTE * bB, BYTE * bC, BYTE * bA1, BYTE *
 
 		mpz_mul(c1[j], a1[j], b1[j]); //c = a * b
 		mpz_sub(c1[j], c1[j], x); // c = c - x
-		mpz_mod_2exp(c1[j], c1[j], m_nShareLength); // c = c mod 2^shareLength
+		reduceShare(c1[j], c1[j], modulus); // c = c mod p, or c mod 2^shareLength for a ring sharing
 
 		mpz_export(bC1 + offset, NULL, 1, shareBytes, 0, 0, c1[j]);
 
@@ -242,9 +242,13 @@ void DGKParty::preCompBench(BYTE * bA, BYTE * bB, BYTE * bC, BYTE * bA1, BYTE *
 		mpz_import(a[i], 1, 1, shareBytes, 0, 0, bA + offset);
 		mpz_import(b[i], 1, 1, shareBytes, 0, 0, bB + offset);
 
-		mpz_mod_2exp(c[i], r, m_nShareLength); // c = x mod 2^shareLength == read the share from least significant bits
+		// c = x mod 2^shareLength == read the share from least significant bits, a field share needs all bits of x
+		if (modulus)
+			mpz_set(c[i], r);
+		else
+			mpz_mod_2exp(c[i], r, m_nShareLength);
 		mpz_addmul(c[i], a[i], b[i]); //c = a*b + c
-		mpz_mod_2exp(c[i], c[i], m_nShareLength); // c = c mod 2^shareLength
+		reduceShare(c[i], c[i], modulus); // c = c mod p, or c mod 2^shareLength for a ring sharing
 		mpz_export(bC + offset, NULL, 1, shareBytes, 0, 0, c[i]);
 		offset += shareBytes;
 
@@ -423,6 +427,16 @@ void DGKParty::receivempz_t(mpz_t t, channel* chan) {
 #endif
 }
 
+/**
+ * reduces a share modulo 2^shareLength, or modulo the prime of a field sharing if modulus is non-zero
+ */
+void DGKParty::reduceShare(mpz_t out, mpz_t in, UINT64_T modulus) {
+	if (modulus)
+		mpz_fdiv_r_ui(out, in, modulus);
+	else
+		mpz_mod_2exp(out, in, m_nShareLength);
+}
+
 #if DEBUG
 void DGKParty::printBuf(BYTE* b, UINT len) {
 	for (UINT i = 0; i < len; i++) {
@@ -37,7 +37,8 @@ public:
 
 	void keyExchange(channel* chan);
 
-	void preCompBench(BYTE * bA, BYTE * bB, BYTE * bC, BYTE * bA1, BYTE * bB1, BYTE * bC1, UINT numMTs, channel* chan);
+	//modulus: reduce the multiplication triples modulo this prime instead of 2^shareLength, if non-zero
+	void preCompBench(BYTE * bA, BYTE * bB, BYTE * bC, BYTE * bA1, BYTE * bB1, BYTE * bC1, UINT numMTs, channel* chan, UINT64_T modulus = 0);
 
 	void readKey();
 
@@ -67,6 +68,8 @@ private:
 
 	void printBuf(BYTE* b, UINT l);
 
+	void reduceShare(mpz_t out, mpz_t in, UINT64_T modulus);
+
 };
 
 #endif //__DGK_PARTY_H__
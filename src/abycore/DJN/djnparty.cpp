@@ -91,7 +91,7 @@ DJNParty::~DJNParty() {
  * inputs pre-allocates byte buffers for aMT calculation.
  * numMTs must be the total number of MTs and divisible by 2
  */
-void DJNParty::preCompBench(BYTE * bA, BYTE * bB, BYTE * bC, BYTE * bA1, BYTE * bB1, BYTE * bC1, UINT numMTs, channel* chan) {
+void DJNParty::preCompBench(BYTE * bA, BYTE * bB, BYTE * bC, BYTE * bA1, BYTE * bB1, BYTE * bC1, UINT numMTs, channel* chan, UINT64_T modulus) {
 	struct timespec start, end;
 
 	numMTs = numMTs / 2; // We can be both sender and receiver at the same time.
@@ -210,13 +210,14 @@ void DJNParty::preCompBench(BYTE * bA, BYTE * bB, BYTE * bC, BYTE * bA1, BYTE *
 
 		// calculate c shares for client part
 		for (UINT j = 0; j < limit; j++) {
-			mpz_mod_2exp(y, x, m_nShareLength); // y = r mod 2^shareLength == read the share from least significant bits
+			// y = r mod 2^shareLength == read the share from least significant bits, a field share needs the whole slot
+			mpz_mod_2exp(y, x, modulus ? maxShareLen : m_nShareLength);
 			mpz_div_2exp(x, x, maxShareLen); // r = r >> maxShareLen
 
 			mpz_mul(c1[j], a1[j], b1[j]); //c = a * b
 			mpz_sub(c1[j], c1[j], y); // c = c - y
 
-			mpz_mod_2exp(c1[j], c1[j], m_nShareLength); // c = c mod 2^shareLength
+			reduceShare(c1[j], c1[j], modulus); // c = c mod p, or c mod 2^shareLength for a ring sharing
 			mpz_export(bC1 + offset, NULL, 1, shareBytes, 0, 0, c1[j]);
 
 			offset += shareBytes;
@@ -258,10 +259,11 @@ void DJNParty::preCompBench(BYTE * bA, BYTE * bB, BYTE * bC, BYTE * bA1, BYTE *
 			mpz_import(a[j], 1, 1, shareBytes, 0, 0, bA + offset);
 			mpz_import(b[j], 1, 1, shareBytes, 0, 0, bB + offset);
 
-			mpz_mod_2exp(c[j], r, m_nShareLength); // c = x mod 2^shareLength == read the share from least significant bits
+			// c = x mod 2^shareLength == read the share from least significant bits, a field share needs the whole slot
+			mpz_mod_2exp(c[j], r, modulus ? maxShareLen : m_nShareLength);
 			mpz_div_2exp(r, r, maxShareLen); // x = x >> maxShareLen
 			mpz_addmul(c[j], a[j], b[j]); //c = a*b + c
-			mpz_mod_2exp(c[j], c[j], m_nShareLength); // c = c mod 2^shareLength
+			reduceShare(c[j], c[j], modulus); // c = c mod p, or c mod 2^shareLength for a ring sharing
 			mpz_export(bC + offset, NULL, 1, shareBytes, 0, 0, c[j]);
 			offset += shareBytes;
 		}
@@ -510,6 +512,16 @@ void DJNParty::receivempz_t(mpz_t t, channel* chan) {
 #endif
 }
 
+/**
+ * reduces a share modulo 2^shareLength, or modulo the prime of a field sharing if modulus is non-zero
+ */
+void DJNParty::reduceShare(mpz_t out, mpz_t in, UINT64_T modulus) {
+	if (modulus)
+		mpz_fdiv_r_ui(out, in, modulus);
+	else
+		mpz_mod_2exp(out, in, m_nShareLength);
+}
+
 #if DEBUG
 void DJNParty::printBuf(BYTE* b, UINT len) {
 	for (UINT i = 0; i < len; i++) {
@@ -36,7 +36,8 @@ public:
 	~DJNParty();
 
 	void keyExchange(channel* chan);
-	void preCompBench(BYTE * bA, BYTE * bB, BYTE * bC, BYTE * bA1, BYTE * bB1, BYTE * bC1, UINT numMTs, channel* chan);
+	//modulus: reduce the multiplication triples modulo this prime instead of 2^shareLength, if non-zero
+	void preCompBench(BYTE * bA, BYTE * bB, BYTE * bC, BYTE * bA1, BYTE * bB1, BYTE * bC1, UINT numMTs, channel* chan, UINT64_T modulus = 0);
 
 	void setSharelLength(UINT sharelen);
 
@@ -64,6 +65,8 @@ private:
 
 	void printBuf(BYTE* b, UINT l);
 
+	void reduceShare(mpz_t out, mpz_t in, UINT64_T modulus);
+
 };
 
 #endif //__DJN_PARTY_H__
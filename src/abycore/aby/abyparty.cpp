@@ -29,7 +29,8 @@ using namespace std;
 #endif
 
 
-ABYParty::ABYParty(e_role pid, char* addr, seclvl seclvl, uint32_t bitlen, uint32_t nthreads, e_mt_gen_alg mg_algo, uint32_t maxgates, uint16_t port) {
+ABYParty::ABYParty(e_role pid, char* addr, seclvl seclvl, uint32_t bitlen, uint32_t nthreads, e_mt_gen_alg mg_algo, uint32_t maxgates, uint16_t port, BOOL async_startup,
+		uint32_t npoolthreads, BOOL pinthreads) {
 	StartWatch("Initialization", P_INIT);
 
 	m_eRole = pid;
@@ -40,6 +41,9 @@ ABYParty::ABYParty(e_role pid, char* addr, seclvl seclvl, uint32_t bitlen, uint3
 	m_sSecLvl = seclvl;
 
 	m_eMTGenAlg = mg_algo;
+	m_bAsyncStartup = async_startup;
+	m_nPoolThreads = npoolthreads > 0 ? npoolthreads : ThreadPool::GetNumCores();
+	m_bPinThreads = pinthreads;
 
 	//
 	m_cCrypt = new crypto(seclvl.symbits, (uint8_t*) const_seed[pid]);
@@ -66,6 +70,15 @@ ABYParty::ABYParty(e_role pid, char* addr, seclvl seclvl, uint32_t bitlen, uint3
 	}
 	StopWatch("Time for circuit generation: ", P_CIRCUIT);
 
+	if (async_startup) {
+		//connect and compute the base OTs while the application builds the circuit
+		m_pThreadPool->Submit(&m_tStartupTask, StartupTask, this);
+	} else if (!PerformStartup()) {
+		exit(0);
+	}
+}
+
+BOOL ABYParty::PerformStartup() {
 #ifndef BATCH
 	cout << "Establishing network connection" << endl;
 #endif
@@ -73,7 +86,7 @@ ABYParty::ABYParty(e_role pid, char* addr, seclvl seclvl, uint32_t bitlen, uint3
 	StartWatch("Establishing network connection: ", P_NETWORK);
 	if (!EstablishConnection()) {
 		cout << "There was an error during establish connection, ending! " << endl;
-		exit(0);
+		return FALSE;
 	}
 	StopWatch("Time for network connect: ", P_NETWORK);
 
@@ -82,31 +95,41 @@ ABYParty::ABYParty(e_role pid, char* addr, seclvl seclvl, uint32_t bitlen, uint3
 #endif
 	/* Pre-Compute Naor-Pinkas base OTs by starting two threads */
 	StartRecording("Starting NP OT", P_BASE_OT, m_vSockets);
-	m_pSetup->PrepareSetupPhase(m_tComm);
+	BOOL success = m_pSetup->PrepareSetupPhase(m_tComm);
 	StopRecording("Time for NP OT: ", P_BASE_OT, m_vSockets);
+	return success;
+}
+
+BOOL ABYParty::WaitForStartup() {
+	if (!m_bAsyncStartup)
+		return TRUE;
+
+	BOOL success = m_pThreadPool->Wait(&m_tStartupTask);
+	m_bAsyncStartup = FALSE;
+	if (!success) {
+		cout << "There was an error during the startup, ending! " << endl;
+		exit(0);
+	}
+	return success;
 }
 
 ABYParty::~ABYParty() {
+	WaitForStartup();
 
 	m_vSharings[S_BOOL]->PreCompFileDelete();
 	Cleanup();
 }
 
 BOOL ABYParty::Init() {
-	//Threads that support execution by e.g. concurrent sending / receiving
-	m_nHelperThreads = 2;
+	//Pool that executes the OT extension, MT generation, and communication tasks. The OT and public-key MT generation jobs
+	//of both roles communicate with the peer and need to run at the same time, hence at least 2 * m_nNumOTThreads threads are required
+	m_pThreadPool = new ThreadPool(max(m_nPoolThreads, 2 * m_nNumOTThreads), m_bPinThreads);
 
 	//m_vSockets.resize(m_nNumOTThreads * 2);
 	m_vSockets.resize(2);
 
 	//Initialize necessary routines for computing the setup phase
-	m_pSetup = new ABYSetup(m_cCrypt, m_nNumOTThreads, m_eRole, m_eMTGenAlg);
-
-	m_vThreads.resize(m_nHelperThreads);
-	for (uint32_t i = 0; i < m_nHelperThreads; i++) {
-		m_vThreads[i] = new CPartyWorkerThread(i, this); //First thread is started as receiver, second as sender
-		m_vThreads[i]->Start();
-	}
+	m_pSetup = new ABYSetup(m_cCrypt, m_nNumOTThreads, m_eRole, m_eMTGenAlg, m_pThreadPool);
 
 	m_nMyNumInBits = 0;
 
@@ -130,13 +153,10 @@ void ABYParty::Cleanup() {
 		delete m_vSharings[S_YAO_REV];
 	if(m_vSharings[S_ARITH])
 		delete m_vSharings[S_ARITH];
+	for (uint32_t i = S_LAST; i < m_vSharings.size(); i++)
+		delete m_vSharings[i];
 
-	for (uint32_t i = 0; i < m_nHelperThreads; i++) {
-		m_vThreads[i]->PutJob(e_Party_Stop);
-		m_vThreads[i]->Wait();
-		m_vThreads[i]->Kill();
-		delete m_vThreads[i];
-	}
+	delete m_pThreadPool;
 
 	delete m_tComm->snd_std;
 	delete m_tComm->snd_inv;
@@ -154,6 +174,9 @@ CBitVector ABYParty::ExecCircuit() {
 	cout << "Finishing circuit generation" << endl;
 #endif
 
+	//the circuit was built while connecting; from here on the connection and the base OTs are required
+	WaitForStartup();
+
 	CBitVector result;
 	StartRecording("Starting execution", P_TOTAL, m_vSockets);
 
@@ -179,17 +202,14 @@ CBitVector ABYParty::ExecCircuit() {
 #endif
 		if(i == S_YAO) {
 			StartWatch("Starting Circuit Garbling", P_GARBLE);
-			if(m_eRole == SERVER) {
-				m_vSharings[S_YAO]->PerformSetupPhase(m_pSetup);
-				m_vSharings[S_YAO_REV]->PerformSetupPhase(m_pSetup);
-			} else {
-				m_vSharings[S_YAO_REV]->PerformSetupPhase(m_pSetup);
-				m_vSharings[S_YAO]->PerformSetupPhase(m_pSetup);
-			}
-			/*m_vSharings[S_YAO]->PerformSetupPhase(m_pSetup);
-			m_vSharings[S_YAO_REV]->PerformSetupPhase(m_pSetup);*/
-			m_vSharings[S_YAO]->FinishSetupPhase(m_pSetup);
-			m_vSharings[S_YAO_REV]->FinishSetupPhase(m_pSetup);
+			//On each party one of the Yao sharings only sends and the other one only receives, hence both are set up concurrently
+			m_vSharingJobs[S_YAO].party = m_vSharingJobs[S_YAO_REV].party = this;
+			m_vSharingJobs[S_YAO].job = m_vSharingJobs[S_YAO_REV].job = e_SetupSharing;
+			m_vSharingJobs[S_YAO].sharingid = S_YAO;
+			m_vSharingJobs[S_YAO_REV].sharingid = S_YAO_REV;
+			m_pThreadPool->Submit(&m_tSharingTasks, SharingJobTask, &m_vSharingJobs[S_YAO]);
+			m_pThreadPool->Submit(&m_tSharingTasks, SharingJobTask, &m_vSharingJobs[S_YAO_REV]);
+			m_pThreadPool->Wait(&m_tSharingTasks);
 			StopWatch("Time for Circuit garbling: ", P_GARBLE);
 		} else if (i == S_YAO_REV) {
 			//Do nothing, was done in parallel to Yao
@@ -205,8 +225,13 @@ CBitVector ABYParty::ExecCircuit() {
 	cout << "Evaluating circuit" << endl;
 #endif
 
-	//Online phase
-	if(m_vSharings[S_BOOL]->GetPreCompPhaseValue() != ePreCompStore) {
+	//Online phase, which is skipped if a sharing only stores its precomputed values
+	BOOL precompstore = FALSE;
+	for (uint32_t i = 0; i < m_vSharings.size(); i++) {
+		if (m_vSharings[i]->GetPreCompPhaseValue() == ePreCompStore)
+			precompstore = TRUE;
+	}
+	if(!precompstore) {
 		StartRecording("Starting online phase: ", P_ONLINE, m_vSockets);
 		EvaluateCircuit();
 		StopRecording("Time for online phase: ", P_ONLINE, m_vSockets);
@@ -243,25 +268,16 @@ BOOL ABYParty::InitCircuit(uint32_t bitlen, uint32_t maxgates) {
 		m_vSharings[S_YAO] = new YaoClientSharing(S_YAO, CLIENT, m_sSecLvl.symbits, m_pCircuit, m_cCrypt);
 		m_vSharings[S_YAO_REV] = new YaoServerSharing(S_YAO_REV, SERVER, m_sSecLvl.symbits, m_pCircuit, m_cCrypt);
 	}
-	switch (bitlen) {
-	case 8:
-		m_vSharings[S_ARITH] = new ArithSharing<UINT8_T>(S_ARITH, m_eRole, 1, m_pCircuit, m_cCrypt, m_eMTGenAlg);
-		break;
-	case 16:
-		m_vSharings[S_ARITH] = new ArithSharing<UINT16_T>(S_ARITH, m_eRole, 1, m_pCircuit, m_cCrypt, m_eMTGenAlg);
-		break;
-	case 32:
-		m_vSharings[S_ARITH] = new ArithSharing<UINT32_T>(S_ARITH, m_eRole, 1, m_pCircuit, m_cCrypt, m_eMTGenAlg);
-		break;
-	case 64:
-		m_vSharings[S_ARITH] = new ArithSharing<UINT64_T>(S_ARITH, m_eRole, 1, m_pCircuit, m_cCrypt, m_eMTGenAlg);
-		break;
-	default:
-		m_vSharings[S_ARITH] = new ArithSharing<UINT32_T>(S_ARITH, m_eRole, 1, m_pCircuit, m_cCrypt, m_eMTGenAlg);
-		break;
-	}
+	m_vSharings[S_ARITH] = NewArithSharing(bitlen);
+	if (!m_vSharings[S_ARITH])
+		m_vSharings[S_ARITH] = NewArithSharing(32);
 
 	m_pGates = m_pCircuit->Gates();
+	m_vSharingJobs.resize(m_vSharings.size());
+	//large SIMD gates are split among the workers of the pool
+	for (uint32_t i = 0; i < m_vSharings.size(); i++) {
+		m_vSharings[i]->SetThreadPool(m_pThreadPool);
+	}
 
 #ifndef BATCH
 	cout << " circuit initialized..." << endl;
@@ -274,9 +290,9 @@ BOOL ABYParty::EvaluateCircuit() {
 #ifdef BENCHONLINEPHASE
 	timespec tstart, tend;
 	double interaction=0;
-	vector<double> localops(4,0);
-	vector<double> interactiveops(4,0);
-	vector<double> fincirclayer(4,0);
+	m_vLocalOpsTime.assign(m_vSharings.size(), 0);
+	m_vInteractiveOpsTime.assign(m_vSharings.size(), 0);
+	m_vFinishLayerTime.assign(m_vSharings.size(), 0);
 #endif
 	m_nDepth = 0;
 
@@ -291,35 +307,21 @@ BOOL ABYParty::EvaluateCircuit() {
 	for (uint32_t i = 0; i < m_vSharings.size(); i++) {
 		maxdepth = max(maxdepth, m_vSharings[i]->GetMaxCommunicationRounds());
 	}
+	MarkConversionLayers(maxdepth);
 #ifdef DEBUGABYPARTY
 	cout << "Starting online evaluation with maxdepth = " << maxdepth << endl;
 #endif
-	//Evaluate Circuit layerwise;
+	//Evaluate Circuit layerwise; the sharings are evaluated concurrently and only synchronize at conversion layers and for the interaction
 	for (uint32_t depth = 0; depth < maxdepth; depth++, m_nDepth++) {
 #ifdef DEBUGABYPARTY
 		cout << "Starting evaluation on depth " << depth << endl << flush;
 #endif
-		for (uint32_t i = 0; i < m_vSharings.size(); i++) {
-#ifdef DEBUGABYPARTY
-			cout << "Evaluating local operations of sharing " << i << " on depth " << depth << endl;
-#endif
-#ifdef BENCHONLINEPHASE
-			clock_gettime(CLOCK_MONOTONIC, &tstart);
-#endif
-			m_vSharings[i]->EvaluateLocalOperations(depth);
-#ifdef BENCHONLINEPHASE
-			clock_gettime(CLOCK_MONOTONIC, &tend);
-			localops[i] += getMillies(tstart, tend);
-			clock_gettime(CLOCK_MONOTONIC, &tstart);
-#endif
-#ifdef DEBUGABYPARTY
-			cout << "Evaluating interactive operations of sharing " << i << endl;
-#endif
-			m_vSharings[i]->EvaluateInteractiveOperations(depth);
-#ifdef BENCHONLINEPHASE
-			clock_gettime(CLOCK_MONOTONIC, &tend);
-			interactiveops[i] += getMillies(tstart, tend);
-#endif
+		if (m_vConvLayers[depth]) {
+			//a conversion gate reads the values of its parents in the other sharing, which might be evaluated locally on this layer
+			RunSharingJobs(e_LocalOps, depth);
+			RunSharingJobs(e_InteractiveOps, depth);
+		} else {
+			RunSharingJobs(e_LayerOps, depth);
 		}
 #ifdef DEBUGABYPARTY
 		cout << "Finished with evaluating operations on depth = " << depth << ", continuing with interactions" << endl;
@@ -335,38 +337,169 @@ BOOL ABYParty::EvaluateCircuit() {
 #ifdef DEBUGABYPARTY
 		cout << "Done performing interaction, having sharings wrap up this circuit layer" << endl;
 #endif
-		for (uint32_t i = 0; i < m_vSharings.size(); i++) {
-#ifdef BENCHONLINEPHASE
-			clock_gettime(CLOCK_MONOTONIC, &tstart);
-#endif
-			//cout << "Finishing circuit layer for sharing "<< i << endl;
-			m_vSharings[i]->FinishCircuitLayer(depth);
-#ifdef BENCHONLINEPHASE
-			clock_gettime(CLOCK_MONOTONIC, &tend);
-			fincirclayer[i] += getMillies(tstart, tend);
-#endif
-		}
+		RunSharingJobs(e_FinishLayer, depth);
 	}
 #ifdef DEBUGABYPARTY
 		cout << "Done with online phase; synchronizing "<< endl;
 #endif
 	m_tPartyChan->synchronize_end();
+	//the channel is re-opened for every circuit that is evaluated in this session
+	delete m_tPartyChan;
+	m_tPartyChan = NULL;
 
 #ifdef BENCHONLINEPHASE
 	cout << "Online time is distributed as follows: " << endl;
-	cout << "Bool: local gates: " << localops[S_BOOL] << ", interactive gates: " << interactiveops[S_BOOL] << ", layer finish: " << fincirclayer[S_BOOL] << endl;
-	cout << "Yao: local gates: " << localops[S_YAO] << ", interactive gates: " << interactiveops[S_YAO] << ", layer finish: " << fincirclayer[S_YAO] << endl;
-	cout << "Yao Rev: local gates: " << localops[S_YAO_REV] << ", interactive gates: " << interactiveops[S_YAO_REV] << ", layer finish: " << fincirclayer[S_YAO_REV] << endl;
-	cout << "Arith: local gates: " << localops[S_ARITH] << ", interactive gates: " << interactiveops[S_ARITH] << ", layer finish: " << fincirclayer[S_ARITH] << endl;
-	cout << "Bool No MT: local gates: " << localops[S_BOOL_NO_MT] << ", interactive gates: " << interactiveops[S_BOOL_NO_MT] << ", layer finish: " << fincirclayer[S_BOOL_NO_MT] << endl;
+	for (uint32_t i = 0; i < m_vSharings.size(); i++) {
+		cout << m_vSharings[i]->sharing_type() << ": local gates: " << m_vLocalOpsTime[i] << ", interactive gates: " << m_vInteractiveOpsTime[i]
+				<< ", layer finish: " << m_vFinishLayerTime[i] << endl;
+	}
 	cout << "Communication: " << interaction << endl;
 #endif
 	return true;
 }
 
+Sharing* ABYParty::NewArithSharing(uint32_t bitlen) {
+	switch (bitlen) {
+	case 8:
+		return new ArithSharing<UINT8_T>(S_ARITH, m_eRole, 1, m_pCircuit, m_cCrypt, m_eMTGenAlg);
+	case 16:
+		return new ArithSharing<UINT16_T>(S_ARITH, m_eRole, 1, m_pCircuit, m_cCrypt, m_eMTGenAlg);
+	case 32:
+		return new ArithSharing<UINT32_T>(S_ARITH, m_eRole, 1, m_pCircuit, m_cCrypt, m_eMTGenAlg);
+	case 64:
+		return new ArithSharing<UINT64_T>(S_ARITH, m_eRole, 1, m_pCircuit, m_cCrypt, m_eMTGenAlg);
+	case 128:
+		return new ArithSharing<UINT128_T>(S_ARITH, m_eRole, 1, m_pCircuit, m_cCrypt, m_eMTGenAlg);
+	default:
+		return NULL;
+	}
+}
+
+Sharing* ABYParty::GetArithSharing(uint32_t bitlen) {
+	if (m_vSharings[S_ARITH]->GetCircuitBuildRoutine()->GetShareBitLen() == bitlen)
+		return m_vSharings[S_ARITH];
+	for (uint32_t i = S_LAST; i < m_vSharings.size(); i++) {
+		Circuit* circ = m_vSharings[i]->GetCircuitBuildRoutine();
+		if (circ->GetContext() == S_ARITH && circ->GetShareBitLen() == bitlen)
+			return m_vSharings[i];
+	}
+
+	Sharing* sharing = NewArithSharing(bitlen);
+	if (!sharing) {
+		cerr << "Arithmetic sharing with " << bitlen << " bits is not supported" << endl;
+		return NULL;
+	}
+	AddSharing(sharing);
+	return sharing;
+}
+
+Sharing* ABYParty::GetFieldSharing(uint64_t prime) {
+	for (uint32_t i = S_LAST; i < m_vSharings.size(); i++) {
+		if (m_vSharings[i]->GetCircuitBuildRoutine()->GetContext() == S_ARITH_FIELD && ((ArithSharing<UINT64_T>*) m_vSharings[i])->GetModulus() == prime)
+			return m_vSharings[i];
+	}
+
+	//the Montgomery arithmetic requires an odd modulus and sums of three products below prime * 2^64
+	if (prime < 3 || !(prime & 0x01) || (prime >> 62)) {
+		cerr << "Prime field sharing modulo " << prime << " is not supported, the modulus has to be an odd prime < 2^62" << endl;
+		return NULL;
+	}
+	Sharing* sharing = new ArithSharing<UINT64_T>(S_ARITH_FIELD, m_eRole, 1, m_pCircuit, m_cCrypt, m_eMTGenAlg, prime);
+	AddSharing(sharing);
+	return sharing;
+}
+
+//Append a sharing after S_LAST, which is evaluated together with the other sharings
+void ABYParty::AddSharing(Sharing* sharing) {
+	sharing->SetThreadPool(m_pThreadPool);
+	m_vSharings.push_back(sharing);
+	m_vSharingJobs.resize(m_vSharings.size());
+}
+
+//Find the layers on which a gate converts a value from another sharing
+void ABYParty::MarkConversionLayers(uint32_t maxdepth) {
+	m_vConvLayers.assign(maxdepth, FALSE);
+	for (uint32_t i = 0; i < m_vSharings.size(); i++) {
+		Circuit* circ = m_vSharings[i]->GetCircuitBuildRoutine();
+		uint32_t nlayers = min(maxdepth, max(circ->GetNumLocalLayers(), circ->GetNumInteractiveLayers()));
+		for (uint32_t depth = 0; depth < nlayers; depth++) {
+			deque<uint32_t> localqueue = circ->GetLocalQueueOnLvl(depth);
+			deque<uint32_t> interqueue = circ->GetInteractiveQueueOnLvl(depth);
+			for (uint32_t j = 0; j < localqueue.size() && !m_vConvLayers[depth]; j++) {
+				m_vConvLayers[depth] = (m_pGates[localqueue[j]].type == G_CONV);
+			}
+			for (uint32_t j = 0; j < interqueue.size() && !m_vConvLayers[depth]; j++) {
+				m_vConvLayers[depth] = (m_pGates[interqueue[j]].type == G_CONV);
+			}
+		}
+	}
+}
+
+//Run the job for all sharings concurrently and wait until all of them are done
+BOOL ABYParty::RunSharingJobs(ESharingJobType job, uint32_t depth) {
+	for (uint32_t i = 0; i < m_vSharings.size(); i++) {
+		m_vSharingJobs[i].party = this;
+		m_vSharingJobs[i].sharingid = i;
+		m_vSharingJobs[i].job = job;
+		m_vSharingJobs[i].depth = depth;
+		m_pThreadPool->Submit(&m_tSharingTasks, SharingJobTask, &m_vSharingJobs[i]);
+	}
+	return m_pThreadPool->Wait(&m_tSharingTasks);
+}
+
+BOOL ABYParty::RunSharingJob(uint32_t sharingid, ESharingJobType job, uint32_t depth) {
+	Sharing* sharing = m_vSharings[sharingid];
+#ifdef BENCHONLINEPHASE
+	timespec tstart, tend;
+	clock_gettime(CLOCK_MONOTONIC, &tstart);
+#endif
+	switch (job) {
+	case e_SetupSharing:
+		sharing->PerformSetupPhase(m_pSetup);
+		sharing->FinishSetupPhase(m_pSetup);
+		break;
+	case e_LocalOps:
+	case e_LayerOps:
+#ifdef DEBUGABYPARTY
+		cout << "Evaluating local operations of sharing " << sharingid << " on depth " << depth << endl;
+#endif
+		sharing->EvaluateLocalOperations(depth);
+#ifdef BENCHONLINEPHASE
+		clock_gettime(CLOCK_MONOTONIC, &tend);
+		m_vLocalOpsTime[sharingid] += getMillies(tstart, tend);
+		clock_gettime(CLOCK_MONOTONIC, &tstart);
+#endif
+		if (job == e_LocalOps)
+			break;
+		//a whole layer continues with the interactive operations
+	case e_InteractiveOps:
+#ifdef DEBUGABYPARTY
+		cout << "Evaluating interactive operations of sharing " << sharingid << endl;
+#endif
+		sharing->EvaluateInteractiveOperations(depth);
+#ifdef BENCHONLINEPHASE
+		clock_gettime(CLOCK_MONOTONIC, &tend);
+		m_vInteractiveOpsTime[sharingid] += getMillies(tstart, tend);
+#endif
+		break;
+	case e_FinishLayer:
+		sharing->FinishCircuitLayer(depth);
+#ifdef BENCHONLINEPHASE
+		clock_gettime(CLOCK_MONOTONIC, &tend);
+		m_vFinishLayerTime[sharingid] += getMillies(tstart, tend);
+#endif
+		break;
+	default:
+		break;
+	}
+	return TRUE;
+}
+
 BOOL ABYParty::PerformInteraction() {
-	WakeupWorkerThreads(e_Party_Comm);
-	BOOL success = WaitWorkerThreads();
+	//send and receive concurrently
+	m_pThreadPool->Submit(&m_tCommTasks, SendValuesTask, this);
+	m_pThreadPool->Submit(&m_tCommTasks, ReceiveValuesTask, this);
+	BOOL success = m_pThreadPool->Wait(&m_tCommTasks);
 	return success;
 }
 
@@ -460,12 +593,79 @@ BOOL ABYParty::ThreadReceiveValues() {
 }
 
 
+layer_cost ABYParty::EstimateCost(vector<sharing_cost>& costs) {
+	layer_cost total;
+	uint32_t nlayers = 0;
+
+	memset(&total, 0, sizeof(layer_cost));
+	costs.resize(m_vSharings.size());
+	for (uint32_t i = 0; i < m_vSharings.size(); i++) {
+		m_vSharings[i]->EstimateCost(&(costs[i]));
+		nlayers = max(nlayers, (uint32_t) costs[i].layers.size());
+		total.nonlinops += costs[i].total.nonlinops;
+		total.numOTs += costs[i].total.numOTs;
+		total.setupbits += costs[i].total.setupbits;
+		total.onlinebits += costs[i].total.onlinebits;
+	}
+	//the sharings are evaluated layer by layer and interact together after each layer
+	for (uint32_t j = 0; j < nlayers; j++) {
+		uint32_t rounds = 0;
+		for (uint32_t i = 0; i < costs.size(); i++) {
+			if (j < costs[i].layers.size())
+				rounds = max(rounds, costs[i].layers[j].rounds);
+		}
+		total.rounds += rounds;
+	}
+	return total;
+}
+
+double ABYParty::EstimateRuntime(const layer_cost& cost, double bandwidth, double rtt) {
+	double transfer = (double) (cost.setupbits + cost.onlinebits) / (bandwidth * 1000);
+	double latency = cost.rounds * rtt / 2;
+	if (cost.setupbits > 0)
+		latency += rtt;
+	return transfer + latency;
+}
+
+void ABYParty::PrintCostEstimate(double bandwidth, double rtt) {
+	vector<sharing_cost> costs;
+	layer_cost total = EstimateCost(costs);
+
+	cout << "Predicted cost: " << endl;
+	for (uint32_t i = 0; i < costs.size(); i++) {
+		layer_cost& c = costs[i].total;
+		if (c.nonlinops == 0 && c.setupbits == 0 && c.onlinebits == 0)
+			continue;
+		if (i < S_LAST)
+			cout << get_sharing_name((e_sharing) i);
+		else
+			cout << m_vSharings[i]->sharing_type() << " (" << m_vSharings[i]->GetCircuitBuildRoutine()->GetShareBitLen() << " bit)";
+		cout << ": non-linear ops: " << c.nonlinops << " ; OTs: " << c.numOTs << " ; setup: "
+				<< ceil_divide(c.setupbits, 8) << " bytes ; online: " << ceil_divide(c.onlinebits, 8) << " bytes ; rounds: "
+				<< c.rounds << " ; est. time: " << EstimateRuntime(c, bandwidth, rtt) << " ms" << endl;
+		for (uint32_t j = 0; j < costs[i].layers.size(); j++) {
+			layer_cost& l = costs[i].layers[j];
+			if (l.nonlinops == 0 && l.setupbits == 0 && l.onlinebits == 0)
+				continue;
+			cout << "\tLayer " << j << ": non-linear ops: " << l.nonlinops << " ; OTs: " << l.numOTs << " ; setup: "
+					<< ceil_divide(l.setupbits, 8) << " bytes ; online: " << ceil_divide(l.onlinebits, 8) << " bytes" << endl;
+		}
+	}
+	cout << "Total: non-linear ops: " << total.nonlinops << " ; OTs: " << total.numOTs << " ; setup: "
+			<< ceil_divide(total.setupbits, 8) << " bytes ; online: " << ceil_divide(total.onlinebits, 8) << " bytes ; rounds: "
+			<< total.rounds << endl;
+	cout << "Estimated time for " << bandwidth << " Mbit/s and " << rtt << " ms RTT: " << EstimateRuntime(total, bandwidth, rtt)
+			<< " ms" << endl;
+}
+
 void ABYParty::PrintPerformanceStatistics() {
 	cout << "Complexities: " << endl;
 	m_vSharings[S_BOOL]->PrintPerformanceStatistics();
 	m_vSharings[S_YAO]->PrintPerformanceStatistics();
 	m_vSharings[S_YAO_REV]->PrintPerformanceStatistics();
 	m_vSharings[S_ARITH]->PrintPerformanceStatistics();
+	for (uint32_t i = S_LAST; i < m_vSharings.size(); i++)
+		m_vSharings[i]->PrintPerformanceStatistics();
 	//m_vSharings[S_BOOL_NO_MT]->PrintPerformanceStatistics(); //TODO: enable once S_BOOL_NO_MT works
 	cout << "Total number of gates: " << m_pCircuit->GetGateHead() << endl;
 	PrintTimings();
@@ -533,10 +733,9 @@ void ABYParty::InstantiateGate(uint32_t gateid) {
 }
 
 void ABYParty::UsedGate(uint32_t gateid) {
-	//Decrease the number of further uses of the gate
-	m_pGates[gateid].nused--;
-	//If the gate is needed in another subsequent gate, delete it
-	if (!m_pGates[gateid].nused) {
+	//Decrease the number of further uses of the gate atomically, since the sharings of a layer are evaluated concurrently
+	//If the gate is not needed in another subsequent gate, delete it
+	if (!__sync_sub_and_fetch(&m_pGates[gateid].nused, 1)) {
 		free(m_pGates[gateid].gs.val);
 
 	}
@@ -553,78 +752,85 @@ void ABYParty::Reset() {
 	m_pCircuit->Reset();
 }
 
-double ABYParty::GetTiming(ABYPHASE phase) {
-	return GetTimeForPhase(phase);
+void ABYParty::CompileCircuit() {
+	m_pCircuit->Compile();
 }
 
-uint64_t ABYParty::GetSentData(ABYPHASE phase) {
-	return GetSentDataForPhase(phase);
+void ABYParty::ReleaseCompiledCircuit() {
+	m_pCircuit->ReleaseCompiled();
 }
 
-uint64_t ABYParty::GetReceivedData(ABYPHASE phase) {
-	return GetReceivedDataForPhase(phase);
+void ABYParty::SetGateDeduplication(BOOL enable) {
+	m_pCircuit->SetGateDeduplication(enable);
 }
 
-//===========================================================================
-// Thread Management
-BOOL ABYParty::WakeupWorkerThreads(EPartyJobType e) {
-	m_bWorkerThreadSuccess = TRUE;
+BOOL ABYParty::WriteCircuit(const char* filename) {
+	CircuitFile file;
+	if (!m_pCircuit->WriteGates(file))
+		return FALSE;
 
-	m_nWorkingThreads = 2;
-	uint32_t n = m_nWorkingThreads;
+	file.Put<uint32_t>(m_vSharings.size());
+	for (uint32_t i = 0; i < m_vSharings.size(); i++) {
+		Circuit* circ = m_vSharings[i]->GetCircuitBuildRoutine();
+		file.Put<uint32_t>(circ->GetContext());
+		circ->WriteState(file);
+	}
+	return file.Write(filename);
+}
 
-	for (uint32_t i = 0; i < n; i++)
-		m_vThreads[i]->PutJob(e);
+BOOL ABYParty::LoadCircuit(const char* filename) {
+	CircuitFile file;
+	uint32_t nsharings, context;
 
-	return TRUE;
-}
+	if (m_pCircuit->GetGateHead() > 0 || m_pCircuit->IsCompiled()) {
+		cerr << "A circuit can only be loaded if no circuit was built yet" << endl;
+		return FALSE;
+	}
+	if (!file.Map(filename))
+		return FALSE;
 
-BOOL ABYParty::WaitWorkerThreads() {
-	if (!m_nWorkingThreads)
-		return TRUE;
+	BOOL success = m_pCircuit->ReadGates(file, m_eRole) && file.Get<uint32_t>(&nsharings) && nsharings == m_vSharings.size();
+	for (uint32_t i = 0; i < m_vSharings.size() && success; i++) {
+		Circuit* circ = m_vSharings[i]->GetCircuitBuildRoutine();
+		success = file.Get<uint32_t>(&context) && context == (uint32_t) circ->GetContext() && circ->ReadState(file);
+	}
+	success = success && file.AtEnd();
 
-	for (;;) {
-		m_lock.Lock();
-		uint32_t n = m_nWorkingThreads;
-		m_lock.Unlock();
-		if (!n)
-			return m_bWorkerThreadSuccess;
-		m_evt.Wait();
+	if (!success) {
+		cerr << "Could not load circuit from " << filename << endl;
+		m_pCircuit->ReleaseGates();
+		Reset();
 	}
-	return m_bWorkerThreadSuccess;
+	return success;
 }
 
-BOOL ABYParty::ThreadNotifyTaskDone(BOOL bSuccess) {
-	m_lock.Lock();
-	uint32_t n = --m_nWorkingThreads;
-	if (!bSuccess)
-		m_bWorkerThreadSuccess = FALSE;
-	m_lock.Unlock();
+double ABYParty::GetTiming(ABYPHASE phase) {
+	return GetTimeForPhase(phase);
+}
 
-	if (!n)
-		m_evt.Set();
-	return TRUE;
+uint64_t ABYParty::GetSentData(ABYPHASE phase) {
+	return GetSentDataForPhase(phase);
 }
 
-void ABYParty::CPartyWorkerThread::ThreadMain() {
-	BOOL bSuccess = FALSE;
-	for (;;) {
-		m_evt.Wait();
+uint64_t ABYParty::GetReceivedData(ABYPHASE phase) {
+	return GetReceivedDataForPhase(phase);
+}
 
-		switch (m_eJob) {
-		case e_Party_Stop:
-			return;
-		case e_Party_Comm:
-			if (threadid == 0){
-				bSuccess = m_pCallback->ThreadSendValues();
-			}
-			else{
-				bSuccess = m_pCallback->ThreadReceiveValues();
-			}
-			break;
-		}
+//===========================================================================
+// Thread Management
+BOOL ABYParty::SendValuesTask(void* party) {
+	return ((ABYParty*) party)->ThreadSendValues();
+}
 
-		m_pCallback->ThreadNotifyTaskDone(bSuccess);
-	}
+BOOL ABYParty::ReceiveValuesTask(void* party) {
+	return ((ABYParty*) party)->ThreadReceiveValues();
 }
 
+BOOL ABYParty::StartupTask(void* party) {
+	return ((ABYParty*) party)->PerformStartup();
+}
+
+BOOL ABYParty::SharingJobTask(void* arg) {
+	sharing_job* job = (sharing_job*) arg;
+	return job->party->RunSharingJob(job->sharingid, job->job, job->depth);
+}
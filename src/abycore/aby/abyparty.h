@@ -35,6 +35,7 @@
 #include "../sharing/arithsharing.h"
 #include "../util/sndthread.h"
 #include "../util/rcvthread.h"
+#include "../util/threadpool.h"
 
 #include "../util/yaokey.h"
 #include "../util/timer.h"
@@ -59,17 +60,109 @@ using namespace std;
 
 class ABYParty {
 public:
-	ABYParty(e_role pid, char* addr, seclvl seclvl, uint32_t bitlen = 32, uint32_t nthreads = 2, e_mt_gen_alg mg_algo = MT_OT, uint32_t maxgates = 4000000, uint16_t port = 7766);
+	ABYParty(e_role pid, char* addr, seclvl seclvl, uint32_t bitlen = 32, uint32_t nthreads = 2, e_mt_gen_alg mg_algo = MT_OT, uint32_t maxgates = 4000000, uint16_t port = 7766, BOOL async_startup = FALSE, uint32_t npoolthreads = 0, BOOL pinthreads = FALSE);
 	~ABYParty();
 
 	vector<Sharing*>& GetSharings() {
 		return m_vSharings;
 	}
+	/**
+	 Returns the arithmetic sharing with shares of bitlen bits (8, 16, 32, 64, or 128). The sharing with the bit length that was
+	 passed to the constructor is m_vSharings[S_ARITH]. Sharings of other bit lengths are created on the first request and
+	 appended to the sharings after S_LAST, such that their circuits are evaluated together with the other sharings and
+	 their MTs are generated in the same setup phase. Both parties have to request the bit lengths in the same order before
+	 building the circuit. Values are converted between the bit lengths with ArithmeticCircuit::PutWidthConvGate().
+	 \return the sharing, or NULL if the bit length is not supported
+	 */
+	Sharing* GetArithSharing(uint32_t bitlen);
+	/**
+	 Returns an arithmetic sharing over the prime field Z_prime with 64-bit shares, whose circuit uses the context
+	 S_ARITH_FIELD. It is created on the first request for prime and appended to the sharings like the sharings of
+	 GetArithSharing(). Inputs are reduced modulo prime and all operations are computed modulo prime, the shares are kept
+	 in Montgomery representation. Conversions from and to other sharings, matrix multiplications, and width
+	 conversions are not supported.
+	 \param 	prime 	odd prime < 2^62
+	 \return the sharing, or NULL if prime is not supported
+	 */
+	Sharing* GetFieldSharing(uint64_t prime);
 	CBitVector ExecCircuit();
+
+	/**
+	 Waits until the network connection is established and the base OTs are computed. Only blocks if the ABYParty was
+	 created with async_startup, in which case these steps run in the background while the circuit is being built.
+	 Is called by ExecCircuit() before the first operation that requires the connection.
+	 \return TRUE if the startup was successful
+	 */
+	BOOL WaitForStartup();
 	CBitVector ExecSetupPhase();
 
+	/**
+	 Clears the current circuit and the state of all sharings such that a new circuit can be built and evaluated.
+	 The network connection, the base OTs, and the OT extension state are kept for the lifetime of the ABYParty object,
+	 such that an arbitrary sequence of circuits can be evaluated and the setup phase of each circuit only performs the OT
+	 extension for the new circuit. Has to be called by both parties after each ExecCircuit(). If the circuit was compiled,
+	 the circuit is kept and restored instead, such that only the sharings are cleared.
+	 */
 	void Reset();
 
+	/**
+	 Compiles the circuit that was built so far, such that it can be evaluated repeatedly with fresh inputs without being
+	 re-built: the gates, the layer queues, and the gate counts that determine the MT and garbling requirements are kept
+	 across Reset(). Before each ExecCircuit(), the values of the own input shares can be replaced with
+	 Circuit::SetINGateValues(), while the setup phase is run anew for each evaluation. Has to be called by both parties
+	 before the first ExecCircuit().
+	 */
+	void CompileCircuit();
+	/**
+	 Releases the compiled circuit, such that the next Reset() clears the circuit and a new one can be built.
+	 */
+	void ReleaseCompiledCircuit();
+
+	/**
+	 Enables or disables the deduplication of identical AND, XOR, ADD, and MUL gates during circuit construction in all
+	 sharings: putting a gate with the same inputs as a previous gate of the same kind, in either order, returns the wire of
+	 the previous gate and does not count towards the MTs or garbled tables. Disabled by default.
+	 */
+	void SetGateDeduplication(BOOL enable);
+
+	/**
+	 Writes the circuit that was built (or compiled) together with the layer queues of all sharings to a binary circuit
+	 file, which can be loaded by both parties with LoadCircuit() instead of building the circuit. The input values of
+	 this party are not written. Has to be called before ExecCircuit() unless the circuit is compiled.
+	 \return TRUE if the file was written
+	 */
+	BOOL WriteCircuit(const char* filename);
+	/**
+	 Loads a circuit that was written with WriteCircuit() into this ABYParty, which must not hold a circuit yet. The own
+	 input gates are initialized with zero values that can be set with Circuit::SetINGateValues() on the sharings'
+	 circuits, using the gate ids of the written circuit. The circuit can be compiled afterwards.
+	 \return TRUE if the circuit was loaded, otherwise the circuit is cleared
+	 */
+	BOOL LoadCircuit(const char* filename);
+
+	/**
+	 Predicts the cost of evaluating the circuit that was built so far from its gates, without executing it. Both parties
+	 obtain the same prediction. The communication is summed over both parties and excludes the base OTs.
+	 \param costs	is filled with the cost of each sharing in total and for each layer, indexed by e_sharing
+	 \return the cost of the whole circuit, where a layer counts as one round if any sharing interacts on it
+	 */
+	layer_cost EstimateCost(vector<sharing_cost>& costs);
+	/**
+	 Estimates the time for the communication of a predicted cost on a network with the given profile. The local
+	 computation is not included. The data of both parties is assumed to share the bandwidth, each online round takes half a
+	 round-trip time since both parties send at the same time, and the setup phase takes one additional round-trip time.
+	 \param cost		predicted cost, e.g., returned by EstimateCost()
+	 \param bandwidth	bandwidth between the parties in Mbit/s
+	 \param rtt			round-trip time between the parties in ms
+	 \return the estimated time in ms
+	 */
+	static double EstimateRuntime(const layer_cost& cost, double bandwidth, double rtt);
+	/**
+	 Prints the predicted cost of each sharing and layer of the circuit that was built so far, together with the estimated
+	 runtime on a network with the given bandwidth in Mbit/s and round-trip time in ms.
+	 */
+	void PrintCostEstimate(double bandwidth, double rtt);
+
 	double GetTiming(ABYPHASE phase);
 	uint64_t GetSentData(ABYPHASE phase);
 	uint64_t GetReceivedData(ABYPHASE phase);
@@ -80,13 +173,17 @@ private:
 	void Cleanup();
 
 	BOOL InitCircuit(uint32_t bitlen, uint32_t maxgates);
+	Sharing* NewArithSharing(uint32_t bitlen);
+	void AddSharing(Sharing* sharing);
 
 	BOOL EstablishConnection();
+	BOOL PerformStartup();
 
 	BOOL ABYPartyListen();
 	BOOL ABYPartyConnect();
 
 	BOOL EvaluateCircuit();
+	void MarkConversionLayers(uint32_t maxdepth);
 
 	void BuildCircuit();
 	void BuildBoolMult(uint32_t bitlen, uint32_t resbitlen, uint32_t nvals);
@@ -112,8 +209,6 @@ private:
 
 	uint32_t m_nNumOTThreads;
 
-	uint32_t m_nHelperThreads;
-
 	char* m_cAddress;
 
 	uint32_t m_nDepth;
@@ -132,41 +227,48 @@ private:
 
 	crypto* m_cCrypt;
 
-	enum EPartyJobType {
-		e_Party_Comm, e_Party_Stop,
-	};
-
 	comm_ctx* m_tComm;
 
 	channel* m_tPartyChan;
 
-	class CPartyWorkerThread: public CThread {
-	public:
-		CPartyWorkerThread(uint32_t id, ABYParty* callback) :
-				threadid(id), m_pCallback(callback) {
-		}
-		;
-		void PutJob(EPartyJobType e) {
-			m_eJob = e;
-			m_evt.Set();
-		}
-		void ThreadMain();
-		uint32_t threadid;
-		ABYParty* m_pCallback;
-		CEvent m_evt;
-		EPartyJobType m_eJob;
-	};
+	//Pool that is shared by all phases, its size defaults to the number of cores
+	ThreadPool* m_pThreadPool;
+	uint32_t m_nPoolThreads;
+	BOOL m_bPinThreads;
+
+	CTaskGroup m_tCommTasks;
+	CTaskGroup m_tStartupTask;
+	BOOL m_bAsyncStartup;
 
-	BOOL WakeupWorkerThreads(EPartyJobType);
-	BOOL WaitWorkerThreads();
-	BOOL ThreadNotifyTaskDone(BOOL);
+	static BOOL SendValuesTask(void* party);
+	static BOOL ReceiveValuesTask(void* party);
+	static BOOL StartupTask(void* party);
 
-	vector<CPartyWorkerThread*> m_vThreads;
-	CEvent m_evt;
-	CLock m_lock;
+	/* Sharings are evaluated independently of each other, each on its own job of the thread pool */
+	enum ESharingJobType {
+		e_SetupSharing, e_LocalOps, e_InteractiveOps, e_LayerOps, e_FinishLayer,
+	};
+
+	struct sharing_job {
+		ABYParty* party;
+		uint32_t sharingid;
+		ESharingJobType job;
+		uint32_t depth;
+	};
 
-	uint32_t m_nWorkingThreads;
-	BOOL m_bWorkerThreadSuccess;
+	BOOL RunSharingJobs(ESharingJobType job, uint32_t depth);
+	BOOL RunSharingJob(uint32_t sharingid, ESharingJobType job, uint32_t depth);
+	static BOOL SharingJobTask(void* arg);
+
+	CTaskGroup m_tSharingTasks;
+	vector<sharing_job> m_vSharingJobs;
+	//layers that contain a conversion gate, which requires the local gates of all sharings to be evaluated first
+	vector<BOOL> m_vConvLayers;
+#ifdef BENCHONLINEPHASE
+	vector<double> m_vLocalOpsTime;
+	vector<double> m_vInteractiveOpsTime;
+	vector<double> m_vFinishLayerTime;
+#endif
 
 };
 
@@ -18,8 +18,9 @@
 
 #include "abysetup.h"
 
-ABYSetup::ABYSetup(crypto* crypt, uint32_t numThreads, e_role role, e_mt_gen_alg mtalgo) {
+ABYSetup::ABYSetup(crypto* crypt, uint32_t numThreads, e_role role, e_mt_gen_alg mtalgo, ThreadPool* pool) {
 	m_nNumOTThreads = numThreads;
+	m_pThreadPool = pool;
 	m_cCrypt = crypt;
 	m_eRole = role;
 	m_eMTGenAlg = mtalgo;
@@ -41,12 +42,8 @@ BOOL ABYSetup::Init() {
 	m_vIKNPOTTasks.resize(2);
 	m_vKKOTTasks.resize(2);
 
-	uint32_t threadsize = 2 * m_nNumOTThreads;
-	m_vThreads.resize(threadsize);
-	for (uint32_t i = 0; i < threadsize; i++) { //double the number of threads for role-flippling
-		m_vThreads[i] = new CWorkerThread(i, this);
-		m_vThreads[i]->Start();
-	}
+	//double the number of jobs for role-flippling
+	m_vJobs.resize(2 * m_nNumOTThreads);
 
 	//the bit length of the DJN and DGK party is irrelevant here, since it is set for each MT Gen task independently
 	if (m_eMTGenAlg == MT_PAILLIER) {
@@ -69,6 +66,10 @@ BOOL ABYSetup::Init() {
 }
 
 void ABYSetup::Cleanup() {
+	for (map<uint32_t, DGKParty*>::iterator it = m_mDGKMTGenCache.begin(); it != m_mDGKMTGenCache.end(); it++) {
+		delete it->second;
+	}
+	m_mDGKMTGenCache.clear();
 
 	if(m_tSetupChan) {
 		m_tSetupChan->synchronize_end();
@@ -144,21 +145,27 @@ BOOL ABYSetup::PerformSetupPhase() {
 	} else if (m_eMTGenAlg == MT_DGK) {
 #ifndef BENCH_PRECOMP
 		m_cDGKMTGen = (DGKParty**) malloc(sizeof(DGKParty*) * m_vPKMTGenTasks.size());
-#endif
 		for (uint32_t i = 0; i < m_vPKMTGenTasks.size(); i++) {
-#ifndef BENCH_PRECOMP
-			m_cDGKMTGen[i] = new DGKParty(m_cCrypt->get_seclvl().ifcbits, m_vPKMTGenTasks[i]->sharebitlen, 1);
-#endif
+			//DGK keys are kept for the lifetime of the session, such that the key exchange is only done once per share bit length
+			uint32_t sharebitlen = m_vPKMTGenTasks[i]->sharebitlen;
+			if (m_mDGKMTGenCache.find(sharebitlen) == m_mDGKMTGenCache.end()) {
+				m_mDGKMTGenCache[sharebitlen] = new DGKParty(m_cCrypt->get_seclvl().ifcbits, sharebitlen, 1);
+				m_mDGKMTGenCache[sharebitlen]->keyExchange(m_tSetupChan);
+			}
+			m_cDGKMTGen[i] = m_mDGKMTGenCache[sharebitlen];
+		}
+#else
+		for (uint32_t i = 0; i < m_vPKMTGenTasks.size(); i++) {
 			m_cDGKMTGen[i]->keyExchange(m_tSetupChan);
 		}
+#endif
 		//Start DGK MT generation
 		WakeupWorkerThreads(e_MTDGK);
 		success &= WaitWorkerThreads();
 
-		for (uint32_t i = 0; i < m_vPKMTGenTasks.size(); i++) {
-			delete m_cDGKMTGen[i];
-		}
+#ifndef BENCH_PRECOMP
 		free(m_cDGKMTGen);
+#endif
 	}
 	return success;
 }
@@ -327,10 +334,10 @@ BOOL ABYSetup::ThreadRunPaillierMTGen(uint32_t threadid) {
 		UINT32_T roleoffset = mystartpos + sharebytelen * (mynummts / 2);
 		if (m_eRole == SERVER) {
 			m_cPaillierMTGen->preCompBench(ptask->A->GetArr() + mystartpos, ptask->B->GetArr() + mystartpos, ptask->C->GetArr() + mystartpos, ptask->A->GetArr() + roleoffset,
-					ptask->B->GetArr() + roleoffset, ptask->C->GetArr() + roleoffset, mynummts, djnchan);
+					ptask->B->GetArr() + roleoffset, ptask->C->GetArr() + roleoffset, mynummts, djnchan, ptask->modulus);
 		} else {
 			m_cPaillierMTGen->preCompBench(ptask->A->GetArr() + roleoffset, ptask->B->GetArr() + roleoffset, ptask->C->GetArr() + roleoffset, ptask->A->GetArr() + mystartpos,
-					ptask->B->GetArr() + mystartpos, ptask->C->GetArr() + mystartpos, mynummts, djnchan);
+					ptask->B->GetArr() + mystartpos, ptask->C->GetArr() + mystartpos, mynummts, djnchan, ptask->modulus);
 		}
 
 	}
@@ -366,10 +373,10 @@ BOOL ABYSetup::ThreadRunDGKMTGen(uint32_t threadid) {
 
 		if (m_eRole == SERVER) {
 			m_cDGKMTGen[i]->preCompBench(ptask->A->GetArr() + mystartpos, ptask->B->GetArr() + mystartpos, ptask->C->GetArr() + mystartpos, ptask->A->GetArr() + roleoffset,
-					ptask->B->GetArr() + roleoffset, ptask->C->GetArr() + roleoffset, mynummts, dgkchan);
+					ptask->B->GetArr() + roleoffset, ptask->C->GetArr() + roleoffset, mynummts, dgkchan, ptask->modulus);
 		} else {
 			m_cDGKMTGen[i]->preCompBench(ptask->A->GetArr() + roleoffset, ptask->B->GetArr() + roleoffset, ptask->C->GetArr() + roleoffset, ptask->A->GetArr() + mystartpos,
-					ptask->B->GetArr() + mystartpos, ptask->C->GetArr() + mystartpos, mynummts, dgkchan);
+					ptask->B->GetArr() + mystartpos, ptask->C->GetArr() + mystartpos, mynummts, dgkchan, ptask->modulus);
 		}
 	}
 	dgkchan->synchronize_end();
@@ -378,24 +385,32 @@ BOOL ABYSetup::ThreadRunDGKMTGen(uint32_t threadid) {
 	return true;
 }
 
-//starts a new sending thread but may stop if there is a thread already running
+//starts a new sending job but waits for the previous sending job to finish first
 void ABYSetup::AddSendTask(BYTE* sndbuf, uint64_t sndbytes) {
-	WaitWorkerThreads();
+	m_pThreadPool->Wait(&m_tSndJobs);
 	m_tsndtask.sndbytes = sndbytes;
 	m_tsndtask.sndbuf = sndbuf;
-	WakeupWorkerThreads(e_Send);
+	m_tSndJob.setup = this;
+	m_tSndJob.job = e_Send;
+	m_tSndJob.threadid = 0;
+	m_pThreadPool->Submit(&m_tSndJobs, RunJob, &m_tSndJob);
 }
 
 BOOL ABYSetup::WaitForTransmissionEnd() {
-	return WaitWorkerThreads();
+	BOOL success = m_pThreadPool->Wait(&m_tSndJobs);
+	success &= m_pThreadPool->Wait(&m_tRcvJobs);
+	return success;
 }
 
-//starts a new receivingthread but may stop if there is a thread already running
+//starts a new receiving job but waits for the previous receiving job to finish first
 void ABYSetup::AddReceiveTask(BYTE* rcvbuf, uint64_t rcvbytes) {
-	WaitWorkerThreads();
+	m_pThreadPool->Wait(&m_tRcvJobs);
 	m_trcvtask.rcvbytes = rcvbytes;
 	m_trcvtask.rcvbuf = rcvbuf;
-	WakeupWorkerThreads(e_Receive);
+	m_tRcvJob.setup = this;
+	m_tRcvJob.job = e_Receive;
+	m_tRcvJob.threadid = 0;
+	m_pThreadPool->Submit(&m_tRcvJobs, RunJob, &m_tRcvJob);
 }
 
 BOOL ABYSetup::ThreadSendData(uint32_t threadid) {
@@ -411,92 +426,66 @@ BOOL ABYSetup::ThreadReceiveData(uint32_t threadid) {
 //===========================================================================
 // Thread Management
 BOOL ABYSetup::WakeupWorkerThreads(EJobType e) {
-	m_bWorkerThreadSuccess = TRUE;
-
-	m_nWorkingThreads = 2;
+	uint32_t n = 2;
 
 	if (e == e_MTPaillier || e == e_MTDGK)
-		m_nWorkingThreads = 2 * m_nNumOTThreads;
-	else if (e == e_Send || e == e_Receive)
-		m_nWorkingThreads = 1;
-
-	uint32_t n = m_nWorkingThreads;
+		n = 2 * m_nNumOTThreads;
 
-	for (uint32_t i = 0; i < n; i++)
-		m_vThreads[i]->PutJob(e);
+	for (uint32_t i = 0; i < n; i++) {
+		m_vJobs[i].setup = this;
+		m_vJobs[i].job = e;
+		m_vJobs[i].threadid = i;
+		m_pThreadPool->Submit(&m_tJobs, RunJob, &m_vJobs[i]);
+	}
 
 	return TRUE;
 }
 
 BOOL ABYSetup::WaitWorkerThreads() {
-	if (!m_nWorkingThreads)
-		return TRUE;
-
-	for (;;) {
-		m_lock.Lock();
-		uint32_t n = m_nWorkingThreads;
-		m_lock.Unlock();
-		if (!n)
-			return m_bWorkerThreadSuccess;
-		m_evt.Wait();
-	}
-	return m_bWorkerThreadSuccess;
-}
-
-BOOL ABYSetup::ThreadNotifyTaskDone(BOOL bSuccess) {
-	m_lock.Lock();
-	uint32_t n = --m_nWorkingThreads;
-	if (!bSuccess){
-		m_bWorkerThreadSuccess = FALSE;
-	}
-	m_lock.Unlock();
-
-	if (!n)
-		m_evt.Set();
-	return TRUE;
+	return m_pThreadPool->Wait(&m_tJobs);
 }
 
-void ABYSetup::CWorkerThread::ThreadMain() {
+BOOL ABYSetup::RunJob(void* arg) {
+	setup_job* job = (setup_job*) arg;
+	ABYSetup* setup = job->setup;
+	uint32_t threadid = job->threadid;
 	BOOL bSuccess = FALSE;
-	for (;;) {
-		m_evt.Wait();
-
-		switch (m_eJob) {
-		case e_Stop:
-			return;
-		case e_IKNPOTExt:
-			if (threadid == SERVER)
-				bSuccess = m_pCallback->ThreadRunIKNPSnd(threadid);
-			else
-				bSuccess = m_pCallback->ThreadRunIKNPRcv(threadid);
-			break;
-		case e_KKOTExt:
-			if (threadid == SERVER)
-				bSuccess = m_pCallback->ThreadRunKKSnd(threadid);
-			else
-				bSuccess = m_pCallback->ThreadRunKKRcv(threadid);
-			break;
-		case e_NP:
-			if (threadid == SERVER)
-				bSuccess = m_pCallback->ThreadRunNPSnd(threadid);
-			else
-				bSuccess = m_pCallback->ThreadRunNPRcv(threadid);
-			break;
-		case e_MTPaillier:
-			bSuccess = m_pCallback->ThreadRunPaillierMTGen(threadid);
-			break;
-		case e_MTDGK:
-			bSuccess = m_pCallback->ThreadRunDGKMTGen(threadid);
-			break;
-		case e_Send:
-			bSuccess = m_pCallback->ThreadSendData(threadid);
-			break;
-		case e_Receive:
-			bSuccess = m_pCallback->ThreadReceiveData(threadid);
-			break;
-		}
-		m_pCallback->ThreadNotifyTaskDone(bSuccess);
+
+	switch (job->job) {
+	case e_IKNPOTExt:
+		if (threadid == SERVER)
+			bSuccess = setup->ThreadRunIKNPSnd(threadid);
+		else
+			bSuccess = setup->ThreadRunIKNPRcv(threadid);
+		break;
+	case e_KKOTExt:
+		if (threadid == SERVER)
+			bSuccess = setup->ThreadRunKKSnd(threadid);
+		else
+			bSuccess = setup->ThreadRunKKRcv(threadid);
+		break;
+	case e_NP:
+		if (threadid == SERVER)
+			bSuccess = setup->ThreadRunNPSnd(threadid);
+		else
+			bSuccess = setup->ThreadRunNPRcv(threadid);
+		break;
+	case e_MTPaillier:
+		bSuccess = setup->ThreadRunPaillierMTGen(threadid);
+		break;
+	case e_MTDGK:
+		bSuccess = setup->ThreadRunDGKMTGen(threadid);
+		break;
+	case e_Send:
+		bSuccess = setup->ThreadSendData(threadid);
+		break;
+	case e_Receive:
+		bSuccess = setup->ThreadReceiveData(threadid);
+		break;
+	default:
+		break;
 	}
+	return bSuccess;
 }
 
 void ABYSetup::Reset() {
@@ -508,6 +497,8 @@ void ABYSetup::Reset() {
 	for (uint32_t i = 0; i < m_vKKOTTasks.size(); i++) {
 		m_vKKOTTasks[i].clear();
 	}
+	/* Clear the public-key MT generation tasks, the DJN / DGK keys are kept for the next circuit */
+	m_vPKMTGenTasks.clear();
 
 
 }
@@ -36,6 +36,8 @@
 #include "../util/channel.h"
 #include "../util/sndthread.h"
 #include "../util/rcvthread.h"
+#include "../util/threadpool.h"
+#include <map>
 
 typedef struct {
 	SndThread *snd_std, *snd_inv;
@@ -67,6 +69,7 @@ struct PKMTGenVals {
 	CBitVector* C;
 	uint32_t numMTs;
 	uint32_t sharebitlen;
+	uint64_t modulus; //prime modulus of a field sharing, 0 for MTs modulo 2^sharebitlen
 };
 
 union IKNPPartyValues {
@@ -113,9 +116,14 @@ struct ReceiveTask {
 class ABYSetup {
 
 public:
-	ABYSetup(crypto* crypt, uint32_t numThreads, e_role role, e_mt_gen_alg mtalgo);
+	ABYSetup(crypto* crypt, uint32_t numThreads, e_role role, e_mt_gen_alg mtalgo, ThreadPool* pool);
 	~ABYSetup();
 
+	/**
+	 Prepare the setup for the evaluation of a new circuit. The base OTs, the state of the OT extension,
+	 and the keys for the public-key based MT generation are kept, such that the next setup phase only
+	 has to extend the OTs that are required by the new circuit.
+	 */
 	void Reset();
 
 	BOOL PrepareSetupPhase(comm_ctx* comm);
@@ -137,7 +145,9 @@ public:
 	}
 	;
 
-	//Both methods start a new thread but may stop if there is a thread already running
+	//Both methods start a new job but may stop if a job in the same direction is still running. Sending and receiving are
+	//tracked separately, such that a sharing that only sends (e.g., the Yao server) and a sharing that only receives
+	//(e.g., the Yao client) can be set up concurrently
 	void AddSendTask(BYTE* sndbuf, uint64_t sndbytes);
 	void AddReceiveTask(BYTE* rcvbuf, uint64_t rcvbytes);
 
@@ -171,6 +181,7 @@ private:
 	vector<PKMTGenVals*> m_vPKMTGenTasks;
 	DJNParty* m_cPaillierMTGen;
 	DGKParty** m_cDGKMTGen;
+	map<uint32_t, DGKParty*> m_mDGKMTGenCache; //DGK parties that are kept across circuits, one per share bit length
 
 	uint32_t m_nNumOTThreads;
 	e_role m_eRole;
@@ -202,30 +213,22 @@ private:
 
 	BOOL WakeupWorkerThreads(EJobType);
 	BOOL WaitWorkerThreads();
-	BOOL ThreadNotifyTaskDone(BOOL);
-
-	class CWorkerThread: public CThread {
-	public:
-		CWorkerThread(uint32_t i, ABYSetup* callback) :
-				threadid(i), m_pCallback(callback) {
-		}
-		void PutJob(EJobType e) {
-			m_eJob = e;
-			m_evt.Set();
-		}
-		void ThreadMain();
+
+	//A job that is executed by the thread pool, threadid identifies the part of the work that is done by the job
+	struct setup_job {
+		ABYSetup* setup;
+		EJobType job;
 		uint32_t threadid;
-		ABYSetup* m_pCallback;
-		CEvent m_evt;
-		EJobType m_eJob;
 	};
-
-	vector<CWorkerThread*> m_vThreads;
-	CEvent m_evt;
-	CLock m_lock;
-
-	uint32_t m_nWorkingThreads;
-	BOOL m_bWorkerThreadSuccess;
+	static BOOL RunJob(void* arg);
+
+	ThreadPool* m_pThreadPool;
+	CTaskGroup m_tJobs;
+	vector<setup_job> m_vJobs;
+	CTaskGroup m_tSndJobs;
+	setup_job m_tSndJob;
+	CTaskGroup m_tRcvJobs;
+	setup_job m_tRcvJob;
 
 
 };
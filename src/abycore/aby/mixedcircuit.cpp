@@ -0,0 +1,409 @@
+/**
+ \file 		mixedcircuit.cpp
+ \author	michael.zohner@ec-spride.de
+ \copyright	ABY - A Framework for Efficient Mixed-protocol Secure Two-party Computation
+			Copyright (C) 2015 Engineering Cryptographic Protocols Group, TU Darmstadt
+			This program is free software: you can redistribute it and/or modify
+			it under the terms of the GNU Affero General Public License as published
+			by the Free Software Foundation, either version 3 of the License, or
+			(at your option) any later version.
+			This program is distributed in the hope that it will be useful,
+			but WITHOUT ANY WARRANTY; without even the implied warranty of
+			MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+			GNU Affero General Public License for more details.
+			You should have received a copy of the GNU Affero General Public License
+			along with this program. If not, see <http://www.gnu.org/licenses/>.
+ \brief		Sharing-agnostic circuit builder that assigns the operations to sharings
+ */
+
+#include "mixedcircuit.h"
+
+//add the non-linear operations, OTs, and bits of add factor times to cost, the rounds are combined by the caller
+static void AddCost(layer_cost* cost, const layer_cost& add, uint64_t factor = 1) {
+	cost->nonlinops += add.nonlinops * factor;
+	cost->numOTs += add.numOTs * factor;
+	cost->setupbits += add.setupbits * factor;
+	cost->onlinebits += add.onlinebits * factor;
+}
+
+MixedCircuit::MixedCircuit(ABYParty* party, uint32_t nvals) :
+		m_vSharings(party->GetSharings()) {
+	m_vCircuits.resize(MIXED_NUM_SHARINGS);
+	for (uint32_t i = 0; i < MIXED_NUM_SHARINGS; i++) {
+		m_vCircuits[i] = m_vSharings[i]->GetCircuitBuildRoutine();
+	}
+	m_nBitLen = m_vCircuits[S_ARITH]->GetShareBitLen();
+	m_nNumVals = nvals;
+	m_dBandwidth = 0;
+	m_dRTT = 0;
+}
+
+MixedCircuit::~MixedCircuit() {
+	for (uint32_t i = 0; i < m_vNodes.size(); i++) {
+		for (uint32_t s = 0; s < MIXED_NUM_SHARINGS; s++) {
+			if (m_vNodes[i].shr[s])
+				delete m_vNodes[i].shr[s];
+		}
+	}
+}
+
+uint32_t MixedCircuit::PutNode(e_mixed_op op, uint32_t bitlen, uint32_t ina, uint32_t inb, uint32_t sel) {
+	uint32_t ninputs = (op == MIXED_IN || op == MIXED_CONS) ? 0 : (op == MIXED_OUT) ? 1 : (op == MIXED_MUX) ? 3 : 2;
+	uint32_t inputs[] = { ina, inb, sel };
+	uint32_t id = m_vNodes.size();
+	mixed_node node;
+
+	node.op = op;
+	node.bitlen = bitlen;
+	node.role = ALL;
+	node.vals = NULL;
+	node.constval = 0;
+	node.sharing = S_BOOL;
+	memset(node.feasible, 0, sizeof(node.feasible));
+	memset(node.cost, 0, sizeof(node.cost));
+	memset(node.shr, 0, sizeof(node.shr));
+	for (uint32_t i = 0; i < ninputs; i++) {
+		assert(inputs[i] < id && m_vNodes[inputs[i]].op != MIXED_OUT);
+		node.in.push_back(inputs[i]);
+		m_vNodes[inputs[i]].consumers.push_back(id);
+	}
+	m_vNodes.push_back(node);
+	return id;
+}
+
+uint32_t MixedCircuit::PutSIMDINGate(uint64_t* vals, e_role src) {
+	uint32_t id = PutNode(MIXED_IN, m_nBitLen);
+	m_vNodes[id].vals = vals;
+	m_vNodes[id].role = src;
+	return id;
+}
+
+uint32_t MixedCircuit::PutCONSGate(UGATE_T val) {
+	uint32_t id = PutNode(MIXED_CONS, m_nBitLen);
+	m_vNodes[id].constval = val;
+	return id;
+}
+
+uint32_t MixedCircuit::PutADDGate(uint32_t ina, uint32_t inb) {
+	return PutNode(MIXED_ADD, m_nBitLen, ina, inb);
+}
+
+uint32_t MixedCircuit::PutSUBGate(uint32_t ina, uint32_t inb) {
+	return PutNode(MIXED_SUB, m_nBitLen, ina, inb);
+}
+
+uint32_t MixedCircuit::PutMULGate(uint32_t ina, uint32_t inb) {
+	return PutNode(MIXED_MUL, m_nBitLen, ina, inb);
+}
+
+uint32_t MixedCircuit::PutGTGate(uint32_t ina, uint32_t inb) {
+	return PutNode(MIXED_GT, 1, ina, inb);
+}
+
+uint32_t MixedCircuit::PutMUXGate(uint32_t ina, uint32_t inb, uint32_t sel) {
+	return PutNode(MIXED_MUX, max(m_vNodes[ina].bitlen, m_vNodes[inb].bitlen), ina, inb, sel);
+}
+
+uint32_t MixedCircuit::PutOUTGate(uint32_t in, e_role dst) {
+	uint32_t id = PutNode(MIXED_OUT, m_vNodes[in].bitlen, in);
+	m_vNodes[id].role = dst;
+	return id;
+}
+
+layer_cost MixedCircuit::BuildCircuit(double bandwidth, double rtt) {
+	layer_cost total;
+
+	m_dBandwidth = bandwidth;
+	m_dRTT = rtt;
+
+	ComputeCosts();
+	AssignSharings();
+	PutGates();
+
+	//the outputs cover all operations that are used
+	memset(&total, 0, sizeof(layer_cost));
+	for (uint32_t i = 0; i < m_vNodes.size(); i++) {
+		if (m_vNodes[i].op == MIXED_OUT) {
+			AddCost(&total, m_vNodes[i].cost[m_vNodes[i].sharing]);
+			total.rounds = max(total.rounds, m_vNodes[i].cost[m_vNodes[i].sharing].rounds);
+		}
+	}
+	return total;
+}
+
+BOOL MixedCircuit::IsSupported(e_mixed_op op, e_sharing s) {
+	return s != S_ARITH || (op != MIXED_GT && op != MIXED_MUX);
+}
+
+double MixedCircuit::GetTime(const layer_cost& cost) {
+	return ABYParty::EstimateRuntime(cost, m_dBandwidth, m_dRTT);
+}
+
+//add the cost of ngates gates of the given type with nvals values each, as predicted by the sharing
+void MixedCircuit::AddGateCost(e_sharing s, e_gatetype type, e_role role, uint32_t ningates, uint64_t ngates, layer_cost* cost) {
+	GATE gate;
+	layer_cost gatecost;
+
+	memset(&gate, 0, sizeof(GATE));
+	memset(&gatecost, 0, sizeof(layer_cost));
+	gate.type = type;
+	gate.context = s;
+	gate.nvals = m_nNumVals;
+	gate.sharebitlen = 1;
+	gate.ingates.ningates = ningates;
+	if (type == G_IN)
+		gate.gs.ishare.src = role;
+	else if (type == G_OUT)
+		gate.gs.oshare.dst = role;
+	else if (type == G_NON_LIN_VEC) {
+		//the vector ANDs of the depth-optimized adder multiply one bit with two bits
+		gate.gs.avs.bitlen = 2;
+		gate.nvals *= 2;
+	}
+
+	m_vSharings[s]->EstimateGateCost(&gate, &gatecost);
+	AddCost(cost, gatecost, ngates);
+}
+
+//approximate number of AND gates and rounds of the Boolean circuit constructions, where Boolean sharing uses the
+//depth-optimized and Yao sharing the size-optimized variants
+layer_cost MixedCircuit::GetOpCost(mixed_node* node, e_sharing s) {
+	layer_cost cost;
+	uint64_t l = node->bitlen;
+	uint32_t logl = ceil_log2(l);
+	uint64_t nands = 0;
+
+	memset(&cost, 0, sizeof(layer_cost));
+	switch (node->op) {
+	case MIXED_IN:
+	case MIXED_OUT:
+		//Boolean and Yao sharing have one gate per bit, arithmetic sharing one gate per value
+		AddGateCost(s, node->op == MIXED_IN ? G_IN : G_OUT, node->role, 1, s == S_ARITH ? 1 : l, &cost);
+		cost.rounds = 1;
+		break;
+	case MIXED_CONS:
+		break;
+	case MIXED_ADD:
+	case MIXED_SUB:
+		nands = (s == S_BOOL) ? l * logl + l : l;
+		cost.rounds = (s == S_BOOL) ? logl + 1 : 0;
+		break;
+	case MIXED_MUL:
+		if (s == S_ARITH) {
+			AddGateCost(s, G_NON_LIN, ALL, 2, 1, &cost);
+			cost.rounds = 1;
+		} else {
+			nands = l * l;
+			cost.rounds = (s == S_BOOL) ? 2 * logl + 1 : 0;
+		}
+		break;
+	case MIXED_GT:
+		l = m_vNodes[node->in[0]].bitlen;
+		logl = ceil_log2(l);
+		nands = (s == S_BOOL) ? 2 * l : l;
+		cost.rounds = (s == S_BOOL) ? logl + 1 : 0;
+		break;
+	case MIXED_MUX:
+		nands = l;
+		cost.rounds = (s == S_BOOL) ? 1 : 0;
+		break;
+	}
+	if (nands > 0)
+		AddGateCost(s, G_NON_LIN, ALL, 2, nands, &cost);
+	return cost;
+}
+
+//the bits of both arithmetic shares are input locally and added with the depth-optimized adder, where the first level has
+//one AND per bit and each further level one vector AND for half of the bits
+layer_cost MixedCircuit::GetGMWA2BCost(uint32_t bitlen) {
+	layer_cost cost;
+	uint32_t logl = ceil_log2(bitlen);
+
+	memset(&cost, 0, sizeof(layer_cost));
+	AddGateCost(S_BOOL, G_NON_LIN, ALL, 2, bitlen, &cost);
+	AddGateCost(S_BOOL, G_NON_LIN_VEC, ALL, 2, (uint64_t) logl * (bitlen / 2), &cost);
+	cost.rounds = logl + 1;
+	return cost;
+}
+
+BOOL MixedCircuit::IsGMWA2BFaster(uint32_t bitlen) {
+	return GetTime(GetGMWA2BCost(bitlen)) < GetTime(GetConversionCost(S_ARITH, S_YAO, bitlen));
+}
+
+layer_cost MixedCircuit::GetConversionCost(e_sharing from, e_sharing to, uint32_t bitlen) {
+	layer_cost cost;
+	layer_cost step;
+
+	memset(&cost, 0, sizeof(layer_cost));
+	if (from == to || (from == S_YAO && to == S_BOOL)) {
+		//Y2B is evaluated locally
+		return cost;
+	}
+	if (from == S_ARITH && to == S_BOOL) {
+		//A2B is done via Yao sharing or with the adder in Boolean sharing, whichever is predicted to be faster
+		layer_cost gmw = GetGMWA2BCost(bitlen);
+		cost = GetConversionCost(S_ARITH, S_YAO, bitlen);
+		return GetTime(gmw) < GetTime(cost) ? gmw : cost;
+	}
+
+	switch (to) {
+	case S_YAO:
+		//the garbler's share is input directly, the evaluator's share via OT, and A2Y adds both shares
+		AddGateCost(S_YAO, G_IN, SERVER, 1, bitlen, &cost);
+		AddGateCost(S_YAO, G_IN, CLIENT, 1, bitlen, &cost);
+		if (from == S_ARITH)
+			AddGateCost(S_YAO, G_NON_LIN, ALL, 2, bitlen, &cost);
+		cost.rounds = 2;
+		break;
+	case S_ARITH:
+		//B2A converts each bit with one random OT, and Y2A reads the Boolean shares locally from the Yao keys, which
+		//needs no Y2B gate, before the same conversion of each bit
+		memset(&step, 0, sizeof(layer_cost));
+		AddGateCost(S_ARITH, G_CONV, ALL, bitlen, 1, &step);
+		AddCost(&cost, step);
+		cost.rounds += 2;
+		break;
+	default:
+		break;
+	}
+	return cost;
+}
+
+//predict the cost of each node in each sharing, where each input is converted from its cheapest sharing
+void MixedCircuit::ComputeCosts() {
+	for (uint32_t i = 0; i < m_vNodes.size(); i++) {
+		mixed_node* node = &(m_vNodes[i]);
+		for (uint32_t s = 0; s < MIXED_NUM_SHARINGS; s++) {
+			node->feasible[s] = IsSupported(node->op, (e_sharing) s);
+			if (!node->feasible[s])
+				continue;
+			layer_cost cost = GetOpCost(node, (e_sharing) s);
+			uint32_t inrounds = 0;
+			for (uint32_t j = 0; j < node->in.size(); j++) {
+				mixed_node* in = &(m_vNodes[node->in[j]]);
+				layer_cost best, incost;
+				BOOL found = FALSE;
+				for (uint32_t t = 0; t < MIXED_NUM_SHARINGS; t++) {
+					if (!in->feasible[t])
+						continue;
+					incost = GetConversionCost((e_sharing) t, (e_sharing) s, in->bitlen);
+					AddCost(&incost, in->cost[t]);
+					incost.rounds += in->cost[t].rounds;
+					if (!found || GetTime(incost) < GetTime(best)) {
+						best = incost;
+						found = TRUE;
+					}
+				}
+				AddCost(&cost, best);
+				inrounds = max(inrounds, best.rounds);
+			}
+			cost.rounds += inrounds;
+			node->cost[s] = cost;
+		}
+	}
+}
+
+//assign the sharings from the outputs to the inputs, each node takes the sharing that is cheapest for itself together with
+//the conversions to the sharings of its consumers
+void MixedCircuit::AssignSharings() {
+	for (uint32_t i = m_vNodes.size(); i-- > 0;) {
+		mixed_node* node = &(m_vNodes[i]);
+		BOOL consumed[MIXED_NUM_SHARINGS];
+		double besttime = 0;
+		BOOL found = FALSE;
+
+		memset(consumed, 0, sizeof(consumed));
+		for (uint32_t j = 0; j < node->consumers.size(); j++) {
+			consumed[m_vNodes[node->consumers[j]].sharing] = TRUE;
+		}
+		for (uint32_t s = 0; s < MIXED_NUM_SHARINGS; s++) {
+			if (!node->feasible[s])
+				continue;
+			layer_cost cost = node->cost[s];
+			for (uint32_t t = 0; t < MIXED_NUM_SHARINGS; t++) {
+				if (!consumed[t])
+					continue;
+				layer_cost conv = GetConversionCost((e_sharing) s, (e_sharing) t, node->bitlen);
+				AddCost(&cost, conv);
+				cost.rounds = max(cost.rounds, node->cost[s].rounds + conv.rounds);
+			}
+			if (!found || GetTime(cost) < besttime) {
+				besttime = GetTime(cost);
+				node->sharing = (e_sharing) s;
+				found = TRUE;
+			}
+		}
+	}
+}
+
+void MixedCircuit::PutGates() {
+	for (uint32_t i = 0; i < m_vNodes.size(); i++) {
+		mixed_node* node = &(m_vNodes[i]);
+		node->shr[node->sharing] = PutOperation(node, m_vCircuits[node->sharing]);
+	}
+}
+
+//returns the value of a node in sharing s, which is converted from the assigned sharing once
+share* MixedCircuit::GetShare(uint32_t id, e_sharing s) {
+	mixed_node* node = &(m_vNodes[id]);
+	share* in = node->shr[node->sharing];
+	share* shr;
+
+	if (node->shr[s])
+		return node->shr[s];
+
+	switch (s) {
+	case S_BOOL:
+		if (node->sharing == S_YAO)
+			shr = m_vCircuits[S_BOOL]->PutY2BGate(in);
+		else
+			shr = m_vCircuits[S_BOOL]->PutA2BGate(in, IsGMWA2BFaster(node->bitlen) ? NULL : m_vCircuits[S_YAO]);
+		break;
+	case S_YAO:
+		shr = node->sharing == S_BOOL ? m_vCircuits[S_YAO]->PutB2YGate(in) : m_vCircuits[S_YAO]->PutA2YGate(in);
+		break;
+	default:
+		shr = node->sharing == S_BOOL ? m_vCircuits[S_ARITH]->PutB2AGate(in) : m_vCircuits[S_ARITH]->PutY2AGate(in, m_vCircuits[S_BOOL]);
+		break;
+	}
+	if (s != S_ARITH && shr->get_bitlength() > node->bitlen)
+		shr->set_bitlength(node->bitlen);
+	node->shr[s] = shr;
+	return shr;
+}
+
+share* MixedCircuit::PutOperation(mixed_node* node, Circuit* circ) {
+	e_sharing s = node->sharing;
+	share* shr;
+
+	switch (node->op) {
+	case MIXED_IN:
+		shr = circ->PutSIMDINGate(m_nNumVals, node->vals, m_nBitLen, node->role);
+		break;
+	case MIXED_CONS:
+		shr = circ->PutSIMDCONSGate(m_nNumVals, node->constval, m_nBitLen);
+		break;
+	case MIXED_ADD:
+		shr = circ->PutADDGate(GetShare(node->in[0], s), GetShare(node->in[1], s));
+		break;
+	case MIXED_SUB:
+		shr = circ->PutSUBGate(GetShare(node->in[0], s), GetShare(node->in[1], s));
+		break;
+	case MIXED_MUL:
+		shr = circ->PutMULGate(GetShare(node->in[0], s), GetShare(node->in[1], s));
+		break;
+	case MIXED_GT:
+		shr = circ->PutGTGate(GetShare(node->in[0], s), GetShare(node->in[1], s));
+		break;
+	case MIXED_MUX:
+		shr = circ->PutMUXGate(GetShare(node->in[0], s), GetShare(node->in[1], s), GetShare(node->in[2], s));
+		break;
+	default:
+		shr = circ->PutOUTGate(GetShare(node->in[0], s), node->role);
+		break;
+	}
+	//the Boolean circuit constructions may add a carry, values are reduced modulo 2^bitlen
+	if (s != S_ARITH && shr->get_bitlength() > node->bitlen)
+		shr->set_bitlength(node->bitlen);
+	return shr;
+}
@@ -0,0 +1,138 @@
+/**
+ \file 		mixedcircuit.h
+ \author	michael.zohner@ec-spride.de
+ \copyright	ABY - A Framework for Efficient Mixed-protocol Secure Two-party Computation
+			Copyright (C) 2015 Engineering Cryptographic Protocols Group, TU Darmstadt
+			This program is free software: you can redistribute it and/or modify
+			it under the terms of the GNU Affero General Public License as published
+			by the Free Software Foundation, either version 3 of the License, or
+			(at your option) any later version.
+			This program is distributed in the hope that it will be useful,
+			but WITHOUT ANY WARRANTY; without even the implied warranty of
+			MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+			GNU Affero General Public License for more details.
+			You should have received a copy of the GNU Affero General Public License
+			along with this program. If not, see <http://www.gnu.org/licenses/>.
+ \brief		Sharing-agnostic circuit builder that assigns the operations to sharings
+ */
+
+#ifndef __MIXEDCIRCUIT_H__
+#define __MIXEDCIRCUIT_H__
+
+#include "abyparty.h"
+#include <vector>
+
+using namespace std;
+
+/**
+ \def	MIXED_NUM_SHARINGS
+ \brief	The operations are assigned to the first sharings of e_sharing, i.e., S_BOOL, S_YAO, and S_ARITH
+ */
+#define MIXED_NUM_SHARINGS 3
+
+/** Operations of a MixedCircuit */
+enum e_mixed_op {
+	MIXED_IN, MIXED_CONS, MIXED_ADD, MIXED_SUB, MIXED_MUL, MIXED_GT, MIXED_MUX, MIXED_OUT
+};
+
+struct mixed_node {
+	e_mixed_op op;
+	vector<uint32_t> in;
+	uint32_t bitlen;
+	e_role role;			// source of an input, destination of an output
+	uint64_t* vals;			// values of an input, not owned
+	UGATE_T constval;
+	vector<uint32_t> consumers;
+	BOOL feasible[MIXED_NUM_SHARINGS];
+	layer_cost cost[MIXED_NUM_SHARINGS];	// predicted cost of the node and its inputs if the node is evaluated in a sharing
+	e_sharing sharing;		// assigned sharing
+	share* shr[MIXED_NUM_SHARINGS];	// the value of the node in the assigned sharing and converted to other sharings
+};
+
+/**
+ Builder in which a computation is described once on SIMD values of the bit length of the arithmetic sharing, without
+ choosing sharings. BuildCircuit() assigns each operation to Boolean, Yao, or arithmetic sharing such that the predicted
+ runtime for a network profile is minimized, inserts the conversions, and puts the gates into the circuits of the sharings.
+ The cost of each operation and conversion is predicted with Sharing::EstimateGateCost() from approximate gate counts of
+ the circuit constructions. Conversions from arithmetic to Boolean sharing use either Yao sharing or the Boolean adder of
+ BooleanCircuit::PutA2BGate(), whichever is predicted to be faster. The assignment is computed by dynamic programming
+ over the operations, which is optimal if each value is used once and treats shared values as if they were computed for
+ each use.
+ All values are reduced modulo 2^bitlen, the result of a comparison is a single bit.
+ */
+class MixedCircuit {
+public:
+	/**
+	 \param 	party 	party whose sharings are used
+	 \param 	nvals 	number of SIMD values of each operation
+	 */
+	MixedCircuit(ABYParty* party, uint32_t nvals = 1);
+	/** Deletes the shares of all operations, including the output shares */
+	~MixedCircuit();
+
+	/**
+	 Input nvals values of src. Both parties have to pass nvals values, of which the values of the other party are ignored,
+	 which have to remain valid until BuildCircuit().
+	 */
+	uint32_t PutSIMDINGate(uint64_t* vals, e_role src);
+	uint32_t PutCONSGate(UGATE_T val);
+	uint32_t PutADDGate(uint32_t ina, uint32_t inb);
+	uint32_t PutSUBGate(uint32_t ina, uint32_t inb);
+	uint32_t PutMULGate(uint32_t ina, uint32_t inb);
+	/** Single-bit result of ina > inb */
+	uint32_t PutGTGate(uint32_t ina, uint32_t inb);
+	/** sel ? ina : inb, where the least significant bit of sel is used */
+	uint32_t PutMUXGate(uint32_t ina, uint32_t inb, uint32_t sel);
+	uint32_t PutOUTGate(uint32_t in, e_role dst);
+
+	/**
+	 Assigns the operations to sharings for a network profile and puts the gates into the circuits of the sharings. Has to
+	 be called once by both parties with the same profile, after which the party can execute the circuit.
+	 \param 	bandwidth 	bandwidth between the parties in Mbit/s
+	 \param 	rtt 		round-trip time between the parties in ms
+	 \return 	the predicted cost of the assignment
+	 */
+	layer_cost BuildCircuit(double bandwidth, double rtt);
+
+	/** Returns the share of an output after BuildCircuit(), which remains valid as long as the MixedCircuit exists */
+	share* GetOutput(uint32_t out) {
+		return m_vNodes[out].shr[m_vNodes[out].sharing];
+	}
+	;
+	/** Returns the sharing to which an operation was assigned by BuildCircuit() */
+	e_sharing GetSharing(uint32_t id) {
+		return m_vNodes[id].sharing;
+	}
+	;
+	uint32_t GetBitLength() {
+		return m_nBitLen;
+	}
+	;
+
+private:
+	uint32_t PutNode(e_mixed_op op, uint32_t bitlen, uint32_t ina = 0, uint32_t inb = 0, uint32_t sel = 0);
+
+	BOOL IsSupported(e_mixed_op op, e_sharing s);
+	double GetTime(const layer_cost& cost);
+	void AddGateCost(e_sharing s, e_gatetype type, e_role role, uint32_t ningates, uint64_t ngates, layer_cost* cost);
+	layer_cost GetOpCost(mixed_node* node, e_sharing s);
+	layer_cost GetConversionCost(e_sharing from, e_sharing to, uint32_t bitlen);
+	layer_cost GetGMWA2BCost(uint32_t bitlen);
+	BOOL IsGMWA2BFaster(uint32_t bitlen);
+
+	void ComputeCosts();
+	void AssignSharings();
+	void PutGates();
+	share* GetShare(uint32_t id, e_sharing s);
+	share* PutOperation(mixed_node* node, Circuit* circ);
+
+	vector<Sharing*>& m_vSharings;
+	vector<Circuit*> m_vCircuits;
+	vector<mixed_node> m_vNodes;
+	uint32_t m_nBitLen;
+	uint32_t m_nNumVals;
+	double m_dBandwidth;
+	double m_dRTT;
+};
+
+#endif /* __MIXEDCIRCUIT_H__ */
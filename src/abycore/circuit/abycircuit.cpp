@@ -20,6 +20,8 @@
 
 void ABYCircuit::Cleanup() {
 	//TODO
+	ReleaseCompiled();
+	FreeLoadedTables();
 	free(m_pGates);
 }
 
@@ -28,6 +30,10 @@ ABYCircuit::ABYCircuit(uint32_t maxgates) {
 	m_pGates = (GATE*) calloc(maxgates, sizeof(GATE));
 	m_nNextFreeGate = 0;
 	m_nMaxVectorSize = 1;
+	m_bDedupGates = FALSE;
+	m_pCompiledGates = NULL;
+	m_nCompiledGates = 0;
+	m_nCompiledMaxVectorSize = 1;
 }
 
 inline void ABYCircuit::InitGate(GATE* gate, e_gatetype type) {
@@ -38,6 +44,10 @@ inline void ABYCircuit::InitGate(GATE* gate, e_gatetype type) {
 		cout << "I have more gates than available" << endl;
 	}
 	assert(m_nNextFreeGate < m_nMaxGates);
+	if(IsCompiled()) {
+		cerr << "Cannot put gates into a compiled circuit, release it first" << endl;
+		assert(!IsCompiled());
+	}
 
 	gate->type = type;
 	gate->nused = 0;
@@ -80,7 +90,7 @@ inline void ABYCircuit::InitGate(GATE* gate, e_gatetype type, uint32_t ina, uint
 	MarkGateAsUsed(inb);
 }
 
-inline void ABYCircuit::InitGate(GATE* gate, e_gatetype type, vector<uint32_t>& inputs) {
+inline void ABYCircuit::InitGate(GATE* gate, e_gatetype type, const vector<uint32_t>& inputs) {
 	InitGate(gate, type);
 	gate->ingates.ningates = inputs.size();
 	gate->depth = 0;
@@ -111,6 +121,18 @@ inline void ABYCircuit::InitGate(GATE* gate, e_gatetype type, vector<uint32_t>&
 
 //Add a gate to m_pGates, increase the gateptr, used for G_LIN or G_NON_LIN
 uint32_t ABYCircuit::PutPrimitiveGate(e_gatetype type, uint32_t inleft, uint32_t inright, uint32_t rounds) {
+	uint64_t key = 0;
+	BOOL dedup = m_bDedupGates && (type == G_LIN || type == G_NON_LIN);
+
+	if (dedup) {
+		//both gate types are commutative, hence the inputs are ordered before looking up the gate
+		if (inleft > inright)
+			swap(inleft, inright);
+		key = (((uint64_t) inleft) << 32) | inright;
+		unordered_map<uint64_t, uint32_t>::iterator it = m_mPrimitiveGates[type].find(key);
+		if (it != m_mPrimitiveGates[type].end())
+			return it->second;
+	}
 
 	GATE* gate = m_pGates + m_nNextFreeGate;
 	InitGate(gate, type, inleft, inright);
@@ -124,9 +146,20 @@ uint32_t ABYCircuit::PutPrimitiveGate(e_gatetype type, uint32_t inleft, uint32_t
 	", depth = " << gate->depth << ", sharingsize = " << gate->sharebitlen << ", nrounds = " << gate->nrounds << ", and mindepth = " << mindepth << endl;
 #endif
 
+	if (dedup)
+		m_mPrimitiveGates[type][key] = m_nNextFreeGate;
+
 	return m_nNextFreeGate++;
 }
 
+void ABYCircuit::SetGateDeduplication(BOOL enable) {
+	m_bDedupGates = enable;
+	if (!enable) {
+		m_mPrimitiveGates[G_LIN].clear();
+		m_mPrimitiveGates[G_NON_LIN].clear();
+	}
+}
+
 //add a vector-MT gate, mostly the same as a standard primitive gate but with explicit choiceinput / vectorinput
 uint32_t ABYCircuit::PutNonLinearVectorGate(e_gatetype type, uint32_t choiceinput, uint32_t vectorinput, uint32_t rounds) {
 	GATE* gate = m_pGates + m_nNextFreeGate;
@@ -143,7 +176,62 @@ uint32_t ABYCircuit::PutNonLinearVectorGate(e_gatetype type, uint32_t choiceinpu
 	return m_nNextFreeGate++;
 }
 
-uint32_t ABYCircuit::PutCombinerGate(vector<uint32_t> input) {
+uint32_t ABYCircuit::PutMatrixMultiplicationGate(uint32_t a, uint32_t b, uint32_t n, uint32_t m, uint32_t k, uint32_t rounds) {
+	GATE* gate = m_pGates + m_nNextFreeGate;
+	InitGate(gate, G_MATMUL, a, b);
+
+	assert(m_pGates[a].nvals == n * m && m_pGates[b].nvals == m * k);
+
+	gate->nvals = n * k;
+	gate->nrounds = rounds;
+
+	gate->gs.mm.n = n;
+	gate->gs.mm.m = m;
+	gate->gs.mm.k = k;
+
+	if (gate->nvals > m_nMaxVectorSize)
+		m_nMaxVectorSize = gate->nvals;
+
+	return m_nNextFreeGate++;
+}
+
+uint32_t ABYCircuit::PutDotProductGate(uint32_t a, uint32_t b, uint32_t dotlen, uint32_t rounds, uint32_t truncbits) {
+	GATE* gate = m_pGates + m_nNextFreeGate;
+	InitGate(gate, G_DOT, a, b);
+
+	assert(m_pGates[a].nvals == m_pGates[b].nvals && dotlen > 0 && (m_pGates[a].nvals % dotlen) == 0);
+
+	gate->nvals = m_pGates[a].nvals / dotlen;
+	gate->nrounds = rounds;
+	gate->gs.dot.len = dotlen;
+	gate->gs.dot.truncbits = truncbits;
+
+	return m_nNextFreeGate++;
+}
+
+uint32_t ABYCircuit::PutTruncGate(uint32_t in, uint32_t truncbits) {
+	GATE* gate = m_pGates + m_nNextFreeGate;
+	InitGate(gate, G_TRUNC, in);
+
+	gate->nvals = m_pGates[in].nvals;
+	gate->gs.truncbits = truncbits;
+
+	return m_nNextFreeGate++;
+}
+
+uint32_t ABYCircuit::PutWidthConvGate(uint32_t in, uint32_t sharebitlen) {
+	GATE* gate = m_pGates + m_nNextFreeGate;
+	InitGate(gate, G_WIDTH_CONV, in);
+
+	gate->sharebitlen = sharebitlen;
+	gate->nvals = m_pGates[in].nvals;
+	gate->nrounds = 0;
+	gate->depth++; //increase depth by 1 since the input is evaluated by the sharing of another bit length
+
+	return m_nNextFreeGate++;
+}
+
+uint32_t ABYCircuit::PutCombinerGate(const vector<uint32_t>& input) {
 	GATE* gate = m_pGates + m_nNextFreeGate;
 	InitGate(gate, G_COMBINE, input);
 
@@ -175,16 +263,15 @@ uint32_t ABYCircuit::PutSplitterGate(uint32_t input, uint32_t pos, uint32_t bitl
 }
 
 //gatelenghts is defaulted to NULL
-vector<uint32_t> ABYCircuit::PutSplitterGate(uint32_t input, vector<uint32_t> bitlen) {
+vector<uint32_t> ABYCircuit::PutSplitterGate(uint32_t input, const vector<uint32_t>& bitlen) {
 
 	uint32_t nvals = m_pGates[input].nvals;
-	if(bitlen.size() == 0) {
-		bitlen.resize(nvals, 1);
-	}
-	vector<uint32_t> outids(bitlen.size());
+	//without bit lengths, each output gate holds a single value
+	uint32_t nouts = bitlen.size() == 0 ? nvals : bitlen.size();
+	vector<uint32_t> outids(nouts);
 
 	uint32_t ctr = 0;
-	for (uint32_t i = 0; i < bitlen.size(); i++) {
+	for (uint32_t i = 0; i < nouts; i++) {
 		/*GATE* gate = m_pGates + m_nNextFreeGate;
 		outids[i] = m_nNextFreeGate;
 		InitGate(gate, G_SPLIT, input);
@@ -195,8 +282,9 @@ vector<uint32_t> ABYCircuit::PutSplitterGate(uint32_t input, vector<uint32_t> bi
 
 		ctr += gate->nvals;
 		m_nNextFreeGate++;*/
-		outids[i] = PutSplitterGate(input, ctr, bitlen[i]);
-		ctr += bitlen[i];
+		uint32_t outlen = bitlen.size() == 0 ? 1 : bitlen[i];
+		outids[i] = PutSplitterGate(input, ctr, outlen);
+		ctr += outlen;
 		//cout << "bitlen[" << i << "] = " << bitlen[i] << endl;
 	}
 	//cout << "ctr = " << ctr << ", nvals = " << nvals << endl;
@@ -206,7 +294,7 @@ vector<uint32_t> ABYCircuit::PutSplitterGate(uint32_t input, vector<uint32_t> bi
 	return outids;
 }
 
-uint32_t ABYCircuit::PutCombineAtPosGate(vector<uint32_t> input, uint32_t pos) {
+uint32_t ABYCircuit::PutCombineAtPosGate(const vector<uint32_t>& input, uint32_t pos) {
 	GATE* gate = m_pGates + m_nNextFreeGate;
 	InitGate(gate, G_COMBINEPOS, input);
 
@@ -259,7 +347,7 @@ uint32_t ABYCircuit::PutSubsetGate(uint32_t input, uint32_t* posids, uint32_t nv
 	return m_nNextFreeGate++;
 }
 
-uint32_t ABYCircuit::PutStructurizedCombinerGate(vector<uint32_t> input, uint32_t pos_start, uint32_t pos_incr, uint32_t nvals) {
+uint32_t ABYCircuit::PutStructurizedCombinerGate(const vector<uint32_t>& input, uint32_t pos_start, uint32_t pos_incr, uint32_t nvals) {
 	GATE* gate = m_pGates + m_nNextFreeGate;
 	InitGate(gate, G_STRUCT_COMBINE, input);
 
@@ -295,7 +383,7 @@ uint32_t ABYCircuit::PutRepeaterGate(uint32_t input, uint32_t nvals) {
 	return m_nNextFreeGate++;
 }
 
-vector<uint32_t> ABYCircuit::PutRepeaterGate(vector<uint32_t> input, uint32_t nvals) {
+vector<uint32_t> ABYCircuit::PutRepeaterGate(const vector<uint32_t>& input, uint32_t nvals) {
 	vector<uint32_t> out(input.size());
 	for (uint32_t i = 0; i < input.size(); i++) {
 		out[i] = PutRepeaterGate(input[i], nvals);
@@ -303,7 +391,7 @@ vector<uint32_t> ABYCircuit::PutRepeaterGate(vector<uint32_t> input, uint32_t nv
 	return out;
 }
 
-uint32_t ABYCircuit::PutPermutationGate(vector<uint32_t> input, uint32_t* positions) {
+uint32_t ABYCircuit::PutPermutationGate(const vector<uint32_t>& input, uint32_t* positions) {
 	GATE* gate = m_pGates + m_nNextFreeGate;
 	InitGate(gate, G_PERM, input);
 
@@ -407,7 +495,7 @@ uint32_t ABYCircuit::PutINVGate(uint32_t in) {
 	return m_nNextFreeGate++;
 }
 
-uint32_t ABYCircuit::PutCONVGate(vector<uint32_t> in, uint32_t nrounds, e_sharing dst, uint32_t sharebitlen) {
+uint32_t ABYCircuit::PutCONVGate(const vector<uint32_t>& in, uint32_t nrounds, e_sharing dst, uint32_t sharebitlen) {
 	GATE* gate = m_pGates + m_nNextFreeGate;
 	InitGate(gate, G_CONV, in);
 
@@ -422,7 +510,7 @@ uint32_t ABYCircuit::PutCONVGate(vector<uint32_t> in, uint32_t nrounds, e_sharin
 	return m_nNextFreeGate++;
 }
 
-vector<uint32_t> ABYCircuit::PutOUTGate(vector<uint32_t> in, e_role dst, uint32_t rounds) {
+vector<uint32_t> ABYCircuit::PutOUTGate(const vector<uint32_t>& in, e_role dst, uint32_t rounds) {
 	vector<uint32_t> out(in.size());
 	for (uint32_t i = 0; i < in.size(); i++) {
 		out[i] = PutOUTGate(in[i], dst, rounds);
@@ -430,7 +518,7 @@ vector<uint32_t> ABYCircuit::PutOUTGate(vector<uint32_t> in, e_role dst, uint32_
 	return out;
 }
 
-vector<uint32_t> ABYCircuit::PutSharedOUTGate(vector<uint32_t> in) {
+vector<uint32_t> ABYCircuit::PutSharedOUTGate(const vector<uint32_t>& in) {
 	vector<uint32_t> out(in.size());
 	for (uint32_t i = 0; i < in.size(); i++) {
 		out[i] = PutSharedOUTGate(in[i]);
@@ -438,7 +526,7 @@ vector<uint32_t> ABYCircuit::PutSharedOUTGate(vector<uint32_t> in) {
 	return out;
 }
 
-uint32_t ABYCircuit::PutCallbackGate(vector<uint32_t> in, uint32_t rounds, void (*callback)(GATE*, void*), void* infos,
+uint32_t ABYCircuit::PutCallbackGate(const vector<uint32_t>& in, uint32_t rounds, void (*callback)(GATE*, void*), void* infos,
 		uint32_t nvals) {
 	GATE* gate = m_pGates + m_nNextFreeGate;
 	InitGate(gate, G_CALLBACK, in);
@@ -453,7 +541,7 @@ uint32_t ABYCircuit::PutCallbackGate(vector<uint32_t> in, uint32_t rounds, void
 	return m_nNextFreeGate++;
 }
 
-uint32_t ABYCircuit::PutTruthTableGate(vector<uint32_t> in, uint32_t rounds, uint32_t out_bits,
+uint32_t ABYCircuit::PutTruthTableGate(const vector<uint32_t>& in, uint32_t rounds, uint32_t out_bits,
 		uint64_t* truth_table) {
 	GATE* gate = m_pGates + m_nNextFreeGate;
 	InitGate(gate, G_TT, in);
@@ -485,7 +573,7 @@ uint32_t ABYCircuit::PutTruthTableGate(vector<uint32_t> in, uint32_t rounds, uin
 	return m_nNextFreeGate++;
 }
 
-uint32_t ABYCircuit::PutPrintValGate(vector<uint32_t> in, string infostr) {
+uint32_t ABYCircuit::PutPrintValGate(const vector<uint32_t>& in, string infostr) {
 	GATE* gate = m_pGates + m_nNextFreeGate;
 	InitGate(gate, G_PRINT_VAL, in);
 
@@ -503,7 +591,7 @@ uint32_t ABYCircuit::PutPrintValGate(vector<uint32_t> in, string infostr) {
 }
 
 
-uint32_t ABYCircuit::PutAssertGate(vector<uint32_t> in, uint32_t bitlen, UGATE_T* assert_val) {
+uint32_t ABYCircuit::PutAssertGate(const vector<uint32_t>& in, uint32_t bitlen, UGATE_T* assert_val) {
 	GATE* gate = m_pGates + m_nNextFreeGate;
 	InitGate(gate, G_ASSERT, in);
 
@@ -798,13 +886,331 @@ uint32_t FindBitLenPositionInVec(uint32_t bitlen, non_lin_vec_ctx* list, uint32_
 	return pos;
 }
 
+void ABYCircuit::Compile() {
+	ReleaseCompiled();
+
+	m_nCompiledGates = m_nNextFreeGate;
+	m_nCompiledMaxVectorSize = m_nMaxVectorSize;
+	m_pCompiledGates = (GATE*) malloc(sizeof(GATE) * max(m_nCompiledGates, (uint32_t) 1));
+	memcpy(m_pCompiledGates, m_pGates, sizeof(GATE) * m_nCompiledGates);
+	for (uint32_t i = 0; i < m_nCompiledGates; i++) {
+		DuplicateGateArrays(m_pCompiledGates + i);
+	}
+}
+
+void ABYCircuit::ReleaseCompiled() {
+	if (!IsCompiled())
+		return;
+	for (uint32_t i = 0; i < m_nCompiledGates; i++) {
+		FreeGateArrays(m_pCompiledGates + i);
+	}
+	free(m_pCompiledGates);
+	m_pCompiledGates = NULL;
+	m_nCompiledGates = 0;
+}
+
+//Overwrite the evaluated gates with fresh copies of the compiled ones
+void ABYCircuit::RestoreCompiled() {
+	memcpy(m_pGates, m_pCompiledGates, sizeof(GATE) * m_nCompiledGates);
+	for (uint32_t i = 0; i < m_nCompiledGates; i++) {
+		DuplicateGateArrays(m_pGates + i);
+	}
+	m_nNextFreeGate = m_nCompiledGates;
+	m_nMaxVectorSize = m_nCompiledMaxVectorSize;
+}
+
+/*
+ * Collect the arrays that were allocated when the gate was put. Arrays that are never freed during the evaluation (e.g., the
+ * truth table of a G_TT gate or subset positions that are owned by the caller) are marked as such.
+ */
+uint32_t ABYCircuit::GetGateArrays(GATE* gate, gate_array* arrays) {
+	uint32_t narrays = 0;
+
+	if (UsesParentArray(gate->type) && gate->ingates.ningates > 0) {
+		arrays[narrays].ptr = (void**) &gate->ingates.inputs.parents;
+		arrays[narrays].nbytes = sizeof(uint32_t) * gate->ingates.ningates;
+		arrays[narrays++].evalfreed = TRUE;
+	}
+
+	switch (gate->type) {
+	case G_IN:
+		if (gate->gs.ishare.inval != NULL) {
+			arrays[narrays].ptr = (void**) &gate->gs.ishare.inval;
+			arrays[narrays].nbytes = sizeof(UGATE_T) * ceil_divide((uint64_t) gate->nvals * gate->sharebitlen, GATE_T_BITS);
+			arrays[narrays++].evalfreed = TRUE;
+		}
+		break;
+	case G_SHARED_IN:
+		//pre-shared Yao inputs hold wire keys instead of values
+		if (gate->context != S_YAO && gate->context != S_YAO_REV) {
+			arrays[narrays].ptr = (void**) &gate->gs.val;
+			arrays[narrays].nbytes = sizeof(UGATE_T) * ceil_divide((uint64_t) gate->nvals * gate->sharebitlen, GATE_T_BITS);
+			arrays[narrays++].evalfreed = TRUE;
+		}
+		break;
+	case G_PERM:
+		arrays[narrays].ptr = (void**) &gate->gs.perm.posids;
+		arrays[narrays].nbytes = sizeof(uint32_t) * gate->nvals;
+		arrays[narrays++].evalfreed = TRUE;
+		break;
+	case G_SUBSET:
+		arrays[narrays].ptr = (void**) &gate->gs.sub_pos.posids;
+		arrays[narrays].nbytes = sizeof(uint32_t) * gate->nvals;
+		arrays[narrays++].evalfreed = gate->gs.sub_pos.copy_posids;
+		break;
+	case G_TT:
+		arrays[narrays].ptr = (void**) &gate->gs.tt.table;
+		arrays[narrays].nbytes = pad_to_multiple((uint64_t) 1 << gate->ingates.ningates, sizeof(UGATE_T)) * gate->gs.tt.noutputs;
+		arrays[narrays++].evalfreed = FALSE;
+		break;
+	case G_PRINT_VAL:
+		arrays[narrays].ptr = (void**) &gate->gs.infostr;
+		arrays[narrays].nbytes = gate->gs.infostr ? strlen(gate->gs.infostr) + 1 : 0;
+		arrays[narrays++].evalfreed = TRUE;
+		break;
+	case G_ASSERT:
+		arrays[narrays].ptr = (void**) &gate->gs.assertval;
+		arrays[narrays].nbytes = sizeof(UGATE_T) * ceil_divide(gate->ingates.ningates * gate->sharebitlen, GATE_T_BITS) * gate->nvals;
+		arrays[narrays++].evalfreed = TRUE;
+		break;
+	default:
+		break;
+	}
+	return narrays;
+}
+
+//Replace the arrays of a gate that are freed when it is evaluated by copies
+void ABYCircuit::DuplicateGateArrays(GATE* gate) {
+	gate_array arrays[MAX_GATE_ARRAYS];
+	uint32_t narrays = GetGateArrays(gate, arrays);
+	void* tmp;
+
+	if (gate->type == G_SHARED_IN && (gate->context == S_YAO || gate->context == S_YAO_REV)) {
+		cerr << "Pre-shared Yao input gates cannot be compiled" << endl;
+		assert(gate->context != S_YAO && gate->context != S_YAO_REV);
+	}
+
+	for (uint32_t i = 0; i < narrays; i++) {
+		if (arrays[i].evalfreed) {
+			tmp = malloc(arrays[i].nbytes);
+			memcpy(tmp, *arrays[i].ptr, arrays[i].nbytes);
+			*arrays[i].ptr = tmp;
+		}
+	}
+}
+
+void ABYCircuit::FreeGateArrays(GATE* gate) {
+	gate_array arrays[MAX_GATE_ARRAYS];
+	uint32_t narrays = GetGateArrays(gate, arrays);
+
+	for (uint32_t i = 0; i < narrays; i++) {
+		if (arrays[i].evalfreed)
+			free(*arrays[i].ptr);
+	}
+}
+
+BOOL ABYCircuit::WriteGates(CircuitFile& file) {
+	gate_array arrays[MAX_GATE_ARRAYS];
+	uint32_t narrays;
+	//write the compiled gates since the current ones might already have been evaluated
+	GATE* gates = IsCompiled() ? m_pCompiledGates : m_pGates;
+	GATE tmpgate;
+
+	for (uint32_t i = 0; i < m_nNextFreeGate; i++) {
+		if (gates[i].type == G_SHARED_IN || gates[i].type == G_CALLBACK) {
+			cerr << "Gate " << i << " of type " << get_gate_type_name(gates[i].type) << " cannot be written to a circuit file" << endl;
+			return FALSE;
+		}
+	}
+
+	file.Put<uint32_t>(sizeof(GATE));
+	file.Put<uint32_t>(m_nNextFreeGate);
+	file.Put<uint32_t>(m_nMaxVectorSize);
+
+	//the gates are stored in their in-memory layout with all pointers cleared and without the input values of this party
+	for (uint32_t i = 0; i < m_nNextFreeGate; i++) {
+		tmpgate = gates[i];
+		narrays = GetGateArrays(&tmpgate, arrays);
+		for (uint32_t j = 0; j < narrays; j++) {
+			*arrays[j].ptr = NULL;
+		}
+		if (tmpgate.type == G_IN)
+			tmpgate.instantiated = false;
+		file.Put(&tmpgate, sizeof(GATE));
+	}
+
+	for (uint32_t i = 0; i < m_nNextFreeGate; i++) {
+		narrays = GetGateArrays(gates + i, arrays);
+		for (uint32_t j = 0; j < narrays; j++) {
+			if (gates[i].type == G_IN && arrays[j].ptr == (void**) &gates[i].gs.ishare.inval)
+				continue;
+			file.Put<uint64_t>(arrays[j].nbytes);
+			file.Put(*arrays[j].ptr, arrays[j].nbytes);
+		}
+	}
+	return TRUE;
+}
+
+//Check the fields of a gate from a circuit file that are used before its arrays are read
+BOOL ABYCircuit::IsValidLoadedGate(uint32_t gateid) {
+	GATE* gate = m_pGates + gateid;
+
+	switch (gate->type) {
+	case G_LIN: case G_NON_LIN: case G_NON_LIN_VEC: case G_IN: case G_OUT: case G_INV: case G_CONSTANT: case G_CONV:
+	case G_SHARED_OUT: case G_TT: case G_MATMUL: case G_DOT: case G_WIDTH_CONV: case G_TRUNC: case G_PRINT_VAL: case G_ASSERT:
+	case G_COMBINE: case G_SPLIT: case G_REPEAT: case G_PERM: case G_COMBINEPOS: case G_SUBSET: case G_STRUCT_COMBINE:
+		break;
+	default:
+		//pre-shared input gates and callback gates are never written to a circuit file
+		return FALSE;
+	}
+	if (gate->context >= S_LAST && gate->context != S_BOOL_NO_MT && gate->context != S_ARITH_FIELD)
+		return FALSE;
+	//the truth table of a G_TT gate has 2^ningates entries per output
+	if (gate->type == G_TT && gate->ingates.ningates > 32)
+		return FALSE;
+	if (UsesParentArray(gate->type))
+		return TRUE;
+
+	//all other gates have at most two inputs, which have to precede the gate
+	if (gate->ingates.ningates == 1)
+		return gate->ingates.inputs.parent < gateid;
+	if (gate->ingates.ningates == 2)
+		return gate->ingates.inputs.twin.left < gateid && gate->ingates.inputs.twin.right < gateid;
+	return gate->ingates.ningates == 0;
+}
+
+BOOL ABYCircuit::ReadGates(CircuitFile& file, e_role role) {
+	gate_array arrays[MAX_GATE_ARRAYS];
+	uint32_t narrays, gatebytes, ngates, maxvectorsize;
+	uint64_t nbytes;
+	const void* data;
+	GATE* gate;
+
+	if (m_nNextFreeGate > 0 || IsCompiled()) {
+		cerr << "A circuit file can only be loaded into an empty circuit" << endl;
+		return FALSE;
+	}
+	if (!file.Get<uint32_t>(&gatebytes) || !file.Get<uint32_t>(&ngates) || !file.Get<uint32_t>(&maxvectorsize))
+		return FALSE;
+	if (gatebytes != sizeof(GATE) || ngates > m_nMaxGates) {
+		cerr << "The circuit file was written for a different gate layout or has more than " << m_nMaxGates << " gates" << endl;
+		return FALSE;
+	}
+
+	data = file.Get((uint64_t) ngates * sizeof(GATE));
+	if (data == NULL)
+		return FALSE;
+	memcpy(m_pGates, data, (uint64_t) ngates * sizeof(GATE));
+	m_nNextFreeGate = ngates;
+	m_nMaxVectorSize = maxvectorsize;
+
+	//validate the gates and clear all pointers before any array is allocated, such that the arrays can be freed on an error
+	for (uint32_t i = 0; i < ngates; i++) {
+		gate = m_pGates + i;
+		if (!IsValidLoadedGate(i)) {
+			cerr << "Gate " << i << " of the circuit file is invalid" << endl;
+			memset(m_pGates, 0, (uint64_t) ngates * sizeof(GATE));
+			m_nNextFreeGate = 0;
+			return FALSE;
+		}
+		if (gate->type == G_IN)
+			gate->gs.ishare.inval = NULL;
+		narrays = GetGateArrays(gate, arrays);
+		for (uint32_t j = 0; j < narrays; j++) {
+			*arrays[j].ptr = NULL;
+		}
+		//the positions are now owned by the gate
+		if (gate->type == G_SUBSET)
+			gate->gs.sub_pos.copy_posids = true;
+	}
+
+	BOOL success = TRUE;
+	for (uint32_t i = 0; i < ngates && success; i++) {
+		gate = m_pGates + i;
+		narrays = GetGateArrays(gate, arrays);
+		for (uint32_t j = 0; j < narrays && success; j++) {
+			success = file.Get<uint64_t>(&nbytes) && (nbytes == arrays[j].nbytes || gate->type == G_PRINT_VAL);
+			data = success ? file.Get(nbytes) : NULL;
+			success = data != NULL && (gate->type != G_PRINT_VAL || (nbytes > 0 && ((const char*) data)[nbytes - 1] == '\0'));
+			if (success) {
+				*arrays[j].ptr = malloc(nbytes);
+				memcpy(*arrays[j].ptr, data, nbytes);
+				//the truth table is not freed when the gate is evaluated but kept until the circuit is cleared
+				if (!arrays[j].evalfreed)
+					m_vLoadedTables.push_back((uint64_t*) *arrays[j].ptr);
+			}
+		}
+		if (success && UsesParentArray(gate->type)) {
+			for (uint32_t j = 0; j < gate->ingates.ningates && success; j++) {
+				success = gate->ingates.inputs.parents[j] < i;
+			}
+			if (!success)
+				cerr << "Gate " << i << " of the circuit file has an invalid input" << endl;
+		}
+		//the input values of this party have to be set with SetINGateValues()
+		if (success && gate->type == G_IN && gate->gs.ishare.src == role) {
+			gate->gs.ishare.inval = (UGATE_T*) calloc(ceil_divide((uint64_t) gate->nvals * gate->sharebitlen, GATE_T_BITS), sizeof(UGATE_T));
+			gate->instantiated = true;
+		}
+	}
+	if (!success)
+		ReleaseGates();
+	return success;
+}
+
+void ABYCircuit::ReleaseGates() {
+	gate_array arrays[MAX_GATE_ARRAYS];
+	uint32_t narrays;
+
+	if (IsCompiled()) {
+		cerr << "Cannot release the gates of a compiled circuit, release it first" << endl;
+		assert(!IsCompiled());
+	}
+	for (uint32_t i = 0; i < m_nNextFreeGate; i++) {
+		narrays = GetGateArrays(m_pGates + i, arrays);
+		for (uint32_t j = 0; j < narrays; j++) {
+			if (arrays[j].evalfreed)
+				free(*arrays[j].ptr);
+		}
+	}
+	FreeLoadedTables();
+	memset(m_pGates, 0, sizeof(GATE) * m_nNextFreeGate);
+	m_nNextFreeGate = 0;
+	m_nMaxVectorSize = 1;
+}
+
+void ABYCircuit::FreeLoadedTables() {
+	for (uint32_t i = 0; i < m_vLoadedTables.size(); i++) {
+		free(m_vLoadedTables[i]);
+	}
+	m_vLoadedTables.clear();
+}
+
+void ABYCircuit::SetINGateValues(uint32_t gateid, BYTE* val) {
+	assert(gateid < m_nNextFreeGate);
+	GATE* gate = m_pGates + gateid;
+	if (gate->type != G_IN || gate->gs.ishare.inval == NULL) {
+		cerr << "Gate " << gateid << " is not an input gate of this party" << endl;
+		assert(gate->type == G_IN && gate->gs.ishare.inval != NULL);
+	}
+	memcpy(gate->gs.ishare.inval, val, ceil_divide((uint64_t) gate->nvals * gate->sharebitlen, 8));
+}
+
 void ABYCircuit::Reset() {
+	if (IsCompiled()) {
+		RestoreCompiled();
+		return;
+	}
 	//TODO: causes segfault in Boolean sharing if only one party gets output, fix!
 	/*for(uint32_t i = 0; i < m_nNextFreeGate; i++) {
 	 if(m_pGates[i].type == G_OUT)
 	 free(m_pGates[i].gs.val);
 	 }*/
 	memset(m_pGates, 0, sizeof(GATE) * m_nMaxGates);
+	FreeLoadedTables();
 	m_nNextFreeGate = 0;
 	m_nMaxVectorSize = 1;
+	m_mPrimitiveGates[G_LIN].clear();
+	m_mPrimitiveGates[G_NON_LIN].clear();
 }
@@ -24,7 +24,9 @@
 #include <fstream>
 #include <limits.h>
 #include <deque>
+#include <unordered_map>
 #include "../util/constants.h"
+#include "circuitfile.h"
 
 //#define DEBUG_CIRCUIT_CONSTRUCTION
 
@@ -33,6 +35,10 @@
 #define ComputeDepth(predecessor) ( (predecessor).depth + (predecessor).nrounds )
 
 #define IsSIMDGate(gatetype) (!!((gatetype)&0x80))
+//Gates that are put with an arbitrary number of inputs store their input ids in ingates.inputs.parents
+#define UsesParentArray(gatetype) ((gatetype) == G_COMBINE || (gatetype) == G_COMBINEPOS || (gatetype) == G_STRUCT_COMBINE || \
+		(gatetype) == G_PERM || (gatetype) == G_CONV || (gatetype) == G_CALLBACK || (gatetype) == G_TT || \
+		(gatetype) == G_PRINT_VAL || (gatetype) == G_ASSERT)
 
 struct GATE;
 
@@ -88,6 +94,17 @@ struct tt_gate {
 	uint32_t noutputs;
 };
 
+struct matmul_gate {
+	uint32_t n;
+	uint32_t m;
+	uint32_t k;
+};
+
+struct dot_gate {
+	uint32_t len;
+	uint32_t truncbits;
+};
+
 union gate_specific {
 	//fields of the combiner gate
 	uint32_t* cinput;
@@ -123,6 +140,12 @@ union gate_specific {
 	struct_combine_gate struct_comb;
 	//used for the G_TT gate where an arbitrary-sized truth-table is evaluated using OT
 	tt_gate tt;
+	//used for the G_MATMUL gate, holds the dimensions of the (n x m) * (m x k) matrix multiplication
+	matmul_gate mm;
+	//used for the G_DOT gate, holds the number of products that are summed up per value and the number of bits the sum is truncated by
+	dot_gate dot;
+	//used for the G_TRUNC gate, holds the number of bits the values are truncated by
+	uint32_t truncbits;
 	//used for the PRINT VAL gate where the plaintext value of the gate is printed with the info string below
 	const char* infostr;
 	//used for the ASSERT gate where the plaintext value of the gate is checked against the plaintext value in assertval
@@ -168,6 +191,15 @@ struct tt_lens_ctx {
 	uint32_t out_bits;
 };
 
+#define MAX_GATE_ARRAYS 2
+
+//An array that is allocated when a gate is put
+struct gate_array {
+	void** ptr;			// field of the gate that points to the array
+	uint64_t nbytes;
+	BOOL evalfreed;		// whether the array is freed when the gate is evaluated
+};
+
 uint32_t FindBitLenPositionInVec(uint32_t bitlen, non_lin_vec_ctx* list, uint32_t listentries);
 
 class ABYCircuit {
@@ -178,27 +210,54 @@ public:
 	}
 
 	void Cleanup();
+	/**
+	 Clear all gates of the circuit. If the circuit was compiled, the gates are instead restored to the state in which they
+	 were compiled, such that the circuit can be evaluated again.
+	 */
 	void Reset();
 	GATE* Gates() {
 		return m_pGates;
 	}
+	/**
+	 Put a linear or non-linear gate between two gates. If the deduplication of gates is enabled and a gate of the same type
+	 with the same inputs (in any order) was put before, the id of the existing gate is returned instead, which is smaller
+	 than the gate head before the call.
+	 */
 	uint32_t PutPrimitiveGate(e_gatetype type, uint32_t inleft, uint32_t inright, uint32_t rounds);
 	uint32_t PutNonLinearVectorGate(e_gatetype type, uint32_t choiceinput, uint32_t vectorinput, uint32_t rounds);
-	uint32_t PutCombinerGate(vector<uint32_t> input);
+	/**
+	 Put a G_MATMUL gate that multiplies the row-major (n x m) matrix in the values of gate a with the row-major (m x k)
+	 matrix in the values of gate b. The gate holds the n * k values of the resulting matrix.
+	 */
+	uint32_t PutMatrixMultiplicationGate(uint32_t a, uint32_t b, uint32_t n, uint32_t m, uint32_t k, uint32_t rounds);
+	/**
+	 Put a G_DOT gate that computes nvals / dotlen dot products of length dotlen between the values of gates a and b,
+	 where dot product i covers the values i * dotlen, ..., (i + 1) * dotlen - 1. Each dot product is truncated by
+	 truncbits bits if truncbits > 0.
+	 */
+	uint32_t PutDotProductGate(uint32_t a, uint32_t b, uint32_t dotlen, uint32_t rounds, uint32_t truncbits = 0);
+	/** Put a G_TRUNC gate that truncates the values of gate in by truncbits bits */
+	uint32_t PutTruncGate(uint32_t in, uint32_t truncbits);
+	/**
+	 Put a G_WIDTH_CONV gate that holds the values of gate in as shares of sharebitlen bits. The gate is evaluated by
+	 the sharing of the target bit length, one layer after its input.
+	 */
+	uint32_t PutWidthConvGate(uint32_t in, uint32_t sharebitlen);
+	uint32_t PutCombinerGate(const vector<uint32_t>& input);
 	uint32_t PutSplitterGate(uint32_t input, uint32_t pos, uint32_t bitlen);
-	vector<uint32_t> PutSplitterGate(uint32_t input, vector<uint32_t> bitlen = vector<uint32_t>());		//, vector<uint32_t> gatelengths = NULL);
-	uint32_t PutCombineAtPosGate(vector<uint32_t> input, uint32_t pos);
+	vector<uint32_t> PutSplitterGate(uint32_t input, const vector<uint32_t>& bitlen = vector<uint32_t>());		//, const vector<uint32_t>& gatelengths = NULL);
+	uint32_t PutCombineAtPosGate(const vector<uint32_t>& input, uint32_t pos);
 	uint32_t PutSubsetGate(uint32_t input, uint32_t* posids, uint32_t nvals_out, bool copy_posids);
-	uint32_t PutStructurizedCombinerGate(vector<uint32_t> input, uint32_t pos_start, uint32_t pos_incr, uint32_t nvals);
+	uint32_t PutStructurizedCombinerGate(const vector<uint32_t>& input, uint32_t pos_start, uint32_t pos_incr, uint32_t nvals);
 	uint32_t PutRepeaterGate(uint32_t input, uint32_t nvals);
-	vector<uint32_t> PutRepeaterGate(vector<uint32_t> input, uint32_t nvals);
-	uint32_t PutPermutationGate(vector<uint32_t> input, uint32_t* positions);
+	vector<uint32_t> PutRepeaterGate(const vector<uint32_t>& input, uint32_t nvals);
+	uint32_t PutPermutationGate(const vector<uint32_t>& input, uint32_t* positions);
 
 	uint32_t PutOUTGate(uint32_t in, e_role dst, uint32_t rounds);
-	vector<uint32_t> PutOUTGate(vector<uint32_t> in, e_role dst, uint32_t rounds);
+	vector<uint32_t> PutOUTGate(const vector<uint32_t>& in, e_role dst, uint32_t rounds);
 
 	uint32_t PutSharedOUTGate(uint32_t in);
-	vector<uint32_t> PutSharedOUTGate(vector<uint32_t> in);
+	vector<uint32_t> PutSharedOUTGate(const vector<uint32_t>& in);
 
 	uint32_t PutINGate(e_sharing context, uint32_t nvals, uint32_t sharebitlen, e_role src, uint32_t rounds);
 
@@ -206,14 +265,14 @@ public:
 
 	uint32_t PutConstantGate(e_sharing context, UGATE_T val, uint32_t nvals, uint32_t sharebitlen);
 	uint32_t PutINVGate(uint32_t in);
-	uint32_t PutCONVGate(vector<uint32_t> in, uint32_t nrounds, e_sharing dst, uint32_t sharebitlen);
-	uint32_t PutCallbackGate(vector<uint32_t> in, uint32_t rounds, void (*callback)(GATE*, void*), void* infos, uint32_t nvals);
-	uint32_t PutTruthTableGate(vector<uint32_t> in, uint32_t rounds, uint32_t out_bits, uint64_t* truth_table);
-	uint32_t PutTruthTableMultiOutputGate(vector<uint32_t> in, uint32_t rounds, uint32_t out_bits, uint64_t* truth_table);
+	uint32_t PutCONVGate(const vector<uint32_t>& in, uint32_t nrounds, e_sharing dst, uint32_t sharebitlen);
+	uint32_t PutCallbackGate(const vector<uint32_t>& in, uint32_t rounds, void (*callback)(GATE*, void*), void* infos, uint32_t nvals);
+	uint32_t PutTruthTableGate(const vector<uint32_t>& in, uint32_t rounds, uint32_t out_bits, uint64_t* truth_table);
+	uint32_t PutTruthTableMultiOutputGate(const vector<uint32_t>& in, uint32_t rounds, uint32_t out_bits, uint64_t* truth_table);
 
 
-	uint32_t PutPrintValGate(vector<uint32_t> in, string infostr);
-	uint32_t PutAssertGate(vector<uint32_t> in, uint32_t bitlen, UGATE_T* assert_val);
+	uint32_t PutPrintValGate(const vector<uint32_t>& in, string infostr);
+	uint32_t PutAssertGate(const vector<uint32_t>& in, uint32_t bitlen, UGATE_T* assert_val);
 
 	uint32_t GetGateHead() {
 		return m_nNextFreeGate;
@@ -223,6 +282,56 @@ public:
 		return m_nMaxVectorSize;
 	}
 
+	/**
+	 Enable or disable the deduplication of structurally identical linear and non-linear gates, i.e., gates with the same
+	 type and the same inputs, where the inputs of these commutative gates are compared independent of their order. Only
+	 gates that are put while the deduplication is enabled are considered. Removing duplicate non-linear gates reduces the
+	 number of MTs and garbled tables that are required.
+	 */
+	void SetGateDeduplication(BOOL enable);
+	BOOL GetGateDeduplication() {
+		return m_bDedupGates;
+	}
+	;
+
+	/**
+	 Capture the gates that were put so far, such that the circuit can be evaluated repeatedly without re-building it. Has
+	 to be called before the circuit is evaluated for the first time. While the circuit is compiled, no further gates can
+	 be put and Reset() restores the captured gates instead of clearing them.
+	 */
+	void Compile();
+	/** Discard the captured gates, such that the next Reset() clears the circuit again. */
+	void ReleaseCompiled();
+	BOOL IsCompiled() {
+		return m_pCompiledGates != NULL;
+	}
+	;
+	/**
+	 Overwrite the plaintext values of an input gate of this party before the circuit is evaluated (again).
+	 \param 	gateid 	id of a G_IN gate for which this party provided the values
+	 \param 	val 	new values in the layout of the gate, i.e., ceil_divide(nvals * sharebitlen, 8) bytes
+	 */
+	void SetINGateValues(uint32_t gateid, BYTE* val);
+
+	/**
+	 Append the gates to a binary circuit file. Pointers are cleared and the input values of this party are not written,
+	 such that the file can be loaded by both parties. Has to be called before the circuit is evaluated, unless it is
+	 compiled. Pre-shared input gates and callback gates cannot be written.
+	 \return	FALSE if the circuit contains gates that cannot be written
+	 */
+	BOOL WriteGates(CircuitFile& file);
+	/**
+	 Load the gates from a binary circuit file into this empty circuit. The input gates of role are allocated with zero
+	 values, which can be set with SetINGateValues().
+	 \return	FALSE if the file is malformed or does not fit into this circuit
+	 */
+	BOOL ReadGates(CircuitFile& file, e_role role);
+	/**
+	 Free the arrays of all gates, which must not have been evaluated yet, and clear the circuit. Used if a circuit that was
+	 loaded with ReadGates() cannot be used, since Reset() leaves freeing these arrays to the evaluation.
+	 */
+	void ReleaseGates();
+
 	//Export the constructed circuit in the Bristol circuit file format
 	void ExportCircuitInBristolFormat(vector<uint32_t> ingates_client, vector<uint32_t> ingates_server,
 			vector<uint32_t> outgates, const char* filename);
@@ -232,11 +341,18 @@ private:
 	inline void InitGate(GATE* gate, e_gatetype type);
 	inline void InitGate(GATE* gate, e_gatetype type, uint32_t ina);
 	inline void InitGate(GATE* gate, e_gatetype type, uint32_t ina, uint32_t inb);
-	inline void InitGate(GATE* gate, e_gatetype type, vector<uint32_t>& inputs);
+	inline void InitGate(GATE* gate, e_gatetype type, const vector<uint32_t>& inputs);
 
 	inline uint32_t GetNumRounds(e_gatetype type, e_sharing context);
 	inline void MarkGateAsUsed(uint32_t gateid, uint32_t uses = 1);
 
+	void RestoreCompiled();
+	uint32_t GetGateArrays(GATE* gate, gate_array* arrays);
+	void DuplicateGateArrays(GATE* gate);
+	void FreeGateArrays(GATE* gate);
+	BOOL IsValidLoadedGate(uint32_t gateid);
+	void FreeLoadedTables();
+
 	void ExportGateInBristolFormat(uint32_t gateid, uint32_t& next_gate_id, vector<int>& gate_id_map,
 			vector<int>& constant_map, ofstream& outfile);
 	void CheckAndPropagateConstant(uint32_t gateid, uint32_t& next_gate_id, vector<int>& gate_id_map,
@@ -246,6 +362,15 @@ private:
 	uint32_t m_nNextFreeGate;	// points to the current first unused gate
 	uint32_t m_nMaxVectorSize; 	// The maximum vector size in bits, required for correctly instantiating the 0 and 1 gates
 	uint32_t m_nMaxGates; 		// Maximal number of gates that is allowed
+
+	BOOL m_bDedupGates;
+	unordered_map<uint64_t, uint32_t> m_mPrimitiveGates[2];	// ids of the G_LIN and G_NON_LIN gates indexed by their ordered inputs
+
+	GATE* m_pCompiledGates;		// copy of the gates at the time the circuit was compiled, NULL if it is not compiled
+	uint32_t m_nCompiledGates;
+	uint32_t m_nCompiledMaxVectorSize;
+
+	vector<uint64_t*> m_vLoadedTables;	// truth tables of the G_TT gates that were loaded from a circuit file, owned by the circuit
 };
 
 #endif /* __ABYCIRCUIT_H_ */
@@ -22,7 +22,7 @@ void ArithmeticCircuit::Init() {
 	m_nMULs = 0;
 	m_nCONVGates = 0;
 
-	if (m_eContext == S_ARITH) {
+	if (m_eContext == S_ARITH || m_eContext == S_ARITH_FIELD) {
 		m_nRoundsAND = 1;
 		m_nRoundsXOR = 0;
 		m_nRoundsIN.resize(2, 1);
@@ -45,7 +45,11 @@ share* ArithmeticCircuit::PutMULGate(share* ina, share* inb) {
 }
 
 uint32_t ArithmeticCircuit::PutMULGate(uint32_t inleft, uint32_t inright) {
+	uint32_t gatehead = m_cCircuit->GetGateHead();
 	uint32_t gateid = m_cCircuit->PutPrimitiveGate(G_NON_LIN, inleft, inright, m_nRoundsAND);
+	//an identical gate was already put and accounted for
+	if (gateid < gatehead)
+		return gateid;
 	UpdateInteractiveQueue(gateid);
 
 	if (m_pGates[gateid].nvals != INT_MAX) {
@@ -55,8 +59,133 @@ uint32_t ArithmeticCircuit::PutMULGate(uint32_t inleft, uint32_t inright) {
 	return gateid;
 }
 
+uint32_t ArithmeticCircuit::PutMatMulGate(uint32_t a, uint32_t b, uint32_t n, uint32_t m, uint32_t k) {
+	if (m_eContext == S_ARITH_FIELD) {
+		cerr << "Matrix multiplication is not supported in a prime field sharing" << endl;
+		assert(m_eContext != S_ARITH_FIELD);
+	}
+	if (m_pGates[a].nvals != n * m || m_pGates[b].nvals != m * k) {
+		cerr << "Matrix dimensions do not match the number of values of the inputs: " << m_pGates[a].nvals << " values for " << n << " x " << m
+				<< " and " << m_pGates[b].nvals << " values for " << m << " x " << k << endl;
+		assert(m_pGates[a].nvals == n * m && m_pGates[b].nvals == m * k);
+	}
+	uint32_t gateid = m_cCircuit->PutMatrixMultiplicationGate(a, b, n, m, k, m_nRoundsAND);
+	UpdateInteractiveQueue(gateid);
+	return gateid;
+}
+
+share* ArithmeticCircuit::PutMatMulGate(share* a, share* b, uint32_t n, uint32_t m, uint32_t k) {
+	share* shr = new arithshare(this);
+	shr->set_wire_id(0, PutMatMulGate(a->get_wire_id(0), b->get_wire_id(0), n, m, k));
+	return shr;
+}
+
+uint32_t ArithmeticCircuit::PutDotGate(uint32_t a, uint32_t b, uint32_t dotlen) {
+	return PutFPDotGate(a, b, 0, dotlen);
+}
+
+share* ArithmeticCircuit::PutDotGate(share* a, share* b, uint32_t dotlen) {
+	share* shr = new arithshare(this);
+	shr->set_wire_id(0, PutDotGate(a->get_wire_id(0), b->get_wire_id(0), dotlen));
+	return shr;
+}
+
+uint32_t ArithmeticCircuit::PutTruncGate(uint32_t in, uint32_t truncbits) {
+	if (truncbits == 0)
+		return in;
+	if (m_eContext == S_ARITH_FIELD || truncbits >= m_nShareBitLen) {
+		cerr << "Cannot truncate " << m_nShareBitLen << "-bit " << get_sharing_name(m_eContext) << " shares by " << truncbits << " bits" << endl;
+		assert(m_eContext != S_ARITH_FIELD && truncbits < m_nShareBitLen);
+	}
+	uint32_t gateid = m_cCircuit->PutTruncGate(in, truncbits);
+	UpdateLocalQueue(gateid);
+	return gateid;
+}
+
+share* ArithmeticCircuit::PutTruncGate(share* ina, uint32_t truncbits) {
+	share* shr = new arithshare(this);
+	shr->set_wire_id(0, PutTruncGate(ina->get_wire_id(0), truncbits));
+	return shr;
+}
+
+uint32_t ArithmeticCircuit::PutFPMULGate(uint32_t a, uint32_t b, uint32_t truncbits) {
+	//a dot product gate of length 1 computes the products of the values
+	return PutFPDotGate(a, b, truncbits, 1);
+}
+
+share* ArithmeticCircuit::PutFPMULGate(share* ina, share* inb, uint32_t truncbits) {
+	share* shr = new arithshare(this);
+	shr->set_wire_id(0, PutFPMULGate(ina->get_wire_id(0), inb->get_wire_id(0), truncbits));
+	return shr;
+}
+
+uint32_t ArithmeticCircuit::PutFPDotGate(uint32_t a, uint32_t b, uint32_t truncbits, uint32_t dotlen) {
+	uint32_t nvals = m_pGates[a].nvals;
+	if (dotlen == 0)
+		dotlen = nvals;
+	if (m_pGates[b].nvals != nvals || nvals % dotlen != 0) {
+		cerr << "Number of values of the inputs (" << nvals << " and " << m_pGates[b].nvals << ") do not match dot products of length "
+				<< dotlen << endl;
+		assert(m_pGates[b].nvals == nvals && nvals % dotlen == 0);
+	}
+	if (truncbits > 0 && (m_eContext == S_ARITH_FIELD || truncbits >= m_nShareBitLen)) {
+		cerr << "Cannot truncate " << m_nShareBitLen << "-bit " << get_sharing_name(m_eContext) << " shares by " << truncbits << " bits" << endl;
+		assert(m_eContext != S_ARITH_FIELD && truncbits < m_nShareBitLen);
+	}
+	uint32_t gateid = m_cCircuit->PutDotProductGate(a, b, dotlen, m_nRoundsAND, truncbits);
+	UpdateInteractiveQueue(gateid);
+	m_nMULs += nvals;
+	return gateid;
+}
+
+share* ArithmeticCircuit::PutFPDotGate(share* a, share* b, uint32_t truncbits, uint32_t dotlen) {
+	share* shr = new arithshare(this);
+	shr->set_wire_id(0, PutFPDotGate(a->get_wire_id(0), b->get_wire_id(0), truncbits, dotlen));
+	return shr;
+}
+
+uint32_t ArithmeticCircuit::PutWidthConvGate(uint32_t in) {
+	if (m_eContext == S_ARITH_FIELD || m_pGates[in].context == S_ARITH_FIELD) {
+		cerr << "Width conversion is not supported for prime field sharings" << endl;
+		assert(m_eContext != S_ARITH_FIELD && m_pGates[in].context != S_ARITH_FIELD);
+	}
+	assert(m_pGates[in].sharebitlen >= m_nShareBitLen);
+	uint32_t gateid = m_cCircuit->PutWidthConvGate(in, m_nShareBitLen);
+	UpdateLocalQueue(gateid);
+	return gateid;
+}
+
+share* ArithmeticCircuit::PutWidthConvGate(share* ina, Circuit* yc, Circuit* bc) {
+	uint32_t inid = ina->get_wire_id(0);
+	uint32_t inbitlen = m_pGates[inid].sharebitlen;
+	if (inbitlen >= m_nShareBitLen || m_eContext == S_ARITH_FIELD || m_pGates[inid].context == S_ARITH_FIELD) {
+		share* shr = new arithshare(this);
+		shr->set_wire_id(0, PutWidthConvGate(inid));
+		return shr;
+	}
+
+	if (!yc || !bc) {
+		cerr << "Extending arithmetic shares from " << inbitlen << " to " << m_nShareBitLen << " bits requires a Yao and a Boolean circuit" << endl;
+		assert(yc && bc);
+	}
+
+	share* yshr = yc->PutA2YGate(ina);
+	share* bshr = bc->PutY2BGate(yshr);
+	vector<uint32_t> wires = bshr->get_wires();
+	wires.resize(m_nShareBitLen, bc->PutConstantGate(0, m_pGates[inid].nvals));
+	share* shr = new arithshare(this);
+	shr->set_wire_id(0, PutB2AGate(wires));
+
+	delete yshr;
+	delete bshr;
+	return shr;
+}
+
 uint32_t ArithmeticCircuit::PutADDGate(uint32_t inleft, uint32_t inright) {
+	uint32_t gatehead = m_cCircuit->GetGateHead();
 	uint32_t gateid = m_cCircuit->PutPrimitiveGate(G_LIN, inleft, inright, m_nRoundsXOR);
+	if (gateid < gatehead)
+		return gateid;
 	UpdateLocalQueue(gateid);
 	return gateid;
 }
@@ -225,8 +354,6 @@ template<class T> share* ArithmeticCircuit::InternalPutINGate(uint32_t nvals, T*
 	assert(bitlen <= m_nShareBitLen);
 	share* shr = new arithshare(this);
 	uint32_t gateid = PutSIMDINGate(nvals, role);
-	uint32_t iters = sizeof(UGATE_T) / sizeof(T);
-	assert(iters > 0);
 	shr->set_wire_id(0, gateid);
 
 	if (role == m_eMyRole) {
@@ -245,6 +372,10 @@ template<class T> share* ArithmeticCircuit::InternalPutINGate(uint32_t nvals, T*
 }
 
 
+share* ArithmeticCircuit::PutSIMDINGate(uint32_t nvals, UINT128_T* val, uint32_t bitlen, e_role role) {
+	return InternalPutINGate<UINT128_T>(nvals, val, bitlen, role);
+}
+
 template<class T> share* ArithmeticCircuit::InternalPutSharedINGate(uint32_t nvals, T* val, uint32_t bitlen) {
 	assert(bitlen <= m_nShareBitLen);
 	share* shr = new arithshare(this);
@@ -264,6 +395,19 @@ template<class T> share* ArithmeticCircuit::InternalPutSharedINGate(uint32_t nva
 	return shr;
 }
 
+template<class T> void ArithmeticCircuit::InternalSetINGateValues(share* in, T* val) {
+	uint32_t nvals = in->get_nvals_on_wire(0);
+	uint32_t sharebytelen = ceil_divide(m_nShareBitLen, 8);
+	uint32_t inbytelen = min((uint32_t) sizeof(T), sharebytelen);
+	BYTE* tmpval = (BYTE*) calloc(nvals, sharebytelen);
+
+	for(uint32_t i = 0; i < nvals; i++) {
+		memcpy(tmpval + i * sharebytelen, val+i, inbytelen);
+	}
+	m_cCircuit->SetINGateValues(in->get_wire_id(0), tmpval);
+	free(tmpval);
+}
+
 uint32_t ArithmeticCircuit::PutOUTGate(uint32_t parentid, e_role dst) {
 	uint32_t gateid = m_cCircuit->PutOUTGate(parentid, dst, m_nRoundsOUT[dst]);
 	UpdateInteractiveQueue(gateid);
@@ -300,7 +444,7 @@ share* ArithmeticCircuit::PutOUTGate(share* parent, e_role dst) {
 	return shr;
 }
 
-vector<uint32_t> ArithmeticCircuit::PutSharedOUTGate(vector<uint32_t> parentids) {
+vector<uint32_t> ArithmeticCircuit::PutSharedOUTGate(const vector<uint32_t>& parentids) {
 	vector<uint32_t> out = m_cCircuit->PutSharedOUTGate(parentids);
 	for(uint32_t i = 0; i < out.size(); i++) {
 		UpdateLocalQueue(out[i]);
@@ -320,7 +464,11 @@ uint32_t ArithmeticCircuit::PutINVGate(uint32_t parentid) {
 	return gateid;
 }
 
-uint32_t ArithmeticCircuit::PutCONVGate(vector<uint32_t> parentids) {
+uint32_t ArithmeticCircuit::PutCONVGate(const vector<uint32_t>& parentids) {
+	if (m_eContext == S_ARITH_FIELD) {
+		cerr << "Conversions into a prime field sharing are not supported" << endl;
+	}
+	assert(m_eContext != S_ARITH_FIELD);
 	uint32_t gateid = m_cCircuit->PutCONVGate(parentids, 2, S_ARITH, m_nShareBitLen);
 	UpdateInteractiveQueue(gateid);
 	m_nCONVGates += m_pGates[gateid].nvals;
@@ -396,10 +544,33 @@ uint32_t ArithmeticCircuit::PutConstantGate(UGATE_T val, uint32_t nvals) {
 	return gateid;
 }
 
-uint32_t ArithmeticCircuit::PutB2AGate(vector<uint32_t> ina) {
+uint32_t ArithmeticCircuit::PutB2AGate(const vector<uint32_t>& ina) {
 	return PutCONVGate(ina);
 }
 
+uint32_t ArithmeticCircuit::PutY2AGate(const vector<uint32_t>& ina) {
+	if (m_eContext == S_ARITH_FIELD) {
+		cerr << "Conversions into a prime field sharing are not supported" << endl;
+	}
+	assert(m_eContext != S_ARITH_FIELD);
+	for (uint32_t i = 0; i < ina.size(); i++) {
+		assert(m_pGates[ina[i]].context == S_YAO || m_pGates[ina[i]].context == S_YAO_REV);
+		//a Y input gate cannot be parent to a Y2A gate, as for a Y2B gate
+		assert(m_pGates[ina[i]].type != G_IN);
+	}
+	uint32_t gateid = m_cCircuit->PutCONVGate(ina, 2, S_ARITH, m_nShareBitLen);
+	m_pGates[gateid].depth++; //increase depth by 1 since the keys are read after the yao evaluation, as for a Y2B gate
+	UpdateInteractiveQueue(gateid);
+	m_nCONVGates += m_pGates[gateid].nvals;
+	return gateid;
+}
+
+share* ArithmeticCircuit::PutY2AGate(share* ina, Circuit* boolsharingcircuit) {
+	share* shr = new arithshare(this);
+	shr->set_wire_id(0, PutY2AGate(ina->get_wires()));
+	return shr;
+}
+
 share* ArithmeticCircuit::PutB2AGate(share* ina) {
 	share* shr = new arithshare(this);
 	shr->set_wire_id(0, PutCONVGate(ina->get_wires()));
@@ -429,6 +600,9 @@ void ArithmeticCircuit::UpdateLocalQueue(uint32_t gateid) {
 }
 
 void ArithmeticCircuit::Reset() {
+	if (m_cCircuit->IsCompiled())
+		return;
+
 	Circuit::Reset();
 	m_nMULs = 0;
 	m_nCONVGates = 0;
@@ -453,3 +627,13 @@ void ArithmeticCircuit::Reset() {
 	for (uint32_t i = 0; i < m_vOutputBits.size(); i++)
 		m_vOutputBits[i] = 0;
 }
+
+void ArithmeticCircuit::WriteState(CircuitFile& file) {
+	Circuit::WriteState(file);
+	file.Put<uint32_t>(m_nMULs);
+	file.Put<uint32_t>(m_nCONVGates);
+}
+
+BOOL ArithmeticCircuit::ReadState(CircuitFile& file) {
+	return Circuit::ReadState(file) && file.Get<uint32_t>(&m_nMULs) && file.Get<uint32_t>(&m_nCONVGates);
+}
@@ -39,8 +39,56 @@ public:
 	void Init();
 	void Cleanup();
 	void Reset();
+	void WriteState(CircuitFile& file);
+	BOOL ReadState(CircuitFile& file);
 
 	uint32_t PutMULGate(uint32_t left, uint32_t right);
+	/**
+	 Multiply the row-major (n x m) matrix a with the row-major (m x k) matrix b, which are given as SIMD gates with n * m
+	 and m * k values. The product is computed with a single matrix triple, such that only the n * m + m * k values of
+	 the masked inputs are opened instead of one pair per scalar multiplication.
+	 \return 	SIMD gate with the n * k values of the row-major result matrix
+	 */
+	uint32_t PutMatMulGate(uint32_t a, uint32_t b, uint32_t n, uint32_t m, uint32_t k);
+	share* PutMatMulGate(share* a, share* b, uint32_t n, uint32_t m, uint32_t k);
+	/**
+	 Compute the dot products of the SIMD gates a and b, which have the same number of values, without putting a gate for
+	 each product and the additions. The MTs of all products are opened at once and the products are accumulated into the
+	 output values.
+	 \param 	dotlen 	length of each dot product, which has to divide the number of values. 0 computes a single dot
+	 	 	 	 	 	product over all values.
+	 \return 	SIMD gate with one value per dot product
+	 */
+	uint32_t PutDotGate(uint32_t a, uint32_t b, uint32_t dotlen = 0);
+	share* PutDotGate(share* a, share* b, uint32_t dotlen = 0);
+	/**
+	 Truncate the fixed-point values of gate in by truncbits fractional bits without interaction. The server shifts its
+	 share arithmetically to the right and the client the negation of its share, which gives the truncated signed value
+	 up to an error of 1 in the last bit. The result is wrong with a probability of about |x| / 2^l, such that the bit
+	 length has to leave enough room above the values. Not supported in prime field sharings.
+	 */
+	uint32_t PutTruncGate(uint32_t in, uint32_t truncbits);
+	share* PutTruncGate(share* ina, uint32_t truncbits);
+	/** Multiply the fixed-point values of a and b and truncate the products by truncbits bits, see PutTruncGate() */
+	uint32_t PutFPMULGate(uint32_t a, uint32_t b, uint32_t truncbits);
+	share* PutFPMULGate(share* ina, share* inb, uint32_t truncbits);
+	/** Compute the dot products of the fixed-point values of a and b like PutDotGate() and truncate them by truncbits bits */
+	uint32_t PutFPDotGate(uint32_t a, uint32_t b, uint32_t truncbits, uint32_t dotlen = 0);
+	share* PutFPDotGate(share* a, share* b, uint32_t truncbits, uint32_t dotlen = 0);
+	/**
+	 Reduce the values of gate in, which is shared in an arithmetic circuit of a larger bit length, to the bit length
+	 of this circuit. The shares are reduced locally modulo 2^l.
+	 */
+	uint32_t PutWidthConvGate(uint32_t in);
+	/**
+	 Convert the value of ina, which is shared in an arithmetic circuit of another bit length, to the bit length of this
+	 circuit. Values are reduced locally modulo 2^l if this circuit has the smaller bit length. Shares cannot be extended
+	 locally to a larger bit length, since the sum of the shares wraps around, such that the value is converted to Yao
+	 sharing in yc, to Boolean sharing in bc, padded with zero bits, and converted to this circuit with a B2A gate.
+	 \param 	yc 	Yao circuit, only required to extend the bit length
+	 \param 	bc 	Boolean circuit, only required to extend the bit length
+	 */
+	share* PutWidthConvGate(share* ina, Circuit* yc = NULL, Circuit* bc = NULL);
 	uint32_t PutADDGate(uint32_t left, uint32_t right);
 	uint32_t PutSUBGate(uint32_t left, uint32_t right);
 
@@ -116,6 +164,8 @@ public:
 	share* PutSIMDINGate(uint32_t nvals, uint8_t* val, uint32_t bitlen, e_role role) {
 		return InternalPutINGate<uint8_t>(nvals, val, bitlen, role);
 	};
+	/** Input of values with up to 128 bits, for the arithmetic circuit with 128-bit shares */
+	share* PutSIMDINGate(uint32_t nvals, UINT128_T* val, uint32_t bitlen, e_role role);
 
 	template<class T> share* InternalPutSharedINGate(uint32_t nvals, T val, uint32_t bitlen);
 	/* Unfortunately, a template function cannot be used due to virtual */
@@ -175,11 +225,26 @@ public:
 		return InternalPutSharedINGate<uint8_t>(nvals, val, bitlen);
 	};
 
+	template<class T> void InternalSetINGateValues(share* in, T* val);
+	/* Unfortunately, a template function cannot be used due to virtual. Call InternalSetINGateValues*/
+	void SetINGateValues(share* in, uint64_t* val) {
+		InternalSetINGateValues<uint64_t>(in, val);
+	};
+	void SetINGateValues(share* in, uint32_t* val) {
+		InternalSetINGateValues<uint32_t>(in, val);
+	};
+	void SetINGateValues(share* in, uint16_t* val) {
+		InternalSetINGateValues<uint16_t>(in, val);
+	};
+	void SetINGateValues(share* in, uint8_t* val) {
+		InternalSetINGateValues<uint8_t>(in, val);
+	};
+
 
 	uint32_t PutOUTGate(uint32_t parent, e_role dst);
 	share* PutOUTGate(share* parent, e_role dst);
 
-	vector<uint32_t> PutSharedOUTGate(vector<uint32_t> parentids);
+	vector<uint32_t> PutSharedOUTGate(const vector<uint32_t>& parentids);
 	share* PutSharedOUTGate(share* parent);
 
 
@@ -190,7 +255,7 @@ public:
 
 
 	uint32_t PutINVGate(uint32_t parentid);
-	uint32_t PutCONVGate(vector<uint32_t> parentids);
+	uint32_t PutCONVGate(const vector<uint32_t>& parentids);
 
 	share* PutADDGate(share* ina, share* inb);
 
@@ -237,8 +302,16 @@ public:
 		cerr << "ANDVec Gate not implemented in arithmetic sharing" << endl;
 		return new arithshare(this);
 	}
-	uint32_t PutB2AGate(vector<uint32_t> ina);
+	uint32_t PutB2AGate(const vector<uint32_t>& ina);
 	share* PutB2AGate(share* ina);
+	/**
+	 Convert the Yao share ina directly into this circuit. The garbler uses its permutation bits and the evaluator the
+	 least significant bits of its keys as Boolean shares for the OT-based conversion of a B2A gate, which saves the
+	 layer of the Y2B gate.
+	 \param 	boolsharingcircuit 	not required, kept for the interface of Circuit::PutY2AGate()
+	 */
+	share* PutY2AGate(share* ina, Circuit* boolsharingcircuit = NULL);
+	uint32_t PutY2AGate(const vector<uint32_t>& ina);
 
 
 	uint32_t GetNumMULGates() {
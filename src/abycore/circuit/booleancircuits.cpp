@@ -78,7 +78,11 @@ void BooleanCircuit::Cleanup() {
 uint32_t BooleanCircuit::PutANDGate(uint32_t inleft, uint32_t inright) {
 	uint32_t gateid;
 	if(m_eContext != S_BOOL_NO_MT) {
+		uint32_t gatehead = m_cCircuit->GetGateHead();
 		gateid = m_cCircuit->PutPrimitiveGate(G_NON_LIN, inleft, inright, m_nRoundsAND);
+		//an identical gate was already put and accounted for
+		if (gateid < gatehead)
+			return gateid;
 
 		if (m_eContext == S_BOOL) {
 			UpdateInteractiveQueue(gateid);
@@ -104,8 +108,10 @@ uint32_t BooleanCircuit::PutANDGate(uint32_t inleft, uint32_t inright) {
 	return gateid;
 }
 
-vector<uint32_t> BooleanCircuit::PutANDGate(vector<uint32_t> inleft, vector<uint32_t> inright) {
-	PadWithLeadingZeros(inleft, inright);
+vector<uint32_t> BooleanCircuit::PutANDGate(const vector<uint32_t>& inleft, const vector<uint32_t>& inright) {
+	vector<uint32_t> lpad, rpad;
+	if (PadWithLeadingZeros(inleft, inright, lpad, rpad))
+		return PutANDGate(lpad, rpad);
 	uint32_t lim = inleft.size();
 	vector<uint32_t> out(lim);
 	for (uint32_t i = 0; i < lim; i++)
@@ -161,15 +167,20 @@ share* BooleanCircuit::PutXORGate(share* ina, share* inb) {
 
 uint32_t BooleanCircuit::PutXORGate(uint32_t inleft, uint32_t inright) {
 	//cout << "inleft = " << inleft << ", inright = " << inright << endl;
+	uint32_t gatehead = m_cCircuit->GetGateHead();
 	uint32_t gateid = m_cCircuit->PutPrimitiveGate(G_LIN, inleft, inright, m_nRoundsXOR);
+	if (gateid < gatehead)
+		return gateid;
 	UpdateLocalQueue(gateid);
 	m_nNumXORVals += m_pGates[gateid].nvals;
 	m_nNumXORGates += 1;
 	return gateid;
 }
 
-vector<uint32_t> BooleanCircuit::PutXORGate(vector<uint32_t> inleft, vector<uint32_t> inright) {
-	PadWithLeadingZeros(inleft, inright);
+vector<uint32_t> BooleanCircuit::PutXORGate(const vector<uint32_t>& inleft, const vector<uint32_t>& inright) {
+	vector<uint32_t> lpad, rpad;
+	if (PadWithLeadingZeros(inleft, inright, lpad, rpad))
+		return PutXORGate(lpad, rpad);
 	uint32_t lim = inleft.size();
 	vector<uint32_t> out(lim);
 	for (uint32_t i = 0; i < lim; i++)
@@ -530,6 +541,25 @@ template<class T> share* BooleanCircuit::InternalPutSharedINGate(uint32_t nvals,
 	return shr;
 }
 
+//Splits the values into one value per wire in the same way as InternalPutINGate
+template<class T> void BooleanCircuit::InternalSetINGateValues(share* in, T* val) {
+	uint32_t bitlen = in->get_bitlength();
+	uint32_t nvals = in->get_nvals_on_wire(0);
+	uint32_t typebitlen = sizeof(T) * 8;
+	uint32_t typebyteiters = ceil_divide(bitlen, typebitlen);
+	uint64_t tmpval_bytes = max(PadToMultiple(typebyteiters * nvals * sizeof(T), sizeof(UGATE_T)), sizeof(UGATE_T));
+	T* tmpval = (T*) malloc(tmpval_bytes);
+
+	for (uint32_t i = 0; i < bitlen; i++) {
+		memset(tmpval, 0, tmpval_bytes);
+		for (uint32_t j = 0; j < nvals; j++) {
+			tmpval[j /typebitlen] += (((val[j * typebyteiters + i/typebitlen] >> (i % typebitlen)) & 0x01) << (j%typebitlen));
+		}
+		m_cCircuit->SetINGateValues(in->get_wire_id(i), (BYTE*) tmpval);
+	}
+	free(tmpval);
+}
+
 
 uint32_t BooleanCircuit::PutOUTGate(uint32_t parentid, e_role dst) {
 	uint32_t gateid = m_cCircuit->PutOUTGate(parentid, dst, m_nRoundsOUT[dst]);
@@ -563,7 +593,7 @@ share* BooleanCircuit::PutOUTGate(share* parent, e_role dst) {
 	return new boolshare(PutOUTGate(parent->get_wires(), dst), this);
 }
 
-vector<uint32_t> BooleanCircuit::PutOUTGate(vector<uint32_t> parentids, e_role dst) {
+vector<uint32_t> BooleanCircuit::PutOUTGate(const vector<uint32_t>& parentids, e_role dst) {
 	vector<uint32_t> gateid = m_cCircuit->PutOUTGate(parentids, dst, m_nRoundsOUT[dst]);
 
 	//TODO: optimize
@@ -594,7 +624,7 @@ vector<uint32_t> BooleanCircuit::PutOUTGate(vector<uint32_t> parentids, e_role d
 }
 
 
-vector<uint32_t> BooleanCircuit::PutSharedOUTGate(vector<uint32_t> parentids) {
+vector<uint32_t> BooleanCircuit::PutSharedOUTGate(const vector<uint32_t>& parentids) {
 	vector<uint32_t> out = m_cCircuit->PutSharedOUTGate(parentids);
 	for(uint32_t i = 0; i < out.size(); i++) {
 		UpdateLocalQueue(out[i]);
@@ -690,7 +720,7 @@ uint32_t BooleanCircuit::PutINVGate(uint32_t parentid) {
 	return gateid;
 }
 
-vector<uint32_t> BooleanCircuit::PutINVGate(vector<uint32_t> parentid) {
+vector<uint32_t> BooleanCircuit::PutINVGate(const vector<uint32_t>& parentid) {
 	vector<uint32_t> out(parentid.size());
 	for (uint32_t i = 0; i < out.size(); i++)
 		out[i] = PutINVGate(parentid[i]);
@@ -736,7 +766,7 @@ uint32_t BooleanCircuit::PutYSwitchRolesGate(uint32_t parentid) {
 	return gateid;
 }
 
-vector<uint32_t> BooleanCircuit::PutYSwitchRolesGate(vector<uint32_t> parentid) {
+vector<uint32_t> BooleanCircuit::PutYSwitchRolesGate(const vector<uint32_t>& parentid) {
 	vector<uint32_t> out(parentid.size());
 	for (uint32_t i = 0; i < parentid.size(); i++) {
 		out[i] = PutYSwitchRolesGate(parentid[i]);
@@ -746,7 +776,7 @@ vector<uint32_t> BooleanCircuit::PutYSwitchRolesGate(vector<uint32_t> parentid)
 }
 
 
-vector<uint32_t> BooleanCircuit::PutY2BCONVGate(vector<uint32_t> parentid) {
+vector<uint32_t> BooleanCircuit::PutY2BCONVGate(const vector<uint32_t>& parentid) {
 	vector<uint32_t> out(parentid.size());
 	for (uint32_t i = 0; i < parentid.size(); i++) {
 		out[i] = PutY2BCONVGate(parentid[i]);
@@ -754,7 +784,7 @@ vector<uint32_t> BooleanCircuit::PutY2BCONVGate(vector<uint32_t> parentid) {
 	return out;
 }
 
-vector<uint32_t> BooleanCircuit::PutB2YCONVGate(vector<uint32_t> parentid) {
+vector<uint32_t> BooleanCircuit::PutB2YCONVGate(const vector<uint32_t>& parentid) {
 	vector<uint32_t> out(parentid.size());
 	for (uint32_t i = 0; i < parentid.size(); i++) {
 		out[i] = PutB2YCONVGate(parentid[i]);
@@ -775,7 +805,11 @@ share* BooleanCircuit::PutYSwitchRolesGate(share* ina) {
 	return new boolshare(PutYSwitchRolesGate(ina->get_wires()), this);
 }
 
-vector<uint32_t> BooleanCircuit::PutA2YCONVGate(vector<uint32_t> parentid) {
+vector<uint32_t> BooleanCircuit::PutA2YCONVGate(const vector<uint32_t>& parentid) {
+	if (m_pGates[parentid[0]].context == S_ARITH_FIELD) {
+		cerr << "Conversions from a prime field sharing are not supported" << endl;
+	}
+	assert(m_pGates[parentid[0]].context != S_ARITH_FIELD);
 	vector<uint32_t> srvshares(m_pGates[parentid[0]].sharebitlen);
 	vector<uint32_t> clishares(m_pGates[parentid[0]].sharebitlen);
 
@@ -801,7 +835,40 @@ share* BooleanCircuit::PutA2YGate(share* ina) {
 	return new boolshare(PutA2YCONVGate(ina->get_wires()), this);
 }
 
-uint32_t BooleanCircuit::PutStructurizedCombinerGate(vector<uint32_t> input, uint32_t pos_start,
+vector<uint32_t> BooleanCircuit::PutA2BCONVGate(const vector<uint32_t>& parentid) {
+	assert(m_eContext == S_BOOL);
+	if (m_pGates[parentid[0]].context == S_ARITH_FIELD) {
+		cerr << "Conversions from a prime field sharing are not supported" << endl;
+	}
+	assert(m_pGates[parentid[0]].context != S_ARITH_FIELD);
+	vector<uint32_t> srvshares(m_pGates[parentid[0]].sharebitlen);
+	vector<uint32_t> clishares(m_pGates[parentid[0]].sharebitlen);
+
+	//each party locally inputs the bits of its arithmetic share as Boolean shares, where the other party holds 0
+	for (uint32_t i = 0; i < m_pGates[parentid[0]].sharebitlen; i++) {
+		srvshares[i] = m_cCircuit->PutCONVGate(parentid, 0, S_BOOL, m_nShareBitLen);
+		m_pGates[srvshares[i]].gs.pos = 2 * i;
+		m_pGates[srvshares[i]].depth++; //increase depth by 1 since the arithmetic parent may be evaluated in the same layer
+		UpdateLocalQueue(srvshares[i]);
+
+		clishares[i] = m_cCircuit->PutCONVGate(parentid, 0, S_BOOL, m_nShareBitLen);
+		m_pGates[clishares[i]].gs.pos = 2 * i + 1;
+		m_pGates[clishares[i]].depth++;
+		UpdateLocalQueue(clishares[i]);
+	}
+
+	//add both shares with the depth-optimized adder, where the AND gates of each prefix level are merged into vector ANDs
+	return PutDepthOptimizedAddGate(srvshares, clishares, FALSE, true);
+}
+
+share* BooleanCircuit::PutA2BGate(share* ina, Circuit* yaosharingcircuit) {
+	if (yaosharingcircuit != NULL) {
+		return Circuit::PutA2BGate(ina, yaosharingcircuit);
+	}
+	return new boolshare(PutA2BCONVGate(ina->get_wires()), this);
+}
+
+uint32_t BooleanCircuit::PutStructurizedCombinerGate(const vector<uint32_t>& input, uint32_t pos_start,
 		uint32_t pos_incr, uint32_t nvals) {
 	uint32_t gateid = m_cCircuit->PutStructurizedCombinerGate(input, pos_start, pos_incr, nvals);
 	UpdateLocalQueue(gateid);
@@ -816,7 +883,7 @@ share* BooleanCircuit::PutStructurizedCombinerGate(share* input, uint32_t pos_st
 	return out;
 }
 
-uint32_t BooleanCircuit::PutCallbackGate(vector<uint32_t> in, uint32_t rounds, void (*callback)(GATE*, void*),
+uint32_t BooleanCircuit::PutCallbackGate(const vector<uint32_t>& in, uint32_t rounds, void (*callback)(GATE*, void*),
 		void* infos, uint32_t nvals) {
 
 	uint32_t gateid = m_cCircuit->PutCallbackGate(in, rounds, callback, infos, nvals);
@@ -862,7 +929,7 @@ share* BooleanCircuit::PutCallbackGate(share* in, uint32_t rounds, void (*callba
 	return newtt;
 }*/
 
-vector<uint32_t> BooleanCircuit::PutTruthTableMultiOutputGate(vector<uint32_t> in, uint32_t out_bits,
+vector<uint32_t> BooleanCircuit::PutTruthTableMultiOutputGate(const vector<uint32_t>& in, uint32_t out_bits,
 		uint64_t* ttable) {
 	//assert(m_eContext == S_BOOL_NO_MT);
 
@@ -887,7 +954,7 @@ share* BooleanCircuit::PutTruthTableMultiOutputGate(share* in, uint32_t output_b
 	return new boolshare(PutTruthTableMultiOutputGate(in->get_wires(), output_bitlen, ttable), this);
 }
 
-uint32_t BooleanCircuit::PutTruthTableGate(vector<uint32_t> in, uint32_t out_bits, uint64_t* ttable) {
+uint32_t BooleanCircuit::PutTruthTableGate(const vector<uint32_t>& in, uint32_t out_bits, uint64_t* ttable) {
 
 	assert(m_eContext == S_BOOL_NO_MT);
 	uint32_t gateid = m_cCircuit->PutTruthTableGate(in, 1, out_bits, ttable);
@@ -1004,7 +1071,7 @@ void BooleanCircuit::UpdateLocalQueue(uint32_t gateid) {
 
 
 //shift val by pos positions to the left and fill with zeros
-vector<uint32_t> BooleanCircuit::LShift(vector<uint32_t> val, uint32_t pos, uint32_t nvals) {
+vector<uint32_t> BooleanCircuit::LShift(const vector<uint32_t>& val, uint32_t pos, uint32_t nvals) {
 	vector<uint32_t> out(val.size());
 	uint32_t i, zerogate = PutConstantGate(0, nvals);
 	for (i = 0; i < pos && i < val.size(); i++) {
@@ -1023,8 +1090,10 @@ share* BooleanCircuit::PutADDGate(share* ina, share* inb) {
 }
 
 
-vector<uint32_t> BooleanCircuit::PutAddGate(vector<uint32_t> left, vector<uint32_t> right, BOOL bCarry) {
-	PadWithLeadingZeros(left, right);
+vector<uint32_t> BooleanCircuit::PutAddGate(const vector<uint32_t>& left, const vector<uint32_t>& right, BOOL bCarry) {
+	vector<uint32_t> lpad, rpad;
+	if (PadWithLeadingZeros(left, right, lpad, rpad))
+		return PutAddGate(lpad, rpad, bCarry);
 	if (m_eContext == S_BOOL) {
 		return PutDepthOptimizedAddGate(left, right, bCarry);
 	} if (m_eContext == S_BOOL_NO_MT) {
@@ -1037,10 +1106,12 @@ vector<uint32_t> BooleanCircuit::PutAddGate(vector<uint32_t> left, vector<uint32
 
 
 //a + b, do we need a carry?
-vector<uint32_t> BooleanCircuit::PutSizeOptimizedAddGate(vector<uint32_t> a, vector<uint32_t> b, BOOL bCarry) {
+vector<uint32_t> BooleanCircuit::PutSizeOptimizedAddGate(const vector<uint32_t>& a, const vector<uint32_t>& b, BOOL bCarry) {
 	// left + right mod (2^Rep)
 	// Construct C[i] gates
-	PadWithLeadingZeros(a, b);
+	vector<uint32_t> apad, bpad;
+	if (PadWithLeadingZeros(a, b, apad, bpad))
+		return PutSizeOptimizedAddGate(apad, bpad, bCarry);
 	uint32_t rep = a.size();// + (!!bCarry);
 	vector<uint32_t> C(rep);
 	uint32_t axc, bxc, acNbc;
@@ -1116,8 +1187,10 @@ vector<uint32_t> BooleanCircuit::PutSizeOptimizedAddGate(vector<uint32_t> a, vec
 
 
 //TODO: there is a bug when adding 3 and 1 as two 2-bit numbers and expecting a carry
-vector<uint32_t> BooleanCircuit::PutDepthOptimizedAddGate(vector<uint32_t> a, vector<uint32_t> b, BOOL bCARRY, bool vector_and) {
-	PadWithLeadingZeros(a, b);
+vector<uint32_t> BooleanCircuit::PutDepthOptimizedAddGate(const vector<uint32_t>& a, const vector<uint32_t>& b, BOOL bCARRY, bool vector_and) {
+	vector<uint32_t> apad, bpad;
+	if (PadWithLeadingZeros(a, b, apad, bpad))
+		return PutDepthOptimizedAddGate(apad, bpad, bCARRY, vector_and);
 	uint32_t id, rep = min(a.size(), b.size());
 	vector<uint32_t> out(a.size() + bCARRY);
 	vector<uint32_t> parity(a.size()), carry(rep), parity_zero(rep);
@@ -1172,7 +1245,7 @@ vector<uint32_t> BooleanCircuit::PutDepthOptimizedAddGate(vector<uint32_t> a, ve
 
 
 // A carry-save adder
-vector<vector<uint32_t> > BooleanCircuit::PutCarrySaveGate(vector<uint32_t> a, vector<uint32_t> b, vector<uint32_t> c, uint32_t inbitlen, bool carry) {
+vector<vector<uint32_t> > BooleanCircuit::PutCarrySaveGate(const vector<uint32_t>& a, const vector<uint32_t>& b, const vector<uint32_t>& c, uint32_t inbitlen, bool carry) {
 	vector<uint32_t> axc(inbitlen);
 	vector<uint32_t> acNbc(inbitlen);
 	vector<vector<uint32_t> > out(2);
@@ -1217,9 +1290,11 @@ vector<vector<uint32_t> > BooleanCircuit::PutCarrySaveGate(vector<uint32_t> a, v
  * In implementation of the Brent-Kung adder for the Bool-No-MT sharing. To process the values, 5 LUTs are needed:
  * 1) for the inputs, 2) for intermediate carry-forwarding, 3) for critical path on inputs, 4) for the critical path, 5) for the inverse carry tree.
  */
-vector<uint32_t> BooleanCircuit::PutLUTAddGate(vector<uint32_t> a, vector<uint32_t> b, BOOL bCARRY) {
-	uint32_t id, rep = max(a.size(), b.size());
-	PadWithLeadingZeros(a, b);
+vector<uint32_t> BooleanCircuit::PutLUTAddGate(const vector<uint32_t>& a, const vector<uint32_t>& b, BOOL bCARRY) {
+	vector<uint32_t> apad, bpad;
+	if (PadWithLeadingZeros(a, b, apad, bpad))
+		return PutLUTAddGate(apad, bpad, bCARRY);
+	uint32_t id, rep = a.size();
 	vector<uint32_t> out(a.size() + bCARRY);
 	vector<uint32_t> parity(rep), carry(rep), parity_zero(rep), tmp;
 	vector<uint32_t> lut_in(2*rep);
@@ -1394,8 +1469,10 @@ vector<uint32_t> BooleanCircuit::PutLUTAddGate(vector<uint32_t> a, vector<uint32
 	return out;
 }
 
-vector<uint32_t> BooleanCircuit::PutMulGate(vector<uint32_t> a, vector<uint32_t> b, uint32_t resbitlen, bool depth_optimized, bool vector_ands) {
-	PadWithLeadingZeros(a, b);
+vector<uint32_t> BooleanCircuit::PutMulGate(const vector<uint32_t>& a, const vector<uint32_t>& b, uint32_t resbitlen, bool depth_optimized, bool vector_ands) {
+	vector<uint32_t> apad, bpad;
+	if (PadWithLeadingZeros(a, b, apad, bpad))
+		return PutMulGate(apad, bpad, resbitlen, depth_optimized, vector_ands);
 	//cout << "a.size() = " << a.size() << ", b.size() = " << b.size() << endl;
 	uint32_t rep = a.size();
 
@@ -1507,7 +1584,7 @@ vector<uint32_t> BooleanCircuit::PutWideAddGate(vector<vector<uint32_t> > ins) {
 		unsigned j = 0;
 		for (unsigned i = 0; i < survivors.size();) {
 			if (i + 1 >= survivors.size()) {
-				survivors[j++] = survivors[i++];
+				survivors[j++].swap(survivors[i++]);
 			} else {
 				survivors[j++] = PutSizeOptimizedAddGate(survivors[i], survivors[i + 1], false);
 				i += 2;
@@ -1598,15 +1675,16 @@ vector<vector<uint32_t> > BooleanCircuit::PutCSNNetwork(vector<vector<uint32_t>
 }
 
 
-vector<uint32_t> BooleanCircuit::PutSUBGate(vector<uint32_t> a, vector<uint32_t> b, uint32_t max_bitlength) {
+vector<uint32_t> BooleanCircuit::PutSUBGate(const vector<uint32_t>& a, const vector<uint32_t>& b, uint32_t max_bitlength) {
 	//pad with leading zeros
-	if(a.size() < max_bitlength) {
+	if(a.size() < max_bitlength || b.size() < max_bitlength) {
 		uint32_t zerogate = PutConstantGate(0, m_pGates[a[0]].nvals);
-		a.resize(max_bitlength, zerogate);
-	}
-	if(b.size() < max_bitlength) {
-		uint32_t zerogate = PutConstantGate(0, m_pGates[a[0]].nvals);
-		b.resize(max_bitlength, zerogate);
+		vector<uint32_t> apad(a), bpad(b);
+		if(apad.size() < max_bitlength)
+			apad.resize(max_bitlength, zerogate);
+		if(bpad.size() < max_bitlength)
+			bpad.resize(max_bitlength, zerogate);
+		return PutSUBGate(apad, bpad, max_bitlength);
 	}
 
 	uint32_t bitlen = a.size();
@@ -1655,8 +1733,10 @@ share* BooleanCircuit::PutSUBGate(share* ina, share* inb) {
 
 
 //computes: ci = a > b ? 1 : 0; but assumes both values to be of equal length!
-uint32_t BooleanCircuit::PutGTGate(vector<uint32_t> a, vector<uint32_t> b) {
-	PadWithLeadingZeros(a, b);
+uint32_t BooleanCircuit::PutGTGate(const vector<uint32_t>& a, const vector<uint32_t>& b) {
+	vector<uint32_t> apad, bpad;
+	if (PadWithLeadingZeros(a, b, apad, bpad))
+		return PutGTGate(apad, bpad);
 
 	if (m_eContext == S_YAO) {
 		return PutSizeOptimizedGTGate(a, b);
@@ -1668,8 +1748,10 @@ uint32_t BooleanCircuit::PutGTGate(vector<uint32_t> a, vector<uint32_t> b) {
 }
 
 //computes: ci = a > b ? 1 : 0; but assumes both values to be of equal length!
-uint32_t BooleanCircuit::PutSizeOptimizedGTGate(vector<uint32_t> a, vector<uint32_t> b) {
-	PadWithLeadingZeros(a, b);
+uint32_t BooleanCircuit::PutSizeOptimizedGTGate(const vector<uint32_t>& a, const vector<uint32_t>& b) {
+	vector<uint32_t> apad, bpad;
+	if (PadWithLeadingZeros(a, b, apad, bpad))
+		return PutSizeOptimizedGTGate(apad, bpad);
 	uint32_t ci = 0, ci1, ac, bc, acNbc;
 	ci = PutConstantGate((UGATE_T) 0, m_pGates[a[0]].nvals);
 	for (uint32_t i = 0; i < a.size(); i++, ci = ci1) {
@@ -1683,8 +1765,10 @@ uint32_t BooleanCircuit::PutSizeOptimizedGTGate(vector<uint32_t> a, vector<uint3
 }
 
 
-uint32_t BooleanCircuit::PutDepthOptimizedGTGate(vector<uint32_t> a, vector<uint32_t> b) {
-	PadWithLeadingZeros(a, b);
+uint32_t BooleanCircuit::PutDepthOptimizedGTGate(const vector<uint32_t>& a, const vector<uint32_t>& b) {
+	vector<uint32_t> apad, bpad;
+	if (PadWithLeadingZeros(a, b, apad, bpad))
+		return PutDepthOptimizedGTGate(apad, bpad);
 	uint32_t i, rem;
 	uint32_t rep = min(a.size(), b.size());
 	vector<uint32_t> agtb(rep);
@@ -1731,7 +1815,7 @@ uint32_t BooleanCircuit::PutDepthOptimizedGTGate(vector<uint32_t> a, vector<uint
 	return agtb[0];
 }
 
-uint32_t BooleanCircuit::PutLUTGTGate(vector<uint32_t> a, vector<uint32_t> b) {
+uint32_t BooleanCircuit::PutLUTGTGate(const vector<uint32_t>& a, const vector<uint32_t>& b) {
 	// build a balanced 8-wise tree
 	uint32_t nins, maxins = 8, minins = 0, j = 0;
 	vector<uint32_t> lut_ins, tmp;
@@ -1796,8 +1880,10 @@ uint32_t BooleanCircuit::PutLUTGTGate(vector<uint32_t> a, vector<uint32_t> b) {
 }
 
 
-uint32_t BooleanCircuit::PutEQGate(vector<uint32_t> a, vector<uint32_t> b) {
-	PadWithLeadingZeros(a, b);
+uint32_t BooleanCircuit::PutEQGate(const vector<uint32_t>& a, const vector<uint32_t>& b) {
+	vector<uint32_t> apad, bpad;
+	if (PadWithLeadingZeros(a, b, apad, bpad))
+		return PutEQGate(apad, bpad);
 
 	uint32_t rep = a.size(), temp;
 	vector<uint32_t> xors(rep);
@@ -1820,9 +1906,11 @@ uint32_t BooleanCircuit::PutORGate(uint32_t a, uint32_t b) {
 	return PutINVGate(PutANDGate(PutINVGate(a), PutINVGate(b)));
 }
 
-vector<uint32_t> BooleanCircuit::PutORGate(vector<uint32_t> a, vector<uint32_t> b) {
-	uint32_t reps = max(a.size(), b.size());
-	PadWithLeadingZeros(a, b);
+vector<uint32_t> BooleanCircuit::PutORGate(const vector<uint32_t>& a, const vector<uint32_t>& b) {
+	vector<uint32_t> apad, bpad;
+	if (PadWithLeadingZeros(a, b, apad, bpad))
+		return PutORGate(apad, bpad);
+	uint32_t reps = a.size();
 	vector<uint32_t> out(reps);
 	for (uint32_t i = 0; i < reps; i++) {
 		out[i] = PutORGate(a[i], b[i]);
@@ -1854,13 +1942,15 @@ share* BooleanCircuit::PutANDVecGate(share* ina, share* inb) {
 }
 
 /* if s == 0 ? b : a*/
-vector<uint32_t> BooleanCircuit::PutMUXGate(vector<uint32_t> a, vector<uint32_t> b, uint32_t s, BOOL vecand) {
+vector<uint32_t> BooleanCircuit::PutMUXGate(const vector<uint32_t>& a, const vector<uint32_t>& b, uint32_t s, BOOL vecand) {
+	vector<uint32_t> apad, bpad;
+	if (PadWithLeadingZeros(a, b, apad, bpad))
+		return PutMUXGate(apad, bpad, s, vecand);
+
 	vector<uint32_t> out;
-	uint32_t rep = max(a.size(), b.size());
+	uint32_t rep = a.size();
 	uint32_t sab, ab;
 
-	PadWithLeadingZeros(a, b);
-
 	out.resize(rep);
 
 	uint32_t nvals=1;
@@ -1894,9 +1984,12 @@ share* BooleanCircuit::PutVecANDMUXGate(share* a, share* b, share* s) {
 }
 
 /* if s == 0 ? b : a*/
-vector<uint32_t> BooleanCircuit::PutVecANDMUXGate(vector<uint32_t> a, vector<uint32_t> b, vector<uint32_t> s) {
-	uint32_t nmuxes = a.size();
-	PadWithLeadingZeros(a, b);
+vector<uint32_t> BooleanCircuit::PutVecANDMUXGate(const vector<uint32_t>& ina, const vector<uint32_t>& inb, const vector<uint32_t>& s) {
+	uint32_t nmuxes = ina.size();
+	vector<uint32_t> apad, bpad;
+	BOOL padded = PadWithLeadingZeros(ina, inb, apad, bpad);
+	const vector<uint32_t>& a = padded ? apad : ina;
+	const vector<uint32_t>& b = padded ? bpad : inb;
 
 	vector<uint32_t> out(nmuxes);
 	uint32_t sab, ab;
@@ -1928,9 +2021,9 @@ uint32_t BooleanCircuit::PutVecANDMUXGate(uint32_t a, uint32_t b, uint32_t s) {
 
 
 
-uint32_t BooleanCircuit::PutWideGate(e_gatetype type, vector<uint32_t> ins) {
+uint32_t BooleanCircuit::PutWideGate(e_gatetype type, const vector<uint32_t>& ins) {
 	// build a balanced binary tree
-	vector<uint32_t>& survivors = ins;
+	vector<uint32_t> survivors(ins);
 
 	while (survivors.size() > 1) {
 		unsigned j = 0;
@@ -1953,9 +2046,9 @@ uint32_t BooleanCircuit::PutWideGate(e_gatetype type, vector<uint32_t> ins) {
 
 
 //compute the AND over all inputs
-uint32_t BooleanCircuit::PutLUTWideANDGate(vector<uint32_t> ins) {
+uint32_t BooleanCircuit::PutLUTWideANDGate(const vector<uint32_t>& ins) {
 	// build a balanced 8-wise tree
-	vector<uint32_t>& survivors = ins;
+	vector<uint32_t> survivors(ins);
 	uint64_t* lut = (uint64_t*) calloc(4, sizeof(uint64_t));
 	uint32_t nins, maxins = 7, minins = 3;
 	vector<uint32_t> lut_ins;
@@ -1978,7 +2071,7 @@ uint32_t BooleanCircuit::PutLUTWideANDGate(vector<uint32_t> ins) {
 				}
 			} else {
 				lut_ins.clear();
-				lut_ins.assign(ins.begin() + i, ins.begin() + i + nins);
+				lut_ins.assign(survivors.begin() + i, survivors.begin() + i + nins);
 				/*cout << "Combining " << nins << " gates: ";
 				for(uint32_t k = 0; k < lut_ins.size(); k++) {
 					cout << lut_ins[k] << ", ";
@@ -2016,9 +2109,12 @@ share** BooleanCircuit::PutCondSwapGate(share* a, share* b, share* s, BOOL vecto
 
 
 //if s == 0: a stays a, else a becomes b
-vector<vector<uint32_t> > BooleanCircuit::PutCondSwapGate(vector<uint32_t> a, vector<uint32_t> b, uint32_t s, BOOL vectorized) {
-	uint32_t rep = min(a.size(), b.size());
-	PadWithLeadingZeros(a, b);
+vector<vector<uint32_t> > BooleanCircuit::PutCondSwapGate(const vector<uint32_t>& ina, const vector<uint32_t>& inb, uint32_t s, BOOL vectorized) {
+	uint32_t rep = min(ina.size(), inb.size());
+	vector<uint32_t> apad, bpad;
+	BOOL padded = PadWithLeadingZeros(ina, inb, apad, bpad);
+	const vector<uint32_t>& a = padded ? apad : ina;
+	const vector<uint32_t>& b = padded ? bpad : inb;
 
 	vector<vector<uint32_t> > out(2);
 	out[0].resize(rep);
@@ -2092,7 +2188,7 @@ vector<vector<uint32_t> > BooleanCircuit::PutCondSwapGate(vector<uint32_t> a, ve
 }
 
 //Returns val if b==1 and 0 else
-vector<uint32_t> BooleanCircuit::PutELM0Gate(vector<uint32_t> val, uint32_t b) {
+vector<uint32_t> BooleanCircuit::PutELM0Gate(const vector<uint32_t>& val, uint32_t b) {
 	vector<uint32_t> out(val.size());
 	for (uint32_t i = 0; i < val.size(); i++) {
 		out[i] = PutANDGate(val[i], b);
@@ -2369,154 +2465,391 @@ void BooleanCircuit::PutMaxIdxGate(vector<vector<uint32_t> > vals, vector<vector
 
 
 
-vector<uint32_t> BooleanCircuit::PutFPGate(const string func, vector<uint32_t> inputs, uint8_t bitsize, uint32_t nvals){
-	string fn = "circ/fp_";
-	char bs[3];
-	fn += func;
-	fn += "_";
-	cout << "bs = " << (uint32_t) bitsize << endl;
-	sprintf(bs, "%d", bitsize);
-	fn += bs;
-	fn += ".aby";
-	cout << "opening " << fn.c_str() << endl;
-	return PutGateFromFile(fn.c_str(), inputs, nvals);
-}
-
+#define CIRCUIT_FILE_NO_WIRE ((uint32_t) -1)
 
-vector<uint32_t> BooleanCircuit::PutFPGate(const string func, vector<uint32_t> ina, vector<uint32_t> inb, uint8_t bitsize, uint32_t nvals){
-	ina.insert(ina.end(), inb.begin(), inb.end());
-	return PutFPGate(func, ina, bitsize, nvals);
+//Constant with a one in each of the nvals parallel values, as expected by the Yao sharings
+static inline UGATE_T CircuitFileOnes(uint32_t nvals) {
+	return nvals >= GATE_T_BITS ? ~((UGATE_T) 0) : (((UGATE_T) 1) << nvals) - 1;
 }
 
+//Parse the next decimal number on the current line, returns FALSE at the end of the line
+static inline BOOL ParseCircuitFileNumber(const char*& ptr, uint32_t& val) {
+	while (*ptr == ' ' || *ptr == '\t' || *ptr == '\r')
+		ptr++;
+	if (*ptr < '0' || *ptr > '9')
+		return FALSE;
+	val = 0;
+	while (*ptr >= '0' && *ptr <= '9')
+		val = val * 10 + (*ptr++ - '0');
+	return TRUE;
+}
 
-vector<uint32_t> BooleanCircuit::PutGateFromFile(const string filename, vector<uint32_t> inputs, uint32_t nvals){
-	string line;
-	vector<uint32_t> tokens, outputs;
-	map<uint32_t, uint32_t> wires;
+//Parse all numbers of the current line and move to the next line
+static void ParseCircuitFileLine(const char*& ptr, vector<uint32_t>& vals) {
+	uint32_t val;
+	vals.clear();
+	while (ParseCircuitFileNumber(ptr, val))
+		vals.push_back(val);
+	while (*ptr != '\n' && *ptr != '\0')
+		ptr++;
+	if (*ptr == '\n')
+		ptr++;
+}
 
-	ifstream myfile;
+//Skip whitespace including line breaks
+static inline void SkipCircuitFileSpace(const char*& ptr) {
+	while (*ptr == ' ' || *ptr == '\t' || *ptr == '\r' || *ptr == '\n')
+		ptr++;
+}
 
-	//cout << "opening " << filename <<  endl;
-	myfile.open(filename.c_str());
+//Read a whole circuit file into a null-terminated buffer
+static BOOL ReadCircuitFile(const string& filename, vector<char>& buf) {
+	ifstream file(filename.c_str(), ios::in | ios::binary | ios::ate);
+	if (!file.is_open()) {
+		cerr << "Error: Unable to open circuit file " << filename << endl;
+		return FALSE;
+	}
+	buf.resize((uint64_t) file.tellg() + 1);
+	file.seekg(0, ios::beg);
+	file.read(buf.data(), buf.size() - 1);
+	buf[buf.size() - 1] = '\0';
+	return TRUE;
+}
 
-	uint32_t file_input_size = 0;
+aby_file_circuit* BooleanCircuit::GetParsedFile(const string& filename) {
+	struct stat filestat;
+	if (stat(filename.c_str(), &filestat) != 0) {
+		cerr << "Error: Unable to open circuit file " << filename << endl;
+		return NULL;
+	}
 
-	if (myfile.is_open()) {
-		while (getline(myfile, line)) {
+	map<string, aby_file_circuit>::iterator it = m_mParsedFiles.find(filename);
+	if (it != m_mParsedFiles.end() && it->second.mtime == filestat.st_mtime && it->second.filesize == filestat.st_size)
+		return &(it->second);
 
-			if (line != "") {
+	aby_file_circuit& circ = m_mParsedFiles[filename];
+	circ.mtime = filestat.st_mtime;
+	circ.filesize = filestat.st_size;
+	if (!ParseABYFile(filename, &circ)) {
+		m_mParsedFiles.erase(filename);
+		return NULL;
+	}
+	return &circ;
+}
 
-				tokenize_verilog(line, tokens);
+BOOL BooleanCircuit::ParseABYFile(const string& filename, aby_file_circuit* circ) {
+	vector<char> buf;
+	vector<uint32_t> tokens;
+	//maps the wire IDs of the file to the entry that defined them last
+	vector<uint32_t> filewires;
+	uint32_t nargs;
+	char type;
+
+	if (!ReadCircuitFile(filename, buf))
+		return FALSE;
+
+	circ->ninputs = 0;
+	circ->types.clear();
+	circ->args.clear();
+	circ->outputs.clear();
+
+	const char* ptr = buf.data();
+	for (uint32_t line = 1; *ptr != '\0'; line++) {
+		type = *ptr;
+		if (type == '\n' || type == '\r') {
+			ParseCircuitFileLine(ptr, tokens);
+			continue;
+		}
+		ptr++;
+		ParseCircuitFileLine(ptr, tokens);
 
-				switch (line.at(0)) {
+		switch (type) {
+		case 'A':
+		case 'X':
+			nargs = 2;
+			break;
+		case 'M':
+			nargs = 3;
+			break;
+		case 'I':
+			nargs = 1;
+			break;
+		case '0':
+		case '1':
+			nargs = 0;
+			break;
+		case 'S':
+		case 'C':
+		case 'O':
+			nargs = tokens.size();
+			break;
+		default:
+			continue;
+		}
 
-				case 'S': // Server input wire ids
-					assert(inputs.size() >= tokens.size() + file_input_size);
+		BOOL valid = (type == 'S' || type == 'C' || type == 'O') || tokens.size() == nargs + 1;
+		uint32_t nuses = (type == 'S' || type == 'C') ? 0 : nargs;
+		for (uint32_t i = 0; i < nuses && valid; i++) {
+			valid = tokens[i] < filewires.size() && filewires[tokens[i]] != CIRCUIT_FILE_NO_WIRE;
+		}
+		if (!valid) {
+			cerr << "Error: line " << line << " of " << filename << " uses an undefined wire or is malformed" << endl;
+			return FALSE;
+		}
 
-					for (uint32_t i = 0; i < tokens.size(); i++) {
-						wires[tokens[i]] = inputs[i + file_input_size];
-					}
-					file_input_size += tokens.size();
-					break;
+		if (type == 'O') {
+			for (uint32_t i = 0; i < tokens.size(); i++)
+				circ->outputs.push_back(filewires[tokens[i]]);
+			continue;
+		}
 
-				case 'C': // Client input wire ids
-					assert(inputs.size() >= tokens.size() + file_input_size);
+		//inputs define one wire per token, gates define the wire of their last token
+		for (uint32_t i = 0; i < nuses; i++)
+			circ->args.push_back(filewires[tokens[i]]);
+		for (uint32_t i = nuses; i < tokens.size(); i++) {
+			if (tokens[i] >= filewires.size())
+				filewires.resize(tokens[i] + 1, CIRCUIT_FILE_NO_WIRE);
+			filewires[tokens[i]] = circ->types.size();
+			circ->types.push_back(type);
+			if (type == 'S' || type == 'C')
+				circ->ninputs++;
+		}
+	}
+	return TRUE;
+}
 
-					for (uint32_t i = 0; i < tokens.size(); i++) {
-						wires[tokens[i]] = inputs[i + file_input_size];
-					}
-					file_input_size += tokens.size();
-					break;
+vector<uint32_t> BooleanCircuit::PutFPGate(const string func, const vector<uint32_t>& inputs, uint8_t bitsize, uint32_t nvals){
+	char fn[64];
+	snprintf(fn, sizeof(fn), "circ/fp_%s_%u.aby", func.c_str(), (uint32_t) bitsize);
+	return PutGateFromFile(fn, inputs, nvals);
+}
 
-				case '0': // Constant Zero Gate
-					wires[tokens[0]] = PutConstantGate(0, nvals);
-					break;
 
-				case '1': // Constant Zero Gate
-					wires[tokens[0]] = PutConstantGate((1 << nvals) - 1, nvals);
-					break;
+vector<uint32_t> BooleanCircuit::PutFPGate(const string func, const vector<uint32_t>& ina, const vector<uint32_t>& inb, uint8_t bitsize, uint32_t nvals){
+	vector<uint32_t> inputs;
+	inputs.reserve(ina.size() + inb.size());
+	inputs.insert(inputs.end(), ina.begin(), ina.end());
+	inputs.insert(inputs.end(), inb.begin(), inb.end());
+	return PutFPGate(func, inputs, bitsize, nvals);
+}
 
-				case 'A': // AND Gate
-					wires[tokens[2]] = PutANDGate(wires[tokens[0]], wires[tokens[1]]);
-					break;
 
-				case 'X': // XOR Gate
-					wires[tokens[2]] = PutXORGate(wires[tokens[0]], wires[tokens[1]]);
-					break;
+vector<uint32_t> BooleanCircuit::PutGateFromFile(const string filename, const vector<uint32_t>& inputs, uint32_t nvals){
+	vector<uint32_t> outputs;
+	uint32_t zerogate = CIRCUIT_FILE_NO_WIRE, onegate = CIRCUIT_FILE_NO_WIRE;
 
-				case 'M': // MUX Gate
-					wires[tokens[3]] = PutVecANDMUXGate(wires[tokens[1]], wires[tokens[0]], wires[tokens[2]]);
-					break;
+	aby_file_circuit* circ = GetParsedFile(filename);
+	if (circ == NULL)
+		return outputs;
 
-				case 'I': // INV Gate
-					wires[tokens[1]] = PutINVGate(tokens[0]);
-					break;
+	if (inputs.size() < circ->ninputs) {
+		cerr << "Error: " << filename << " expects " << circ->ninputs << " input wires but " << inputs.size() << " were given" << endl;
+		return outputs;
+	}
+	if (inputs.size() > circ->ninputs) {
+		cerr << "Warning: Input sizes didn't match! Less inputs read from circuit file than passed to it!" << endl;
+	}
 
-				case 'O': // List of output wires
-					for (uint32_t i = 0; i < tokens.size(); i++) {
-						outputs.push_back(wires[tokens[i]]);
-					}
-					cout << endl;
-					break;
-				}
-			}
-		}
-		myfile.close();
+	vector<uint32_t> wires(circ->types.size());
+	const uint32_t* args = circ->args.data();
+	uint32_t nextinput = 0;
 
-		if (file_input_size < inputs.size()) {
-			cerr << "Warning: Input sizes didn't match! Less inputs read from circuit file than passed to it!" << endl;
+	for (uint32_t i = 0; i < circ->types.size(); i++) {
+		switch (circ->types[i]) {
+		case 'S': // Server input wire
+		case 'C': // Client input wire
+			wires[i] = inputs[nextinput++];
+			break;
+		case '0': // Constant Zero Gate
+			if (zerogate == CIRCUIT_FILE_NO_WIRE)
+				zerogate = PutConstantGate(0, nvals);
+			wires[i] = zerogate;
+			break;
+		case '1': // Constant One Gate
+			if (onegate == CIRCUIT_FILE_NO_WIRE)
+				onegate = PutConstantGate(CircuitFileOnes(nvals), nvals);
+			wires[i] = onegate;
+			break;
+		case 'A': // AND Gate
+			wires[i] = PutANDGate(wires[args[0]], wires[args[1]]);
+			args += 2;
+			break;
+		case 'X': // XOR Gate
+			wires[i] = PutXORGate(wires[args[0]], wires[args[1]]);
+			args += 2;
+			break;
+		case 'M': // MUX Gate
+			wires[i] = PutVecANDMUXGate(wires[args[1]], wires[args[0]], wires[args[2]]);
+			args += 3;
+			break;
+		case 'I': // INV Gate
+			wires[i] = PutINVGate(wires[args[0]]);
+			args += 1;
+			break;
 		}
 	}
 
-	else {
-		cerr << "Error: Unable to open circuit file " << filename << endl;
+	outputs.resize(circ->outputs.size());
+	for (uint32_t i = 0; i < outputs.size(); i++) {
+		outputs[i] = wires[circ->outputs[i]];
 	}
 
-	wires.clear();
-	tokens.clear();
-
 	return outputs;
 }
 
-uint32_t BooleanCircuit::GetInputLengthFromFile(const string filename){
-	string line;
-	vector<uint32_t> tokens;
-	ifstream myfile;
-
-	//cout << "opening " << filename <<  endl;
-	myfile.open(filename.c_str());
+vector<vector<uint32_t> > BooleanCircuit::PutSIMDGateFromFile(const string& filename, const vector<vector<uint32_t> >& inputs) {
+	uint32_t ninstances = inputs.size();
+	vector<vector<uint32_t> > outputs(ninstances);
+	vector<uint32_t> instvals(ninstances), combined, tmp(ninstances);
+	uint32_t nvals = 0;
 
-	uint32_t file_input_size = 0;
+	if (ninstances == 0)
+		return outputs;
 
-	if (myfile.is_open()) {
-		while (getline(myfile, line)) {
+	for (uint32_t i = 0; i < ninstances; i++) {
+		assert(inputs[i].size() == inputs[0].size());
+		instvals[i] = inputs[i].size() > 0 ? GetNumVals(inputs[i][0]) : 1;
+		nvals += instvals[i];
+	}
 
-			if (line != "") {
+	//combine the i-th input wire of all instances into one SIMD wire
+	combined.resize(inputs[0].size());
+	for (uint32_t j = 0; j < combined.size(); j++) {
+		for (uint32_t i = 0; i < ninstances; i++) {
+			assert(GetNumVals(inputs[i][j]) == instvals[i]);
+			tmp[i] = inputs[i][j];
+		}
+		combined[j] = PutCombinerGate(tmp);
+	}
 
-				tokenize_verilog(line, tokens);
+	vector<uint32_t> simdout = PutGateFromFile(filename, combined, nvals);
 
-				switch (line.at(0)) {
+	for (uint32_t i = 0; i < ninstances; i++)
+		outputs[i].resize(simdout.size());
+	for (uint32_t j = 0; j < simdout.size(); j++) {
+		tmp = m_cCircuit->PutSplitterGate(simdout[j], instvals);
+		for (uint32_t i = 0; i < ninstances; i++) {
+			UpdateLocalQueue(tmp[i]);
+			outputs[i][j] = tmp[i];
+		}
+	}
 
-				case 'S': // Server input wire ids
-					file_input_size += tokens.size();
-					break;
+	return outputs;
+}
 
-				case 'C': // Client input wire ids
-					file_input_size += tokens.size();
-					break;
-				}
-			}
-		}
-		myfile.close();
+uint32_t BooleanCircuit::GetInputLengthFromFile(const string filename){
+	aby_file_circuit* circ = GetParsedFile(filename);
+	return circ == NULL ? 0 : circ->ninputs;
+}
+
+vector<uint32_t> BooleanCircuit::PutGateFromBristolFile(const string filename, const vector<uint32_t>& inputs, uint32_t nvals) {
+	vector<uint32_t> outputs, header, ids;
+	vector<char> buf;
+	uint32_t ngates, nwires, nin, nout, typelen;
+	uint64_t ninwires = 0, noutwires = 0;	//sums of 32-bit header values, which must not wrap around
+	uint32_t zerogate = CIRCUIT_FILE_NO_WIRE, onegate = CIRCUIT_FILE_NO_WIRE;
+	const char *ptr, *type;
+
+	//read the whole file at once and parse it in a single pass
+	if (!ReadCircuitFile(filename, buf))
+		return outputs;
+	ptr = buf.data();
+
+	ParseCircuitFileLine(ptr, header);
+	if (header.size() != 2) {
+		cerr << "Error: " << filename << " does not start with the number of gates and wires" << endl;
+		return outputs;
+	}
+	ngates = header[0];
+	nwires = header[1];
+
+	//Bristol Fashion lists the bits of each input and output value on two lines, the old format has a single line
+	//with the bits of both inputs and of the output followed by an empty line
+	ParseCircuitFileLine(ptr, header);
+	ParseCircuitFileLine(ptr, ids);
+	if (ids.size() == 0 && header.size() == 3) {
+		ninwires = (uint64_t) header[0] + header[1];
+		noutwires = header[2];
+	} else if (header.size() > 0 && header[0] == header.size() - 1 && ids.size() > 0 && ids[0] == ids.size() - 1) {
+		for (uint32_t i = 1; i < header.size(); i++)
+			ninwires += header[i];
+		for (uint32_t i = 1; i < ids.size(); i++)
+			noutwires += ids[i];
+	} else {
+		cerr << "Error: " << filename << " has no valid Bristol header" << endl;
+		return outputs;
 	}
 
-	else {
-		cerr << "Error: Unable to open circuit file " << filename << endl;
+	if (inputs.size() < ninwires || ninwires > nwires || noutwires > nwires - ninwires) {
+		cerr << "Error: " << filename << " expects " << ninwires << " input wires but " << inputs.size() << " were given" << endl;
+		return outputs;
+	}
+	if (inputs.size() > ninwires) {
+		cerr << "Warning: Input sizes didn't match! Less inputs read from circuit file than passed to it!" << endl;
 	}
 
-	tokens.clear();
+	//flat map from the wires of the file to the gates of this circuit
+	vector<uint32_t> wires(nwires, CIRCUIT_FILE_NO_WIRE);
+	for (uint32_t i = 0; i < ninwires; i++)
+		wires[i] = inputs[i];
+
+	for (uint32_t g = 0; g < ngates; g++) {
+		SkipCircuitFileSpace(ptr);
+		//checked such that nin + nout cannot wrap around
+		BOOL valid = ParseCircuitFileNumber(ptr, nin) && ParseCircuitFileNumber(ptr, nout) && nin <= nwires && nout <= nwires - nin;
+		if (valid) {
+			ids.resize(nin + nout);
+			for (uint32_t i = 0; i < nin + nout && valid; i++)
+				valid = ParseCircuitFileNumber(ptr, ids[i]) && ids[i] < nwires;
+		}
+		while (*ptr == ' ' || *ptr == '\t')
+			ptr++;
+		type = ptr;
+		while ((*ptr >= 'A' && *ptr <= 'Z') || (*ptr >= 'a' && *ptr <= 'z'))
+			ptr++;
+		typelen = ptr - type;
+
+		//all input wires, except for the constant of an EQ gate, have to be assigned before
+		BOOL isconst = (typelen == 2 && strncmp(type, "EQ", 2) == 0);
+		for (uint32_t i = isconst; i < nin && valid; i++)
+			valid = (wires[ids[i]] != CIRCUIT_FILE_NO_WIRE);
+
+		if (valid && typelen == 3 && strncmp(type, "XOR", 3) == 0 && nin == 2 && nout == 1) {
+			wires[ids[2]] = PutXORGate(wires[ids[0]], wires[ids[1]]);
+		} else if (valid && typelen == 3 && strncmp(type, "AND", 3) == 0 && nin == 2 && nout == 1) {
+			wires[ids[2]] = PutANDGate(wires[ids[0]], wires[ids[1]]);
+		} else if (valid && ((typelen == 3 && strncmp(type, "INV", 3) == 0) || (typelen == 3 && strncmp(type, "NOT", 3) == 0))
+				&& nin == 1 && nout == 1) {
+			wires[ids[1]] = PutINVGate(wires[ids[0]]);
+		} else if (valid && isconst && nin == 1 && nout == 1 && ids[0] <= 1) {
+			//constants are shared among all EQ gates of the file
+			uint32_t& constgate = ids[0] ? onegate : zerogate;
+			if (constgate == CIRCUIT_FILE_NO_WIRE)
+				constgate = PutConstantGate(ids[0] ? CircuitFileOnes(nvals) : 0, nvals);
+			wires[ids[1]] = constgate;
+		} else if (valid && typelen == 3 && strncmp(type, "EQW", 3) == 0 && nin == 1 && nout == 1) {
+			wires[ids[1]] = wires[ids[0]];
+		} else if (valid && typelen == 4 && strncmp(type, "MAND", 4) == 0 && (uint64_t) nin == 2 * (uint64_t) nout) {
+			for (uint32_t i = 0; i < nout; i++)
+				wires[ids[nin + i]] = PutANDGate(wires[ids[i]], wires[ids[nout + i]]);
+		} else {
+			cerr << "Error: gate " << g << " (" << string(type, typelen) << ") of " << filename << " is invalid or unsupported" << endl;
+			outputs.clear();
+			return outputs;
+		}
+	}
 
-	return file_input_size;
+	//the outputs are the last wires of the circuit
+	outputs.resize(noutwires);
+	for (uint32_t i = 0; i < noutwires; i++) {
+		outputs[i] = wires[nwires - noutwires + i];
+		if (outputs[i] == CIRCUIT_FILE_NO_WIRE) {
+			cerr << "Error: output wire " << nwires - noutwires + i << " of " << filename << " is not assigned" << endl;
+			outputs.clear();
+			break;
+		}
+	}
+	return outputs;
 }
 
 uint32_t BooleanCircuit::PutIdxGate(uint32_t r, uint32_t maxidx) {
@@ -2589,6 +2922,9 @@ void BooleanCircuit::PutMultiMUXGate(share** Sa, share** Sb, share* sel, uint32_
 }
 
 void BooleanCircuit::Reset() {
+	if (m_cCircuit->IsCompiled())
+		return;
+
 	Circuit::Reset();
 
 	free(m_vANDs);
@@ -2616,11 +2952,76 @@ void BooleanCircuit::Reset() {
 	m_vTTlens[0].numgates = 0;*/
 }
 
-void BooleanCircuit::PadWithLeadingZeros(vector<uint32_t> &a, vector<uint32_t> &b) {
-	uint32_t maxlen = max(a.size(), b.size());
-	if(a.size() != b.size()) {
-		uint32_t zerogate = PutConstantGate(0, m_pGates[a[0]].nvals);
-		a.resize(maxlen, zerogate);
-		b.resize(maxlen, zerogate);
+void BooleanCircuit::WriteState(CircuitFile& file) {
+	Circuit::WriteState(file);
+
+	uint32_t counters[] = { m_nB2YGates, m_nA2YGates, m_nYSwitchGates, m_nNumXORVals, m_nNumXORGates };
+	file.Put(counters, sizeof(counters));
+
+	file.Put<uint32_t>(m_nNumANDSizes);
+	file.Put(m_vANDs, m_nNumANDSizes * sizeof(non_lin_vec_ctx));
+
+	file.Put<uint64_t>(m_vTTlens.size());
+	for (uint32_t i = 0; i < m_vTTlens.size(); i++) {
+		file.Put<uint64_t>(m_vTTlens[i].size());
+		for (uint32_t j = 0; j < m_vTTlens[i].size(); j++) {
+			file.Put<uint64_t>(m_vTTlens[i][j].size());
+			file.Put(m_vTTlens[i][j].data(), m_vTTlens[i][j].size() * sizeof(tt_lens_ctx));
+		}
 	}
 }
+
+BOOL BooleanCircuit::ReadState(CircuitFile& file) {
+	uint32_t numandsizes;
+	uint64_t ndepths, ninputs, noutbits;
+
+	if (!Circuit::ReadState(file))
+		return FALSE;
+
+	const uint32_t* counters = (const uint32_t*) file.Get(5 * sizeof(uint32_t));
+	if (counters == NULL || !file.Get<uint32_t>(&numandsizes) || numandsizes == 0)
+		return FALSE;
+	m_nB2YGates = counters[0];
+	m_nA2YGates = counters[1];
+	m_nYSwitchGates = counters[2];
+	m_nNumXORVals = counters[3];
+	m_nNumXORGates = counters[4];
+
+	const non_lin_vec_ctx* ands = (const non_lin_vec_ctx*) file.Get((uint64_t) numandsizes * sizeof(non_lin_vec_ctx));
+	if (ands == NULL)
+		return FALSE;
+	free(m_vANDs);
+	m_nNumANDSizes = numandsizes;
+	m_vANDs = (non_lin_vec_ctx*) malloc(sizeof(non_lin_vec_ctx) * m_nNumANDSizes);
+	memcpy(m_vANDs, ands, sizeof(non_lin_vec_ctx) * m_nNumANDSizes);
+
+	if (!file.GetSize(&ndepths, sizeof(uint64_t)))
+		return FALSE;
+	m_vTTlens.resize(ndepths);
+	for (uint32_t i = 0; i < ndepths; i++) {
+		if (!file.GetSize(&ninputs, sizeof(uint64_t)))
+			return FALSE;
+		m_vTTlens[i].resize(ninputs);
+		for (uint32_t j = 0; j < ninputs; j++) {
+			const tt_lens_ctx* lens;
+			if (!file.GetSize(&noutbits, sizeof(tt_lens_ctx)) || (lens = (const tt_lens_ctx*) file.Get(noutbits * sizeof(tt_lens_ctx))) == NULL)
+				return FALSE;
+			m_vTTlens[i][j].assign(lens, lens + noutbits);
+		}
+	}
+	return TRUE;
+}
+
+BOOL BooleanCircuit::PadWithLeadingZeros(const vector<uint32_t> &a, const vector<uint32_t> &b, vector<uint32_t> &apad, vector<uint32_t> &bpad) {
+	if(a.size() == b.size())
+		return FALSE;
+	uint32_t maxlen = max(a.size(), b.size());
+	uint32_t zerogate = PutConstantGate(0, m_pGates[a[0]].nvals);
+	apad.reserve(maxlen);
+	apad.assign(a.begin(), a.end());
+	apad.resize(maxlen, zerogate);
+	bpad.reserve(maxlen);
+	bpad.assign(b.begin(), b.end());
+	bpad.resize(maxlen, zerogate);
+	return TRUE;
+}
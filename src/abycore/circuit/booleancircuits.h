@@ -26,6 +26,20 @@
 #include <map>
 #include <fstream>
 #include "../util/parse_options.h"
+#include <sys/stat.h>
+
+/**
+ Gates of a parsed .aby circuit file. Each input and gate of the file defines a new wire, such that the wire IDs of the
+ file are renumbered to the index of the defining entry and the gates can be instantiated with a flat wire vector.
+ */
+struct aby_file_circuit {
+	time_t mtime;				// modification time and size of the file when it was parsed
+	off_t filesize;
+	uint32_t ninputs;
+	vector<char> types;			// 'S' and 'C' for inputs, '0' and '1' for constants, 'A', 'X', 'M', and 'I' for gates
+	vector<uint32_t> args;		// input wires of all gates in the order of the gates
+	vector<uint32_t> outputs;
+};
 
 /** BooleanCircuit class. */
 class BooleanCircuit: public Circuit {
@@ -43,20 +57,22 @@ public:
 	void Init();
 	void Cleanup();
 	void Reset();
+	void WriteState(CircuitFile& file);
+	BOOL ReadState(CircuitFile& file);
 
 	uint32_t PutANDGate(uint32_t left, uint32_t right);
-	vector<uint32_t> PutANDGate(vector<uint32_t> inleft, vector<uint32_t> inright);
+	vector<uint32_t> PutANDGate(const vector<uint32_t>& inleft, const vector<uint32_t>& inright);
 	share* PutANDGate(share* ina, share* inb);
 
 	uint32_t PutVectorANDGate(uint32_t choiceinput, uint32_t vectorinput);
 
 	uint32_t PutXORGate(uint32_t left, uint32_t right);
-	vector<uint32_t> PutXORGate(vector<uint32_t> inleft, vector<uint32_t> inright);
+	vector<uint32_t> PutXORGate(const vector<uint32_t>& inleft, const vector<uint32_t>& inright);
 	share* PutXORGate(share* ina, share* inb);
 
 	uint32_t PutORGate(uint32_t a, uint32_t b);
 	share* PutORGate(share* a, share* b);
-	vector<uint32_t> PutORGate(vector<uint32_t> a, vector<uint32_t> b);
+	vector<uint32_t> PutORGate(const vector<uint32_t>& a, const vector<uint32_t>& b);
 
 	uint32_t PutINGate(e_role src);
 	template<class T> uint32_t PutINGate(T val);
@@ -198,15 +214,30 @@ public:
 		return InternalPutSharedINGate<uint8_t>(nvals, val, bitlen);
 	};
 
+	template<class T> void InternalSetINGateValues(share* in, T* val);
+	/* Unfortunately, a template function cannot be used due to virtual. Call InternalSetINGateValues*/
+	void SetINGateValues(share* in, uint64_t* val) {
+		InternalSetINGateValues<uint64_t>(in, val);
+	};
+	void SetINGateValues(share* in, uint32_t* val) {
+		InternalSetINGateValues<uint32_t>(in, val);
+	};
+	void SetINGateValues(share* in, uint16_t* val) {
+		InternalSetINGateValues<uint16_t>(in, val);
+	};
+	void SetINGateValues(share* in, uint8_t* val) {
+		InternalSetINGateValues<uint8_t>(in, val);
+	};
+
 	//Shared input for Yao garbled circuits
 	uint32_t PutYaoSharedSIMDINGate(uint32_t nvals, yao_fields keys);
 	share* PutYaoSharedSIMDINGate(uint32_t nvals, yao_fields* keys, uint32_t bitlen);
 
 	uint32_t PutOUTGate(uint32_t parent, e_role dst);
-	vector<uint32_t> PutOUTGate(vector<uint32_t> parents, e_role dst);
+	vector<uint32_t> PutOUTGate(const vector<uint32_t>& parents, e_role dst);
 	share* PutOUTGate(share* parent, e_role dst);
 
-	vector<uint32_t> PutSharedOUTGate(vector<uint32_t> parents);
+	vector<uint32_t> PutSharedOUTGate(const vector<uint32_t>& parents);
 	share* PutSharedOUTGate(share* parent);
 
 	share* PutCONSGate(UGATE_T val, uint32_t bitlen);
@@ -258,56 +289,56 @@ public:
 	share* PutEQGate(share* ina, share* inb);
 	share* PutMUXGate(share* ina, share* inb, share* sel);
 
-	vector<uint32_t> PutMulGate(vector<uint32_t> a, vector<uint32_t> b, uint32_t resbitlen, bool depth_optimized = false, bool vector_ands = false);
+	vector<uint32_t> PutMulGate(const vector<uint32_t>& a, const vector<uint32_t>& b, uint32_t resbitlen, bool depth_optimized = false, bool vector_ands = false);
 
 
-	vector<uint32_t> PutAddGate(vector<uint32_t> left, vector<uint32_t> right, BOOL bCarry = FALSE);
+	vector<uint32_t> PutAddGate(const vector<uint32_t>& left, const vector<uint32_t>& right, BOOL bCarry = FALSE);
 	share* PutADDGate(share* ina, share* inb);
 
-	vector<uint32_t> PutSizeOptimizedAddGate(vector<uint32_t> left, vector<uint32_t> right, BOOL bCarry = FALSE);
-	vector<uint32_t> PutDepthOptimizedAddGate(vector<uint32_t> lefta, vector<uint32_t> right, BOOL bCARRY = FALSE, bool vector_ands = false);
-	vector<uint32_t> PutLUTAddGate(vector<uint32_t> lefta, vector<uint32_t> right, BOOL bCARRY = FALSE);
+	vector<uint32_t> PutSizeOptimizedAddGate(const vector<uint32_t>& left, const vector<uint32_t>& right, BOOL bCarry = FALSE);
+	vector<uint32_t> PutDepthOptimizedAddGate(const vector<uint32_t>& lefta, const vector<uint32_t>& right, BOOL bCARRY = FALSE, bool vector_ands = false);
+	vector<uint32_t> PutLUTAddGate(const vector<uint32_t>& lefta, const vector<uint32_t>& right, BOOL bCARRY = FALSE);
 
-	vector<vector<uint32_t> > PutCarrySaveGate(vector<uint32_t> a, vector<uint32_t> b, vector<uint32_t> c, uint32_t inbitlen, bool bCarry = FALSE);
+	vector<vector<uint32_t> > PutCarrySaveGate(const vector<uint32_t>& a, const vector<uint32_t>& b, const vector<uint32_t>& c, uint32_t inbitlen, bool bCarry = FALSE);
 	vector<vector<uint32_t> > PutCSNNetwork(vector<vector<uint32_t> > ins);
 
-	vector<uint32_t> PutSUBGate(vector<uint32_t> a, vector<uint32_t> b, uint32_t max_bitlen);
+	vector<uint32_t> PutSUBGate(const vector<uint32_t>& a, const vector<uint32_t>& b, uint32_t max_bitlen);
 	share* PutSUBGate(share* ina, share* inb);
 	vector<uint32_t> PutWideAddGate(vector<vector<uint32_t> > ins);
-	uint32_t PutGTGate(vector<uint32_t> a, vector<uint32_t> b);
-	uint32_t PutSizeOptimizedGTGate(vector<uint32_t> a, vector<uint32_t> b);
-	uint32_t PutDepthOptimizedGTGate(vector<uint32_t> a, vector<uint32_t> b);
-	uint32_t PutLUTGTGate(vector<uint32_t> a, vector<uint32_t> b);
+	uint32_t PutGTGate(const vector<uint32_t>& a, const vector<uint32_t>& b);
+	uint32_t PutSizeOptimizedGTGate(const vector<uint32_t>& a, const vector<uint32_t>& b);
+	uint32_t PutDepthOptimizedGTGate(const vector<uint32_t>& a, const vector<uint32_t>& b);
+	uint32_t PutLUTGTGate(const vector<uint32_t>& a, const vector<uint32_t>& b);
 
-	uint32_t PutEQGate(vector<uint32_t> a, vector<uint32_t> b);
+	uint32_t PutEQGate(const vector<uint32_t>& a, const vector<uint32_t>& b);
 
 
 	share* PutANDVecGate(share* ina, share* inb);
-	vector<uint32_t> PutMUXGate(vector<uint32_t> a, vector<uint32_t> b, uint32_t s, BOOL vecand = true);
+	vector<uint32_t> PutMUXGate(const vector<uint32_t>& a, const vector<uint32_t>& b, uint32_t s, BOOL vecand = true);
 
 	share* PutVecANDMUXGate(share* a, share* b, share* s);
-	vector<uint32_t> PutVecANDMUXGate(vector<uint32_t> a, vector<uint32_t> b, vector<uint32_t> s);
+	vector<uint32_t> PutVecANDMUXGate(const vector<uint32_t>& ina, const vector<uint32_t>& inb, const vector<uint32_t>& s);
 	uint32_t PutVecANDMUXGate(uint32_t a, uint32_t b, uint32_t s);
-	uint32_t PutWideGate(e_gatetype type, vector<uint32_t> ins);
-	uint32_t PutLUTWideANDGate(vector<uint32_t> in);
+	uint32_t PutWideGate(e_gatetype type, const vector<uint32_t>& ins);
+	uint32_t PutLUTWideANDGate(const vector<uint32_t>& in);
 	share** PutCondSwapGate(share* a, share* b, share* s, BOOL vectorized);
-	vector<vector<uint32_t> > PutCondSwapGate(vector<uint32_t> a, vector<uint32_t> b, uint32_t s, BOOL vectorized);
-	vector<uint32_t> PutELM0Gate(vector<uint32_t> val, uint32_t b);
+	vector<vector<uint32_t> > PutCondSwapGate(const vector<uint32_t>& a, const vector<uint32_t>& b, uint32_t s, BOOL vectorized);
+	vector<uint32_t> PutELM0Gate(const vector<uint32_t>& val, uint32_t b);
 
-	vector<uint32_t> LShift(vector<uint32_t> val, uint32_t pos, uint32_t nvals = 1);
+	vector<uint32_t> LShift(const vector<uint32_t>& val, uint32_t pos, uint32_t nvals = 1);
 
 	uint32_t PutIdxGate(uint32_t r, uint32_t maxidx);
 
 	share* PutStructurizedCombinerGate(share* input, uint32_t pos_start, uint32_t pos_incr, uint32_t nvals);
-	uint32_t PutStructurizedCombinerGate(vector<uint32_t> input, uint32_t pos_start, uint32_t pos_incr, uint32_t nvals);
+	uint32_t PutStructurizedCombinerGate(const vector<uint32_t>& input, uint32_t pos_start, uint32_t pos_incr, uint32_t nvals);
 
-	uint32_t PutCallbackGate(vector<uint32_t> in, uint32_t rounds, void (*callback)(GATE*, void*), void* infos, uint32_t nvals);
+	uint32_t PutCallbackGate(const vector<uint32_t>& in, uint32_t rounds, void (*callback)(GATE*, void*), void* infos, uint32_t nvals);
 	share* PutCallbackGate(share* in, uint32_t rounds, void (*callback)(GATE*, void*), void* infos, uint32_t nvals);
 
-	uint32_t PutTruthTableGate(vector<uint32_t> in, uint32_t out_bits, uint64_t* ttable);
+	uint32_t PutTruthTableGate(const vector<uint32_t>& in, uint32_t out_bits, uint64_t* ttable);
 	share* PutTruthTableGate(share* in, uint64_t* ttable);
 
-	vector<uint32_t> PutTruthTableMultiOutputGate(vector<uint32_t> in, uint32_t out_bits, uint64_t* ttable);
+	vector<uint32_t> PutTruthTableMultiOutputGate(const vector<uint32_t>& in, uint32_t out_bits, uint64_t* ttable);
 	share* PutTruthTableMultiOutputGate(share* in, uint32_t out_bits, uint64_t* ttable);
 
 	share* PutY2BGate(share* ina);
@@ -318,13 +349,21 @@ public:
 	uint32_t PutY2BCONVGate(uint32_t parentid);
 	uint32_t PutB2YCONVGate(uint32_t parentid);
 	uint32_t PutYSwitchRolesGate(uint32_t parentid);
-	vector<uint32_t> PutY2BCONVGate(vector<uint32_t> parentid);
-	vector<uint32_t> PutB2YCONVGate(vector<uint32_t> parentid);
-	vector<uint32_t> PutYSwitchRolesGate(vector<uint32_t> parentid);
+	vector<uint32_t> PutY2BCONVGate(const vector<uint32_t>& parentid);
+	vector<uint32_t> PutB2YCONVGate(const vector<uint32_t>& parentid);
+	vector<uint32_t> PutYSwitchRolesGate(const vector<uint32_t>& parentid);
 
 
-	vector<uint32_t> PutA2YCONVGate(vector<uint32_t> parentid);
+	vector<uint32_t> PutA2YCONVGate(const vector<uint32_t>& parentid);
 	share* PutA2YGate(share* ina);
+	/**
+	 Convert the arithmetic share ina into this Boolean circuit without garbled circuits. Both parties input the bits of
+	 their arithmetic shares locally as Boolean shares, which are added with the depth-optimized parallel-prefix adder
+	 using vector ANDs, i.e., in ceil(log2(l)) + 1 rounds.
+	 \param 	yaosharingcircuit 	if set, the conversion is done via this Yao circuit as in Circuit::PutA2BGate()
+	 */
+	share* PutA2BGate(share* ina, Circuit* yaosharingcircuit = NULL);
+	vector<uint32_t> PutA2BCONVGate(const vector<uint32_t>& parentid);
 
 	share* PutB2AGate(share* ina) {
 		cerr << "B2A not available for Boolean circuits, please use Arithmetic circuits instead" << endl;
@@ -332,7 +371,7 @@ public:
 	}
 
 	uint32_t PutINVGate(uint32_t parentid);
-	vector<uint32_t> PutINVGate(vector<uint32_t> parentid);
+	vector<uint32_t> PutINVGate(const vector<uint32_t>& parentid);
 	share* PutINVGate(share* parent);
 
 	share* PutMinGate(share** a, uint32_t nvals);
@@ -346,7 +385,7 @@ public:
 	 * \param nvals parallel instantiation
 	 * \return output wire IDs
 	 */
-	vector<uint32_t> PutFPGate(const string func, vector<uint32_t> inputs, uint8_t bitsize, uint32_t nvals = 1);
+	vector<uint32_t> PutFPGate(const string func, const vector<uint32_t>& inputs, uint8_t bitsize, uint32_t nvals = 1);
 
 	/**
 	 * \brief Floating point gate with two inputs
@@ -357,15 +396,32 @@ public:
 	 * \param nvals parallel instantiation
 	 * \return output wire IDs
 	 */
-	vector<uint32_t> PutFPGate(const string func, vector<uint32_t> ina, vector<uint32_t> inb, uint8_t bitsize, uint32_t nvals = 1);
+	vector<uint32_t> PutFPGate(const string func, const vector<uint32_t>& ina, const vector<uint32_t>& inb, uint8_t bitsize, uint32_t nvals = 1);
 
 	/**
-	 * \brief Add gate from a certain .aby file
+	 * \brief Add gate from a certain .aby file. The file is parsed once and cached until its modification time changes.
 	 * \param inputs input wire IDs
 	 * \param nvals parallel instantiation
 	 * \return output wire IDs
 	 */
-	vector<uint32_t> PutGateFromFile(const string filename, vector<uint32_t> inputs, uint32_t nvals = 1);
+	vector<uint32_t> PutGateFromFile(const string filename, const vector<uint32_t>& inputs, uint32_t nvals = 1);
+
+	/**
+	 * \brief Add a single copy of the gates of a .aby file for several instances, whose inputs are combined into SIMD
+	 * 	wires and whose outputs are split again
+	 * \param inputs input wire IDs of each instance, all wires of an instance need to have the same number of values
+	 * \return output wire IDs of each instance
+	 */
+	vector<vector<uint32_t> > PutSIMDGateFromFile(const string& filename, const vector<vector<uint32_t> >& inputs);
+
+	/**
+	 * \brief Add the gates of a circuit in the Bristol or Bristol Fashion format (XOR, AND, INV, EQ, EQW, and MAND gates)
+	 * \param filename the circuit file
+	 * \param inputs input wire IDs in the order of the input wires of the file
+	 * \param nvals parallel instantiation, has to match the number of values of the inputs
+	 * \return output wire IDs in the order of the output wires of the file, empty if the file could not be read
+	 */
+	vector<uint32_t> PutGateFromBristolFile(const string filename, const vector<uint32_t>& inputs, uint32_t nvals = 1);
 
 	/**
 	 * \brief Get the number of input bits for both parties that a given circuit file expects
@@ -391,7 +447,11 @@ private:
 
 	void UpdateTruthTableSizes(uint32_t len, uint32_t nvals, uint32_t depth, uint32_t out_bits);
 
-	void PadWithLeadingZeros(vector<uint32_t> &a, vector<uint32_t> &b);
+	/* Pads a and b to the same length. Only if their lengths differ, padded copies are written to apad and bpad and TRUE is returned. */
+	BOOL PadWithLeadingZeros(const vector<uint32_t> &a, const vector<uint32_t> &b, vector<uint32_t> &apad, vector<uint32_t> &bpad);
+
+	aby_file_circuit* GetParsedFile(const string& filename);
+	BOOL ParseABYFile(const string& filename, aby_file_circuit* circ);
 
 	non_lin_vec_ctx* m_vANDs;
 	//first dimension: circuit depth, second dimension: num-inputs, third dimension: out_bitlen
@@ -407,6 +467,8 @@ private:
 	uint32_t m_nNumXORVals;
 	uint32_t m_nNumXORGates;
 
+	map<string, aby_file_circuit> m_mParsedFiles; // cache of parsed .aby files, kept across Reset()
+
 };
 
 #endif /* __BOOLEANCIRCUITS_H_ */
@@ -49,6 +49,10 @@ void Circuit::Cleanup() {
 ;
 
 void Circuit::Reset() {
+	//a compiled circuit keeps its layers and gate counts for the next evaluation
+	if (m_cCircuit->IsCompiled())
+		return;
+
 	m_nMaxDepth = 0;
 	m_nGates = 0;
 
@@ -79,6 +83,43 @@ void Circuit::Reset() {
 	//m_vNonLinOnLayer.min_depth = 0;
 }
 
+void Circuit::WriteState(CircuitFile& file) {
+	uint32_t counters[] = { m_nMaxDepth, m_nGates, ncombgates, npermgates, nsubsetgates, nsplitgates, nstructcombgates };
+	file.Put(counters, sizeof(counters));
+
+	file.PutQueues(m_vLocalQueueOnLvl);
+	file.PutQueues(m_vInteractiveQueueOnLvl);
+	file.PutQueues(m_vInputGates);
+	file.PutQueues(m_vOutputGates);
+	file.Put(m_vInputBits.data(), m_vInputBits.size() * sizeof(uint32_t));
+	file.Put(m_vOutputBits.data(), m_vOutputBits.size() * sizeof(uint32_t));
+}
+
+BOOL Circuit::ReadState(CircuitFile& file) {
+	const uint32_t* counters = (const uint32_t*) file.Get(7 * sizeof(uint32_t));
+	if (counters == NULL)
+		return FALSE;
+	m_nMaxDepth = counters[0];
+	m_nGates = counters[1];
+	ncombgates = counters[2];
+	npermgates = counters[3];
+	nsubsetgates = counters[4];
+	nsplitgates = counters[5];
+	nstructcombgates = counters[6];
+
+	if (!file.GetQueues(m_vLocalQueueOnLvl) || !file.GetQueues(m_vInteractiveQueueOnLvl) || !file.GetQueues(m_vInputGates)
+			|| !file.GetQueues(m_vOutputGates) || m_vInputGates.size() != 2 || m_vOutputGates.size() != 2)
+		return FALSE;
+
+	const uint32_t* inbits = (const uint32_t*) file.Get(m_vInputBits.size() * sizeof(uint32_t));
+	const uint32_t* outbits = (const uint32_t*) file.Get(m_vOutputBits.size() * sizeof(uint32_t));
+	if (inbits == NULL || outbits == NULL)
+		return FALSE;
+	m_vInputBits.assign(inbits, inbits + m_vInputBits.size());
+	m_vOutputBits.assign(outbits, outbits + m_vOutputBits.size());
+	return TRUE;
+}
+
 gate_specific Circuit::GetGateSpecificOutput(uint32_t gateid) {
 	assert(m_pGates[gateid].instantiated);
 	return m_pGates[gateid].gs;
@@ -117,13 +158,13 @@ share* Circuit::PutA2BGate(share* ina, Circuit* yaosharingcircuit) {
 
 
 
-uint32_t Circuit::PutCombinerGate(vector<uint32_t> input) {
+uint32_t Circuit::PutCombinerGate(const vector<uint32_t>& input) {
 	uint32_t gateid = m_cCircuit->PutCombinerGate(input);
 	UpdateLocalQueue(gateid);
 	return gateid;
 }
 
-uint32_t Circuit::PutCombineAtPosGate(vector<uint32_t> input, uint32_t pos) {
+uint32_t Circuit::PutCombineAtPosGate(const vector<uint32_t>& input, uint32_t pos) {
 	uint32_t gateid = m_cCircuit->PutCombineAtPosGate(input, pos);
 	UpdateLocalQueue(gateid);
 	return gateid;
@@ -146,7 +187,7 @@ uint32_t Circuit::PutRepeaterGate(uint32_t input, uint32_t nvals) {
 	UpdateLocalQueue(gateid);
 	return gateid;
 }
-uint32_t Circuit::PutPermutationGate(vector<uint32_t> input, uint32_t* positions) {
+uint32_t Circuit::PutPermutationGate(const vector<uint32_t>& input, uint32_t* positions) {
 	uint32_t gateid = m_cCircuit->PutPermutationGate(input, positions);
 	UpdateLocalQueue(gateid);
 	return gateid;
@@ -374,7 +415,7 @@ static share* create_new_share(uint32_t size, Circuit* circ) {
 	}
 }
 
-static share* create_new_share(vector<uint32_t> vals, Circuit* circ) {
+static share* create_new_share(const vector<uint32_t>& vals, Circuit* circ) {
 	switch (circ->GetCircuitType()) {
 	case C_BOOLEAN:
 		return new boolshare(vals, circ);
@@ -59,6 +59,17 @@ public:
 	/** It will reset all the member objects to zero/clear them.*/
 	void Reset();
 
+	/**
+	 Append the layer queues, the input and output gates, and the gate counts of this circuit to a binary circuit file.
+	 The gates themselves are written by ABYCircuit::WriteGates().
+	 */
+	virtual void WriteState(CircuitFile& file);
+	/**
+	 Load the state that was written by WriteState() into this circuit.
+	 \return FALSE if the file is malformed
+	 */
+	virtual BOOL ReadState(CircuitFile& file);
+
 	/* organizational routines */
 
 	/**
@@ -252,6 +263,17 @@ public:
 	virtual share* PutSharedSIMDINGate(uint32_t nvals, uint16_t* val, uint32_t bitlen) = 0;
 	virtual share* PutSharedSIMDINGate(uint32_t nvals, uint8_t* val, uint32_t bitlen) = 0;
 
+	/*
+	 * Overwrite the values of an input share of this party, e.g., before a compiled circuit is evaluated again (see
+	 * ABYParty::CompileCircuit()). The values have the same format as for PutSIMDINGate() and the number of values and
+	 * the bitlength are taken from the share.
+	 */
+	/* Unfortunately, a template function cannot be used due to virtual */
+	virtual void SetINGateValues(share* in, uint64_t* val) = 0;
+	virtual void SetINGateValues(share* in, uint32_t* val) = 0;
+	virtual void SetINGateValues(share* in, uint16_t* val) = 0;
+	virtual void SetINGateValues(share* in, uint8_t* val) = 0;
+
 
 	virtual share* PutADDGate(share* ina, share* inb) = 0;
 	virtual share* PutSUBGate(share* ina, share* inb) = 0;
@@ -265,8 +287,8 @@ public:
 	virtual share* PutB2AGate(share* ina) = 0;
 	virtual share* PutB2YGate(share* ina) = 0;
 	virtual share* PutA2YGate(share* ina) = 0;
-	share* PutY2AGate(share* ina, Circuit* boolsharingcircuit);
-	share* PutA2BGate(share* ina, Circuit* yaosharingcircuit);
+	virtual share* PutY2AGate(share* ina, Circuit* boolsharingcircuit);
+	virtual share* PutA2BGate(share* ina, Circuit* yaosharingcircuit);
 	virtual share* PutANDVecGate(share* ina, share* inb) = 0;
 	virtual share* PutCallbackGate(share* in, uint32_t rounds, void (*callback)(GATE*, void*), void* infos, uint32_t nvals) = 0;
 	virtual share* PutTruthTableGate(share* in, uint64_t* ttable) = 0;
@@ -358,10 +380,10 @@ public:
 
 
 	uint32_t PutRepeaterGate(uint32_t input, uint32_t nvals);
-	uint32_t PutCombinerGate(vector<uint32_t> input);
-	uint32_t PutCombineAtPosGate(vector<uint32_t> input, uint32_t pos);
+	uint32_t PutCombinerGate(const vector<uint32_t>& input);
+	uint32_t PutCombineAtPosGate(const vector<uint32_t>& input, uint32_t pos);
 	uint32_t PutSubsetGate(uint32_t input, uint32_t* posids, uint32_t nvals_out, bool copy_posids = true);
-	uint32_t PutPermutationGate(vector<uint32_t> input, uint32_t* positions);
+	uint32_t PutPermutationGate(const vector<uint32_t>& input, uint32_t* positions);
 	vector<uint32_t> PutSplitterGate(uint32_t input);
 
 
@@ -485,7 +507,7 @@ protected:
 
 
 static share* create_new_share(uint32_t size, Circuit* circ);
-static share* create_new_share(vector<uint32_t> vals, Circuit* circ);
+static share* create_new_share(const vector<uint32_t>& vals, Circuit* circ);
 
 #include "share.h"
 
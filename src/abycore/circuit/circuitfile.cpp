@@ -0,0 +1,178 @@
+/**
+ \file 		circuitfile.cpp
+ \author	michael.zohner@ec-spride.de
+ \copyright	ABY - A Framework for Efficient Mixed-protocol Secure Two-party Computation
+			Copyright (C) 2015 Engineering Cryptographic Protocols Group, TU Darmstadt
+			This program is free software: you can redistribute it and/or modify
+			it under the terms of the GNU Affero General Public License as published
+			by the Free Software Foundation, either version 3 of the License, or
+			(at your option) any later version.
+			This program is distributed in the hope that it will be useful,
+			but WITHOUT ANY WARRANTY; without even the implied warranty of
+			MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+			GNU Affero General Public License for more details.
+			You should have received a copy of the GNU Affero General Public License
+			along with this program. If not, see <http://www.gnu.org/licenses/>.
+ \brief		Binary on-disk representation of a constructed circuit
+ */
+
+#include "circuitfile.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <iostream>
+
+CircuitFile::CircuitFile() {
+	m_pMap = NULL;
+	m_nMapBytes = 0;
+	m_pPayload = NULL;
+	m_nPayloadBytes = 0;
+	m_nReadPos = 0;
+}
+
+CircuitFile::~CircuitFile() {
+	if (m_pMap)
+		munmap(m_pMap, m_nMapBytes);
+}
+
+void CircuitFile::Put(const void* data, uint64_t nbytes) {
+	uint64_t pos = m_vWriteBuf.size();
+	m_vWriteBuf.resize(pos + PadToMultiple(nbytes, sizeof(uint64_t)), 0);
+	if (nbytes > 0)
+		memcpy(m_vWriteBuf.data() + pos, data, nbytes);
+}
+
+void CircuitFile::PutQueue(deque<uint32_t>& queue) {
+	uint64_t nentries = queue.size();
+	uint64_t pos;
+
+	Put<uint64_t>(nentries);
+	pos = m_vWriteBuf.size();
+	m_vWriteBuf.resize(pos + PadToMultiple(nentries * sizeof(uint32_t), sizeof(uint64_t)), 0);
+	for (uint64_t i = 0; i < nentries; i++) {
+		((uint32_t*) (m_vWriteBuf.data() + pos))[i] = queue[i];
+	}
+}
+
+void CircuitFile::PutQueues(vector<deque<uint32_t> >& queues) {
+	Put<uint64_t>(queues.size());
+	for (uint64_t i = 0; i < queues.size(); i++) {
+		PutQueue(queues[i]);
+	}
+}
+
+BOOL CircuitFile::Write(const char* filename) {
+	circuit_file_header header;
+	memset(&header, 0, sizeof(header));
+	header.magic = CIRCUIT_FILE_MAGIC;
+	header.version = CIRCUIT_FILE_VERSION;
+	header.headerbytes = sizeof(circuit_file_header);
+	header.payloadbytes = m_vWriteBuf.size();
+	header.checksum = Checksum(m_vWriteBuf.data(), m_vWriteBuf.size());
+
+	FILE* fp = fopen(filename, "wb");
+	if (!fp) {
+		cerr << "Could not open circuit file " << filename << " for writing" << endl;
+		return FALSE;
+	}
+	BOOL success = (fwrite(&header, sizeof(header), 1, fp) == 1);
+	success &= (fwrite(m_vWriteBuf.data(), 1, m_vWriteBuf.size(), fp) == m_vWriteBuf.size());
+	success &= (fclose(fp) == 0);
+	if (!success) {
+		cerr << "Could not write circuit file " << filename << endl;
+		remove(filename);
+	}
+	return success;
+}
+
+BOOL CircuitFile::Map(const char* filename) {
+	struct stat filestat;
+	circuit_file_header* header;
+
+	int fd = open(filename, O_RDONLY);
+	if (fd < 0) {
+		cerr << "Could not open circuit file " << filename << endl;
+		return FALSE;
+	}
+	if (fstat(fd, &filestat) != 0 || (uint64_t) filestat.st_size < sizeof(circuit_file_header)) {
+		cerr << "Circuit file " << filename << " is too short" << endl;
+		close(fd);
+		return FALSE;
+	}
+	m_nMapBytes = filestat.st_size;
+	m_pMap = (uint8_t*) mmap(NULL, m_nMapBytes, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (m_pMap == MAP_FAILED) {
+		cerr << "Could not map circuit file " << filename << endl;
+		m_pMap = NULL;
+		return FALSE;
+	}
+
+	header = (circuit_file_header*) m_pMap;
+	if (header->magic != CIRCUIT_FILE_MAGIC || header->version != CIRCUIT_FILE_VERSION
+			|| header->headerbytes != sizeof(circuit_file_header)) {
+		cerr << "Circuit file " << filename << " has an unknown format or version" << endl;
+		return FALSE;
+	}
+	if (header->payloadbytes != m_nMapBytes - sizeof(circuit_file_header) || header->payloadbytes % sizeof(uint64_t) != 0) {
+		cerr << "Circuit file " << filename << " is truncated" << endl;
+		return FALSE;
+	}
+
+	m_pPayload = m_pMap + sizeof(circuit_file_header);
+	m_nPayloadBytes = header->payloadbytes;
+	m_nReadPos = 0;
+	if (Checksum(m_pPayload, m_nPayloadBytes) != header->checksum) {
+		cerr << "Checksum of circuit file " << filename << " does not match" << endl;
+		return FALSE;
+	}
+	return TRUE;
+}
+
+const void* CircuitFile::Get(uint64_t nbytes) {
+	uint64_t paddedbytes = PadToMultiple(nbytes, sizeof(uint64_t));
+	if (m_pPayload == NULL || paddedbytes > m_nPayloadBytes - m_nReadPos)
+		return NULL;
+	const void* ptr = m_pPayload + m_nReadPos;
+	m_nReadPos += paddedbytes;
+	return ptr;
+}
+
+BOOL CircuitFile::GetSize(uint64_t* nentries, uint64_t entrybytes) {
+	return Get<uint64_t>(nentries) && *nentries <= (m_nPayloadBytes - m_nReadPos) / entrybytes;
+}
+
+BOOL CircuitFile::GetQueue(deque<uint32_t>& queue) {
+	uint64_t nentries;
+	if (!GetSize(&nentries, sizeof(uint32_t)))
+		return FALSE;
+	const uint32_t* entries = (const uint32_t*) Get(nentries * sizeof(uint32_t));
+	if (entries == NULL)
+		return FALSE;
+	queue.assign(entries, entries + nentries);
+	return TRUE;
+}
+
+BOOL CircuitFile::GetQueues(vector<deque<uint32_t> >& queues) {
+	uint64_t nqueues;
+	if (!GetSize(&nqueues, sizeof(uint64_t)))
+		return FALSE;
+	queues.resize(nqueues);
+	for (uint64_t i = 0; i < nqueues; i++) {
+		if (!GetQueue(queues[i]))
+			return FALSE;
+	}
+	return TRUE;
+}
+
+//FNV-1a over 64-bit words, nbytes is a multiple of 8 since all items are padded
+uint64_t CircuitFile::Checksum(const uint8_t* buf, uint64_t nbytes) {
+	uint64_t checksum = 0xcbf29ce484222325ULL;
+	const uint64_t* words = (const uint64_t*) buf;
+	for (uint64_t i = 0; i < nbytes / sizeof(uint64_t); i++) {
+		checksum ^= words[i];
+		checksum *= 0x100000001b3ULL;
+	}
+	return checksum;
+}
@@ -0,0 +1,95 @@
+/**
+ \file 		circuitfile.h
+ \author	michael.zohner@ec-spride.de
+ \copyright	ABY - A Framework for Efficient Mixed-protocol Secure Two-party Computation
+			Copyright (C) 2015 Engineering Cryptographic Protocols Group, TU Darmstadt
+			This program is free software: you can redistribute it and/or modify
+			it under the terms of the GNU Affero General Public License as published
+			by the Free Software Foundation, either version 3 of the License, or
+			(at your option) any later version.
+			This program is distributed in the hope that it will be useful,
+			but WITHOUT ANY WARRANTY; without even the implied warranty of
+			MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+			GNU Affero General Public License for more details.
+			You should have received a copy of the GNU Affero General Public License
+			along with this program. If not, see <http://www.gnu.org/licenses/>.
+ \brief		Binary on-disk representation of a constructed circuit
+ */
+
+#ifndef __CIRCUITFILE_H__
+#define __CIRCUITFILE_H__
+
+#include "../util/typedefs.h"
+#include <deque>
+#include <vector>
+
+using namespace std;
+
+#define CIRCUIT_FILE_MAGIC 0x4352494359424100ULL //"\0ABYCIRC"
+#define CIRCUIT_FILE_VERSION 1
+
+struct circuit_file_header {
+	uint64_t magic;
+	uint32_t version;
+	uint32_t headerbytes;
+	uint64_t checksum;		// checksum over the payload that follows the header
+	uint64_t payloadbytes;
+};
+
+/**
+ Sequential binary file for circuits. When writing, all data is appended to a memory buffer and written together with the
+ header by Write(). When reading, the file is mapped into memory by Map() and Get() returns pointers into the mapping, such
+ that the large parts of a circuit can be copied in one go instead of being parsed. All items are padded to a multiple of 8
+ bytes, which keeps the items aligned in the mapping and allows computing the checksum over 64-bit words.
+ */
+class CircuitFile {
+public:
+	CircuitFile();
+	~CircuitFile();
+
+	/** Append nbytes of data to the file */
+	void Put(const void* data, uint64_t nbytes);
+	template<class T> void Put(T val) {
+		Put(&val, sizeof(T));
+	}
+	void PutQueue(deque<uint32_t>& queue);
+	void PutQueues(vector<deque<uint32_t> >& queues);
+	/** Write the header and all appended data to filename */
+	BOOL Write(const char* filename);
+
+	/** Map filename into memory and check its header and checksum */
+	BOOL Map(const char* filename);
+	/**
+	 Read the next item of nbytes bytes.
+	 \return	pointer to the item in the mapping, which is valid until the file is destroyed, or NULL if the file ends
+	 */
+	const void* Get(uint64_t nbytes);
+	template<class T> BOOL Get(T* val) {
+		const void* ptr = Get(sizeof(T));
+		if (ptr)
+			*val = *((const T*) ptr);
+		return ptr != NULL;
+	}
+	/** Read a number of entries and check that the remaining file can hold them, with at least entrybytes per entry */
+	BOOL GetSize(uint64_t* nentries, uint64_t entrybytes);
+	BOOL GetQueue(deque<uint32_t>& queue);
+	BOOL GetQueues(vector<deque<uint32_t> >& queues);
+	/** Returns TRUE if all items of the mapped file have been read */
+	BOOL AtEnd() {
+		return m_nReadPos == m_nPayloadBytes;
+	}
+	;
+
+private:
+	static uint64_t Checksum(const uint8_t* buf, uint64_t nbytes);
+
+	vector<uint8_t> m_vWriteBuf;
+
+	uint8_t* m_pMap;
+	uint64_t m_nMapBytes;
+	const uint8_t* m_pPayload;
+	uint64_t m_nPayloadBytes;
+	uint64_t m_nReadPos;
+};
+
+#endif /* __CIRCUITFILE_H__ */
@@ -28,8 +28,7 @@ share::share(uint32_t sharelen, Circuit* circ) {
 	init(circ);
 }
 
-share::share(vector<uint32_t> gates, Circuit* circ) {
-	m_ngateids.resize(gates.size());
+share::share(const vector<uint32_t>& gates, Circuit* circ) {
 	m_ngateids = gates;
 	init(circ);
 }
@@ -174,31 +173,18 @@ uint8_t* arithshare::get_clear_value() {
 }
 
 void arithshare::get_clear_value_vec(uint32_t** vec, uint32_t* bitlen, uint32_t* nvals) {
-	//assert(m_ngateids.size() <= sizeof(uint32_t) * 8);
-
-	UGATE_T* gate_val;
-	*nvals = 0;
-	for(uint32_t i = 0; i < m_ngateids.size(); i++) {
-		(*nvals) += m_ccirc->GetOutputGateValue(m_ngateids[i], gate_val);
-	}
-	uint32_t sharebytes = ceil_divide(m_ccirc->GetShareBitLen(), 8);
-
-	//*nvals = m_ccirc->GetOutputGateValue(m_ngateids[0], gate_val);
-	*vec = (uint32_t*) calloc(*nvals, sizeof(uint32_t));
+	get_clear_value_vec_internal(vec, bitlen, nvals);
+}
 
-	for(uint32_t i = 0, tmpctr=0, tmpnvals; i < m_ngateids.size(); i++) {
-		tmpnvals = m_ccirc->GetOutputGateValue(m_ngateids[i], gate_val);
-		//cout << m_ngateids[i] << " gateval = " << gate_val[0] << ", nvals = " << *nvals << ", sharebitlen = " << m_ccirc->GetShareBitLen() << endl;
-		for(uint32_t j = 0; j < tmpnvals; j++, tmpctr++) {
-			memcpy((*vec)+tmpctr, ((uint8_t*) gate_val)+(j*sharebytes), sharebytes);
-		}
-	}
+void arithshare::get_clear_value_vec(uint64_t** vec, uint32_t* bitlen, uint32_t* nvals) {
+	get_clear_value_vec_internal(vec, bitlen, nvals);
+}
 
-	*bitlen = m_ccirc->GetShareBitLen();
+void arithshare::get_clear_value_vec(UINT128_T** vec, uint32_t* bitlen, uint32_t* nvals) {
+	get_clear_value_vec_internal(vec, bitlen, nvals);
 }
 
-//TODO: copied from 32 bits. Put template in and test later on!
-void arithshare::get_clear_value_vec(uint64_t** vec, uint32_t* bitlen, uint32_t* nvals) {
+template<class T> void arithshare::get_clear_value_vec_internal(T** vec, uint32_t* bitlen, uint32_t* nvals) {
 	//assert(m_ngateids.size() <= sizeof(uint32_t) * 8);
 
 	UGATE_T* gate_val;
@@ -207,15 +193,14 @@ void arithshare::get_clear_value_vec(uint64_t** vec, uint32_t* bitlen, uint32_t*
 		(*nvals) += m_ccirc->GetOutputGateValue(m_ngateids[i], gate_val);
 	}
 	uint32_t sharebytes = ceil_divide(m_ccirc->GetShareBitLen(), 8);
+	uint32_t copybytes = min(sharebytes, (uint32_t) sizeof(T));
 
-	//*nvals = m_ccirc->GetOutputGateValue(m_ngateids[0], gate_val);
-	*vec = (uint64_t*) calloc(*nvals, sizeof(uint64_t));
+	*vec = (T*) calloc(*nvals, sizeof(T));
 
 	for(uint32_t i = 0, tmpctr=0, tmpnvals; i < m_ngateids.size(); i++) {
 		tmpnvals = m_ccirc->GetOutputGateValue(m_ngateids[i], gate_val);
-		//cout << m_ngateids[i] << " gateval = " << gate_val[0] << ", nvals = " << *nvals << ", sharebitlen = " << m_ccirc->GetShareBitLen() << endl;
 		for(uint32_t j = 0; j < tmpnvals; j++, tmpctr++) {
-			memcpy((*vec)+tmpctr, ((uint8_t*) gate_val)+(j*sharebytes), sharebytes);
+			memcpy((*vec)+tmpctr, ((uint8_t*) gate_val)+(j*sharebytes), copybytes);
 		}
 	}
 
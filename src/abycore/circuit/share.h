@@ -27,7 +27,7 @@ public:
 	/** Constructor overloaded with shared length and circuit.*/
 	share(uint32_t sharelen, Circuit* circ);
 	/** Constructor overloaded with gates and circuit.*/
-	share(vector<uint32_t> gates, Circuit* circ);
+	share(const vector<uint32_t>& gates, Circuit* circ);
 	/**
 	 Initialise Function
 	 \param circ 		Ciruit object.
@@ -40,7 +40,8 @@ public:
 	}
 	;
 
-	vector<uint32_t> get_wires() {
+	/** Returns the wire IDs of the share, the reference is valid as long as the share exists and is not modified */
+	const vector<uint32_t>& get_wires() {
 		return m_ngateids;
 	}
 	;
@@ -50,7 +51,7 @@ public:
 
 	void set_wire_id(uint32_t posid, uint32_t wireid);
 
-	void set_wire_ids(vector<uint32_t> wires) {
+	void set_wire_ids(const vector<uint32_t>& wires) {
 		m_ngateids = wires;
 	}
 	;
@@ -119,7 +120,7 @@ public:
 	}
 	;
 	/** Constructor overloaded with gates and circuit.*/
-	boolshare(vector<uint32_t> gates, Circuit* circ) :
+	boolshare(const vector<uint32_t>& gates, Circuit* circ) :
 			share(gates, circ) {
 	}
 	;
@@ -164,7 +165,7 @@ public:
 	}
 	;
 	/** Constructor overloaded with gates and circuit.*/
-	arithshare(vector<uint32_t> gates, Circuit* circ) :
+	arithshare(const vector<uint32_t>& gates, Circuit* circ) :
 			share(gates, circ) {
 	}
 	;
@@ -177,6 +178,8 @@ public:
 	uint8_t* get_clear_value();
 	void get_clear_value_vec(uint32_t** vec, uint32_t* bitlen, uint32_t* nvals);
 	void get_clear_value_vec(uint64_t** vec, uint32_t* bitlen, uint32_t* nvals);
+	/** Returns the output values of a 128-bit arithmetic circuit */
+	void get_clear_value_vec(UINT128_T** vec, uint32_t* bitlen, uint32_t* nvals);
 
 	/**
 		\brief	The function returns a share object based on the shareid being inputed.
@@ -186,6 +189,9 @@ public:
 	*/
 	share* get_share_from_wire_id(uint32_t shareid);
 
+private:
+	/** Copies the output values into elements of type T, which are truncated if the shares are longer than T */
+	template<class T> void get_clear_value_vec_internal(T** vec, uint32_t* bitlen, uint32_t* nvals);
 };
 
 /*static share* create_new_share(uint32_t size, Circuit* circ, e_circuit circtype);
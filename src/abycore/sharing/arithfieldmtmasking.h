@@ -0,0 +1,133 @@
+/**
+ \file 		arithfieldmtmasking.h
+ \author 	michael.zohner@ec-spride.de
+ \copyright	ABY - A Framework for Efficient Mixed-protocol Secure Two-party Computation
+			Copyright (C) 2015 Engineering Cryptographic Protocols Group, TU Darmstadt
+			This program is free software: you can redistribute it and/or modify
+			it under the terms of the GNU Affero General Public License as published
+			by the Free Software Foundation, either version 3 of the License, or
+			(at your option) any later version.
+			This program is distributed in the hope that it will be useful,
+			but WITHOUT ANY WARRANTY; without even the implied warranty of
+			MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+			GNU Affero General Public License for more details.
+			You should have received a copy of the GNU Affero General Public License
+			along with this program. If not, see <http://www.gnu.org/licenses/>.
+ \brief		Masking function for the correlated OTs that generate multiplication triples over a prime field.
+ */
+#ifndef __ARITHFIELDMTMASKING_H_
+#define __ARITHFIELDMTMASKING_H_
+
+#include "../ot/maskingfunction.h"
+
+/**
+ Masking function that computes additive shares modulo an odd prime p < 2^62 of the product of a receiver value x with a
+ sender value y, both in [0, p). Each product requires 64 OTs with the bits of x as choice bits, where the OT for bit i
+ carries the correlation y * 2^i mod p. Each OT transfers 128 bits, such that the random masks, which are reduced
+ modulo p, are statistically close to uniform.
+ The sender obtains the sum of the random masks and the receiver x * y minus this sum, both modulo p.
+ */
+class ArithFieldMTMasking: public MaskingFunction {
+public:
+	/**
+	 \param 	modulus 	the prime p
+	 \param 	in 			sender values, one UINT64_T value in [0, p) per product
+	 */
+	ArithFieldMTMasking(UINT64_T modulus, CBitVector* in) {
+		m_nModulus = modulus;
+		m_vInput = in;
+		m_nMTBitLen = sizeof(UINT64_T) * 8;
+		m_nOTByteLen = sizeof(UINT128_T);
+	}
+	;
+
+	~ArithFieldMTMasking() {
+	}
+	;
+
+	void Mask(uint32_t progress, uint32_t len, CBitVector** values, CBitVector* snd_buf, snd_ot_flavor protocol) {
+		//progress and len should always be divisible by MTBitLen
+		if (progress % m_nMTBitLen != 0 || len % m_nMTBitLen != 0) {
+			cerr << "progress or processed OTs not divisible by MTBitLen, cannot guarantee correct result. Progress = " << progress << ", processed OTs " << len
+					<< ", MTBitLen = " << m_nMTBitLen << endl;
+		}
+
+		uint32_t startpos = progress / m_nMTBitLen;
+
+		UINT128_T* rndval = (UINT128_T*) snd_buf[0].GetArr();
+		UINT128_T* maskedval = (UINT128_T*) snd_buf[1].GetArr();
+		UINT64_T* input = ((UINT64_T*) m_vInput->GetArr()) + startpos;
+		UINT64_T* retvals = ((UINT64_T*) values[0]->GetArr()) + startpos;
+
+		UINT64_T r, corr, sum;
+		for (uint32_t i = 0, mtbit, ctr = 0; i < len; input++, retvals++) {
+			sum = 0;
+			corr = *input;
+			for (mtbit = 0; mtbit < m_nMTBitLen; mtbit++, i++, ctr++) {
+				//Add the random mask to the masks of this product and send the correlation minus the mask
+				r = (UINT64_T) (rndval[ctr] % m_nModulus);
+				sum = AddMod(sum, r);
+				maskedval[ctr] ^= (UINT128_T) SubMod(corr, r);
+				corr = AddMod(corr, corr);
+			}
+			*retvals = sum;
+		}
+	}
+	;
+
+	void UnMask(uint32_t progress, uint32_t len, CBitVector* choices, CBitVector* output, CBitVector* rcv_buf, CBitVector* tmpmask, snd_ot_flavor version) {
+		//progress and len should always be divisible by MTBitLen
+		if (progress % m_nMTBitLen != 0 || len % m_nMTBitLen != 0) {
+			cerr << "progress or processed OTs not divisible by MTBitLen, cannot guarantee correct result. Progress = " << progress << ", processed OTs " << len
+					<< ", MTBitLen = " << m_nMTBitLen << endl;
+		}
+
+		uint32_t lim = progress + len;
+		BYTE* rcvbufptr = rcv_buf->GetArr();
+		UINT128_T* masks = (UINT128_T*) tmpmask->GetArr();
+		UINT64_T* outvals = ((UINT64_T*) output->GetArr()) + progress / m_nMTBitLen;
+
+		UINT64_T sum;
+		for (uint32_t i = progress, mtbit, maskctr = 0; i < lim; outvals++) {
+			sum = 0;
+			for (mtbit = 0; mtbit < m_nMTBitLen; mtbit++, i++, rcvbufptr += m_nOTByteLen, maskctr++) {
+				if (choices->GetBitNoMask(i)) {
+					//the unmasked value is the correlation minus the random mask of the sender
+					tmpmask->XORBytes(rcvbufptr, maskctr * m_nOTByteLen, m_nOTByteLen);
+					sum = AddMod(sum, (UINT64_T) masks[maskctr]);
+				} else {
+					sum = SubMod(sum, (UINT64_T) (masks[maskctr] % m_nModulus));
+				}
+			}
+			*outvals = sum;
+		}
+	}
+	;
+
+	void expandMask(CBitVector* out, BYTE* sbp, uint32_t offset, uint32_t processedOTs, uint32_t bitlength, crypto* crypt) {
+		//the 128-bit strings are taken directly from the OT seeds
+		BYTE* outptr = out->GetArr() + offset * m_nOTByteLen;
+		for (uint32_t i = 0; i < processedOTs; i++, sbp += AES_KEY_BYTES, outptr += m_nOTByteLen) {
+			memcpy(outptr, sbp, m_nOTByteLen);
+		}
+	}
+	;
+
+private:
+	inline UINT64_T AddMod(UINT64_T a, UINT64_T b) {
+		UINT64_T s = a + b;
+		return s >= m_nModulus ? s - m_nModulus : s;
+	}
+	;
+	inline UINT64_T SubMod(UINT64_T a, UINT64_T b) {
+		return a >= b ? a - b : a + m_nModulus - b;
+	}
+	;
+
+	CBitVector* m_vInput;
+	UINT64_T m_nModulus;
+	uint32_t m_nOTByteLen;
+	uint32_t m_nMTBitLen;
+};
+
+#endif /* __ARITHFIELDMTMASKING_H_ */
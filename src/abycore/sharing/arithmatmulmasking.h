@@ -0,0 +1,144 @@
+/**
+ \file 		arithmatmulmasking.h
+ \author 	michael.zohner@ec-spride.de
+ \copyright	ABY - A Framework for Efficient Mixed-protocol Secure Two-party Computation
+			Copyright (C) 2015 Engineering Cryptographic Protocols Group, TU Darmstadt
+			This program is free software: you can redistribute it and/or modify
+			it under the terms of the GNU Affero General Public License as published
+			by the Free Software Foundation, either version 3 of the License, or
+			(at your option) any later version.
+			This program is distributed in the hope that it will be useful,
+			but WITHOUT ANY WARRANTY; without even the implied warranty of
+			MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+			GNU Affero General Public License for more details.
+			You should have received a copy of the GNU Affero General Public License
+			along with this program. If not, see <http://www.gnu.org/licenses/>.
+ \brief		Masking function for the correlated OTs that generate matrix triples.
+ */
+#ifndef __ARITHMATMULMASKING_H_
+#define __ARITHMATMULMASKING_H_
+
+#include "../ot/maskingfunction.h"
+
+/**
+ Masking function that computes additive shares of the products of a receiver value x with a vector y of the sender. In
+ contrast to ArithMTMasking, where the same sender value is used for all elements of an OT, the sender holds a vector of
+ numelements values per product (e.g., a row of a matrix). Each product requires sizeof(T) * 8 OTs with the bits of x as
+ choice bits, where the OT for bit i carries the correlations (y_j << i), j < numelements.
+ The sender obtains the sum of the random masks and the receiver x * y_j minus this sum for each element.
+ */
+template<typename T>
+class ArithMatMulMasking: public MaskingFunction {
+public:
+	/**
+	 \param 	numelements 	number of elements of the sender vector of each product
+	 \param 	in 				sender vectors, numelements values of type T per product
+	 */
+	ArithMatMulMasking(uint32_t numelements, CBitVector* in) {
+		m_nElements = numelements;
+		m_vInput = in;
+		m_nMTBitLen = sizeof(T) * 8;
+		m_nOTByteLen = sizeof(T) * m_nElements;
+		m_bAESExpand = m_nOTByteLen > AES_BYTES;
+	}
+	;
+
+	void Mask(uint32_t progress, uint32_t len, CBitVector** values, CBitVector* snd_buf, snd_ot_flavor protocol) {
+		//progress and len should always be divisible by MTBitLen
+		if (progress % m_nMTBitLen != 0 || len % m_nMTBitLen != 0) {
+			cerr << "progress or processed OTs not divisible by MTBitLen, cannot guarantee correct result. Progress = " << progress << ", processed OTs " << len
+					<< ", MTBitLen = " << m_nMTBitLen << endl;
+		}
+
+		//each product requires m_nMTBitLen OTs, which each carry m_nElements values
+		uint32_t startpos = progress / m_nMTBitLen;
+
+		T* rndval = (T*) snd_buf[0].GetArr();
+		T* maskedval = (T*) snd_buf[1].GetArr();
+		T* input = ((T*) m_vInput->GetArr()) + (uint64_t) startpos * m_nElements;
+		T* retvals = ((T*) values[0]->GetArr()) + (uint64_t) startpos * m_nElements;
+
+		for (uint32_t i = 0, mtbit, j, ctr = 0; i < len; input += m_nElements, retvals += m_nElements) {
+			for (j = 0; j < m_nElements; j++)
+				retvals[j] = 0;
+
+			for (mtbit = 0; mtbit < m_nMTBitLen; mtbit++, i++) {
+				for (j = 0; j < m_nElements; j++, ctr++) {
+					//Add the random mask to the masks of this product and send the correlation minus the mask
+					retvals[j] += rndval[ctr];
+					maskedval[ctr] ^= (T) ((T) (input[j] << mtbit) - rndval[ctr]);
+				}
+			}
+		}
+	}
+	;
+
+	void UnMask(uint32_t progress, uint32_t len, CBitVector* choices, CBitVector* output, CBitVector* rcv_buf, CBitVector* tmpmask, snd_ot_flavor version) {
+		//progress and len should always be divisible by MTBitLen
+		if (progress % m_nMTBitLen != 0 || len % m_nMTBitLen != 0) {
+			cerr << "progress or processed OTs not divisible by MTBitLen, cannot guarantee correct result. Progress = " << progress << ", processed OTs " << len
+					<< ", MTBitLen = " << m_nMTBitLen << endl;
+		}
+
+		uint32_t lim = progress + len;
+		BYTE* rcvbufptr = rcv_buf->GetArr();
+		T* masks = (T*) tmpmask->GetArr();
+		T* outvals = ((T*) output->GetArr()) + (uint64_t) (progress / m_nMTBitLen) * m_nElements;
+
+		for (uint32_t i = progress, mtbit, j, maskctr = 0; i < lim; outvals += m_nElements) {
+			for (j = 0; j < m_nElements; j++)
+				outvals[j] = 0;
+
+			for (mtbit = 0; mtbit < m_nMTBitLen; mtbit++, i++, rcvbufptr += m_nOTByteLen, maskctr++) {
+				if (choices->GetBitNoMask(i)) {
+					tmpmask->XORBytes(rcvbufptr, maskctr * m_nOTByteLen, m_nOTByteLen);
+					for (j = 0; j < m_nElements; j++)
+						outvals[j] += masks[maskctr * m_nElements + j];
+				} else {
+					for (j = 0; j < m_nElements; j++)
+						outvals[j] -= masks[maskctr * m_nElements + j];
+				}
+			}
+		}
+	}
+	;
+
+	void expandMask(CBitVector* out, BYTE* sbp, uint32_t offset, uint32_t processedOTs, uint32_t bitlength, crypto* crypt) {
+		if (!m_bAESExpand) {
+			BYTE* outptr = out->GetArr() + offset * m_nOTByteLen;
+			for (uint32_t i = 0; i < processedOTs; i++, sbp += AES_KEY_BYTES, outptr += m_nOTByteLen) {
+				memcpy(outptr, sbp, m_nOTByteLen);
+			}
+		} else {
+			//the masking function is shared by both OT directions and all OT threads, hence the AES key, the counter,
+			//and the random bits are kept on the stack of each call
+			uint32_t nblocks = ceil_divide(m_nOTByteLen, AES_BYTES);
+			BYTE* rndbuf = (BYTE*) malloc(sizeof(BYTE) * nblocks * AES_BYTES);
+			BYTE ctrbuf[AES_BYTES];
+			AES_KEY_CTX aeskey;
+
+			memset(ctrbuf, 0, AES_BYTES);
+			uint32_t* counter = (uint32_t*) ctrbuf;
+			for (uint32_t i = 0; i < processedOTs; i++, sbp += AES_KEY_BYTES) {
+				//Generate sufficient random bits from the seed of the OT
+				crypt->init_aes_key(&aeskey, sbp);
+				for (counter[0] = 0; counter[0] < nblocks; counter[0]++) {
+					crypt->encrypt(&aeskey, rndbuf + counter[0] * AES_BYTES, ctrbuf, AES_BYTES);
+				}
+				crypt->clean_aes_key(&aeskey);
+				out->SetBytes(rndbuf, (uint64_t) (offset + i) * m_nOTByteLen, m_nOTByteLen);
+			}
+			free(rndbuf);
+		}
+	}
+	;
+
+private:
+	CBitVector* m_vInput;
+	uint32_t m_nElements;
+	uint32_t m_nOTByteLen;
+	uint32_t m_nMTBitLen;
+	BOOL m_bAESExpand;
+};
+
+#endif /* __ARITHMATMULMASKING_H_ */
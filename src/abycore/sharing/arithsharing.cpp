@@ -24,9 +24,24 @@ void ArithSharing<T>::Init() {
 
 	m_nTypeBitLen = sizeof(T) * 8;
 
-	memset(&m_nTypeBitMask, 0, sizeof(uint64_t));
 	memset(&m_nTypeBitMask, 0xFF, sizeof(T));
 
+	//The public-key based MT generation works on at most 64-bit shares
+	if (m_nTypeBitLen > 64 && (m_eMTGenAlg == MT_PAILLIER || m_eMTGenAlg == MT_DGK)) {
+		cerr << "MT generation for " << m_nTypeBitLen << "-bit arithmetic sharing is only supported with OTs, switching to OT-based MT generation" << endl;
+		m_eMTGenAlg = MT_OT;
+	}
+
+	if (m_nModulus) {
+		//p^-1 mod 2^64 by Newton iteration, each step doubles the number of correct low bits, starting from 3
+		UINT64_T inv = m_nModulus;
+		for (uint32_t i = 0; i < 5; i++)
+			inv *= 2 - m_nModulus * inv;
+		m_nMontInv = -inv;
+		UINT64_T r = (UINT64_T) ((((UINT128_T) 1) << 64) % m_nModulus);
+		m_nMontR2 = (UINT64_T) (((UINT128_T) r * r) % m_nModulus);
+	}
+
 	m_cArithCircuit = new ArithmeticCircuit(m_pCircuit, m_eContext, m_eRole, m_nTypeBitLen);
 
 	m_vConversionMasks.resize(2);
@@ -42,6 +57,8 @@ void ArithSharing<T>::Init() {
 
 	m_vCONVGates.clear();
 
+	m_nMatMulStartIdx = 0;
+	m_nMatMulIdx = 0;
 }
 
 //Pre-set values for new layer
@@ -51,7 +68,7 @@ void ArithSharing<T>::InitNewLayer() {
 	if (m_nInputShareSndCtr > 0) {
 		//TODO: exchange by input and output variables
 		uint32_t invals = m_cArithCircuit->GetNumInputBitsForParty(m_eRole);
-		m_vInputShareSndBuf.Create((uint64_t) invals * m_nTypeBitLen, m_cCrypto);
+		CreateRandomShares(m_vInputShareSndBuf, invals);
 
 #ifdef DEBUGARITH
 		cout << " m_vInputShareSndBuf at init new layer = ";
@@ -77,7 +94,14 @@ void ArithSharing<T>::PrepareSetupPhase(ABYSetup* setup) {
 
 	InitMTs();
 
-	ArithMTMasking<T> *fMaskFct = new ArithMTMasking<T>(1, &(m_vB[0])); //TODO to implement the vector multiplication change first argument
+	MaskingFunction* fMaskFct;
+	//ArithMTMasking keeps a 64-bit mask, wider shares use the matrix triple masking with a single element per product
+	if (m_nModulus)
+		fMaskFct = new ArithFieldMTMasking(m_nModulus, &(m_vB[0]));
+	else if (m_nTypeBitLen > 64)
+		fMaskFct = new ArithMatMulMasking<T>(1, &(m_vB[0]));
+	else
+		fMaskFct = new ArithMTMasking<T>(1, &(m_vB[0])); //TODO to implement the vector multiplication change first argument
 	if (m_nMTs > 0) {
 		if (m_eMTGenAlg == MT_PAILLIER || m_eMTGenAlg == MT_DGK) {
 			PKMTGenVals* pgentask = (PKMTGenVals*) malloc(sizeof(PKMTGenVals));
@@ -86,11 +110,13 @@ void ArithSharing<T>::PrepareSetupPhase(ABYSetup* setup) {
 			pgentask->C = &(m_vC[0]);
 			pgentask->numMTs = m_nMTs;
 			pgentask->sharebitlen = m_nTypeBitLen;
+			pgentask->modulus = m_nModulus;
 			setup->AddPKMTGenTask(pgentask);
 		} else {
 			for (uint32_t i = 0; i < 2; i++) {
 				IKNP_OTTask* task = (IKNP_OTTask*) malloc(sizeof(IKNP_OTTask));
-				task->bitlen = m_nTypeBitLen;
+				//the field masking transfers 128-bit strings, such that the masks reduced modulo p are statistically uniform
+				task->bitlen = m_nModulus ? sizeof(UINT128_T) * 8 : m_nTypeBitLen;
 				task->snd_flavor = Snd_C_OT;
 				task->rec_flavor = Rec_OT;
 				task->numOTs = m_nMTs * m_nTypeBitLen;
@@ -110,6 +136,8 @@ void ArithSharing<T>::PrepareSetupPhase(ABYSetup* setup) {
 		}
 	}
 
+	InitMatMulTriples(setup);
+
 	m_nNumCONVs = m_cArithCircuit->GetNumCONVGates();
 	if (m_nNumCONVs > 0) {
 		XORMasking* fXORMaskFct = new XORMasking(m_nTypeBitLen); //TODO to implement the vector multiplication change first argument
@@ -156,12 +184,15 @@ void ArithSharing<T>::FinishSetupPhase(ABYSetup* setup) {
 		<< ", C: " << (UINT64_T) m_vC[0].Get<T>(i * m_nTypeBitLen, m_nTypeBitLen) << ", S: " << (UINT64_T) m_vS[0].Get<T>(i * m_nTypeBitLen, m_nTypeBitLen) << endl;
 	}
 #endif
-	if (m_eMTGenAlg == MT_OT) {
+	if (m_nModulus) {
+		ComputeFieldMTs();
+	} else if (m_eMTGenAlg == MT_OT) {
 		//Compute Multiplication Triples
 		ComputeMTsFromOTs();
 	}
 
 	FinishMTGeneration();
+	ComputeMatMulTriples();
 #ifdef VERIFY_ARITH_MT
 	VerifyArithMT(setup);
 #endif
@@ -180,12 +211,12 @@ void ArithSharing<T>::InitMTs() {
 	m_vB.resize(1);
 
 	m_vC[0].Create(m_nMTs, m_nTypeBitLen);
-	m_vB[0].Create(m_nMTs, m_nTypeBitLen, m_cCrypto);
+	CreateRandomShares(m_vB[0], m_nMTs);
 
 	m_vA.resize(1);
 	m_vS.resize(1);
 
-	m_vA[0].Create(m_nMTs, m_nTypeBitLen, m_cCrypto);
+	CreateRandomShares(m_vA[0], m_nMTs);
 	m_vS[0].Create(m_nMTs, m_nTypeBitLen);
 
 	m_vD_snd.resize(1);
@@ -218,6 +249,42 @@ void ArithSharing<T>::ComputeMTsFromOTs() {
 	}
 }
 
+template<typename T>
+void ArithSharing<T>::CreateRandomShares(CBitVector& vec, uint32_t nvals) {
+	if (!m_nModulus) {
+		vec.Create(nvals, m_nTypeBitLen, m_cCrypto);
+		return;
+	}
+
+	CBitVector rnd;
+	rnd.Create(nvals, sizeof(UINT128_T) * 8, m_cCrypto);
+	vec.Create(nvals, m_nTypeBitLen);
+
+	UINT128_T* rndvals = (UINT128_T*) rnd.GetArr();
+	UINT64_T* vals = (UINT64_T*) vec.GetArr();
+	for (uint32_t i = 0; i < nvals; i++)
+		vals[i] = (UINT64_T) (rndvals[i] % m_nModulus);
+
+	rnd.delCBitVector();
+}
+
+template<typename T>
+void ArithSharing<T>::ComputeFieldMTs() {
+	UINT64_T* a = (UINT64_T*) m_vA[0].GetArr();
+	UINT64_T* b = (UINT64_T*) m_vB[0].GetArr();
+	UINT64_T* c = (UINT64_T*) m_vC[0].GetArr();
+	UINT64_T* s = (UINT64_T*) m_vS[0].GetArr();
+
+	//A and B are random field elements, which are interpreted in Montgomery representation. Since the Montgomery reduction
+	//is linear, reducing the shares of A * B mod p gives shares of the Montgomery representation of the product
+	for (uint32_t i = 0; i < m_nMTs; i++) {
+		if (m_eMTGenAlg == MT_OT)
+			c[i] = MontReduce((UINT128_T) a[i] * b[i] + AddMod(c[i], s[i]));
+		else
+			c[i] = MontReduce(c[i]);
+	}
+}
+
 template<typename T>
 void ArithSharing<T>::FinishMTGeneration() {
 	uint32_t bytesMTs = ceil_divide(m_nMTs * m_nTypeBitLen, 8);
@@ -247,7 +314,7 @@ void ArithSharing<T>::PrepareOnlinePhase() {
 	cout << "ninputvals = " << myinvals << ", noutputvals = " << myoutvals << ", typelen = " << m_nTypeBitLen << endl;
 #endif
 
-	m_vInputShareSndBuf.Create(myinvals, m_nTypeBitLen, m_cCrypto);
+	CreateRandomShares(m_vInputShareSndBuf, myinvals);
 #ifdef DEBUGARITH
 	cout << " m_vInputShareSndBuf at prep online phase = ";
 	m_vInputShareSndBuf.PrintHex();
@@ -289,6 +356,8 @@ void ArithSharing<T>::EvaluateLocalOperations(uint32_t depth) {
 			InstantiateGate(gate);
 			if (value > 0 && m_eRole == CLIENT)
 				value = 0;
+			else if (m_nModulus)
+				value = ToMont(value);
 			for (uint32_t i = 0; i < gate->nvals; i++)
 				gate->gs.val[i] = value;
 		} else if (gate->type == G_CALLBACK) {
@@ -300,6 +369,10 @@ void ArithSharing<T>::EvaluateLocalOperations(uint32_t depth) {
 			InstantiateGate(gate);
 			memcpy(gate->gs.val, parent->gs.val, gate->nvals * sizeof(T));
 			UsedGate(gate->ingates.inputs.parent);
+		} else if (gate->type == G_WIDTH_CONV) {
+			EvaluateWidthConvGate(gate);
+		} else if (gate->type == G_TRUNC) {
+			EvaluateTruncGate(gate);
 		} else if (gate->type == G_PRINT_VAL) {
 			EvaluatePrintValGate(localops[i], C_ARITHMETIC);
 		} else if (gate->type == G_ASSERT) {
@@ -318,11 +391,16 @@ void ArithSharing<T>::EvaluateInteractiveOperations(uint32_t depth) {
 	for (uint32_t i = 0; i < interactiveops.size(); i++) {
 		GATE* gate = m_pGates + interactiveops[i];
 
-		if (gate->type == G_NON_LIN) {
+		if (gate->type == G_NON_LIN || gate->type == G_DOT) {
 #ifdef DEBUGARITH
 			cout << " which is an MUL gate" << endl;
 #endif
 			SelectiveOpen(gate);
+		} else if (gate->type == G_MATMUL) {
+#ifdef DEBUGARITH
+			cout << " which is a MATMUL gate" << endl;
+#endif
+			SelectiveOpenMatrix(gate);
 		} else if (gate->type == G_IN) {
 			if (gate->gs.ishare.src == m_eRole) {
 #ifdef DEBUGARITH
@@ -376,7 +454,10 @@ void ArithSharing<T>::EvaluateADDGate(GATE* gate) {
 	uint32_t idright = gate->ingates.inputs.twin.right;
 	InstantiateGate(gate);
 
-	for (uint32_t i = 0; i < nvals; i++) {
+	if (m_nModulus) {
+		for (uint32_t i = 0; i < nvals; i++)
+			((T*) gate->gs.aval)[i] = AddMod(((T*) m_pGates[idleft].gs.aval)[i], ((T*) m_pGates[idright].gs.aval)[i]);
+	} else for (uint32_t i = 0; i < nvals; i++) {
 		((T*) gate->gs.aval)[i] = ((T*) m_pGates[idleft].gs.aval)[i] + ((T*) m_pGates[idright].gs.aval)[i];
 #ifdef DEBUGARITH
 		cout << "Result ADD (" << i << "): "<< ((T*)gate->gs.aval)[i] << " = " << ((T*) m_pGates[idleft].gs.aval)[i] << " + " << ((T*)m_pGates[idright].gs.aval)[i] << endl;
@@ -387,6 +468,69 @@ void ArithSharing<T>::EvaluateADDGate(GATE* gate) {
 	UsedGate(idright);
 }
 
+template<typename T>
+void ArithSharing<T>::EvaluateWidthConvGate(GATE* gate) {
+	uint32_t parentid = gate->ingates.inputs.parent;
+	GATE* parent = m_pGates + parentid;
+	InstantiateGate(gate);
+
+	switch (parent->sharebitlen) {
+	case 8:
+		ReduceShares((T*) gate->gs.aval, (UINT8_T*) parent->gs.aval, gate->nvals);
+		break;
+	case 16:
+		ReduceShares((T*) gate->gs.aval, (UINT16_T*) parent->gs.aval, gate->nvals);
+		break;
+	case 32:
+		ReduceShares((T*) gate->gs.aval, (UINT32_T*) parent->gs.aval, gate->nvals);
+		break;
+	case 64:
+		ReduceShares((T*) gate->gs.aval, (UINT64_T*) parent->gs.aval, gate->nvals);
+		break;
+	case 128:
+		ReduceShares((T*) gate->gs.aval, (UINT128_T*) parent->gs.aval, gate->nvals);
+		break;
+	default:
+		cerr << "Width conversion from " << parent->sharebitlen << " bits is not supported" << endl;
+		break;
+	}
+
+	UsedGate(parentid);
+}
+
+template<typename T>
+void ArithSharing<T>::EvaluateTruncGate(GATE* gate) {
+	uint32_t parentid = gate->ingates.inputs.parent;
+	uint32_t truncbits = gate->gs.truncbits;
+	InstantiateGate(gate);
+
+	memcpy(gate->gs.aval, m_pGates[parentid].gs.aval, gate->nvals * sizeof(T));
+	TruncShares((T*) gate->gs.aval, gate->nvals, truncbits);
+
+	UsedGate(parentid);
+}
+
+template<typename T>
+void ArithSharing<T>::TruncShares(T* vals, uint32_t nvals, uint32_t truncbits) {
+	//the server shifts its share x_0 and the client computes -((-x_1) >> f), such that the shifted shares sum up to
+	//x >> f or (x >> f) + 1 unless x_0 + x_1 wraps around 2^l on the wrong side of the value, see SecureML
+	uint32_t signshift = m_nTypeBitLen - truncbits;
+	T sign;
+	if (m_eRole == SERVER) {
+		for (uint32_t i = 0; i < nvals; i++) {
+			sign = (T) 0 - (vals[i] >> (m_nTypeBitLen - 1));
+			vals[i] = (vals[i] >> truncbits) | (T) (sign << signshift);
+		}
+	} else {
+		T neg;
+		for (uint32_t i = 0; i < nvals; i++) {
+			neg = (T) 0 - vals[i];
+			sign = (T) 0 - (neg >> (m_nTypeBitLen - 1));
+			vals[i] = (T) 0 - ((neg >> truncbits) | (T) (sign << signshift));
+		}
+	}
+}
+
 template<typename T>
 void ArithSharing<T>::ShareValues(GATE* gate) {
 	T* input = (T*) gate->gs.ishare.inval;
@@ -401,7 +545,10 @@ void ArithSharing<T>::ShareValues(GATE* gate) {
 
 	for (uint32_t i = 0; i < gate->nvals; i++, m_nInputShareSndCtr++) {
 		tmpval = m_vInputShareSndBuf.Get<T>(m_nInputShareSndCtr);
-		((T*) gate->gs.aval)[i] = MOD_SUB(input[i], tmpval, m_nTypeBitMask);
+		if (m_nModulus)
+			((T*) gate->gs.aval)[i] = SubMod(ToMont(input[i]), tmpval);
+		else
+			((T*) gate->gs.aval)[i] = MOD_SUB(input[i], tmpval, m_nTypeBitMask);
 #ifdef DEBUGARITH
 							cout << "Shared: " << (UINT64_T) ((T*)gate->gs.aval)[i] << " = " << (UINT64_T) input[i] << " - " <<
 									(UINT64_T) m_vInputShareSndBuf.Get<T>(m_nInputShareSndCtr) << ", " << m_nTypeBitMask <<
@@ -420,11 +567,12 @@ void ArithSharing<T>::EvaluateCONVGate(GATE* gate) {
 #ifdef DEBUGARITH
 	cout << "Values of B2A gates with id " << ((((uint64_t) gate)-((uint64_t)m_pGates))/sizeof(GATE)) << ": ";
 #endif
+	//the Boolean shares of the parents, which are extracted from the keys of Yao parents
+	vector<UGATE_T*> parentvals(nparents);
 	for (uint32_t i = 0; i < nparents; i++) {
-		if (m_pGates[parentids[i]].context == S_YAO)
-			cerr << "can't convert from yao representation directly into arithmetic" << endl;
+		parentvals[i] = GetConvParentBits(parentids[i]);
 #ifdef DEBUGARITH
-		cout << (uint32_t) m_pGates[parentids[i]].gs.val[0];
+		cout << (uint32_t) parentvals[i][0];
 #endif
 
 	}
@@ -434,6 +582,7 @@ void ArithSharing<T>::EvaluateCONVGate(GATE* gate) {
 #endif
 
 	m_vCONVGates.push_back(gate);
+	m_vCONVParentVals.push_back(parentvals);
 	if (m_eRole == SERVER) {
 		m_nConvShareRcvCtr += gate->nvals;
 	} else {
@@ -444,7 +593,7 @@ void ArithSharing<T>::EvaluateCONVGate(GATE* gate) {
 				m_nConvShareSndCtr * sizeof(T), sizeof(T) * gate->nvals);
 		for (uint32_t i = 0, ctr = m_nConvShareSndCtr*sizeof(T)*8; i < nparents; i++, ctr += gate->nvals) {
 			//XOR the choice bits and the current values of the gate and write into the snd buffer
-			m_vConvShareSndBuf.XORBits((BYTE*) m_pGates[parentids[i]].gs.val, ctr, gate->nvals);
+			m_vConvShareSndBuf.XORBits((BYTE*) parentvals[i], ctr, gate->nvals);
 		}
 #ifdef DEBUGARITH
 		cout << "Conversion shares: ";
@@ -454,6 +603,61 @@ void ArithSharing<T>::EvaluateCONVGate(GATE* gate) {
 	}
 }
 
+template<typename T>
+BOOL ArithSharing<T>::IsYaoGarbler(e_sharing context) {
+	return (context == S_YAO && m_eRole == SERVER) || (context == S_YAO_REV && m_eRole == CLIENT);
+}
+
+template<typename T>
+BOOL ArithSharing<T>::IsY2AGate(GATE* gate) {
+	//the conversion gates that are predicted by MixedCircuit have no parents in the circuit and are estimated as B2A
+	if (gate->ingates.ningates == 0 || gate->ingates.inputs.parents == NULL)
+		return FALSE;
+	e_sharing context = m_pGates[gate->ingates.inputs.parents[0]].context;
+	return context == S_YAO || context == S_YAO_REV;
+}
+
+template<typename T>
+UGATE_T* ArithSharing<T>::GetConvParentBits(uint32_t parentid) {
+	GATE* parent = m_pGates + parentid;
+	if (parent->context != S_YAO && parent->context != S_YAO_REV)
+		return parent->gs.val;
+
+	//Y2A: as for a Y2B gate, the Boolean share of the garbler is the permutation bit and the share of the evaluator is
+	//the least significant bit of its key
+	UGATE_T* bits = (UGATE_T*) calloc(ceil_divide(parent->nvals, GATE_T_BITS), sizeof(UGATE_T));
+	if (IsYaoGarbler(parent->context)) {
+		for (uint32_t k = 0; k < parent->nvals; k++)
+			bits[k / GATE_T_BITS] |= ((UGATE_T) parent->gs.yinput.pi[k]) << (k % GATE_T_BITS);
+	} else {
+		uint32_t keybytes = m_cCrypto->get_seclvl().symbits / 8;
+		for (uint32_t k = 0; k < parent->nvals; k++)
+			bits[k / GATE_T_BITS] |= ((UGATE_T) (parent->gs.yval[(k + 1) * keybytes - 1] & 0x01)) << (k % GATE_T_BITS);
+	}
+	return bits;
+}
+
+template<typename T>
+void ArithSharing<T>::ReleaseConvParent(uint32_t parentid, UGATE_T* bits) {
+	GATE* parent = m_pGates + parentid;
+	if (parent->context != S_YAO && parent->context != S_YAO_REV) {
+		UsedGate(parentid);
+		return;
+	}
+
+	free(bits);
+	//free the keys of the Yao gate like the Yao sharing would
+	if (!__sync_sub_and_fetch(&parent->nused, 1)) {
+		if (IsYaoGarbler(parent->context)) {
+			free(parent->gs.yinput.outKey);
+			free(parent->gs.yinput.pi);
+		} else {
+			free(parent->gs.yval);
+		}
+		parent->instantiated = false;
+	}
+}
+
 template<typename T>
 void ArithSharing<T>::ReconstructValue(GATE* gate) {
 	uint32_t parentid = gate->ingates.inputs.parent;
@@ -473,15 +677,18 @@ void ArithSharing<T>::SelectiveOpen(GATE* gate) {
 	uint32_t idleft = gate->ingates.inputs.twin.left;
 	uint32_t idright = gate->ingates.inputs.twin.right;
 
+	//a dot product gate requires one MT for each of the dotlen products that are summed up per value
+	uint32_t nmts = gate->type == G_DOT ? gate->nvals * gate->gs.dot.len : gate->nvals;
+
 	T d, e, x, y, a, b;
-	for (uint32_t i = 0; i < gate->nvals; i++, m_vMTIdx[0]++) {
+	for (uint32_t i = 0; i < nmts; i++, m_vMTIdx[0]++) {
 		a = m_vD_snd[0].Get<T>(m_vMTIdx[0]);
 		x = ((T*) m_pGates[idleft].gs.aval)[i];
-		d = MOD_SUB(x, a, m_nTypeBitMask); //a > x ? m_nTypeBitMask - (a - 1) + x : x - a;
+		d = m_nModulus ? SubMod(x, a) : MOD_SUB(x, a, m_nTypeBitMask); //a > x ? m_nTypeBitMask - (a - 1) + x : x - a;
 		m_vD_snd[0].Set<T>(d, m_vMTIdx[0]);
 		b = m_vE_snd[0].Get<T>(m_vMTIdx[0]);
 		y = ((T*) m_pGates[idright].gs.aval)[i];
-		e = MOD_SUB(y, b, m_nTypeBitMask); //b > y ? m_nTypeBitMask - (b - 1) + y : y - b;
+		e = m_nModulus ? SubMod(y, b) : MOD_SUB(y, b, m_nTypeBitMask); //b > y ? m_nTypeBitMask - (b - 1) + y : y - b;
 		m_vE_snd[0].Set<T>(e, m_vMTIdx[0]);
 	}
 	m_vMULGates.push_back(gate);
@@ -509,6 +716,7 @@ void ArithSharing<T>::FinishCircuitLayer(uint32_t depth) {
 
 	EvaluateMTs();
 	EvaluateMULGate();
+	EvaluateMatMulGates();
 	AssignInputShares();
 	AssignOutputShares();
 	AssignConversionShares();
@@ -518,53 +726,278 @@ void ArithSharing<T>::FinishCircuitLayer(uint32_t depth) {
 
 template<typename T>
 void ArithSharing<T>::EvaluateMTs() {
+	if (m_nModulus) {
+		EvaluateFieldMTs();
+		return;
+	}
 
 	uint32_t startid = m_vMTStartIdx[0];
 	uint32_t endid = m_vMTIdx[0];
 
-	T a, b, c, dsnd, esnd, drcv, ercv, e, d, tempres;
+	//the MTs are stored as arrays of T, which allows the compiler to vectorize the loop
+	T* a = (T*) m_vA[0].GetArr();
+	T* b = (T*) m_vB[0].GetArr();
+	T* c = (T*) m_vC[0].GetArr();
+	T* dsnd = (T*) m_vD_snd[0].GetArr();
+	T* esnd = (T*) m_vE_snd[0].GetArr();
+	T* drcv = (T*) m_vD_rcv[0].GetArr();
+	T* ercv = (T*) m_vE_rcv[0].GetArr();
+	T* res = (T*) m_vResA[0].GetArr();
+	//only the server adds d * e
+	T isserver = (m_eRole == SERVER);
+
+	T e, d;
 	for (uint32_t i = startid; i < endid; i++) {
-		a = m_vA[0].Get<T>(i);
-		b = m_vB[0].Get<T>(i);
-		c = m_vC[0].Get<T>(i);
-
-		dsnd = m_vD_snd[0].Get<T>(i);
-		esnd = m_vE_snd[0].Get<T>(i);
+		d = dsnd[i] + drcv[i];
+		e = esnd[i] + ercv[i];
 
-		drcv = m_vD_rcv[0].Get<T>(i);
-		ercv = m_vE_rcv[0].Get<T>(i);
-
-		d = (dsnd + drcv) & m_nTypeBitMask;
-		e = (esnd + ercv) & m_nTypeBitMask;
-
-		tempres = ((a * e) + (b * d) + c) & m_nTypeBitMask;
-
-		if (m_eRole == SERVER) {
-			tempres = (tempres + (d * e)) & m_nTypeBitMask;
-		}
+		res[i] = (a[i] * e) + (b[i] * d) + c[i] + isserver * (d * e);
 #ifdef DEBUGARITH
-		cout << "mt result = " << (UINT64_T) tempres << " = ((" << (UINT64_T) a << " * " << (UINT64_T) e << " ) + ( " << (UINT64_T) b
-		<< " * " << (UINT64_T) d << ") + " << (UINT64_T) c << ")" << endl;
+		cout << "mt result = " << (UINT64_T) res[i] << " = ((" << (UINT64_T) a[i] << " * " << (UINT64_T) e << " ) + ( " << (UINT64_T) b[i]
+		<< " * " << (UINT64_T) d << ") + " << (UINT64_T) c[i] << ")" << endl;
 #endif
-		m_vResA[0].Set<T>(tempres, i);
+	}
+}
+
+template<typename T>
+void ArithSharing<T>::EvaluateFieldMTs() {
+	UINT64_T* a = (UINT64_T*) m_vA[0].GetArr();
+	UINT64_T* b = (UINT64_T*) m_vB[0].GetArr();
+	UINT64_T* c = (UINT64_T*) m_vC[0].GetArr();
+	UINT64_T* dsnd = (UINT64_T*) m_vD_snd[0].GetArr();
+	UINT64_T* esnd = (UINT64_T*) m_vE_snd[0].GetArr();
+	UINT64_T* drcv = (UINT64_T*) m_vD_rcv[0].GetArr();
+	UINT64_T* ercv = (UINT64_T*) m_vE_rcv[0].GetArr();
+	UINT64_T* res = (UINT64_T*) m_vResA[0].GetArr();
+	//only the server adds d * e, multiplying by a 0 / 1 mask keeps the loop free of branches
+	UINT64_T isserver = (m_eRole == SERVER);
+
+	UINT64_T e, d;
+	for (uint32_t i = m_vMTStartIdx[0]; i < m_vMTIdx[0]; i++) {
+		d = AddMod(dsnd[i], drcv[i]);
+		e = AddMod(esnd[i], ercv[i]);
+		//a * e + b * d + isserver * d * e < 3p^2 < p * 2^64 allows a single Montgomery reduction for the sum
+		res[i] = AddMod(c[i], MontReduce((UINT128_T) a[i] * e + (UINT128_T) b[i] * d + (UINT128_T) (isserver * d) * e));
 	}
 }
 
 template<typename T>
 void ArithSharing<T>::EvaluateMULGate() {
 	GATE* gate;
+	T* res = (T*) m_vResA[0].GetArr();
 	for (uint32_t i = 0, idx = m_vMTStartIdx[0]; i < m_vMULGates.size() && idx < m_vMTIdx[0]; i++) {
 		gate = m_vMULGates[i];
-		InstantiateGate(gate);
-
-		for (uint32_t j = 0; j < gate->nvals; j++, idx++) {
-			((T*) gate->gs.aval)[j] = m_vResA[0].Get<T>(idx);
+		if (gate->type == G_DOT) {
+			//accumulate the products of each dot product directly into the output value
+			uint32_t dotlen = gate->gs.dot.len;
+			uint32_t truncbits = gate->gs.dot.truncbits;
+			InstantiateGate(gate);
+			T* out = (T*) gate->gs.aval;
+			for (uint32_t j = 0; j < gate->nvals; j++) {
+				T sum = 0;
+				if (m_nModulus) {
+					for (uint32_t k = 0; k < dotlen; k++, idx++)
+						sum = AddMod(sum, res[idx]);
+				} else for (uint32_t k = 0; k < dotlen; k++, idx++) {
+					sum += res[idx];
+				}
+				out[j] = sum;
+			}
+			if (truncbits > 0)
+				TruncShares(out, gate->nvals, truncbits);
+		} else {
+			InstantiateGate(gate);
+			memcpy(gate->gs.aval, res + idx, gate->nvals * sizeof(T));
+			idx += gate->nvals;
 		}
 	}
 
 	m_vMTStartIdx[0] = m_vMTIdx[0];
 }
 
+template<typename T>
+void ArithSharing<T>::InitMatMulTriples(ABYSetup* setup) {
+	//the matrix triples are generated from OTs, also if the MTs are generated using homomorphic encryption
+	for (uint32_t i = 0; i < m_cArithCircuit->GetNumInteractiveLayers(); i++) {
+		deque<uint32_t> interactiveops = m_cArithCircuit->GetInteractiveQueueOnLvl(i);
+		for (uint32_t j = 0; j < interactiveops.size(); j++) {
+			GATE* gate = m_pGates + interactiveops[j];
+			if (gate->type != G_MATMUL)
+				continue;
+
+			matmul_triple* tr = new matmul_triple;
+			uint32_t n = tr->n = gate->gs.mm.n;
+			uint32_t m = tr->m = gate->gs.mm.m;
+			uint32_t k = tr->k = gate->gs.mm.k;
+
+			tr->A.Create(n * m, m_nTypeBitLen, m_cCrypto);
+			tr->B.Create(m * k, m_nTypeBitLen, m_cCrypto);
+			tr->C.Create(n * k, m_nTypeBitLen);
+
+			//the OT for element (r, t) of A carries row t of B
+			tr->Bexp.Create((uint64_t) n * m * k, m_nTypeBitLen);
+			for (uint32_t r = 0; r < n; r++) {
+				for (uint32_t t = 0; t < m; t++) {
+					memcpy(tr->Bexp.GetArr() + ((uint64_t) r * m + t) * k * sizeof(T), tr->B.GetArr() + (uint64_t) t * k * sizeof(T), k * sizeof(T));
+				}
+			}
+			tr->S.Create((uint64_t) n * m * k, m_nTypeBitLen);
+			tr->R.Create((uint64_t) n * m * k, m_nTypeBitLen);
+
+			tr->D_snd.Create(n * m, m_nTypeBitLen);
+			tr->E_snd.Create(m * k, m_nTypeBitLen);
+			tr->D_rcv.Create(n * m, m_nTypeBitLen);
+			tr->E_rcv.Create(m * k, m_nTypeBitLen);
+			tr->gate = NULL;
+
+			tr->mskfct = new ArithMatMulMasking<T>(k, &(tr->Bexp));
+			for (uint32_t p = 0; p < 2; p++) {
+				IKNP_OTTask* task = (IKNP_OTTask*) malloc(sizeof(IKNP_OTTask));
+				task->bitlen = k * m_nTypeBitLen;
+				task->snd_flavor = Snd_C_OT;
+				task->rec_flavor = Rec_OT;
+				task->numOTs = n * m * m_nTypeBitLen;
+				task->mskfct = tr->mskfct;
+				if ((m_eRole ^ p) == SERVER) {
+					task->pval.sndval.X0 = &(tr->S);
+					task->pval.sndval.X1 = &(tr->S);
+				} else {
+					task->pval.rcvval.C = &(tr->A);
+					task->pval.rcvval.R = &(tr->R);
+				}
+#ifndef BATCH
+				cout << "Adding a OT task which is supposed to perform " << task->numOTs << " OTs on " << task->bitlen << " bits for ArithMatMul" << endl;
+#endif
+				setup->AddOTTask(task, p);
+			}
+			m_vMatMulTriples.push_back(tr);
+		}
+	}
+}
+
+template<typename T>
+void ArithSharing<T>::ComputeMatMulTriples() {
+	for (uint32_t i = 0; i < m_vMatMulTriples.size(); i++) {
+		matmul_triple* tr = m_vMatMulTriples[i];
+		T* c = (T*) tr->C.GetArr();
+		T* s = (T*) tr->S.GetArr();
+		T* r = (T*) tr->R.GetArr();
+
+		//C = A_p * B_p + shares of the cross products A_p * B_(1-p) and A_(1-p) * B_p
+		MatMulAdd(c, (T*) tr->A.GetArr(), (T*) tr->B.GetArr(), tr->n, tr->m, tr->k);
+		for (uint32_t row = 0; row < tr->n; row++) {
+			for (uint32_t t = 0; t < tr->m; t++) {
+				for (uint32_t col = 0, idx = (row * tr->m + t) * tr->k; col < tr->k; col++, idx++) {
+					c[row * tr->k + col] += s[idx] + r[idx];
+				}
+			}
+		}
+
+		tr->Bexp.delCBitVector();
+		tr->S.delCBitVector();
+		tr->R.delCBitVector();
+		delete tr->mskfct;
+		tr->mskfct = NULL;
+	}
+}
+
+template<typename T>
+void ArithSharing<T>::SelectiveOpenMatrix(GATE* gate) {
+	uint32_t idleft = gate->ingates.inputs.twin.left;
+	uint32_t idright = gate->ingates.inputs.twin.right;
+	matmul_triple* tr = m_vMatMulTriples[m_nMatMulIdx++];
+
+	T* x = (T*) m_pGates[idleft].gs.aval;
+	T* a = (T*) tr->A.GetArr();
+	T* d = (T*) tr->D_snd.GetArr();
+	for (uint32_t i = 0; i < tr->n * tr->m; i++) {
+		d[i] = MOD_SUB(x[i], a[i], m_nTypeBitMask);
+	}
+
+	T* y = (T*) m_pGates[idright].gs.aval;
+	T* b = (T*) tr->B.GetArr();
+	T* e = (T*) tr->E_snd.GetArr();
+	for (uint32_t i = 0; i < tr->m * tr->k; i++) {
+		e[i] = MOD_SUB(y[i], b[i], m_nTypeBitMask);
+	}
+	tr->gate = gate;
+
+	UsedGate(idleft);
+	UsedGate(idright);
+}
+
+template<typename T>
+void ArithSharing<T>::EvaluateMatMulGates() {
+	for (uint32_t i = m_nMatMulStartIdx; i < m_nMatMulIdx; i++) {
+		matmul_triple* tr = m_vMatMulTriples[i];
+		T* d = (T*) tr->D_snd.GetArr();
+		T* e = (T*) tr->E_snd.GetArr();
+		T* drcv = (T*) tr->D_rcv.GetArr();
+		T* ercv = (T*) tr->E_rcv.GetArr();
+
+		for (uint32_t j = 0; j < tr->n * tr->m; j++)
+			d[j] += drcv[j];
+		for (uint32_t j = 0; j < tr->m * tr->k; j++)
+			e[j] += ercv[j];
+
+		InstantiateGate(tr->gate);
+		T* z = (T*) tr->gate->gs.aval;
+
+		//Z = C + A * E + D * B (+ D * E for the server)
+		memcpy(z, tr->C.GetArr(), tr->n * tr->k * sizeof(T));
+		MatMulAdd(z, (T*) tr->A.GetArr(), e, tr->n, tr->m, tr->k);
+		MatMulAdd(z, d, (T*) tr->B.GetArr(), tr->n, tr->m, tr->k);
+		if (m_eRole == SERVER) {
+			MatMulAdd(z, d, e, tr->n, tr->m, tr->k);
+		}
+	}
+
+	m_nMatMulStartIdx = m_nMatMulIdx;
+}
+
+template<typename T>
+void ArithSharing<T>::DeleteMatMulTriples() {
+	for (uint32_t i = 0; i < m_vMatMulTriples.size(); i++) {
+		matmul_triple* tr = m_vMatMulTriples[i];
+		tr->A.delCBitVector();
+		tr->B.delCBitVector();
+		tr->C.delCBitVector();
+		tr->Bexp.delCBitVector();
+		tr->S.delCBitVector();
+		tr->R.delCBitVector();
+		tr->D_snd.delCBitVector();
+		tr->E_snd.delCBitVector();
+		tr->D_rcv.delCBitVector();
+		tr->E_rcv.delCBitVector();
+		if (tr->mskfct)
+			delete tr->mskfct;
+		delete tr;
+	}
+	m_vMatMulTriples.clear();
+	m_nMatMulStartIdx = 0;
+	m_nMatMulIdx = 0;
+}
+
+template<typename T>
+void ArithSharing<T>::MatMulAdd(T* c, const T* a, const T* b, uint32_t n, uint32_t m, uint32_t k) {
+	for (uint32_t t0 = 0; t0 < m; t0 += MATMUL_BLOCK_SIZE) {
+		uint32_t tmax = min(t0 + MATMUL_BLOCK_SIZE, m);
+		for (uint32_t j0 = 0; j0 < k; j0 += MATMUL_BLOCK_SIZE) {
+			uint32_t jmax = min(j0 + MATMUL_BLOCK_SIZE, k);
+			for (uint32_t i = 0; i < n; i++) {
+				T* crow = c + (uint64_t) i * k;
+				for (uint32_t t = t0; t < tmax; t++) {
+					T aval = a[(uint64_t) i * m + t];
+					const T* brow = b + (uint64_t) t * k;
+					for (uint32_t j = j0; j < jmax; j++) {
+						crow[j] += aval * brow[j];
+					}
+				}
+			}
+		}
+	}
+}
+
 template<typename T>
 void ArithSharing<T>::AssignInputShares() {
 	GATE* gate;
@@ -590,7 +1023,10 @@ void ArithSharing<T>::AssignOutputShares() {
 		InstantiateGate(gate);
 
 		for (uint32_t j = 0; j < gate->nvals; j++, rcvshareidx++) {
-			((T*) gate->gs.val)[j] = ((T*) m_pGates[parentid].gs.aval)[j] + m_vOutputShareRcvBuf.Get<T>(rcvshareidx) & m_nTypeBitMask;
+			if (m_nModulus)
+				((T*) gate->gs.val)[j] = MontReduce(AddMod(((T*) m_pGates[parentid].gs.aval)[j], m_vOutputShareRcvBuf.Get<T>(rcvshareidx)));
+			else
+				((T*) gate->gs.val)[j] = ((T*) m_pGates[parentid].gs.aval)[j] + m_vOutputShareRcvBuf.Get<T>(rcvshareidx) & m_nTypeBitMask;
 #ifdef DEBUGARITH
 			cout << "Received output share: " << m_vOutputShareRcvBuf.Get<T>(rcvshareidx) << endl;
 			cout << "Computed output: " << (UINT64_T) ((T*)gate->gs.aval)[j] << " = " << (UINT64_T) ((T*)m_pGates[parentid].gs.aval)[j] << " + " << (UINT64_T) m_vOutputShareRcvBuf.Get<T>(rcvshareidx) << endl;
@@ -642,10 +1078,10 @@ void ArithSharing<T>::AssignServerConversionShares() {
 		for (uint32_t j = 0; j < nparents; j++) {
 			for (uint32_t k = 0; k < m_pGates[parentids[j]].nvals; k++, lctr++, gctr++) {
 				clientpermbit = m_vConvShareRcvBuf.GetBitNoMask(lctr);
-				cor = (m_pGates[parentids[j]].gs.val[k / GATE_T_BITS] >> (k % GATE_T_BITS)) & 0x01;
+				cor = (m_vCONVParentVals[i][j][k / GATE_T_BITS] >> (k % GATE_T_BITS)) & 0x01;
 
-				tmpa = (m_nTypeBitMask - (m_vConversionRandomness.Get<T>(gctr) - 1)) + (cor) * (1L << j);
-				tmpb = (m_nTypeBitMask - (m_vConversionRandomness.Get<T>(gctr) - 1)) + (!cor) * (1L << j);
+				tmpa = (m_nTypeBitMask - (m_vConversionRandomness.Get<T>(gctr) - 1)) + (cor) * ((T) 1 << j);
+				tmpb = (m_nTypeBitMask - (m_vConversionRandomness.Get<T>(gctr) - 1)) + (!cor) * ((T) 1 << j);
 
 				tmpa = m_vConversionMasks[clientpermbit].Get<T>(gctr) ^ tmpa;
 				tmpb = m_vConversionMasks[!clientpermbit].Get<T>(gctr) ^ tmpb;
@@ -663,7 +1099,7 @@ void ArithSharing<T>::AssignServerConversionShares() {
 				m_vConvShareSndBuf.Set<T>(tmpa, 2 * lctr);
 				m_vConvShareSndBuf.Set<T>(tmpb, 2 * lctr + 1);
 			}
-			UsedGate(parentids[j]);
+			ReleaseConvParent(parentids[j], m_vCONVParentVals[i][j]);
 		}
 		InstantiateGate(gate);
 #ifdef DEBUGARITH
@@ -684,6 +1120,7 @@ void ArithSharing<T>::AssignServerConversionShares() {
 	}
 	free(tmpsum);
 	m_vCONVGates.clear();
+	m_vCONVParentVals.clear();
 }
 
 template<typename T>
@@ -706,16 +1143,16 @@ void ArithSharing<T>::AssignClientConversionShares() {
 
 		for (uint32_t j = 0; j < nparents; j++) {
 			for (uint32_t k = 0; k < m_pGates[parentids[j]].nvals; k++, lctr++, gctr++) {
-				rcv = m_vConvShareRcvBuf.Get<T>((2 * lctr + ((m_pGates[parentids[j]].gs.val[k / GATE_T_BITS] >> (k % GATE_T_BITS)) & 0x01)) * m_nTypeBitLen, m_nTypeBitLen);
+				rcv = m_vConvShareRcvBuf.Get<T>((2 * lctr + ((m_vCONVParentVals[i][j][k / GATE_T_BITS] >> (k % GATE_T_BITS)) & 0x01)) * m_nTypeBitLen, m_nTypeBitLen);
 				mask = m_vConversionMasks[1].Get<T>(gctr * m_nTypeBitLen, m_nTypeBitLen);
 				tmp = rcv ^ mask;
 				tmpsum[k] += tmp;
 #ifdef DEBUGARITH
 				cout << "Gate " << i << ", " << j << ", " << k << ": " << tmp << " = " << rcv << " ^ " << mask << ", tmpsum = " << tmpsum[k] << ", " <<
-						((uint32_t) ((m_pGates[parentids[j]].gs.val[k / GATE_T_BITS] >> (k % GATE_T_BITS)) & 0x01)) << ", gctr = " << gctr << endl;
+						((uint32_t) ((m_vCONVParentVals[i][j][k / GATE_T_BITS] >> (k % GATE_T_BITS)) & 0x01)) << ", gctr = " << gctr << endl;
 #endif
 			}
-			UsedGate(parentids[j]);
+			ReleaseConvParent(parentids[j], m_vCONVParentVals[i][j]);
 		}
 
 		InstantiateGate(gate);
@@ -736,6 +1173,7 @@ void ArithSharing<T>::AssignClientConversionShares() {
 	}
 	free(tmpsum);
 	m_vCONVGates.clear();
+	m_vCONVParentVals.clear();
 }
 
 template<typename T>
@@ -744,7 +1182,7 @@ void ArithSharing<T>::EvaluateINVGate(GATE* gate) {
 	InstantiateGate(gate);
 	for (uint32_t i = 0; i < gate->nvals; i++) {
 //			((T*) gate->gs.aval)[i] = MOD_SUB(0, ((T*) m_pGates[parentid].gs.aval)[i], m_nTypeBitMask);//0 - ((T*) m_pGates[parentid].gs.aval)[i];
-		((T*) gate->gs.aval)[i] = -((T*) m_pGates[parentid].gs.aval)[i];
+		((T*) gate->gs.aval)[i] = m_nModulus ? SubMod(0, ((T*) m_pGates[parentid].gs.aval)[i]) : -((T*) m_pGates[parentid].gs.aval)[i];
 	}
 	UsedGate(parentid);
 }
@@ -783,6 +1221,15 @@ void ArithSharing<T>::GetDataToSend(vector<BYTE*>& sendbuf, vector<uint64_t>& sn
 		sndbytes.push_back(mtbytelen);
 	}
 
+	//Selective openings of the matrix multiplications
+	for (uint32_t i = m_nMatMulStartIdx; i < m_nMatMulIdx; i++) {
+		matmul_triple* tr = m_vMatMulTriples[i];
+		sendbuf.push_back(tr->D_snd.GetArr());
+		sndbytes.push_back((uint64_t) tr->n * tr->m * sizeof(T));
+		sendbuf.push_back(tr->E_snd.GetArr());
+		sndbytes.push_back((uint64_t) tr->m * tr->k * sizeof(T));
+	}
+
 #ifdef DEBUGARITH
 	if(m_nInputShareSndCtr > 0) {
 		cout << "Sending " << m_nInputShareSndCtr << " Input shares : ";
@@ -847,6 +1294,15 @@ void ArithSharing<T>::GetBuffersToReceive(vector<BYTE*>& rcvbuf, vector<uint64_t
 		rcvbytes.push_back(mtbytelen);
 	}
 
+	//Selective openings of the matrix multiplications
+	for (uint32_t i = m_nMatMulStartIdx; i < m_nMatMulIdx; i++) {
+		matmul_triple* tr = m_vMatMulTriples[i];
+		rcvbuf.push_back(tr->D_rcv.GetArr());
+		rcvbytes.push_back((uint64_t) tr->n * tr->m * sizeof(T));
+		rcvbuf.push_back(tr->E_rcv.GetArr());
+		rcvbytes.push_back((uint64_t) tr->m * tr->k * sizeof(T));
+	}
+
 #ifdef DEBUGARITH
 	if(mtbytelen > 0) {
 		cout << "Receiving 2* " << (m_vMTIdx[0] - m_vMTStartIdx[0]) << " MTs" << endl;
@@ -866,10 +1322,9 @@ void ArithSharing<T>::InstantiateGate(GATE* gate) {
 
 template<typename T>
 void ArithSharing<T>::UsedGate(uint32_t gateid) {
-	//Decrease the number of further uses of the gate
-	m_pGates[gateid].nused--;
+	//Decrease the number of further uses of the gate, atomically since the children of a gate may be evaluated concurrently by different sharings
 	//If the gate is needed in another subsequent gate, delete it
-	if (!m_pGates[gateid].nused) {
+	if (!__sync_sub_and_fetch(&m_pGates[gateid].nused, 1)) {
 		free(((T*) m_pGates[gateid].gs.val));
 	}
 }
@@ -1022,14 +1477,12 @@ uint32_t ArithSharing<T>::AssignInput(CBitVector& inputvals) {
 	uint32_t ninvals = m_cArithCircuit->GetNumInputBitsForParty(m_eRole) / m_nTypeBitLen;
 	inputvals.Create(ninvals, m_nTypeBitLen, m_cCrypto);
 
-	uint32_t typebytes = sizeof(UGATE_T) / sizeof(T);
-
 	GATE* gate;
 	for (uint32_t i = 0, inbitctr = 0; i < myingates.size(); i++) {
 		gate = m_pGates + myingates[i];
 		if (!gate->instantiated) {
 
-			UGATE_T* inval = (UGATE_T*) calloc(ceil_divide(gate->nvals, typebytes), sizeof(UGATE_T));
+			UGATE_T* inval = (UGATE_T*) calloc(ceil_divide(gate->nvals * sizeof(T), sizeof(UGATE_T)), sizeof(UGATE_T));
 
 			for (uint32_t j = 0; j < gate->nvals; j++) {
 				((T*) inval)[j] = inputvals.Get<T>(inbitctr);
@@ -1060,6 +1513,67 @@ uint32_t ArithSharing<T>::GetOutput(CBitVector& out) {
 	return outbits;
 }
 
+template<typename T>
+void ArithSharing<T>::EstimateGateCost(GATE* gate, layer_cost* cost) {
+	uint64_t symbits = m_cCrypto->get_seclvl().symbits;
+	uint64_t nbits = (uint64_t) gate->nvals * m_nTypeBitLen;
+	//the MT OTs of a field sharing transfer 128-bit strings
+	uint64_t otbits = m_nModulus ? sizeof(UINT128_T) * 8 : m_nTypeBitLen;
+
+	switch (gate->type) {
+	case G_NON_LIN:
+		//one MT per value from m_nTypeBitLen correlated OTs in each direction (the OT-based MT generation is assumed),
+		//in the online phase both parties send d and e
+		cost->nonlinops += gate->nvals;
+		cost->numOTs += 2 * nbits;
+		cost->setupbits += 2 * nbits * (symbits + otbits);
+		cost->onlinebits += 4 * nbits;
+		break;
+	case G_DOT:
+		//one MT per product
+		cost->nonlinops += (uint64_t) gate->nvals * gate->gs.dot.len;
+		cost->numOTs += 2 * nbits * gate->gs.dot.len;
+		cost->setupbits += 2 * nbits * gate->gs.dot.len * (symbits + otbits);
+		cost->onlinebits += 4 * nbits * gate->gs.dot.len;
+		break;
+	case G_MATMUL:
+		//one matrix triple from m_nTypeBitLen correlated OTs on rows of B per element of A in each direction, in the
+		//online phase both parties send the masked input matrices
+		cost->nonlinops += 1;
+		cost->numOTs += 2 * (uint64_t) gate->gs.mm.n * gate->gs.mm.m * m_nTypeBitLen;
+		cost->setupbits += 2 * (uint64_t) gate->gs.mm.n * gate->gs.mm.m * m_nTypeBitLen * (symbits + (uint64_t) gate->gs.mm.k * m_nTypeBitLen);
+		cost->onlinebits += 4 * ((uint64_t) gate->gs.mm.n * gate->gs.mm.m + (uint64_t) gate->gs.mm.m * gate->gs.mm.k) * m_nTypeBitLen;
+		break;
+	case G_CONV:
+		if (IsY2AGate(gate)) {
+			//Y2A: the Boolean shares are read locally from the permutation bits and keys of the Yao parents, which
+			//replaces the Y2B gate, then each extracted bit is converted with one random OT as below
+			uint64_t nconvbits = 0;
+			for (uint32_t i = 0; i < gate->ingates.ningates; i++) {
+				nconvbits += m_pGates[gate->ingates.inputs.parents[i]].nvals;
+			}
+			cost->numOTs += nconvbits;
+			cost->setupbits += nconvbits * symbits;
+			cost->onlinebits += nconvbits * (1 + 2 * m_nTypeBitLen);
+		} else {
+			//B2A: one random OT per converted bit, the client sends its permutation bits and the server two masked
+			//values per bit
+			cost->numOTs += (uint64_t) gate->nvals * gate->ingates.ningates;
+			cost->setupbits += (uint64_t) gate->nvals * gate->ingates.ningates * symbits;
+			cost->onlinebits += (uint64_t) gate->nvals * gate->ingates.ningates * (1 + 2 * m_nTypeBitLen);
+		}
+		break;
+	case G_IN:
+		cost->onlinebits += nbits;
+		break;
+	case G_OUT:
+		cost->onlinebits += nbits * (gate->gs.oshare.dst == ALL ? 2 : 1);
+		break;
+	default:
+		break;
+	}
+}
+
 template<typename T>
 void ArithSharing<T>::PrintPerformanceStatistics() {
 	cout << "Arithmetic Sharing: MULs: " << m_nMTs << " ; Depth: " << GetMaxCommunicationRounds() << endl;
@@ -1077,6 +1591,8 @@ void ArithSharing<T>::Reset() {
 	m_vInputShareGates.clear();
 	m_vOutputShareGates.clear();
 
+	DeleteMatMulTriples();
+
 	m_nInputShareSndCtr = 0;
 	m_nOutputShareSndCtr = 0;
 
@@ -1109,6 +1625,7 @@ void ArithSharing<T>::Reset() {
 	m_nConvShareRcvCtr = 0;
 
 	m_vCONVGates.clear();
+	m_vCONVParentVals.clear();
 }
 
 //The explicit instantiation part
@@ -1116,4 +1633,5 @@ template class ArithSharing<UINT8_T> ;
 template class ArithSharing<UINT16_T> ;
 template class ArithSharing<UINT32_T> ;
 template class ArithSharing<UINT64_T> ;
+template class ArithSharing<UINT128_T> ;
 
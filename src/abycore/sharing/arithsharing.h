@@ -22,8 +22,13 @@
 #include "sharing.h"
 #include <algorithm>
 #include "../circuit/arithmeticcircuits.h"
+#include "arithmatmulmasking.h"
+#include "arithfieldmtmasking.h"
 
 //#define DEBUGARITH
+
+/** Size of the square blocks in which the local matrix multiplications are computed */
+#define MATMUL_BLOCK_SIZE 64
 //#define VERIFY_ARITH_MT
 
 template<typename T>
@@ -31,10 +36,15 @@ template<typename T>
 class ArithSharing: public Sharing {
 
 public:
-	/** Constructor of the class.*/
-	ArithSharing(e_sharing context, e_role role, uint32_t sharebitlen, ABYCircuit* circuit, crypto* crypt, e_mt_gen_alg mt_alg) :
+	/**
+	 Constructor of the class.
+	 \param 	modulus 	0 for a sharing over the ring Z_{2^l}, l = sizeof(T) * 8, or an odd prime p < 2^62 for a sharing over
+	 	 	 	 	 	the field Z_p, which requires T = UINT64_T.
+	 */
+	ArithSharing(e_sharing context, e_role role, uint32_t sharebitlen, ABYCircuit* circuit, crypto* crypt, e_mt_gen_alg mt_alg, UINT64_T modulus = 0) :
 			Sharing(context, role, sharebitlen, circuit, crypt) {
 		m_eMTGenAlg = mt_alg;
+		m_nModulus = modulus;
 		Init();
 	}
 	;
@@ -77,6 +87,7 @@ public:
 		return m_nMTs;
 	}
 	;
+	void EstimateGateCost(GATE* gate, layer_cost* cost);
 
 	Circuit* GetCircuitBuildRoutine() {
 		return m_cArithCircuit;
@@ -84,7 +95,13 @@ public:
 	;
 
 	const char* sharing_type() {
-		return "Arithmetic";
+		return m_nModulus ? "Arithmetic (prime field)" : "Arithmetic";
+	}
+	;
+
+	/** Returns the prime modulus of a field sharing, or 0 for a sharing over Z_{2^l} */
+	UINT64_T GetModulus() {
+		return m_nModulus;
 	}
 	;
 
@@ -106,6 +123,27 @@ public:
 	 \param 	gate 	Object of the gate to be evaluated.
 	 */
 	void EvaluateCONVGate(GATE* gate);
+	/** Returns TRUE if this party garbles the gates of a Yao sharing with the given context */
+	BOOL IsYaoGarbler(e_sharing context);
+	/** Returns TRUE if the given conversion gate converts from Yao sharing, i.e., if it is a Y2A gate */
+	BOOL IsY2AGate(GATE* gate);
+	/**
+	 Returns the Boolean shares of the values of a parent of a conversion gate. The shares of a Yao parent are extracted
+	 from its keys into a new array.
+	 */
+	UGATE_T* GetConvParentBits(uint32_t parentid);
+	/** Marks a parent of a conversion gate as used and frees the array from GetConvParentBits() for a Yao parent */
+	void ReleaseConvParent(uint32_t parentid, UGATE_T* bits);
+	/**
+	 Evaluating Width Conversion Gate, which reduces the shares of its input of a larger bit length to T.
+	 \param 	gate 	Object of the gate to be evaluated.
+	 */
+	void EvaluateWidthConvGate(GATE* gate);
+	/**
+	 Evaluating Truncation Gate.
+	 \param 	gate 	Object of the gate to be evaluated.
+	 */
+	void EvaluateTruncGate(GATE* gate);
 
 private:
 
@@ -116,14 +154,40 @@ private:
 	uint32_t m_nMTs;
 	uint32_t m_nNumCONVs;
 
-	uint64_t m_nTypeBitMask;
+	T m_nTypeBitMask;
+
+	//In a field sharing, all shares are kept in Montgomery representation x * 2^64 mod p
+	UINT64_T m_nModulus; //the prime p, 0 in a sharing over Z_{2^l}
+	UINT64_T m_nMontInv; //-p^-1 mod 2^64
+	UINT64_T m_nMontR2; //2^128 mod p
 
 	vector<uint32_t> m_vMTStartIdx;
 	vector<uint32_t> m_vMTIdx;
 	vector<GATE*> m_vMULGates;
+
+	/** Matrix triple (A, B, C = A * B) for a G_MATMUL gate, all matrices are shared and stored row-major */
+	struct matmul_triple {
+		uint32_t n, m, k;
+		CBitVector A; //(n x m) matrix
+		CBitVector B; //(m x k) matrix
+		CBitVector C; //(n x k) matrix
+		CBitVector Bexp; //rows of B repeated for each row of A, which are the correlations as OT sender
+		CBitVector S; //(n * m x k) outputs as OT sender
+		CBitVector R; //(n * m x k) outputs as OT receiver
+		CBitVector D_snd; //masked (n x m) input X - A
+		CBitVector E_snd; //masked (m x k) input Y - B
+		CBitVector D_rcv;
+		CBitVector E_rcv;
+		GATE* gate;
+		ArithMatMulMasking<T>* mskfct;
+	};
+	vector<matmul_triple*> m_vMatMulTriples;
+	uint32_t m_nMatMulStartIdx; //first matrix triple that is opened in the current layer
+	uint32_t m_nMatMulIdx; //next matrix triple to open
 	vector<GATE*> m_vInputShareGates;
 	vector<GATE*> m_vOutputShareGates;
 	vector<GATE*> m_vCONVGates;
+	vector<vector<UGATE_T*> > m_vCONVParentVals; //Boolean shares of the parents of each gate in m_vCONVGates
 
 	uint32_t m_nInputShareSndCtr;
 	uint32_t m_nOutputShareSndCtr;
@@ -187,6 +251,77 @@ private:
 	 Method for Evaluating MTs.
 	 */
 	void EvaluateMTs();
+
+	/**
+	 Method for generating the matrix triples of all G_MATMUL gates. For each gate, the cross products A_0 * B_1 and
+	 A_1 * B_0 are computed from m_nTypeBitLen correlated OTs per element of A, where each OT carries a row of B.
+	 */
+	void InitMatMulTriples(ABYSetup* setup);
+	/**
+	 Method for computing the matrix triples from the OT outputs.
+	 */
+	void ComputeMatMulTriples();
+	/**
+	 Method for selective open of the masked input matrices of a G_MATMUL gate.
+	 \param gate 	Gate Object
+	 */
+	void SelectiveOpenMatrix(GATE* gate);
+	/**
+	 Method for evaluating the G_MATMUL gates of the current layer from the opened matrices.
+	 */
+	void EvaluateMatMulGates();
+	/**
+	 Method for freeing all matrix triples.
+	 */
+	void DeleteMatMulTriples();
+	/**
+	 Add the product of the row-major (n x m) matrix a and (m x k) matrix b to the (n x k) matrix c. The product is
+	 computed in blocks of MATMUL_BLOCK_SIZE, such that the rows of a block of b remain in the cache.
+	 */
+	static void MatMulAdd(T* c, const T* a, const T* b, uint32_t n, uint32_t m, uint32_t k);
+	/** Montgomery reduction x * 2^-64 mod p for x < p * 2^64 */
+	inline UINT64_T MontReduce(UINT128_T x) {
+		UINT64_T m = (UINT64_T) x * m_nMontInv;
+		UINT64_T t = (UINT64_T) ((x + (UINT128_T) m * m_nModulus) >> 64);
+		return t >= m_nModulus ? t - m_nModulus : t;
+	}
+	;
+	/** Montgomery product a * b * 2^-64 mod p */
+	inline UINT64_T MontMul(UINT64_T a, UINT64_T b) {
+		return MontReduce((UINT128_T) a * b);
+	}
+	;
+	/** Converts an arbitrary 64-bit value into Montgomery representation */
+	inline UINT64_T ToMont(UINT64_T x) {
+		return MontMul(x, m_nMontR2);
+	}
+	;
+	inline UINT64_T AddMod(UINT64_T a, UINT64_T b) {
+		UINT64_T s = a + b;
+		return s >= m_nModulus ? s - m_nModulus : s;
+	}
+	;
+	inline UINT64_T SubMod(UINT64_T a, UINT64_T b) {
+		return a >= b ? a - b : a + m_nModulus - b;
+	}
+	;
+	/**
+	 Creates nvals random shares in vec. In a field sharing, each share is reduced from 128 random bits, such that it is
+	 statistically close to uniform in Z_p.
+	 */
+	void CreateRandomShares(CBitVector& vec, uint32_t nvals);
+	/** Computes the multiplication triples of a field sharing from the OT outputs and converts them to Montgomery representation */
+	void ComputeFieldMTs();
+	/** Field sharing variant of EvaluateMTs() */
+	void EvaluateFieldMTs();
+	/** Locally truncates the nvals fixed-point shares in vals by truncbits bits, where 0 < truncbits < m_nTypeBitLen */
+	void TruncShares(T* vals, uint32_t nvals, uint32_t truncbits);
+	/** Reduce the nvals shares in src to T */
+	template<typename S> static void ReduceShares(T* dst, const S* src, uint32_t nvals) {
+		for (uint32_t i = 0; i < nvals; i++)
+			dst[i] = (T) src[i];
+	}
+	;
 	/**
 	 Method for evaluating Add Gate using the gate object.
 	 \param 	gate 	Gate Object.
@@ -559,12 +559,22 @@ inline void BoolSharing::EvaluateINVGate(uint32_t gateid) {
 inline void BoolSharing::EvaluateCONVGate(uint32_t gateid) {
 	GATE* gate = m_pGates + gateid;
 	uint32_t parentid = gate->ingates.inputs.parents[0];
-	if (m_pGates[parentid].context == S_ARITH)
-		cerr << "can't convert from arithmetic representation directly into Boolean" << endl;
+	GATE* parent = m_pGates + parentid;
+	//the position of the bit and the owner of the share have to be read before the gate is instantiated
+	uint32_t pos = gate->gs.pos;
 	InstantiateGate(gate);
 
 	memset(gate->gs.val, 0, ceil_divide(gate->nvals, 8));
-	if (m_eRole == SERVER) {
+	if (parent->context == S_ARITH) {
+		//the owner of the arithmetic share inputs its bit at position pos >> 1 as Boolean share, the other party inputs 0
+		if ((pos & 0x01) == (m_eRole == SERVER ? 0 : 1)) {
+			uint32_t id = pos >> 1;
+			for (uint32_t i = 0; i < gate->nvals; i++) {
+				gate->gs.val[i / GATE_T_BITS] |= ((parent->gs.aval[(id + i * parent->sharebitlen) / GATE_T_BITS] >>
+						((id + i * parent->sharebitlen) % GATE_T_BITS)) & 0x01) << (i % GATE_T_BITS);
+			}
+		}
+	} else if (m_eRole == SERVER) {
 		for (uint32_t i = 0; i < gate->nvals; i++) {
 			gate->gs.val[i / GATE_T_BITS] |= ((uint64_t) m_pGates[parentid].gs.yinput.pi[i]) << (i % GATE_T_BITS);
 		}
@@ -602,21 +612,43 @@ inline void BoolSharing::SelectiveOpen(uint32_t gateid) {
 	uint32_t idleft = gate->ingates.inputs.twin.left;
 	uint32_t idright = gate->ingates.inputs.twin.right;
 
-	for (uint32_t i = 0, bitstocopy = gate->nvals, len; i < ceil_divide(gate->nvals, GATE_T_BITS); i++, bitstocopy -= GATE_T_BITS) {
-		len = min(bitstocopy, (uint32_t) GATE_T_BITS);
-		m_vD_snd[0].XOR(m_pGates[idleft].gs.val[i], m_vMTIdx[0], len);
-		m_vE_snd[0].XOR(m_pGates[idright].gs.val[i], m_vMTIdx[0], len);
-		m_vMTIdx[0] += len;
-#ifdef DEBUGBOOL
-		cout << "opening " << idleft << " = " << m_pGates[idleft].gs.val[i] << " , and " << idright << " = " << m_pGates[idright].gs.val[i] << endl;
-#endif
+	simd_job job = { this, gateid, 0, m_vMTIdx[0] };
+	uint64_t chunksize = ParallelSIMD(gate->nvals, GATE_T_BITS, SIMD_CHUNK_MIN_BITS, SelectiveOpenChunk, &job);
+	//the first word of each part may share a byte of D and E with the previous part and is therefore opened afterwards
+	for (uint64_t i = chunksize; i < gate->nvals; i += chunksize) {
+		SelectiveOpenValues(gateid, m_vMTIdx[0], i, min(i + GATE_T_BITS, (uint64_t) gate->nvals));
 	}
+	m_vMTIdx[0] += gate->nvals;
 	m_vANDGates[0].push_back(gateid);
 
 	UsedGate(idleft);
 	UsedGate(idright);
 }
 
+//XOR the values [from, to) of the inputs of an AND gate, which start at bit mtpos in D and E, onto D and E
+void BoolSharing::SelectiveOpenValues(uint32_t gateid, uint64_t mtpos, uint64_t from, uint64_t to) {
+	GATE* gate = m_pGates + gateid;
+	uint32_t idleft = gate->ingates.inputs.twin.left;
+	uint32_t idright = gate->ingates.inputs.twin.right;
+
+	for (uint64_t i = from, len; i < to; i += GATE_T_BITS) {
+		len = min(to - i, (uint64_t) GATE_T_BITS);
+		m_vD_snd[0].XOR(m_pGates[idleft].gs.val[i / GATE_T_BITS], mtpos + i, len);
+		m_vE_snd[0].XOR(m_pGates[idright].gs.val[i / GATE_T_BITS], mtpos + i, len);
+#ifdef DEBUGBOOL
+		cout << "opening " << idleft << " = " << m_pGates[idleft].gs.val[i / GATE_T_BITS] << " , and " << idright << " = " << m_pGates[idright].gs.val[i / GATE_T_BITS] << endl;
+#endif
+	}
+}
+
+void BoolSharing::SelectiveOpenChunk(void* ctx, uint32_t chunkid, uint64_t from, uint64_t to) {
+	simd_job* job = (simd_job*) ctx;
+	//the first word of all but the first part is opened by the calling thread
+	if (chunkid > 0)
+		from += GATE_T_BITS;
+	job->sharing->SelectiveOpenValues(job->gateid, job->pos, from, to);
+}
+
 inline void BoolSharing::SelectiveOpenVec(uint32_t gateid) {
 	GATE* gate = m_pGates + gateid;
 
@@ -697,145 +729,140 @@ void BoolSharing::EvaluateMTs() {
 		uint64_t startpos = m_vMTStartIdx[i];
 		uint64_t endpos = m_vMTIdx[i];
 		if(startpos != endpos) {//do nothing, since len = 0, TODO: there is an error somewhere that makes this check necessary, fix!
-			uint64_t len = endpos - startpos;
-			uint64_t startposbytes = ceil_divide(startpos, 8);
-			uint64_t startposstringbits = startpos * m_vANDs[i].bitlen;
-			uint64_t startposstringbytes = startposbytes * m_vANDs[i].bitlen;
-			uint64_t lenbytes = ceil_divide(len, 8);
-			uint64_t stringbytelen = ceil_divide(m_vANDs[i].bitlen * len, 8);
-			uint64_t mtbytelen = ceil_divide(m_vANDs[i].bitlen, 8);
+			//startpos is a multiple of 8, hence parts that start at multiples of 8 MTs write disjoint bytes
+			simd_job job = { this, 0, i, startpos };
+			ParallelSIMD(endpos - startpos, 8, ceil_divide(SIMD_CHUNK_MIN_BITS, m_vANDs[i].bitlen), EvaluateMTChunk, &job);
+		}
+	}
+}
+
+void BoolSharing::EvaluateMTChunk(void* ctx, uint32_t chunkid, uint64_t from, uint64_t to) {
+	simd_job* job = (simd_job*) ctx;
+	job->sharing->EvaluateMTs(job->andsize, job->pos + from, to - from);
+}
+
+//Evaluate the MTs [startpos, startpos+len) of the AND gates with the i-th bit-length
+void BoolSharing::EvaluateMTs(uint32_t i, uint64_t startpos, uint64_t len) {
+	uint64_t startposbytes = ceil_divide(startpos, 8);
+	uint64_t startposstringbits = startpos * m_vANDs[i].bitlen;
+	uint64_t startposstringbytes = startposbytes * m_vANDs[i].bitlen;
+	uint64_t lenbytes = ceil_divide(len, 8);
+	uint64_t stringbytelen = ceil_divide(m_vANDs[i].bitlen * len, 8);
+	uint64_t mtbytelen = ceil_divide(m_vANDs[i].bitlen, 8);
 
 
-		/*	cout << "lenbytes = " << lenbytes << ", stringlen = " << stringbytelen << ", mtbytelen = " << mtbytelen <<
-			", startposbytes = " << startposbytes << ", startposstring = " << startposstringbytes << ", nummts: " <<
-				m_nNumMTs[i] << ", mtidx = " << m_vMTIdx[i] << ", mtstartidx = " << m_vMTStartIdx[i] << ", numandgates: " <<
-				m_vANDs[i].numgates <<endl;*/
+/*	cout << "lenbytes = " << lenbytes << ", stringlen = " << stringbytelen << ", mtbytelen = " << mtbytelen <<
+	", startposbytes = " << startposbytes << ", startposstring = " << startposstringbytes << ", nummts: " <<
+		m_nNumMTs[i] << ", mtidx = " << m_vMTIdx[i] << ", mtstartidx = " << m_vMTStartIdx[i] << ", numandgates: " <<
+		m_vANDs[i].numgates <<endl;*/
 
-			m_vD_snd[i].XORBytes(m_vD_rcv[i].GetArr() + startposbytes, startposbytes, lenbytes);
-			m_vE_snd[i].XORBytes(m_vE_rcv[i].GetArr() + startposstringbytes, startposstringbytes, stringbytelen);
+	m_vD_snd[i].XORBytes(m_vD_rcv[i].GetArr() + startposbytes, startposbytes, lenbytes);
+	m_vE_snd[i].XORBytes(m_vE_rcv[i].GetArr() + startposstringbytes, startposstringbytes, stringbytelen);
 
 
 #ifdef DEBUGBOOL
-			if(i > 0) {
-				cout << "i = " << i << ", lenbytes = " << lenbytes << ", stringlen = " << stringbytelen << ", mtbytelen = " << mtbytelen <<
-					", startposbytes = " << startposbytes << ", startposstring = " << startposstringbytes << ", startidx = " <<
-					m_vMTStartIdx[i] << ", idx = " << m_vMTIdx[i] << ", num ANDs = " << m_vANDs[i].numgates << ", nummts = " <<
-					m_nNumMTs[i] << ", " << m_vMTIdx[i] - m_vMTStartIdx[i] << endl;
-
-			cout << "A share: ";
-			m_vA[i].Print(0, len);
-			cout << "B share: ";
-			m_vB[i].PrintHex(0, stringbytelen);
-			cout << "C-share: ";
-			m_vC[i].PrintHex(0, stringbytelen);
-
-			cout << "D-rcv: ";
-			m_vD_rcv[i].Print(0,len);
-			cout << "E-rcv: ";
-			m_vE_rcv[i].PrintHex(0, stringbytelen);
-			cout << "D-total: ";
-			m_vD_snd[i].Print(0,len);
-			cout << "E-total: ";
-			m_vE_snd[i].PrintHex(0, stringbytelen);
-			}
+	if(i > 0) {
+		cout << "i = " << i << ", lenbytes = " << lenbytes << ", stringlen = " << stringbytelen << ", mtbytelen = " << mtbytelen <<
+			", startposbytes = " << startposbytes << ", startposstring = " << startposstringbytes << ", startidx = " <<
+			m_vMTStartIdx[i] << ", idx = " << m_vMTIdx[i] << ", num ANDs = " << m_vANDs[i].numgates << ", nummts = " <<
+			m_nNumMTs[i] << ", " << m_vMTIdx[i] - m_vMTStartIdx[i] << endl;
+
+	cout << "A share: ";
+	m_vA[i].Print(0, len);
+	cout << "B share: ";
+	m_vB[i].PrintHex(0, stringbytelen);
+	cout << "C-share: ";
+	m_vC[i].PrintHex(0, stringbytelen);
+
+	cout << "D-rcv: ";
+	m_vD_rcv[i].Print(0,len);
+	cout << "E-rcv: ";
+	m_vE_rcv[i].PrintHex(0, stringbytelen);
+	cout << "D-total: ";
+	m_vD_snd[i].Print(0,len);
+	cout << "E-total: ";
+	m_vE_snd[i].PrintHex(0, stringbytelen);
+	}
 #endif
 
-			if (i == 0) {
-				m_vResA[i].Copy(m_vA[i].GetArr() + startposbytes, startposbytes, lenbytes);
-				m_vResB[i].Copy(m_vB[i].GetArr() + startposbytes, startposbytes, lenbytes);
+	if (i == 0) {
+		m_vResA[i].Copy(m_vA[i].GetArr() + startposbytes, startposbytes, lenbytes);
+		m_vResB[i].Copy(m_vB[i].GetArr() + startposbytes, startposbytes, lenbytes);
 
-				m_vResA[i].ANDBytes(m_vE_snd[i].GetArr() + startposbytes, startposbytes, lenbytes);
-				m_vResB[i].ANDBytes(m_vD_snd[i].GetArr() + startposbytes, startposbytes, lenbytes);
-			} else {
-				if((m_vANDs[i].bitlen & 0x07) == 0) {
-					for (uint32_t j = 0; j < len; j++) {
-						if (m_vA[i].GetBitNoMask(j + startpos)) { //a * e
-							m_vResA[i].SetBytes(m_vE_snd[i].GetArr() + startposstringbytes + j * mtbytelen,
-									startposstringbytes + j * mtbytelen, mtbytelen);
-						}
-						if (m_vD_snd[i].GetBitNoMask(j + startpos)) { //d * b
-							m_vResB[i].SetBytes(m_vB[i].GetArr() + startposstringbytes + j * mtbytelen,
-									startposstringbytes + j * mtbytelen, mtbytelen);
-						}
-					}
-				} else {
-					uint8_t* tmp = (uint8_t*) malloc(ceil_divide(m_vANDs[i].bitlen, 8));
-					for (uint32_t j = 0; j < len; j++) {
-						if (m_vA[i].GetBitNoMask(j + startpos)) { //a * e
-							m_vE_snd[i].GetBits(tmp, startposstringbits + j*m_vANDs[i].bitlen, m_vANDs[i].bitlen);
-							m_vResA[i].SetBits(tmp, startposstringbits + j*m_vANDs[i].bitlen, m_vANDs[i].bitlen);
-						}
-						if (m_vD_snd[i].GetBitNoMask(j + startpos)) { //d * b
-							m_vB[i].GetBits(tmp, startposstringbits + j*m_vANDs[i].bitlen, m_vANDs[i].bitlen);
-							m_vResB[i].SetBits(tmp, startposstringbits + j*m_vANDs[i].bitlen, m_vANDs[i].bitlen);
-						}
-					}
-					free(tmp);
+		m_vResA[i].ANDBytes(m_vE_snd[i].GetArr() + startposbytes, startposbytes, lenbytes);
+		m_vResB[i].ANDBytes(m_vD_snd[i].GetArr() + startposbytes, startposbytes, lenbytes);
+	} else {
+		if((m_vANDs[i].bitlen & 0x07) == 0) {
+			for (uint32_t j = 0; j < len; j++) {
+				if (m_vA[i].GetBitNoMask(j + startpos)) { //a * e
+					m_vResA[i].SetBytes(m_vE_snd[i].GetArr() + startposstringbytes + j * mtbytelen,
+							startposstringbytes + j * mtbytelen, mtbytelen);
+				}
+				if (m_vD_snd[i].GetBitNoMask(j + startpos)) { //d * b
+					m_vResB[i].SetBytes(m_vB[i].GetArr() + startposstringbytes + j * mtbytelen,
+							startposstringbytes + j * mtbytelen, mtbytelen);
 				}
 			}
+		} else {
+			uint8_t* tmp = (uint8_t*) malloc(ceil_divide(m_vANDs[i].bitlen, 8));
+			for (uint32_t j = 0; j < len; j++) {
+				if (m_vA[i].GetBitNoMask(j + startpos)) { //a * e
+					m_vE_snd[i].GetBits(tmp, startposstringbits + j*m_vANDs[i].bitlen, m_vANDs[i].bitlen);
+					m_vResA[i].SetBits(tmp, startposstringbits + j*m_vANDs[i].bitlen, m_vANDs[i].bitlen);
+				}
+				if (m_vD_snd[i].GetBitNoMask(j + startpos)) { //d * b
+					m_vB[i].GetBits(tmp, startposstringbits + j*m_vANDs[i].bitlen, m_vANDs[i].bitlen);
+					m_vResB[i].SetBits(tmp, startposstringbits + j*m_vANDs[i].bitlen, m_vANDs[i].bitlen);
+				}
+			}
+			free(tmp);
+		}
+	}
 
-			m_vResA[i].XORBytes(m_vResB[i].GetArr() + startposstringbytes, startposstringbytes, stringbytelen);
-			m_vResA[i].XORBytes(m_vC[i].GetArr() + startposstringbytes, startposstringbytes, stringbytelen);
+	m_vResA[i].XORBytes(m_vResB[i].GetArr() + startposstringbytes, startposstringbytes, stringbytelen);
+	m_vResA[i].XORBytes(m_vC[i].GetArr() + startposstringbytes, startposstringbytes, stringbytelen);
 
-			if (m_eRole == SERVER) {
-				if (i == 0) {
-					m_vResB[i].Copy(m_vE_snd[i].GetArr() + startposbytes, startposbytes, lenbytes);
-					m_vResB[i].ANDBytes(m_vD_snd[i].GetArr() + startposbytes, startposbytes, lenbytes);
-				} else {
-					if((m_vANDs[i].bitlen & 0x07) == 0) {
-						for (uint32_t j = 0; j < len; j++) {
-							if (m_vD_snd[i].GetBitNoMask(j + startpos)) { //d * e
-								m_vResB[i].SetBytes(m_vE_snd[i].GetArr() + startposstringbytes + j * mtbytelen,
-										startposstringbytes + j * mtbytelen, mtbytelen);
-							}
-						}
-					} else {
-						uint8_t* tmp = (uint8_t*) malloc(ceil_divide(m_vANDs[i].bitlen, 8));
-						for (uint32_t j = 0; j < len; j++) {
-							if (m_vD_snd[i].GetBitNoMask(j + startpos)) { //d * e
-								//uint64_t tmp = m_vE_snd[i].Get<uint64_t>(startposstringbits + j*m_vANDs[i].bitlen, m_vANDs[i].bitlen);
-								m_vE_snd[i].GetBits(tmp, startposstringbits + j*m_vANDs[i].bitlen, m_vANDs[i].bitlen);
-								//m_vResB[i].Set<uint64_t>(tmp, startposstringbits + j*m_vANDs[i].bitlen, m_vANDs[i].bitlen);
-								m_vResB[i].SetBits(tmp, startposstringbits + j*m_vANDs[i].bitlen, m_vANDs[i].bitlen);
-								//m_vResB[i].SetBitsPosOffset(m_vE_snd[i].GetArr(), startposstringbits + j * m_vANDs[i].bitlen,
-								//		startposstringbits + j * m_vANDs[i].bitlen, m_vANDs[i].bitlen);
-							}
-						}
-						free(tmp);
+	if (m_eRole == SERVER) {
+		if (i == 0) {
+			m_vResB[i].Copy(m_vE_snd[i].GetArr() + startposbytes, startposbytes, lenbytes);
+			m_vResB[i].ANDBytes(m_vD_snd[i].GetArr() + startposbytes, startposbytes, lenbytes);
+		} else {
+			if((m_vANDs[i].bitlen & 0x07) == 0) {
+				for (uint32_t j = 0; j < len; j++) {
+					if (m_vD_snd[i].GetBitNoMask(j + startpos)) { //d * e
+						m_vResB[i].SetBytes(m_vE_snd[i].GetArr() + startposstringbytes + j * mtbytelen,
+								startposstringbytes + j * mtbytelen, mtbytelen);
+					}
+				}
+			} else {
+				uint8_t* tmp = (uint8_t*) malloc(ceil_divide(m_vANDs[i].bitlen, 8));
+				for (uint32_t j = 0; j < len; j++) {
+					if (m_vD_snd[i].GetBitNoMask(j + startpos)) { //d * e
+						//uint64_t tmp = m_vE_snd[i].Get<uint64_t>(startposstringbits + j*m_vANDs[i].bitlen, m_vANDs[i].bitlen);
+						m_vE_snd[i].GetBits(tmp, startposstringbits + j*m_vANDs[i].bitlen, m_vANDs[i].bitlen);
+						//m_vResB[i].Set<uint64_t>(tmp, startposstringbits + j*m_vANDs[i].bitlen, m_vANDs[i].bitlen);
+						m_vResB[i].SetBits(tmp, startposstringbits + j*m_vANDs[i].bitlen, m_vANDs[i].bitlen);
+						//m_vResB[i].SetBitsPosOffset(m_vE_snd[i].GetArr(), startposstringbits + j * m_vANDs[i].bitlen,
+						//		startposstringbits + j * m_vANDs[i].bitlen, m_vANDs[i].bitlen);
 					}
 				}
-				m_vResA[i].XORBytes(m_vResB[i].GetArr() + startposstringbytes, startposstringbytes, stringbytelen);
+				free(tmp);
 			}
 		}
+		m_vResA[i].XORBytes(m_vResB[i].GetArr() + startposstringbytes, startposstringbytes, stringbytelen);
 	}
 }
 
 void BoolSharing::EvaluateANDGate() {
 	GATE* gate;
 	for (uint32_t k = 0; k < m_nNumANDSizes; k++) {
-		for (uint32_t i = 0, j, bitstocopy, len, idx = m_vMTStartIdx[k]*m_vANDs[k].bitlen; i < m_vANDGates[k].size(); i++) {
+		for (uint64_t i = 0, idx = m_vMTStartIdx[k]*m_vANDs[k].bitlen; i < m_vANDGates[k].size(); i++) {
 			gate = m_pGates + m_vANDGates[k][i];
 			InstantiateGate(gate);
 
-			bitstocopy = gate->nvals;
-
-			for (j = 0; j < ceil_divide(gate->nvals, GATE_T_BITS); j++, bitstocopy -= GATE_T_BITS) {
-				len = min(bitstocopy, (uint32_t) GATE_T_BITS);
-
-#ifdef DEBUGBOOL
-				m_vResA[k].PrintHex();
-
-				cout << "setting AND gate " << m_vANDGates[k][i] << " with val-size = " << gate->nvals <<
-				", sharinbits = " << gate->sharebitlen << ", and bitstocopy = " << bitstocopy <<
-				" to value: " << (hex) << m_vResA[k].Get<UGATE_T>(idx, len) << (dec) << endl;
-#endif
-				gate->gs.val[j] = m_vResA[k].Get<UGATE_T>(idx, len);
-				/*if(k > 0) {
-					cout << "res_val = " << gate->gs.val[j] << " (" << m_vANDGates[k][i] << ")" <<
-							", startpos = " << m_vMTStartIdx[k] << ", idx = " << idx << ", len = " << len << endl;
-				}*/
-				idx += len;
-			}
+			simd_job job = { this, m_vANDGates[k][i], k, idx };
+			ParallelSIMD(gate->nvals, GATE_T_BITS, SIMD_CHUNK_MIN_BITS, EvaluateANDGateChunk, &job);
+			idx += gate->nvals;
 		}
 
 		m_vMTIdx[k] = PadToMultiple(m_vMTIdx[k], 8); //pad mtidx to next byte
@@ -843,6 +870,23 @@ void BoolSharing::EvaluateANDGate() {
 	}
 }
 
+//Set the values [from, to) of an AND gate, whose results start at bit pos in the result vector
+void BoolSharing::EvaluateANDGateChunk(void* ctx, uint32_t chunkid, uint64_t from, uint64_t to) {
+	simd_job* job = (simd_job*) ctx;
+	GATE* gate = job->sharing->m_pGates + job->gateid;
+	CBitVector& res = job->sharing->m_vResA[job->andsize];
+
+	for (uint64_t j = from, len; j < to; j += GATE_T_BITS) {
+		len = min(to - j, (uint64_t) GATE_T_BITS);
+#ifdef DEBUGBOOL
+		cout << "setting AND gate " << job->gateid << " with val-size = " << gate->nvals <<
+		", sharinbits = " << gate->sharebitlen << ", and bitstocopy = " << gate->nvals - j <<
+		" to value: " << (hex) << res.Get<UGATE_T>(job->pos + j, len) << (dec) << endl;
+#endif
+		gate->gs.val[j / GATE_T_BITS] = res.Get<UGATE_T>(job->pos + j, len);
+	}
+}
+
 void BoolSharing::AssignInputShares() {
 	GATE* gate;
 	for (uint32_t i = 0, j, rcvshareidx = 0, bitstocopy, len; i < m_vInputShareGates.size(); i++) {
@@ -960,10 +1004,9 @@ inline void BoolSharing::InstantiateGate(GATE* gate) {
 }
 
 inline void BoolSharing::UsedGate(uint32_t gateid) {
-	//Decrease the number of further uses of the gate
-	m_pGates[gateid].nused--;
+	//Decrease the number of further uses of the gate, atomically since the children of a gate may be evaluated concurrently by different sharings
 	//If the gate is needed in another subsequent gate, delete it
-	if (!m_pGates[gateid].nused) {
+	if (!__sync_sub_and_fetch(&m_pGates[gateid].nused, 1)) {
 		free(m_pGates[gateid].gs.val);
 	}
 }
@@ -1021,12 +1064,9 @@ void BoolSharing::EvaluateSIMDGate(uint32_t gateid) {
 #ifdef DEBUGSHARING
 		cout << " which is a SPLIT gate" << endl;
 #endif
-		uint32_t pos = gate->gs.sinput.pos;
 		uint32_t idparent = gate->ingates.inputs.parent;
 		InstantiateGate(gate);
-		for (uint32_t i = 0; i < vsize; i++) {
-			gate->gs.val[i / GATE_T_BITS] |= ((m_pGates[idparent].gs.val[(pos + i) / GATE_T_BITS] >> ((pos + i) % GATE_T_BITS)) & 0x1) << (i % GATE_T_BITS);
-		}
+		EvaluateSIMDGateValues(gateid);
 		UsedGate(idparent);
 	} else if (gate->type == G_REPEAT) //TODO only meant for single bit values, update
 			{
@@ -1052,11 +1092,7 @@ void BoolSharing::EvaluateSIMDGate(uint32_t gateid) {
 		//TODO: there might be a problem here since some bits might not be set to zero
 		memset(gate->gs.val, 0x00, ceil_divide(vsize, 8));
 
-		//TODO: Optimize
-		for (uint32_t i = 0; i < vsize; i++) {
-			gate->gs.val[i / GATE_T_BITS] |= (((m_pGates[inputs[i]].gs.val[posids[i] / GATE_T_BITS] >> (posids[i] % GATE_T_BITS)) & 0x1) << (i % GATE_T_BITS));
-			UsedGate(inputs[i]);
-		}
+		EvaluateSIMDGateValues(gateid);
 		free(inputs);
 		free(posids);
 	} else if (gate->type == G_COMBINEPOS) {
@@ -1064,17 +1100,10 @@ void BoolSharing::EvaluateSIMDGate(uint32_t gateid) {
 		cout << " which is a COMBINEPOS gate" << endl;
 #endif
 		uint32_t* combinepos = gate->ingates.inputs.parents; //gate->gs.combinepos.input;
-		uint32_t arraypos = gate->gs.combinepos.pos / GATE_T_BITS;
-		uint32_t bitpos = gate->gs.combinepos.pos % GATE_T_BITS;
 		InstantiateGate(gate);
 		//TODO: there might be a problem here since some bits might not be set to zero
 		memset(gate->gs.val, 0x00, ceil_divide(vsize, 8));
-		//TODO: Optimize
-		for (uint32_t i = 0; i < vsize; i++) {
-			uint32_t idparent = combinepos[i];
-			gate->gs.val[i / GATE_T_BITS] |= (((m_pGates[idparent].gs.val[arraypos] >> bitpos) & 0x1) << (i % GATE_T_BITS));
-			UsedGate(idparent);
-		}
+		EvaluateSIMDGateValues(gateid);
 		free(combinepos);
 	} else if (gate->type == G_SUBSET) {
 #ifdef DEBUGSHARING
@@ -1083,16 +1112,9 @@ void BoolSharing::EvaluateSIMDGate(uint32_t gateid) {
 		uint32_t idparent = gate->ingates.inputs.parent;
 		uint32_t* positions = gate->gs.sub_pos.posids; //gate->gs.combinepos.input;
 		bool del_pos = gate->gs.sub_pos.copy_posids;
-		uint32_t arraypos;
-		uint32_t bitpos;
 		InstantiateGate(gate);
 		memset(gate->gs.val, 0x00, ceil_divide(vsize, 8));
-		UGATE_T* valptr = m_pGates[idparent].gs.val;
-		for (uint32_t i = 0; i < vsize; i++) {
-			arraypos = positions[i] >> 6;
-			bitpos = positions[i] & 0x3F;
-			gate->gs.val[i >> 6] |= (((valptr[arraypos] >> bitpos) & 0x1) << (i & 0x3F));
-		}
+		EvaluateSIMDGateValues(gateid);
 		UsedGate(idparent);
 		if(del_pos)
 			free(positions);
@@ -1146,6 +1168,55 @@ void BoolSharing::EvaluateSIMDGate(uint32_t gateid) {
 #endif
 }
 
+//Evaluate a SIMD gate whose values can be computed independently of each other, large gates are split among the thread pool
+void BoolSharing::EvaluateSIMDGateValues(uint32_t gateid) {
+	simd_job job = { this, gateid, 0, 0 };
+	ParallelSIMD(m_pGates[gateid].nvals, GATE_T_BITS, SIMD_CHUNK_MIN_BITS, EvaluateSIMDGateChunk, &job);
+}
+
+void BoolSharing::EvaluateSIMDGateChunk(void* ctx, uint32_t chunkid, uint64_t from, uint64_t to) {
+	simd_job* job = (simd_job*) ctx;
+	BoolSharing* bs = job->sharing;
+	GATE* gate = bs->m_pGates + job->gateid;
+	GATE* gates = bs->m_pGates;
+
+	if (gate->type == G_SPLIT) {
+		uint32_t pos = gate->gs.sinput.pos;
+		UGATE_T* valptr = gates[gate->ingates.inputs.parent].gs.val;
+		for (uint64_t i = from; i < to; i++) {
+			gate->gs.val[i / GATE_T_BITS] |= ((valptr[(pos + i) / GATE_T_BITS] >> ((pos + i) % GATE_T_BITS)) & 0x1) << (i % GATE_T_BITS);
+		}
+	} else if (gate->type == G_PERM) {
+		uint32_t* inputs = gate->ingates.inputs.parents;
+		uint32_t* posids = gate->gs.perm.posids;
+		//TODO: Optimize
+		for (uint64_t i = from; i < to; i++) {
+			gate->gs.val[i / GATE_T_BITS] |= (((gates[inputs[i]].gs.val[posids[i] / GATE_T_BITS] >> (posids[i] % GATE_T_BITS)) & 0x1) << (i % GATE_T_BITS));
+			bs->UsedGate(inputs[i]);
+		}
+	} else if (gate->type == G_COMBINEPOS) {
+		uint32_t* combinepos = gate->ingates.inputs.parents;
+		uint32_t arraypos = gate->gs.combinepos.pos / GATE_T_BITS;
+		uint32_t bitpos = gate->gs.combinepos.pos % GATE_T_BITS;
+		//TODO: Optimize
+		for (uint64_t i = from; i < to; i++) {
+			uint32_t idparent = combinepos[i];
+			gate->gs.val[i / GATE_T_BITS] |= (((gates[idparent].gs.val[arraypos] >> bitpos) & 0x1) << (i % GATE_T_BITS));
+			bs->UsedGate(idparent);
+		}
+	} else if (gate->type == G_SUBSET) {
+		uint32_t* positions = gate->gs.sub_pos.posids;
+		UGATE_T* valptr = gates[gate->ingates.inputs.parent].gs.val;
+		uint32_t arraypos;
+		uint32_t bitpos;
+		for (uint64_t i = from; i < to; i++) {
+			arraypos = positions[i] >> 6;
+			bitpos = positions[i] & 0x3F;
+			gate->gs.val[i >> 6] |= (((valptr[arraypos] >> bitpos) & 0x1) << (i & 0x3F));
+		}
+	}
+}
+
 uint32_t BoolSharing::AssignInput(CBitVector& inputvals) {
 	deque<uint32_t> myingates = m_cBoolCircuit->GetInputGatesForParty(m_eRole);
 	inputvals.Create((uint64_t) m_cBoolCircuit->GetNumInputBitsForParty(m_eRole), m_cCrypto);
@@ -1189,6 +1260,37 @@ uint32_t BoolSharing::GetOutput(CBitVector& out) {
 	return outbits;
 }
 
+void BoolSharing::EstimateGateCost(GATE* gate, layer_cost* cost) {
+	uint64_t symbits = m_cCrypto->get_seclvl().symbits;
+	uint64_t nmts;
+
+	switch (gate->type) {
+	case G_NON_LIN:
+		//one MT per value from two random OTs, in the online phase both parties send d and e
+		cost->nonlinops += gate->nvals;
+		cost->numOTs += 2 * (uint64_t) gate->nvals;
+		cost->setupbits += 2 * (uint64_t) gate->nvals * symbits;
+		cost->onlinebits += 4 * (uint64_t) gate->nvals;
+		break;
+	case G_NON_LIN_VEC:
+		//one MT on bitlen-bit strings per choice bit, d has a single bit and e has bitlen bits
+		nmts = gate->nvals / gate->gs.avs.bitlen;
+		cost->nonlinops += nmts;
+		cost->numOTs += 2 * nmts;
+		cost->setupbits += 2 * nmts * symbits;
+		cost->onlinebits += 2 * nmts * (1 + gate->gs.avs.bitlen);
+		break;
+	case G_IN:
+		cost->onlinebits += (uint64_t) gate->nvals * gate->sharebitlen;
+		break;
+	case G_OUT:
+		cost->onlinebits += (uint64_t) gate->nvals * gate->sharebitlen * (gate->gs.oshare.dst == ALL ? 2 : 1);
+		break;
+	default:
+		break;
+	}
+}
+
 void BoolSharing::PrintPerformanceStatistics() {
 	cout << "Boolean Sharing: ANDs: ";
 	uint64_t total_non_vec_ANDs = 0;
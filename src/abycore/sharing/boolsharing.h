@@ -80,6 +80,7 @@ public:
 		return m_nTotalNumMTs > 0? m_nTotalNumMTs-GetMaxCommunicationRounds()*8 : m_nTotalNumMTs;
 	}
 	;
+	void EstimateGateCost(GATE* gate, layer_cost* cost);
 
 	void Reset();
 	vector<uint32_t> GetNumOTs() {
@@ -182,14 +183,46 @@ private:
 	 \param gateid 	Gate Identifier
 	 */
 	inline void SelectiveOpenVec(uint32_t gateid);
+	/**
+	 Method for XORing the values [from, to) of the inputs of an AND gate onto the D and E vectors.
+	 \param gateid 	Gate Identifier
+	 \param mtpos 	position of the first value of the gate in the D and E vectors
+	 \param from 	first value
+	 \param to 		value after the last value
+	 */
+	void SelectiveOpenValues(uint32_t gateid, uint64_t mtpos, uint64_t from, uint64_t to);
 	/**
 	 Method for Evaluating MTs.
 	 */
 	void EvaluateMTs();
+	/**
+	 Method for evaluating the MTs [startpos, startpos+len) of the AND gates with the same bit-length.
+	 \param andsize 	index of the bit-length of the AND gates
+	 \param startpos 	first MT, a multiple of 8
+	 \param len 		number of MTs
+	 */
+	void EvaluateMTs(uint32_t andsize, uint64_t startpos, uint64_t len);
 	/**
 	 Method for evaluating AND gate
 	 */
 	void EvaluateANDGate();
+	/**
+	 Method for evaluating a SPLIT, PERM, COMBINEPOS, or SUBSET gate, whose values are computed independently of each other.
+	 \param gateid		Gate identifier
+	 */
+	void EvaluateSIMDGateValues(uint32_t gateid);
+
+	/** Context for splitting the evaluation of a large gate or of many MTs among the workers of the thread pool */
+	struct simd_job {
+		BoolSharing* sharing;
+		uint32_t gateid;
+		uint32_t andsize;
+		uint64_t pos;
+	};
+	static void SelectiveOpenChunk(void* ctx, uint32_t chunkid, uint64_t from, uint64_t to);
+	static void EvaluateMTChunk(void* ctx, uint32_t chunkid, uint64_t from, uint64_t to);
+	static void EvaluateANDGateChunk(void* ctx, uint32_t chunkid, uint64_t from, uint64_t to);
+	static void EvaluateSIMDGateChunk(void* ctx, uint32_t chunkid, uint64_t from, uint64_t to);
 	/**
 	 Method for evaluating XOR gate for the inputted
 	 gate object.
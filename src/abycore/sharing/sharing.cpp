@@ -30,6 +30,76 @@ void Sharing::EvaluateCallbackGate(uint32_t gateid) {
 	free(gate->ingates.inputs.parents);
 }
 
+void Sharing::EstimateCost(sharing_cost* cost) {
+	Circuit* circ = GetCircuitBuildRoutine();
+	uint32_t nlayers = max(circ->GetNumLocalLayers(), circ->GetNumInteractiveLayers());
+	deque<uint32_t> queue;
+	GATE* gate;
+
+	memset(&(cost->total), 0, sizeof(layer_cost));
+	cost->layers.assign(nlayers, cost->total);
+
+	for (uint32_t i = 0; i < nlayers; i++) {
+		queue = circ->GetLocalQueueOnLvl(i);
+		for (uint32_t j = 0; j < queue.size(); j++) {
+			EstimateGateCost(m_pGates + queue[j], &(cost->layers[i]));
+		}
+		queue = circ->GetInteractiveQueueOnLvl(i);
+		for (uint32_t j = 0; j < queue.size(); j++) {
+			gate = m_pGates + queue[j];
+			EstimateGateCost(gate, &(cost->layers[i]));
+			//the parties interact once after each layer, a gate with several rounds interacts on the following layers
+			if (i + gate->nrounds > cost->layers.size())
+				cost->layers.resize(i + gate->nrounds, cost->total);
+			for (uint32_t r = 0; r < gate->nrounds; r++) {
+				cost->layers[i + r].rounds = 1;
+			}
+		}
+	}
+
+	for (uint32_t i = 0; i < cost->layers.size(); i++) {
+		cost->total.nonlinops += cost->layers[i].nonlinops;
+		cost->total.numOTs += cost->layers[i].numOTs;
+		cost->total.setupbits += cost->layers[i].setupbits;
+		cost->total.onlinebits += cost->layers[i].onlinebits;
+		cost->total.rounds += cost->layers[i].rounds;
+	}
+}
+
+uint32_t Sharing::GetNumSIMDChunks(uint64_t nvals, uint64_t minchunk) {
+	if (m_pThreadPool == NULL || nvals < 2 * minchunk)
+		return 1;
+	return (uint32_t) min((uint64_t) m_pThreadPool->GetNumThreads(), nvals / minchunk);
+}
+
+uint64_t Sharing::ParallelSIMD(uint64_t nvals, uint64_t align, uint64_t minchunk, simd_chunk_fct fct, void* ctx) {
+	uint32_t nchunks = GetNumSIMDChunks(nvals, minchunk);
+	if (nchunks == 1) {
+		fct(ctx, 0, 0, nvals);
+		return nvals;
+	}
+
+	uint64_t chunksize = PadToMultiple(ceil_divide(nvals, nchunks), align);
+	vector<simd_chunk> chunks(nchunks);
+	CTaskGroup group;
+	for (uint32_t i = 0; i < nchunks && i * chunksize < nvals; i++) {
+		chunks[i].fct = fct;
+		chunks[i].ctx = ctx;
+		chunks[i].chunkid = i;
+		chunks[i].from = i * chunksize;
+		chunks[i].to = min(nvals, (i + 1) * chunksize);
+		m_pThreadPool->Submit(&group, EvaluateSIMDChunk, &chunks[i]);
+	}
+	m_pThreadPool->Wait(&group);
+	return chunksize;
+}
+
+BOOL Sharing::EvaluateSIMDChunk(void* arg) {
+	simd_chunk* chunk = (simd_chunk*) arg;
+	chunk->fct(chunk->ctx, chunk->chunkid, chunk->from, chunk->to);
+	return TRUE;
+}
+
 /**Precomputation phasevalue getter and setter functions*/
 void Sharing::SetPreCompPhaseValue(ePreCompPhase in_phase_value) {
 
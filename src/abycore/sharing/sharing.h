@@ -28,6 +28,7 @@
 #include "../aby/abysetup.h"
 #include "../util/constants.h"
 #include "../util/crypto/crypto.h"
+#include "../util/threadpool.h"
 #include <assert.h>
 //#define DEBUGSHARING
 
@@ -37,6 +38,24 @@
  */
 #define MAXSHAREBUFSIZE 1000000
 
+/**
+ Predicted cost of evaluating a circuit layer or a whole circuit, which is derived from the gates before the execution.
+ The communication is summed over both parties.
+ */
+struct layer_cost {
+	uint64_t nonlinops; /**< AND gates in Boolean and Yao sharing, MUL gates in arithmetic sharing */
+	uint64_t numOTs; /**< OT extensions that are performed in the setup phase */
+	uint64_t setupbits; /**< bits that are sent in the setup phase */
+	uint64_t onlinebits; /**< bits that are sent in the online phase */
+	uint32_t rounds; /**< communication rounds in the online phase, for a single layer 1 if the parties interact after it */
+};
+
+/** Predicted cost of a sharing in total and for each layer of its circuit */
+struct sharing_cost {
+	layer_cost total;
+	vector<layer_cost> layers;
+};
+
 /**
  Generic class for specifying different types of sharing.
  */
@@ -60,6 +79,7 @@ public:
 		m_nSecParamBytes = ceil_divide(m_cCrypto->get_seclvl().symbits, 8);
 		m_ePhaseValue = ePreCompDefault;
 		m_nFilePos = -1;
+		m_pThreadPool = NULL;
 	}
 	;
 	/**
@@ -158,6 +178,12 @@ public:
 	 Method for finding the number of non-linear operations.
 	 */
 	virtual uint32_t GetNumNonLinearOperations() = 0;
+	/**
+	 Method for predicting the cost of a gate in the circuit of this sharing, summed over both parties.
+	 \param	gate	gate that is not yet evaluated
+	 \param	cost	cost of the layer of the gate, to which the non-linear operations, OTs, and sent bits of the gate are added
+	 */
+	virtual void EstimateGateCost(GATE* gate, layer_cost* cost) = 0;
 	/**	
 	 Method for knowing the sharing type used.
 	 */
@@ -166,6 +192,11 @@ public:
 	 Method for printing the performance statistics.
 	 */
 	virtual void PrintPerformanceStatistics() = 0;
+	/**
+	 Predicts the cost of evaluating the circuit that was built so far in this sharing, without executing it.
+	 \param	cost	the cost of each layer, which is indexed by the depth on which ABYParty evaluates it, and their sum
+	 */
+	void EstimateCost(sharing_cost* cost);
 	/**	
 	 Method for _________________________________
 	 */
@@ -209,6 +240,15 @@ public:
 	*/
 	void PreCompFileDelete();
 
+	/**
+	 Set the thread pool that is used to split the evaluation of large SIMD gates among several workers.
+	 \param pool		thread pool of the party, NULL evaluates every gate by a single thread
+	 */
+	void SetThreadPool(ThreadPool* pool) {
+		m_pThreadPool = pool;
+	}
+	;
+
 	//TODO move to utils
 	/*File Operation Methods*/
 	/**
@@ -260,6 +300,26 @@ protected:
 	 */
 	UGATE_T* ReadOutputValue(uint32_t gateid, e_circuit circ_type, uint32_t* bitlen);
 
+	/** Function that evaluates the values [from, to) of a SIMD gate as the chunkid-th part of the gate */
+	typedef void (*simd_chunk_fct)(void* ctx, uint32_t chunkid, uint64_t from, uint64_t to);
+	/**
+	 Returns the number of parts into which the evaluation of nvals values is split.
+	 \param nvals		number of values of the gate
+	 \param minchunk	minimum number of values that is worth being evaluated by a separate worker
+	 */
+	uint32_t GetNumSIMDChunks(uint64_t nvals, uint64_t minchunk);
+	/**
+	 Split the values [0, nvals) into GetNumSIMDChunks() parts whose borders are multiples of align, evaluate them on the
+	 thread pool, and wait for all parts to finish. Small gates are evaluated directly by the calling thread.
+	 \param nvals		number of values of the gate
+	 \param align		the borders of the parts are multiples of align, e.g., to avoid that two parts write the same word
+	 \param minchunk	minimum number of values that is worth being evaluated by a separate worker
+	 \param fct		function that evaluates a part
+	 \param ctx		context that is passed to fct
+	 \return the number of values in each but the last part
+	 */
+	uint64_t ParallelSIMD(uint64_t nvals, uint64_t align, uint64_t minchunk, simd_chunk_fct fct, void* ctx);
+
 
 	uint32_t m_nShareBitLen; /**< Bit length of shared item. */
 	GATE* m_pGates; /**< Pointer to array of Logical Gates. */
@@ -271,6 +331,17 @@ protected:
 	uint32_t m_nTypeBitLen; /** Bit-length of the arithmetic shares in arithsharing */
 	uint64_t m_nFilePos;/**< Variable which stores the position of the file pointer. */
 	ePreCompPhase m_ePhaseValue;/**< Variable storing the current Precomputation Mode */
+	ThreadPool* m_pThreadPool; /**< Pool for splitting the evaluation of large SIMD gates, may be NULL */
+
+private:
+	struct simd_chunk {
+		simd_chunk_fct fct;
+		void* ctx;
+		uint32_t chunkid;
+		uint64_t from;
+		uint64_t to;
+	};
+	static BOOL EvaluateSIMDChunk(void* arg);
 
 };
 
@@ -35,11 +35,6 @@ void YaoClientSharing::InitClient() {
 
 	fMaskFct = new XORMasking(m_cCrypto->get_seclvl().symbits);
 
-	//TODO free memory after use
-	m_vTmpEncBuf = (uint8_t**) malloc(sizeof(uint8_t*) * KEYS_PER_GATE_IN_TABLE);
-	for(uint32_t i = 0; i < KEYS_PER_GATE_IN_TABLE; i++)
-		m_vTmpEncBuf[i] = (uint8_t*) malloc(sizeof(uint8_t) * AES_BYTES);
-
 }
 
 //Pre-set values for new layer
@@ -67,13 +62,23 @@ void YaoClientSharing::PrepareSetupPhase(ABYSetup* setup) {
 	m_nClientInputBits = m_cBoolCircuit->GetNumInputBitsForParty(CLIENT);
 	m_nConversionInputBits = m_cBoolCircuit->GetNumB2YGates() + m_cBoolCircuit->GetNumA2YGates() + m_cBoolCircuit->GetNumYSwitchGates();
 
+	m_vOutputShareSndBuf.Create((uint32_t) m_cBoolCircuit->GetNumOutputBitsForParty(SERVER));
+	m_vROTSndBuf.Create((uint32_t) m_cBoolCircuit->GetNumInputBitsForParty(CLIENT) + m_nConversionInputBits);
+
+	//Read the garbled circuit, the output shares, and the OTs of a circuit that was garbled in advance
+	if (GetPreCompPhaseValue() == ePreCompRead && IsPreCompSupported()) {
+		vector<CBitVector*> vecs;
+		GetPreCompVectors(vecs);
+		m_bPreCompRead = AgreeOnPreCompCircuit(setup, vecs);
+		if (m_bPreCompRead)
+			return;
+	}
+
 	m_vGarbledCircuit.Create(0); //m_nANDGates * KEYS_PER_GATE_IN_TABLE * m_sSecLvl.symbits);
 	buf = (BYTE*) malloc(gt_size);
 	m_vGarbledCircuit.AttachBuf(buf, gt_size);
 
 	m_vOutputShareRcvBuf.Create((uint32_t) m_cBoolCircuit->GetNumOutputBitsForParty(CLIENT));
-	m_vOutputShareSndBuf.Create((uint32_t) m_cBoolCircuit->GetNumOutputBitsForParty(SERVER));
-	m_vROTSndBuf.Create((uint32_t) m_cBoolCircuit->GetNumInputBitsForParty(CLIENT) + m_nConversionInputBits);
 
 	m_vROTMasks.Create((m_nClientInputBits + m_nConversionInputBits) * m_cCrypto->get_seclvl().symbits); //TODO: do a bit more R-OTs to get the offset right
 
@@ -100,16 +105,27 @@ void YaoClientSharing::PrepareSetupPhase(ABYSetup* setup) {
 
 /* If played as server send the garbled table, if played as client receive the garbled table */
 void YaoClientSharing::PerformSetupPhase(ABYSetup* setup) {
-	if (m_cBoolCircuit->GetMaxDepth() == 0)
+	if (m_cBoolCircuit->GetMaxDepth() == 0 || m_bPreCompRead)
 		return;
 	ReceiveGarbledCircuitAndOutputShares(setup);
 }
 
+//the vectors that the online phase requires: the garbled circuit, the output shares, and the OTs
+void YaoClientSharing::GetPreCompVectors(vector<CBitVector*>& vecs) {
+	vecs.push_back(&m_vGarbledCircuit);
+	vecs.push_back(&m_vOutputShareRcvBuf);
+	vecs.push_back(&m_vChoiceBits);
+	vecs.push_back(&m_vROTMasks);
+}
+
 void YaoClientSharing::PrepareOnlinePhase() {
 	InitNewLayer();
 }
 
 void YaoClientSharing::ReceiveGarbledCircuitAndOutputShares(ABYSetup* setup) {
+	//the garbler picks the identifier of a circuit that is stored
+	if (GetPreCompPhaseValue() == ePreCompStore && IsPreCompSupported())
+		setup->AddReceiveTask(m_vPreCompID, YAO_PRECOMP_ID_BYTES);
 	if (m_nANDGates > 0)
 		setup->AddReceiveTask(m_vGarbledCircuit.GetArr(), ((uint64_t) m_nANDGates) * m_nSecParamBytes * KEYS_PER_GATE_IN_TABLE);
 	if (m_cBoolCircuit->GetNumOutputBitsForParty(CLIENT) > 0)
@@ -120,6 +136,12 @@ void YaoClientSharing::ReceiveGarbledCircuitAndOutputShares(ABYSetup* setup) {
 void YaoClientSharing::FinishSetupPhase(ABYSetup* setup) {
 	//wait for transmission end of GC
 	setup->WaitForTransmissionEnd();
+
+	if (m_cBoolCircuit->GetMaxDepth() > 0 && GetPreCompPhaseValue() == ePreCompStore && IsPreCompSupported()) {
+		vector<CBitVector*> vecs;
+		GetPreCompVectors(vecs);
+		StorePreCompCircuit(vecs);
+	}
 	/*cout << "Garbled Table Cl: " << endl;
 	m_vGarbledCircuit.PrintHex(0, ((uint64_t) m_nANDGates) * m_nSecParamBytes * KEYS_PER_GATE_IN_TABLE);
 
@@ -267,45 +289,55 @@ void YaoClientSharing::EvaluateANDGate(GATE* gate) {
 	GATE* gleft = m_pGates + idleft;
 	GATE* gright = m_pGates + idright;
 
-	//evaluate garbled table
+	//evaluate garbled table, the tables of large SIMD gates are evaluated by several workers
 	InstantiateGate(gate);
-	for (uint32_t g = 0; g < gate->nvals; g++) {
-		EvaluateGarbledTable(gate, g, gleft, gright);
-		m_nGarbledTableCtr++;
-
-		//Pipelined receive - TODO: outsource in own thread
-		/*if(andctr >= GARBLED_TABLE_WINDOW) {
-		 gtsize = min(remandgates, GARBLED_TABLE_WINDOW);
-		 sock.Receive(m_vGarbledTables.GetArr(), gtsize * KEYS_PER_GATE_IN_TABLE * BYTES_SSP);
-		 remandgates -= gtsize;
-		 andctr=0;
-		 }*/
-
-	}
+	InitScratch(GetNumSIMDChunks(gate->nvals, SIMD_CHUNK_MIN_TABLES));
+	yao_and_job job = { this, gate, gleft, gright, m_nGarbledTableCtr };
+	ParallelSIMD(gate->nvals, 1, SIMD_CHUNK_MIN_TABLES, EvaluateGarbledTableChunk, &job);
+	m_nGarbledTableCtr += gate->nvals;
+
+	//Pipelined receive - TODO: outsource in own thread
+	/*if(andctr >= GARBLED_TABLE_WINDOW) {
+	 gtsize = min(remandgates, GARBLED_TABLE_WINDOW);
+	 sock.Receive(m_vGarbledTables.GetArr(), gtsize * KEYS_PER_GATE_IN_TABLE * BYTES_SSP);
+	 remandgates -= gtsize;
+	 andctr=0;
+	 }*/
 	UsedGate(idleft);
 	UsedGate(idright);
 }
 
-BOOL YaoClientSharing::EvaluateGarbledTable(GATE* gate, uint32_t pos, GATE* gleft, GATE* gright)
+void YaoClientSharing::EvaluateGarbledTableChunk(void* ctx, uint32_t chunkid, uint64_t from, uint64_t to) {
+	yao_and_job* job = (yao_and_job*) ctx;
+	YaoClientSharing* ycs = (YaoClientSharing*) job->sharing;
+	yao_scratch* scratch = &(ycs->m_vScratch[chunkid]);
+
+	for (uint64_t g = from; g < to; g++) {
+		ycs->EvaluateGarbledTable(job->gate, g, job->gleft, job->gright, job->tablectr + g, scratch);
+	}
+}
+
+BOOL YaoClientSharing::EvaluateGarbledTable(GATE* gate, uint32_t pos, GATE* gleft, GATE* gright, uint64_t tablectr, yao_scratch* scratch)
 {
 
 	uint8_t *lkey, *rkey, *okey, *gtptr;
 	uint8_t lpbit, rpbit;
+	uint8_t** encbuf = scratch->maskbuf;
 
 	okey = gate->gs.yval + pos * m_nSecParamBytes;
 	lkey = gleft->gs.yval + pos * m_nSecParamBytes;
 	rkey = gright->gs.yval + pos * m_nSecParamBytes;
-	gtptr = m_vGarbledCircuit.GetArr() + m_nSecParamBytes * KEYS_PER_GATE_IN_TABLE * m_nGarbledTableCtr;
+	gtptr = m_vGarbledCircuit.GetArr() + m_nSecParamBytes * KEYS_PER_GATE_IN_TABLE * tablectr;
 
 	lpbit = lkey[m_nSecParamBytes-1] & 0x01;
 	rpbit = rkey[m_nSecParamBytes-1] & 0x01;
 
 	assert(lpbit < 2 && rpbit < 2);
 
-	EncryptWire(m_vTmpEncBuf[0], lkey, KEYS_PER_GATE_IN_TABLE*m_nGarbledTableCtr);
-	EncryptWire(m_vTmpEncBuf[1], rkey, KEYS_PER_GATE_IN_TABLE*m_nGarbledTableCtr+1);
+	EncryptWire(encbuf[0], lkey, KEYS_PER_GATE_IN_TABLE*tablectr, scratch);
+	EncryptWire(encbuf[1], rkey, KEYS_PER_GATE_IN_TABLE*tablectr+1, scratch);
 
-	m_pKeyOps->XOR(okey, m_vTmpEncBuf[0], m_vTmpEncBuf[1]);//gc_xor(okey, encbuf[0], encbuf[1]);
+	m_pKeyOps->XOR(okey, encbuf[0], encbuf[1]);//gc_xor(okey, encbuf[0], encbuf[1]);
 
 	if(lpbit) {
 		m_pKeyOps->XOR(okey, okey, gtptr);//gc_xor(okey, okey, gtptr);
@@ -324,9 +356,9 @@ BOOL YaoClientSharing::EvaluateGarbledTable(GATE* gate, uint32_t pos, GATE* glef
 		PrintKey(okey);
 		cout << " (" << (uint32_t) (okey[m_nSecParamBytes-1] & 0x01) << ")" << endl;
 		cout << "A: ";
-		PrintKey(m_vTmpEncBuf[0]);
+		PrintKey(encbuf[0]);
 		cout << "; B: ";
-		PrintKey(m_vTmpEncBuf[1]);
+		PrintKey(encbuf[1]);
 		cout << endl;
 		cout << "Table A: ";
 		PrintKey(gtptr);
@@ -591,10 +623,9 @@ void YaoClientSharing::InstantiateGate(GATE* gate) {
 }
 
 void YaoClientSharing::UsedGate(uint32_t gateid) {
-	//Decrease the number of further uses of the gate
-	m_pGates[gateid].nused--;
+	//Decrease the number of further uses of the gate, atomically since the children of a gate may be evaluated concurrently by different sharings
 	//If the gate is needed in another subsequent gate, delete it
-	if (!m_pGates[gateid].nused && m_pGates[gateid].type != G_CONV) {
+	if (!__sync_sub_and_fetch(&m_pGates[gateid].nused, 1) && m_pGates[gateid].type != G_CONV) {
 		free(m_pGates[gateid].gs.yval);
 		m_pGates[gateid].instantiated = false;
 	}
@@ -619,16 +650,17 @@ void YaoClientSharing::EvaluateSIMDGate(uint32_t gateid) {
 	} else if (gate->type == G_SPLIT) {
 		uint32_t pos = gate->gs.sinput.pos;
 		uint32_t idleft = gate->ingates.inputs.parent; // gate->gs.sinput.input;
-		InstantiateGate(gate);
-		memcpy(gate->gs.yval, m_pGates[idleft].gs.yval + pos * m_nSecParamBytes, m_nSecParamBytes * gate->nvals);
-		UsedGate(idleft);
+		if (pos == 0 && CanTakeOverParent(idleft)) {
+			TakeOverParent(gate, idleft);
+		} else {
+			InstantiateGate(gate);
+			memcpy(gate->gs.yval, m_pGates[idleft].gs.yval + pos * m_nSecParamBytes, m_nSecParamBytes * gate->nvals);
+			UsedGate(idleft);
+		}
 	} else if (gate->type == G_REPEAT) {
 		uint32_t idleft = gate->ingates.inputs.parent; //gate->gs.rinput;
 		InstantiateGate(gate);
-		BYTE* keyptr = gate->gs.yval;
-		for (uint32_t g = 0; g < gate->nvals; g++, keyptr += m_nSecParamBytes) {
-			memcpy(keyptr, m_pGates[idleft].gs.yval, m_nSecParamBytes);
-		}
+		RepeatValue(gate->gs.yval, m_pGates[idleft].gs.yval, gate->nvals, m_nSecParamBytes);
 		UsedGate(idleft);
 	} else if (gate->type == G_COMBINEPOS) {
 		uint32_t* combinepos = gate->ingates.inputs.parents; //gate->gs.combinepos.input;
@@ -652,17 +684,26 @@ void YaoClientSharing::EvaluateSIMDGate(uint32_t gateid) {
 		uint32_t* positions = gate->gs.sub_pos.posids; //gate->gs.combinepos.input;
 		bool del_pos = gate->gs.sub_pos.copy_posids;
 
-		InstantiateGate(gate);
-		BYTE* keyptr = gate->gs.yval;
-		for (uint32_t g = 0; g < gate->nvals; g++, keyptr += m_nSecParamBytes) {
-			memcpy(keyptr, m_pGates[idparent].gs.yval + positions[g] * m_nSecParamBytes, m_nSecParamBytes);
+		if (CanTakeOverParent(idparent) && IsPrefixView(positions, gate->nvals)) {
+			TakeOverParent(gate, idparent);
+		} else {
+			InstantiateGate(gate);
+			CopyPositionRuns(gate->gs.yval, m_pGates[idparent].gs.yval, positions, gate->nvals, m_nSecParamBytes);
+			UsedGate(idparent);
 		}
-		UsedGate(idparent);
 		if(del_pos)
 			free(positions);
 	}
 }
 
+//the gate uses the keys of its parent, whose first values are the values of the gate, and the parent is released
+void YaoClientSharing::TakeOverParent(GATE* gate, uint32_t parentid) {
+	gate->gs.yval = m_pGates[parentid].gs.yval;
+	gate->instantiated = true;
+	m_pGates[parentid].nused = 0;
+	m_pGates[parentid].instantiated = false;
+}
+
 uint32_t YaoClientSharing::AssignInput(CBitVector& inputvals) {
 	deque<uint32_t> myingates = m_cBoolCircuit->GetInputGatesForParty(m_eRole);
 	inputvals.Create(m_cBoolCircuit->GetNumInputBitsForParty(m_eRole), m_cCrypto);
@@ -739,6 +780,8 @@ void YaoClientSharing::Reset() {
 	m_vROTSndBuf.delCBitVector();
 	m_vROTCtr = 0;
 
+	m_bPreCompRead = FALSE;
+
 	m_nANDGates = 0;
 	m_nXORGates = 0;
 
@@ -101,7 +101,6 @@ private:
 	CBitVector m_vROTSndBuf;/**< __________________*/
 	uint32_t m_vROTCtr;/**< __________________*/
 
-	uint8_t**			m_vTmpEncBuf;
 
 	/**
 	 Receive Server Keys from the given gateid.
@@ -141,8 +140,12 @@ private:
 	 \param pos 		Position of the object in the queue.
 	 \param gleft	left gate in the queue.
 	 \param gright	right gate in the queue.
+	 \param tablectr	index of the garbled table that is evaluated.
+	 \param scratch	scratch memory of the calling worker.
 	 */
-	BOOL EvaluateGarbledTable(GATE* gate, uint32_t pos, GATE* gleft, GATE* gright);
+	BOOL EvaluateGarbledTable(GATE* gate, uint32_t pos, GATE* gleft, GATE* gright, uint64_t tablectr, yao_scratch* scratch);
+	/** Evaluate the garbled tables of the values [from, to) of an AND gate */
+	static void EvaluateGarbledTableChunk(void* ctx, uint32_t chunkid, uint64_t from, uint64_t to);
 	/**
 	 Method for server output Gate for the inputted Gate.
 	 \param gate		Gate Object
@@ -154,6 +157,8 @@ private:
 	 \param gateid		Gate Identifier
 	 */
 	void EvaluateSIMDGate(uint32_t gateid);
+	/** Let a gate that is a view of the first values of its parent use the keys of the parent instead of a copy */
+	void TakeOverParent(GATE* gate, uint32_t parentid);
 
 	/**
 	 Method for initiating the client.
@@ -176,6 +181,8 @@ private:
 	 \param setup 	ABYSetup Object.
 	 */
 	void ReceiveGarbledCircuitAndOutputShares(ABYSetup* setup);
+	/** Collect the vectors that are stored for a precomputed garbled circuit and required in the online phase */
+	void GetPreCompVectors(vector<CBitVector*>& vecs);
 };
 
 #endif /* __YAOCLIENTSHARING_H__ */
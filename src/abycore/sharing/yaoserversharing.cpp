@@ -22,12 +22,8 @@ void YaoServerSharing::InitServer() {
 
 	//Allocate memory that is needed when generating the garbled tables
 	for(uint32_t i = 0; i < 2; i++) {
-		m_bLMaskBuf[i] = (BYTE*) malloc(sizeof(BYTE) * m_nSecParamBytes);
-		m_bRMaskBuf[i] = (BYTE*) malloc(sizeof(BYTE) * m_nSecParamBytes);
 		m_bOKeyBuf[i] = (BYTE*) malloc(sizeof(BYTE) * m_nSecParamBytes);
 	}
-	m_bLKeyBuf = (BYTE*) malloc(sizeof(BYTE) * m_nSecParamBytes);
-	m_bTmpBuf = (BYTE*) malloc(sizeof(BYTE) * AES_BYTES);
 
 
 
@@ -73,6 +69,29 @@ void YaoServerSharing::PrepareSetupPhase(ABYSetup* setup) {
 
 	//m_vPreSetInputGates = (input_gate_val_t*) calloc(m_nServerInputBits, sizeof(input_gate_val_t));
 
+	m_vServerKeySndBuf.Create((m_nServerInputBits + m_cBoolCircuit->GetNumA2YGates()) * symbits);
+
+	m_vClientKeySndBuf.resize(2);
+	m_vClientKeySndBuf[0].Create((m_nClientInputBits + m_nConversionInputBits) * symbits);
+	m_vClientKeySndBuf[1].Create((m_nClientInputBits + m_nConversionInputBits) * symbits);
+
+	m_vOutputShareSndBuf.Create(m_cBoolCircuit->GetNumOutputBitsForParty(CLIENT));
+
+	m_vOutputDestionations = (e_role*) malloc(sizeof(e_role) * m_cBoolCircuit->GetOutputGatesForParty(CLIENT).size()+m_cBoolCircuit->GetOutputGatesForParty(SERVER).size());
+	m_nOutputDestionationsCtr = 0;
+	//deque<uint32_t> out = m_cBoolCircuit->GetOutputGatesForParty(CLIENT);
+
+	m_vROTMasks.resize(2);
+
+	//Read the wire keys and the OTs of a circuit that was garbled in advance, such that neither garbling nor OTs are required
+	if (GetPreCompPhaseValue() == ePreCompRead && IsPreCompSupported()) {
+		vector<CBitVector*> vecs;
+		GetPreCompVectors(vecs);
+		m_bPreCompRead = AgreeOnPreCompCircuit(setup, vecs);
+		if (m_bPreCompRead)
+			return;
+	}
+
 	m_vGarbledCircuit.Create(0);
 	buf = (BYTE*) malloc(gt_size);
 	m_vGarbledCircuit.AttachBuf(buf, gt_size);
@@ -86,7 +105,6 @@ void YaoServerSharing::PrepareSetupPhase(ABYSetup* setup) {
 	cout << endl;
 #endif
 
-	m_vROTMasks.resize(2);
 	m_vROTMasks[0].Create((m_nClientInputBits + m_nConversionInputBits) * symbits);
 	m_vROTMasks[1].Create((m_nClientInputBits + m_nConversionInputBits) * symbits);
 
@@ -103,18 +121,6 @@ void YaoServerSharing::PrepareSetupPhase(ABYSetup* setup) {
 
 	m_vPermBits.Create(m_nServerInputBits + m_nConversionInputBits, m_cCrypto);
 
-	m_vServerKeySndBuf.Create((m_nServerInputBits + m_cBoolCircuit->GetNumA2YGates()) * symbits);
-
-	m_vClientKeySndBuf.resize(2);
-	m_vClientKeySndBuf[0].Create((m_nClientInputBits + m_nConversionInputBits) * symbits);
-	m_vClientKeySndBuf[1].Create((m_nClientInputBits + m_nConversionInputBits) * symbits);
-
-	m_vOutputShareSndBuf.Create(m_cBoolCircuit->GetNumOutputBitsForParty(CLIENT));
-
-	m_vOutputDestionations = (e_role*) malloc(sizeof(e_role) * m_cBoolCircuit->GetOutputGatesForParty(CLIENT).size()+m_cBoolCircuit->GetOutputGatesForParty(SERVER).size());
-	m_nOutputDestionationsCtr = 0;
-	//deque<uint32_t> out = m_cBoolCircuit->GetOutputGatesForParty(CLIENT);
-
 	IKNP_OTTask* task = (IKNP_OTTask*) malloc(sizeof(IKNP_OTTask));
 	task->bitlen = symbits;
 	task->snd_flavor = Snd_R_OT;
@@ -133,7 +139,10 @@ void YaoServerSharing::PerformSetupPhase(ABYSetup* setup) {
 	if (m_cBoolCircuit->GetMaxDepth() == 0)
 		return;
 
-	CreateAndSendGarbledCircuit(setup);
+	if (m_bPreCompRead)
+		AssignPreCompGates();
+	else
+		CreateAndSendGarbledCircuit(setup);
 }
 
 void YaoServerSharing::FinishSetupPhase(ABYSetup* setup) {
@@ -145,6 +154,13 @@ void YaoServerSharing::FinishSetupPhase(ABYSetup* setup) {
 
 	setup->WaitForTransmissionEnd();
 
+	if (GetPreCompPhaseValue() == ePreCompStore && IsPreCompSupported()) {
+		vector<CBitVector*> vecs;
+		CollectPreCompOutputs();
+		GetPreCompVectors(vecs);
+		StorePreCompCircuit(vecs);
+	}
+
 	//Reset input gates since they were instantiated before
 	//TODO: Change execution
 	deque<uint32_t> insrvgates = m_cBoolCircuit->GetInputGatesForParty(SERVER);
@@ -310,6 +326,12 @@ void YaoServerSharing::CreateAndSendGarbledCircuit(ABYSetup* setup) {
 	if (maxdepth == 0)
 		return;
 
+	//pick the identifier of a circuit that is stored, which the client stores with its circuit as well
+	if (GetPreCompPhaseValue() == ePreCompStore && IsPreCompSupported()) {
+		m_cCrypto->gen_rnd(m_vPreCompID, YAO_PRECOMP_ID_BYTES);
+		setup->AddSendTask(m_vPreCompID, YAO_PRECOMP_ID_BYTES);
+	}
+
 	for (uint32_t i = 0; i < maxdepth; i++) {
 		deque<uint32_t> localqueue = m_cBoolCircuit->GetLocalQueueOnLvl(i);
 		PrecomputeGC(localqueue, setup);
@@ -337,6 +359,80 @@ void YaoServerSharing::CreateAndSendGarbledCircuit(ABYSetup* setup) {
 
 }
 
+//the vectors that the online phase requires: the wire keys, the permutation bits, the OTs, and the output gate values
+void YaoServerSharing::GetPreCompVectors(vector<CBitVector*>& vecs) {
+	vecs.push_back(&m_vR);
+	vecs.push_back(&m_vServerInputKeys);
+	vecs.push_back(&m_vClientInputKeys);
+	vecs.push_back(&m_vPermBits);
+	vecs.push_back(&m_vROTMasks[0]);
+	vecs.push_back(&m_vROTMasks[1]);
+	vecs.push_back(&m_vPreCompOutputs);
+}
+
+//Store the permutation bits of the output gates in the order in which they are garbled
+void YaoServerSharing::CollectPreCompOutputs() {
+	uint64_t noutbits = 0;
+	GATE* gate;
+	for (uint32_t i = 0; i < m_cBoolCircuit->GetMaxDepth(); i++) {
+		for (uint32_t q = 0; q < 2; q++) {
+			deque<uint32_t> queue = q == 0 ? m_cBoolCircuit->GetLocalQueueOnLvl(i) : m_cBoolCircuit->GetInteractiveQueueOnLvl(i);
+			for (uint32_t j = 0; j < queue.size(); j++) {
+				if (m_pGates[queue[j]].type == G_OUT)
+					noutbits += m_pGates[queue[j]].nvals;
+			}
+		}
+	}
+	m_vPreCompOutputs.Create(noutbits);
+	noutbits = 0;
+	for (uint32_t i = 0; i < m_cBoolCircuit->GetMaxDepth(); i++) {
+		for (uint32_t q = 0; q < 2; q++) {
+			deque<uint32_t> queue = q == 0 ? m_cBoolCircuit->GetLocalQueueOnLvl(i) : m_cBoolCircuit->GetInteractiveQueueOnLvl(i);
+			for (uint32_t j = 0; j < queue.size(); j++) {
+				gate = m_pGates + queue[j];
+				if (gate->type != G_OUT)
+					continue;
+				for (uint32_t k = 0; k < gate->nvals; k++, noutbits++) {
+					m_vPreCompOutputs.SetBit(noutbits, (gate->gs.val[k / GATE_T_BITS] >> (k % GATE_T_BITS)) & 0x01);
+				}
+			}
+		}
+	}
+}
+
+//Assign the input, conversion, and output gates in the same order as CreateAndSendGarbledCircuit(), where the wire keys and
+//the values of the output gates were read from the precomputation file. All other gates are only required for garbling.
+void YaoServerSharing::AssignPreCompGates() {
+	uint64_t outbitctr = 0;
+	GATE* gate;
+	for (uint32_t i = 0; i < m_cBoolCircuit->GetMaxDepth(); i++) {
+		for (uint32_t q = 0; q < 2; q++) {
+			deque<uint32_t> queue = q == 0 ? m_cBoolCircuit->GetLocalQueueOnLvl(i) : m_cBoolCircuit->GetInteractiveQueueOnLvl(i);
+			for (uint32_t j = 0; j < queue.size(); j++) {
+				gate = m_pGates + queue[j];
+				if (gate->type == G_IN) {
+					//the keys are taken from the input key vectors in the online phase, only the counters are advanced
+					if (gate->gs.ishare.src == SERVER) {
+						m_nPermBitCtr += gate->nvals;
+					} else {
+						m_nClientInBitCtr += gate->nvals;
+						m_vClientInputGate.push_back(queue[j]);
+					}
+				} else if (gate->type == G_CONV) {
+					EvaluateConversionGate(queue[j]);
+				} else if (gate->type == G_OUT) {
+					m_vOutputDestionations[m_nOutputDestionationsCtr++] = gate->gs.oshare.dst;
+					gate->gs.val = (UGATE_T*) calloc(ceil_divide(gate->nvals, GATE_T_BITS), sizeof(UGATE_T));
+					gate->instantiated = true;
+					for (uint32_t k = 0; k < gate->nvals; k++, outbitctr++) {
+						gate->gs.val[k / GATE_T_BITS] |= ((UGATE_T) m_vPreCompOutputs.GetBit(outbitctr)) << (k % GATE_T_BITS);
+					}
+				}
+			}
+		}
+	}
+}
+
 void YaoServerSharing::PrecomputeGC(deque<uint32_t>& queue, ABYSetup* setup) {
 	for (uint32_t i = 0; i < queue.size(); i++) {
 		GATE* gate = m_pGates + queue[i];
@@ -566,12 +662,11 @@ void YaoServerSharing::EvaluateANDGate(GATE* gate, ABYSetup* setup) {
 
 	InstantiateGate(gate);
 
-	for(uint32_t g = 0; g < gate->nvals; g++) {
-		CreateGarbledTable(gate, g, gleft, gright);
-		m_nGarbledTableCtr++;
-		assert(gate->gs.yinput.pi[g] < 2);
-
-	}
+	//the garbled tables of large SIMD gates are created by several workers
+	InitScratch(GetNumSIMDChunks(gate->nvals, SIMD_CHUNK_MIN_TABLES));
+	yao_and_job job = { this, gate, gleft, gright, m_nGarbledTableCtr };
+	ParallelSIMD(gate->nvals, 1, SIMD_CHUNK_MIN_TABLES, GarbleChunk, &job);
+	m_nGarbledTableCtr += gate->nvals;
 
 	if((m_nGarbledTableCtr - m_nGarbledTableSndCtr) >= GARBLED_TABLE_WINDOW) {
 		//setup->AddSendTask(m_vGarbledCircuit.GetArr(), m_nGarbledTableCtr * m_nSecParamBytes * KEYS_PER_GATE_IN_TABLE);
@@ -585,7 +680,18 @@ void YaoServerSharing::EvaluateANDGate(GATE* gate, ABYSetup* setup) {
 }
 
 
-void YaoServerSharing::CreateGarbledTable(GATE* ggate, uint32_t pos, GATE* gleft, GATE* gright){
+void YaoServerSharing::GarbleChunk(void* ctx, uint32_t chunkid, uint64_t from, uint64_t to) {
+	yao_and_job* job = (yao_and_job*) ctx;
+	YaoServerSharing* yss = (YaoServerSharing*) job->sharing;
+	yao_scratch* scratch = &(yss->m_vScratch[chunkid]);
+
+	for(uint64_t g = from; g < to; g++) {
+		yss->CreateGarbledTable(job->gate, g, job->gleft, job->gright, job->tablectr + g, scratch);
+		assert(job->gate->gs.yinput.pi[g] < 2);
+	}
+}
+
+void YaoServerSharing::CreateGarbledTable(GATE* ggate, uint32_t pos, GATE* gleft, GATE* gright, uint64_t tablectr, yao_scratch* scratch){
 
 	uint32_t outkey;
 
@@ -593,10 +699,14 @@ void YaoServerSharing::CreateGarbledTable(GATE* ggate, uint32_t pos, GATE* gleft
 	uint8_t lpbit = gleft->gs.yinput.pi[pos];
 	uint8_t rpbit = gright->gs.yinput.pi[pos];
 	uint8_t lsbit, rsbit;
+	uint8_t** lmaskbuf = scratch->maskbuf;
+	uint8_t** rmaskbuf = scratch->maskbuf + 2;
+	uint8_t* lkeybuf = scratch->keybuf[0];
+	uint8_t* tmpbuf = scratch->keybuf[1];
 
 	assert(lpbit < 2 && rpbit < 2);
 
-	table = m_vGarbledCircuit.GetArr() + m_nGarbledTableCtr * KEYS_PER_GATE_IN_TABLE * m_nSecParamBytes;
+	table = m_vGarbledCircuit.GetArr() + tablectr * KEYS_PER_GATE_IN_TABLE * m_nSecParamBytes;
 	outwire_key = ggate->gs.yinput.outKey + pos * m_nSecParamBytes;
 
 	lkey = gleft->gs.yinput.outKey + pos * m_nSecParamBytes;
@@ -606,32 +716,32 @@ void YaoServerSharing::CreateGarbledTable(GATE* ggate, uint32_t pos, GATE* gleft
 	rsbit = (rkey[m_nSecParamBytes-1] & 0x01);
 
 	if(lpbit) {
-		m_pKeyOps->XOR(m_bLKeyBuf, lkey, m_vR.GetArr());
+		m_pKeyOps->XOR(lkeybuf, lkey, m_vR.GetArr());
 	} else {
-		memcpy(m_bLKeyBuf, lkey, m_nSecParamBytes);
+		memcpy(lkeybuf, lkey, m_nSecParamBytes);
 	}
 
 	//Encryptions of wire A
-	EncryptWire(m_bLMaskBuf[lpbit], lkey, KEYS_PER_GATE_IN_TABLE*m_nGarbledTableCtr);
-	m_pKeyOps->XOR(m_bTmpBuf, lkey, m_vR.GetArr());
-	EncryptWire(m_bLMaskBuf[!lpbit], m_bTmpBuf, KEYS_PER_GATE_IN_TABLE*m_nGarbledTableCtr);
+	EncryptWire(lmaskbuf[lpbit], lkey, KEYS_PER_GATE_IN_TABLE*tablectr, scratch);
+	m_pKeyOps->XOR(tmpbuf, lkey, m_vR.GetArr());
+	EncryptWire(lmaskbuf[!lpbit], tmpbuf, KEYS_PER_GATE_IN_TABLE*tablectr, scratch);
 
 	//Encryptions of wire B
-	EncryptWire(m_bRMaskBuf[rpbit], rkey, KEYS_PER_GATE_IN_TABLE*m_nGarbledTableCtr+1);
-	m_pKeyOps->XOR(m_bTmpBuf, rkey, m_vR.GetArr());
-	EncryptWire(m_bRMaskBuf[!rpbit], m_bTmpBuf, KEYS_PER_GATE_IN_TABLE*m_nGarbledTableCtr+1);
+	EncryptWire(rmaskbuf[rpbit], rkey, KEYS_PER_GATE_IN_TABLE*tablectr+1, scratch);
+	m_pKeyOps->XOR(tmpbuf, rkey, m_vR.GetArr());
+	EncryptWire(rmaskbuf[!rpbit], tmpbuf, KEYS_PER_GATE_IN_TABLE*tablectr+1, scratch);
 
 	//Compute two table entries, T_G is the first cipher-text, T_E the second cipher-text
 	//Compute T_G = Enc(W_a^0) XOR Enc(W_a^1) XOR p_b*R
 
-	m_pKeyOps->XOR(table, m_bLMaskBuf[0], m_bLMaskBuf[1]);
+	m_pKeyOps->XOR(table, lmaskbuf[0], lmaskbuf[1]);
 	if(rpbit)
 		m_pKeyOps->XOR(table, table, m_vR.GetArr());
 
 	if(lpbit)
-		m_pKeyOps->XOR(outwire_key, m_bLMaskBuf[1], m_bRMaskBuf[0]);
+		m_pKeyOps->XOR(outwire_key, lmaskbuf[1], rmaskbuf[0]);
 	else
-		m_pKeyOps->XOR(outwire_key, m_bLMaskBuf[0], m_bRMaskBuf[0]);
+		m_pKeyOps->XOR(outwire_key, lmaskbuf[0], rmaskbuf[0]);
 
 	if((lsbit) & (rsbit))
 		m_pKeyOps->XOR(outwire_key, outwire_key, m_vR.GetArr());
@@ -640,14 +750,14 @@ void YaoServerSharing::CreateGarbledTable(GATE* ggate, uint32_t pos, GATE* gleft
 	//Compute W^0 = W_G^0 XOR W_E^0 = Enc(W_a^0) XOR Enc(W_b^0) XOR p_a*T_G XOR p_b * (T_E XOR W_a^0)
 
 	//Compute T_E = Enc(W_b^0) XOR Enc(W_b^1) XOR W_a^0
-	m_pKeyOps->XOR(table + m_nSecParamBytes, m_bRMaskBuf[0], m_bRMaskBuf[1]);
-	m_pKeyOps->XOR(table + m_nSecParamBytes, table + m_nSecParamBytes, m_bLKeyBuf);
+	m_pKeyOps->XOR(table + m_nSecParamBytes, rmaskbuf[0], rmaskbuf[1]);
+	m_pKeyOps->XOR(table + m_nSecParamBytes, table + m_nSecParamBytes, lkeybuf);
 
 	//Compute the resulting key for the output wire
 	if(rpbit) {
 		//cout << "Server Xoring right_table" << endl;
 		m_pKeyOps->XOR(outwire_key, outwire_key, table + m_nSecParamBytes);
-		m_pKeyOps->XOR(outwire_key, outwire_key, m_bLKeyBuf);
+		m_pKeyOps->XOR(outwire_key, outwire_key, lkeybuf);
 	}
 
 	//Set permutation bit
@@ -667,13 +777,13 @@ void YaoServerSharing::CreateGarbledTable(GATE* ggate, uint32_t pos, GATE* gleft
 		PrintKey(outwire_key);
 		cout << " (" << (uint32_t) ggate->gs.yinput.pi[pos] << ")" << endl;
 		cout << "A_0: ";
-		PrintKey(m_bLMaskBuf[0]);
+		PrintKey(lmaskbuf[0]);
 		cout << "; A_1: ";
-		PrintKey(m_bLMaskBuf[1]);
+		PrintKey(lmaskbuf[1]);
 		cout << endl << "B_0: ";
-		PrintKey(m_bRMaskBuf[0]);
+		PrintKey(rmaskbuf[0]);
 		cout << "; B_1: ";
-		PrintKey(m_bRMaskBuf[1]);
+		PrintKey(rmaskbuf[1]);
 
 		cout << endl << "Table A: ";
 		PrintKey(table);
@@ -916,10 +1026,9 @@ void YaoServerSharing::InstantiateGate(GATE* gate) {
 }
 
 void YaoServerSharing::UsedGate(uint32_t gateid) {
-	//Decrease the number of further uses of the gate
-	m_pGates[gateid].nused--;
+	//Decrease the number of further uses of the gate, atomically since the children of a gate may be evaluated concurrently by different sharings
 	//If the gate is needed in another subsequent gate, delete it
-	if (!m_pGates[gateid].nused) {
+	if (!__sync_sub_and_fetch(&m_pGates[gateid].nused, 1)) {
 		free(m_pGates[gateid].gs.yinput.outKey);
 		free(m_pGates[gateid].gs.yinput.pi);
 		m_pGates[gateid].instantiated = false;
@@ -949,19 +1058,20 @@ void YaoServerSharing::EvaluateSIMDGate(uint32_t gateid) {
 	} else if (gate->type == G_SPLIT) {
 		uint32_t pos = gate->gs.sinput.pos;
 		uint32_t idleft = gate->ingates.inputs.parent; //gate->gs.sinput.input;
-		InstantiateGate(gate);
-		memcpy(gate->gs.yinput.outKey, m_pGates[idleft].gs.yinput.outKey + pos * m_nSecParamBytes, m_nSecParamBytes * gate->nvals);
-		memcpy(gate->gs.yinput.pi, m_pGates[idleft].gs.yinput.pi + pos, gate->nvals);
-		UsedGate(idleft);
+		if (pos == 0 && CanTakeOverParent(idleft)) {
+			TakeOverParent(gate, idleft);
+		} else {
+			InstantiateGate(gate);
+			memcpy(gate->gs.yinput.outKey, m_pGates[idleft].gs.yinput.outKey + pos * m_nSecParamBytes, m_nSecParamBytes * gate->nvals);
+			memcpy(gate->gs.yinput.pi, m_pGates[idleft].gs.yinput.pi + pos, gate->nvals);
+			UsedGate(idleft);
+		}
 	} else if (gate->type == G_REPEAT) {
 		uint32_t idleft = gate->ingates.inputs.parent; //gate->gs.rinput;
 		InstantiateGate(gate);
-		BYTE* keyptr = gate->gs.yinput.outKey;
-		for (uint32_t g = 0; g < gate->nvals; g++, keyptr += m_nSecParamBytes) {
-			memcpy(keyptr, m_pGates[idleft].gs.yinput.outKey, m_nSecParamBytes);
-			gate->gs.yinput.pi[g] = m_pGates[idleft].gs.yinput.pi[0];
-			assert(gate->gs.yinput.pi[g] < 2);
-		}
+		RepeatValue(gate->gs.yinput.outKey, m_pGates[idleft].gs.yinput.outKey, gate->nvals, m_nSecParamBytes);
+		assert(m_pGates[idleft].gs.yinput.pi[0] < 2);
+		memset(gate->gs.yinput.pi, m_pGates[idleft].gs.yinput.pi[0], gate->nvals);
 		UsedGate(idleft);
 	} else if (gate->type == G_COMBINEPOS) {
 		uint32_t* combinepos = gate->ingates.inputs.parents; //gate->gs.combinepos.input;
@@ -981,19 +1091,30 @@ void YaoServerSharing::EvaluateSIMDGate(uint32_t gateid) {
 		uint32_t* positions = gate->gs.sub_pos.posids; //gate->gs.combinepos.input;
 		bool del_pos = gate->gs.sub_pos.copy_posids;
 
-		InstantiateGate(gate);
-		BYTE* keyptr = gate->gs.yinput.outKey;
-		for (uint32_t g = 0; g < gate->nvals; g++, keyptr += m_nSecParamBytes) {
-			memcpy(keyptr, m_pGates[idparent].gs.yinput.outKey + positions[g] * m_nSecParamBytes, m_nSecParamBytes);
-			gate->gs.yinput.pi[g] = m_pGates[idparent].gs.yinput.pi[positions[g]];
-			assert(gate->gs.yinput.pi[g] < 2);
+		if (CanTakeOverParent(idparent) && IsPrefixView(positions, gate->nvals)) {
+			TakeOverParent(gate, idparent);
+		} else {
+			InstantiateGate(gate);
+			CopyPositionRuns(gate->gs.yinput.outKey, m_pGates[idparent].gs.yinput.outKey, positions, gate->nvals, m_nSecParamBytes);
+			CopyPositionRuns(gate->gs.yinput.pi, m_pGates[idparent].gs.yinput.pi, positions, gate->nvals, 1);
+			UsedGate(idparent);
 		}
-		UsedGate(idparent);
 		if(del_pos)
 			free(positions);
 	}
 }
 
+//the gate uses the keys and permutation bits of its parent, whose first values are the values of the gate, and the parent is released
+void YaoServerSharing::TakeOverParent(GATE* gate, uint32_t parentid) {
+	BYTE* outkey = m_pGates[parentid].gs.yinput.outKey;
+	BYTE* pi = m_pGates[parentid].gs.yinput.pi;
+	gate->gs.yinput.outKey = outkey;
+	gate->gs.yinput.pi = pi;
+	gate->instantiated = true;
+	m_pGates[parentid].nused = 0;
+	m_pGates[parentid].instantiated = false;
+}
+
 uint32_t YaoServerSharing::AssignInput(CBitVector& inputvals) {
 	deque<uint32_t> myingates = m_cBoolCircuit->GetInputGatesForParty(m_eRole);
 	inputvals.Create(m_cBoolCircuit->GetNumInputBitsForParty(m_eRole), m_cCrypto);
@@ -1095,6 +1216,9 @@ void YaoServerSharing::Reset() {
 	m_nGarbledTableCtr = 0;
 	m_nGarbledTableSndCtr = 0L;
 
+	m_vPreCompOutputs.delCBitVector();
+	m_bPreCompRead = FALSE;
+
 
 	m_cBoolCircuit->Reset();
 }
@@ -107,11 +107,7 @@ private:
 	uint32_t m_nServerKeyCtr; /**< _____________*/
 	uint32_t m_nClientInBitCtr; /**< _____________*/
 
-	uint8_t* m_bLMaskBuf[2]; /**< _____________*/
-	uint8_t* m_bRMaskBuf[2]; /**< _____________*/
-	uint8_t* m_bLKeyBuf; /**< _____________*/
 	uint8_t* m_bOKeyBuf[2]; /**< _____________*/
-	uint8_t* m_bTmpBuf;
 	//CBitVector
 
 	vector<uint32_t> m_vClientInputGate; /**< _____________*/
@@ -119,6 +115,7 @@ private:
 	deque<a2y_gate_pos_t> m_vPreSetA2YPositions;/**< _____________*/
 	e_role* m_vOutputDestionations; /** <  _____________*/
 	uint32_t m_nOutputDestionationsCtr;
+	CBitVector m_vPreCompOutputs; /**< Permutation bits of the output gates of a precomputed garbled circuit */
 
 
 	//deque<uint32_t> 			m_vClientInputGate;
@@ -167,6 +164,8 @@ private:
 	 \param gateid		Gate identifier
 	 */
 	void EvaluateSIMDGate(uint32_t gateid);
+	/** Let a gate that is a view of the first values of its parent use the keys of the parent instead of a copy */
+	void TakeOverParent(GATE* gate, uint32_t parentid);
 	/**
 	 Method for evaluating Inversion gate for the inputted
 	 gate object.
@@ -185,8 +184,12 @@ private:
 	 \param pos 		Position of the object in the queue.
 	 \param gleft	left gate in the queue.
 	 \param gright	right gate in the queue.
+	 \param tablectr	index of the garbled table that is created.
+	 \param scratch	scratch memory of the calling worker.
 	 */
-	void CreateGarbledTable(GATE* ggate, uint32_t pos, GATE* gleft, GATE* gright);
+	void CreateGarbledTable(GATE* ggate, uint32_t pos, GATE* gleft, GATE* gright, uint64_t tablectr, yao_scratch* scratch);
+	/** Create the garbled tables of the values [from, to) of an AND gate */
+	static void GarbleChunk(void* ctx, uint32_t chunkid, uint64_t from, uint64_t to);
 	/**
 	 PrecomputeGC______________
 	 \param queue 	Dequeue Object.
@@ -194,6 +197,13 @@ private:
 	 */
 	void PrecomputeGC(deque<uint32_t>& queue, ABYSetup* setup);
 
+	/** Collect the vectors that are stored for a precomputed garbled circuit and required in the online phase */
+	void GetPreCompVectors(vector<CBitVector*>& vecs);
+	/** Collect the permutation bits of the output gates, which are stored with the precomputed garbled circuit */
+	void CollectPreCompOutputs();
+	/** Assign the gates that are required in the online phase from a precomputed garbled circuit instead of garbling */
+	void AssignPreCompGates();
+
 	//void EvaluateClientOutputGate(GATE* gate);
 	void CollectClientOutputShares();
 	/**
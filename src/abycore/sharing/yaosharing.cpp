@@ -28,26 +28,43 @@ void YaoSharing::Init() {
 	m_bTempKeyBuf = (BYTE*) malloc(sizeof(BYTE) * AES_BYTES);
 
 	m_nGarbledTableCtr = 0;
+	m_bPreCompRead = FALSE;
+	memset(m_vPreCompID, 0, YAO_PRECOMP_ID_BYTES);
 
-#ifdef FIXED_KEY_GARBLING
-	m_bResKeyBuf = (BYTE*) malloc(sizeof(BYTE) * AES_BYTES);
-	m_kGarble = (AES_KEY_CTX*) malloc(sizeof(AES_KEY_CTX));
-	m_cCrypto->init_aes_key(m_kGarble, (uint8_t*) m_vFixedKeyAESSeed);
-#endif
+	InitScratch(1);
 
 	m_nSecParamIters = ceil_divide(m_nSecParamBytes, sizeof(UGATE_T));
 }
 
-BOOL YaoSharing::EncryptWire(BYTE* c, BYTE* p, uint32_t id)
+void YaoSharing::InitScratch(uint32_t nworkers) {
+	for (uint32_t i = m_vScratch.size(); i < nworkers; i++) {
+		yao_scratch scratch;
+		for (uint32_t j = 0; j < 4; j++)
+			scratch.maskbuf[j] = (BYTE*) malloc(sizeof(BYTE) * AES_BYTES);
+		for (uint32_t j = 0; j < 2; j++)
+			scratch.keybuf[j] = (BYTE*) malloc(sizeof(BYTE) * AES_BYTES);
+#ifdef FIXED_KEY_GARBLING
+		scratch.tmpkeybuf = (BYTE*) malloc(sizeof(BYTE) * AES_BYTES);
+		scratch.reskeybuf = (BYTE*) malloc(sizeof(BYTE) * AES_BYTES);
+		//every worker has its own AES context, since contexts must not be used concurrently
+		scratch.kgarble = (AES_KEY_CTX*) malloc(sizeof(AES_KEY_CTX));
+		m_cCrypto->init_aes_key(scratch.kgarble, (uint8_t*) m_vFixedKeyAESSeed);
+#endif
+		m_vScratch.push_back(scratch);
+	}
+}
+
+BOOL YaoSharing::EncryptWire(BYTE* c, BYTE* p, uint32_t id, yao_scratch* scratch)
 {
 #ifdef FIXED_KEY_GARBLING
-	memset(m_bTempKeyBuf, 0, AES_BYTES);
-	memcpy(m_bTempKeyBuf, (BYTE*) (&id), sizeof(uint32_t));
-	m_pKeyOps->XOR_DOUBLE_B(m_bTempKeyBuf, m_bTempKeyBuf, p);
-	//m_pKeyOps->XOR(m_bTempKeyBuf, m_bTempKeyBuf, p);
-	m_cCrypto->encrypt(m_kGarble, m_bResKeyBuf, m_bTempKeyBuf, AES_BYTES);
+	BYTE* tmpkeybuf = scratch->tmpkeybuf;
+	memset(tmpkeybuf, 0, AES_BYTES);
+	memcpy(tmpkeybuf, (BYTE*) (&id), sizeof(uint32_t));
+	m_pKeyOps->XOR_DOUBLE_B(tmpkeybuf, tmpkeybuf, p);
+	//m_pKeyOps->XOR(tmpkeybuf, tmpkeybuf, p);
+	m_cCrypto->encrypt(scratch->kgarble, scratch->reskeybuf, tmpkeybuf, AES_BYTES);
 
-	m_pKeyOps->XOR(c, m_bResKeyBuf, m_bTempKeyBuf);
+	m_pKeyOps->XOR(c, scratch->reskeybuf, tmpkeybuf);
 
 
 #else
@@ -82,6 +99,264 @@ void YaoSharing::PrintKey(BYTE* key) {
 	cout << (dec);
 }
 
+void YaoSharing::EstimateGateCost(GATE* gate, layer_cost* cost) {
+	uint64_t symbits = m_cCrypto->get_seclvl().symbits;
+	BOOL serverinput;
+
+	switch (gate->type) {
+	case G_NON_LIN:
+	case G_NON_LIN_VEC:
+		//the garbled tables are sent in the setup phase
+		cost->nonlinops += gate->nvals;
+		cost->setupbits += (uint64_t) gate->nvals * KEYS_PER_GATE_IN_TABLE * symbits;
+		break;
+	case G_IN:
+	case G_CONV:
+		if (gate->type == G_IN)
+			serverinput = (gate->gs.ishare.src == SERVER);
+		else
+			serverinput = (m_pGates[gate->ingates.inputs.parents[0]].context == S_ARITH && (gate->gs.pos & 0x01) == 0);
+		if ((m_eContext == S_YAO) == serverinput) {
+			//the garbler sends its input keys
+			cost->onlinebits += (uint64_t) gate->nvals * symbits;
+		} else {
+			//the evaluator obtains its keys via a random OT, sends the correction bit, and receives both masked keys
+			cost->numOTs += gate->nvals;
+			cost->setupbits += (uint64_t) gate->nvals * symbits;
+			cost->onlinebits += (uint64_t) gate->nvals * (1 + 2 * symbits);
+		}
+		break;
+	case G_OUT:
+		//the decoding bits for the evaluator are sent in the setup phase, the evaluator sends the outputs of the garbler
+		if (gate->gs.oshare.dst != SERVER)
+			cost->setupbits += gate->nvals;
+		if (gate->gs.oshare.dst != CLIENT)
+			cost->onlinebits += gate->nvals;
+		break;
+	default:
+		break;
+	}
+}
+
 void YaoSharing::PrintPerformanceStatistics() {
 	cout <<  get_sharing_name(m_eContext) << ": ANDs: " << m_nANDGates << " ; Depth: " << GetMaxCommunicationRounds() << endl;
 }
+
+void YaoSharing::CopyPositionRuns(BYTE* dst, BYTE* src, uint32_t* positions, uint32_t nvals, uint32_t valbytes) {
+	for (uint32_t g = 0, run; g < nvals; g += run) {
+		for (run = 1; g + run < nvals && positions[g + run] == positions[g] + run; run++)
+			;
+		memcpy(dst + (uint64_t) g * valbytes, src + (uint64_t) positions[g] * valbytes, (uint64_t) run * valbytes);
+	}
+}
+
+void YaoSharing::RepeatValue(BYTE* dst, BYTE* src, uint32_t nvals, uint32_t valbytes) {
+	if (nvals == 0)
+		return;
+	memcpy(dst, src, valbytes);
+	for (uint64_t filled = 1, len; filled < nvals; filled += len) {
+		len = min(filled, (uint64_t) nvals - filled);
+		memcpy(dst + filled * valbytes, dst, len * valbytes);
+	}
+}
+
+BOOL YaoSharing::IsPrefixView(uint32_t* positions, uint32_t nvals) {
+	for (uint32_t g = 0; g < nvals; g++) {
+		if (positions[g] != g)
+			return FALSE;
+	}
+	return TRUE;
+}
+
+//the keys of conversion gates are kept after their last use, hence their memory is not taken over
+BOOL YaoSharing::CanTakeOverParent(uint32_t parentid) {
+	return m_pGates[parentid].nused == 1 && m_pGates[parentid].type != G_CONV;
+}
+
+void YaoSharing::GetPreCompFileName(char* filename) {
+	sprintf(filename, "%s_pre_comp_%s.dump", m_eContext == S_YAO ? "yao" : "yao_rev", m_eRole == SERVER ? "server" : "client");
+}
+
+//the circuit is identified by its numbers of AND gates, inputs, conversions, and outputs
+void YaoSharing::GetPreCompHeader(uint32_t* header) {
+	header[0] = m_cCrypto->get_seclvl().symbits;
+	header[1] = m_cBoolCircuit->GetNumANDGates();
+	header[2] = m_cBoolCircuit->GetNumInputBitsForParty(SERVER);
+	header[3] = m_cBoolCircuit->GetNumInputBitsForParty(CLIENT);
+	header[4] = m_cBoolCircuit->GetNumB2YGates();
+	header[5] = m_cBoolCircuit->GetNumA2YGates();
+	header[6] = m_cBoolCircuit->GetNumYSwitchGates();
+	header[7] = m_cBoolCircuit->GetNumOutputBitsForParty(SERVER);
+	header[8] = m_cBoolCircuit->GetNumOutputBitsForParty(CLIENT);
+	header[9] = m_cBoolCircuit->GetMaxDepth();
+}
+
+BOOL YaoSharing::IsPreCompSupported() {
+	GATE* gate;
+	for (uint32_t i = 0; i < m_pCircuit->GetGateHead(); i++) {
+		gate = m_pGates + i;
+		if ((gate->context == m_eContext && (gate->type == G_SHARED_OUT || gate->type == G_CALLBACK || gate->type == G_PRINT_VAL || gate->type == G_ASSERT))
+				|| (gate->type == G_CONV && gate->context != m_eContext && m_pGates[gate->ingates.inputs.parents[0]].context == m_eContext)) {
+			cerr << "Yao values that are used outside of output gates cannot be precomputed, garbling the circuit in the setup phase" << endl;
+			return FALSE;
+		}
+	}
+	return TRUE;
+}
+
+//each circuit is stored as consumed flag, header, instance identifier, size of the vectors, and the vectors with their sizes
+void YaoSharing::StorePreCompCircuit(vector<CBitVector*>& vecs) {
+	char filename[32];
+	uint32_t header[YAO_PRECOMP_HEADER_LEN];
+	BYTE consumed = 0;
+	uint64_t bytes, payload = 0;
+
+	GetPreCompFileName(filename);
+	GetPreCompHeader(header);
+	for (uint32_t i = 0; i < vecs.size(); i++) {
+		payload += sizeof(uint64_t) + vecs[i]->GetSize();
+	}
+
+	FILE* fp = fopen(filename, "ab");
+	if (fp == NULL) {
+		cerr << "Could not open " << filename << " to store the garbled circuit" << endl;
+		return;
+	}
+	fwrite(&consumed, sizeof(BYTE), 1, fp);
+	fwrite(header, sizeof(uint32_t), YAO_PRECOMP_HEADER_LEN, fp);
+	fwrite(m_vPreCompID, sizeof(BYTE), YAO_PRECOMP_ID_BYTES, fp);
+	fwrite(&payload, sizeof(uint64_t), 1, fp);
+	for (uint32_t i = 0; i < vecs.size(); i++) {
+		bytes = vecs[i]->GetSize();
+		fwrite(&bytes, sizeof(uint64_t), 1, fp);
+		fwrite(vecs[i]->GetArr(), sizeof(BYTE), bytes, fp);
+	}
+	fclose(fp);
+}
+
+BOOL YaoSharing::ReadPreCompRecord(FILE* fp, BYTE* consumed, uint32_t* header, BYTE* id, uint64_t* payload) {
+	return fread(consumed, sizeof(BYTE), 1, fp) == 1 && fread(header, sizeof(uint32_t), YAO_PRECOMP_HEADER_LEN, fp) == YAO_PRECOMP_HEADER_LEN
+			&& fread(id, sizeof(BYTE), YAO_PRECOMP_ID_BYTES, fp) == YAO_PRECOMP_ID_BYTES && fread(payload, sizeof(uint64_t), 1, fp) == 1;
+}
+
+BOOL YaoSharing::ReadPreCompCircuit(vector<CBitVector*>& vecs, BOOL matchid, long* recordpos) {
+	char filename[32];
+	uint32_t header[YAO_PRECOMP_HEADER_LEN], stored[YAO_PRECOMP_HEADER_LEN];
+	BYTE id[YAO_PRECOMP_ID_BYTES];
+	BYTE consumed;
+	uint64_t bytes, payload;
+	BOOL found = FALSE;
+
+	GetPreCompFileName(filename);
+	GetPreCompHeader(header);
+	FILE* fp = fopen(filename, "rb");
+	if (fp == NULL)
+		return FALSE;
+
+	//skip the circuits that were consumed by previous executions and, for the evaluator, the circuits that the garbler
+	//does not have anymore
+	while (!found) {
+		*recordpos = ftell(fp);
+		if (!ReadPreCompRecord(fp, &consumed, stored, id, &payload))
+			break;
+		if (consumed || (matchid && memcmp(id, m_vPreCompID, YAO_PRECOMP_ID_BYTES) != 0))
+			fseek(fp, (long) payload, SEEK_CUR);
+		else
+			found = TRUE;
+	}
+	if (!found || memcmp(header, stored, sizeof(header)) != 0) {
+		if (found)
+			cerr << "The next garbled circuit in " << filename << " was stored for a different circuit, garbling the circuit in the setup phase" << endl;
+		fclose(fp);
+		return FALSE;
+	}
+
+	for (uint32_t i = 0; i < vecs.size(); i++) {
+		if (fread(&bytes, sizeof(uint64_t), 1, fp) != 1) {
+			cerr << "The garbled circuit in " << filename << " is incomplete" << endl;
+			fclose(fp);
+			return FALSE;
+		}
+		vecs[i]->Create(bytes * 8);
+		if (fread(vecs[i]->GetArr(), sizeof(BYTE), bytes, fp) != bytes) {
+			cerr << "The garbled circuit in " << filename << " is incomplete" << endl;
+			fclose(fp);
+			return FALSE;
+		}
+	}
+	fclose(fp);
+	memcpy(m_vPreCompID, id, YAO_PRECOMP_ID_BYTES);
+	return TRUE;
+}
+
+void YaoSharing::ConsumePreCompCircuit(long recordpos) {
+	char filename[32];
+	BYTE consumed = 1;
+
+	GetPreCompFileName(filename);
+	FILE* fp = fopen(filename, "r+b");
+	if (fp == NULL)
+		return;
+	fseek(fp, recordpos, SEEK_SET);
+	fwrite(&consumed, sizeof(BYTE), 1, fp);
+	fclose(fp);
+	//delete the file once the pool is empty
+	if (GetNumPreCompCircuits() == 0)
+		remove(filename);
+}
+
+//the garbler offers the identifier of its oldest unconsumed circuit, or that it has none, and the evaluator agrees if it
+//has an unconsumed circuit with the same identifier. Both parties only consume their circuits if they agreed.
+BOOL YaoSharing::AgreeOnPreCompCircuit(ABYSetup* setup, vector<CBitVector*>& vecs) {
+	BOOL garbler = (m_eContext == S_YAO) == (m_eRole == SERVER);
+	BYTE offer[1 + YAO_PRECOMP_ID_BYTES];
+	BYTE agreed;
+	long recordpos = 0;
+
+	if (garbler) {
+		offer[0] = ReadPreCompCircuit(vecs, FALSE, &recordpos);
+		memcpy(offer + 1, m_vPreCompID, YAO_PRECOMP_ID_BYTES);
+		setup->AddSendTask(offer, sizeof(offer));
+		setup->AddReceiveTask(&agreed, 1);
+		setup->WaitForTransmissionEnd();
+	} else {
+		setup->AddReceiveTask(offer, sizeof(offer));
+		setup->WaitForTransmissionEnd();
+		memcpy(m_vPreCompID, offer + 1, YAO_PRECOMP_ID_BYTES);
+		agreed = offer[0] && ReadPreCompCircuit(vecs, TRUE, &recordpos);
+		setup->AddSendTask(&agreed, 1);
+		setup->WaitForTransmissionEnd();
+	}
+
+	if (agreed) {
+		ConsumePreCompCircuit(recordpos);
+		return TRUE;
+	}
+	if (offer[0])
+		cerr << "The parties have no common precomputed garbled circuit, garbling the circuit in the setup phase" << endl;
+	for (uint32_t i = 0; i < vecs.size(); i++) {
+		vecs[i]->delCBitVector();
+	}
+	return FALSE;
+}
+
+uint32_t YaoSharing::GetNumPreCompCircuits() {
+	char filename[32];
+	uint32_t header[YAO_PRECOMP_HEADER_LEN];
+	BYTE id[YAO_PRECOMP_ID_BYTES];
+	BYTE consumed;
+	uint64_t payload;
+	uint32_t ncircuits = 0;
+
+	GetPreCompFileName(filename);
+	FILE* fp = fopen(filename, "rb");
+	if (fp == NULL)
+		return 0;
+	while (ReadPreCompRecord(fp, &consumed, header, id, &payload)) {
+		if (!consumed)
+			ncircuits++;
+		fseek(fp, (long) payload, SEEK_CUR);
+	}
+	fclose(fp);
+	return ncircuits;
+}
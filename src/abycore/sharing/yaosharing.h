@@ -44,6 +44,18 @@ typedef struct {
  */
 #define KEYS_PER_GATE_IN_TABLE 2
 
+/**
+ \def 	YAO_PRECOMP_HEADER_LEN
+ \brief	Number of uint32_t values that identify the circuit of a garbled circuit in the precomputation file
+ */
+#define YAO_PRECOMP_HEADER_LEN 10
+
+/**
+ \def 	YAO_PRECOMP_ID_BYTES
+ \brief	Number of bytes of the random identifier that both parties store with a garbled circuit in the precomputation file
+ */
+#define YAO_PRECOMP_ID_BYTES 16
+
 /**
  Yao Sharing class. <Detailed Description please.>
  */
@@ -94,6 +106,7 @@ public:
 		return m_nANDGates;
 	}
 	;
+	void EstimateGateCost(GATE* gate, layer_cost* cost);
 
 	Circuit* GetCircuitBuildRoutine() {
 		return m_cBoolCircuit;
@@ -103,6 +116,19 @@ public:
 	void PrintPerformanceStatistics();
 	//SUPER CLASS METHODS END HERE...
 
+	/**
+	 Returns the number of garbled circuits in the precomputation file of this party that were stored in ePreCompStore
+	 mode and were not consumed yet. In ePreCompStore mode, each execution garbles the circuit, transfers it to the client,
+	 and appends the wire keys, the OTs, and the garbled tables to the file of each party without evaluating the circuit,
+	 such that N executions of a compiled circuit fill the pool with N circuits. In ePreCompRead mode, each execution
+	 consumes the oldest unconsumed circuit, such that the online phase only sends the input keys and output shares.
+	 Both parties have to use the same mode. The garbler picks a random identifier for each stored circuit, and before
+	 a circuit is read, the parties check that both have a circuit with the identifier of the oldest unconsumed circuit
+	 of the garbler. Otherwise, the circuit is garbled in the setup phase as in ePreCompDefault mode and no circuit is
+	 consumed. The file is deleted once all circuits are consumed.
+	 */
+	uint32_t GetNumPreCompCircuits();
+
 	/** 
 	 Evaluating SIMD Gate.
 	 \param 	gateid 	Identifier of the gate to be evaluated.
@@ -148,24 +174,105 @@ protected:
 	uint64_t m_nANDWindowCtr; /**< Counts #AND gates for pipelined exec */
 	uint64_t m_nRemANDGates; /**< Remaining AND gates to be processed for pipelined exec */
 
+	/**
+	 Scratch memory for garbling or evaluating a single garbled table. The values of a large AND gate are split among the
+	 workers of the thread pool, each of which uses its own scratch memory.
+	 */
+	struct yao_scratch {
+		BYTE* maskbuf[4]; /**< Encryptions of the wire keys */
+		BYTE* keybuf[2]; /**< Temporary wire keys */
 #ifdef FIXED_KEY_GARBLING
-	BYTE* m_bResKeyBuf; /**< _________________________*/
-	AES_KEY_CTX* m_kGarble; /**< _________________________*/
+		BYTE* tmpkeybuf; /**< Input of the fixed-key encryption */
+		BYTE* reskeybuf; /**< Output of the fixed-key encryption */
+		AES_KEY_CTX* kgarble; /**< Fixed-key AES context */
 #endif
+	};
+	vector<yao_scratch> m_vScratch; /**< Scratch memory of the workers, the first entry is used for all small gates */
+
+	/** Context for splitting the garbling or evaluation of a large AND gate among the workers of the thread pool */
+	struct yao_and_job {
+		YaoSharing* sharing;
+		GATE* gate;
+		GATE* gleft;
+		GATE* gright;
+		uint64_t tablectr; /**< Index of the garbled table of the first value of the gate */
+	};
+
+	BOOL m_bPreCompRead; /**< The garbled circuit of the current execution was read from the precomputation file */
+	BYTE m_vPreCompID[YAO_PRECOMP_ID_BYTES]; /**< Identifier of the garbled circuit that is stored or read in the current execution */
 
 	/** Initiator function. This method is invoked from the constructor of the class.*/
 	void Init();
 
+	/**
+	 Checks whether the garbled circuit can be precomputed, i.e., whether Yao values leave this sharing only through
+	 output gates, since the keys of the other gates are not stored.
+	 */
+	BOOL IsPreCompSupported();
+	/**
+	 Appends the vectors that the online phase of this party requires as unconsumed circuit with the identifier
+	 m_vPreCompID to the precomputation file
+	 */
+	void StorePreCompCircuit(vector<CBitVector*>& vecs);
+	/**
+	 Agrees with the other party on a precomputed garbled circuit that both parties read instead of garbling the circuit,
+	 and marks the circuit as consumed. Sends and receives one message in each direction on the setup channel.
+	 \param 	setup 	setup phase, whose channel is used for the agreement
+	 \param 	vecs 	vectors that are read from the precomputation file, and deleted if no circuit is read
+	 \return 	TRUE if both parties read the circuit
+	 */
+	BOOL AgreeOnPreCompCircuit(ABYSetup* setup, vector<CBitVector*>& vecs);
+
+	/** Allocate scratch memory for nworkers workers, if not done already. Must not be called while gates are evaluated. */
+	void InitScratch(uint32_t nworkers);
+
 	/**	
 	 Encrypt Wire Function <DETAILED DESCRIPTION> 
 	 \param  c 		________________
 	 \param  p 		________________
 	 \param  id 		________________	
+	 \param  scratch 	scratch memory of the calling worker
 	 */
-	BOOL EncryptWire(BYTE* c, BYTE* p, uint32_t id);
+	BOOL EncryptWire(BYTE* c, BYTE* p, uint32_t id, yao_scratch* scratch);
 
 	/** Print the key. */
 	void PrintKey(BYTE* key);
+
+	/**
+	 Copy the values at the given positions of a parent, where each run of consecutive positions is copied by a single memcpy.
+	 \param 	dst 		destination of nvals values
+	 \param 	src 		values of the parent
+	 \param 	positions 	position in the parent of each value
+	 \param 	nvals 		number of values
+	 \param 	valbytes 	bytes per value, i.e., m_nSecParamBytes for keys and 1 for permutation bits
+	 */
+	void CopyPositionRuns(BYTE* dst, BYTE* src, uint32_t* positions, uint32_t nvals, uint32_t valbytes);
+	/** Fill nvals values with the value at src, doubling the filled range with each memcpy */
+	void RepeatValue(BYTE* dst, BYTE* src, uint32_t nvals, uint32_t valbytes);
+	/** Checks whether the positions select the first nvals values of the parent in order, i.e., the gate is a view of its parent */
+	BOOL IsPrefixView(uint32_t* positions, uint32_t nvals);
+	/**
+	 Checks whether a view of the first values of a parent can take over the memory of the parent instead of copying it,
+	 which is the case if the gate is the last use of the parent.
+	 */
+	BOOL CanTakeOverParent(uint32_t parentid);
+
+private:
+	void GetPreCompFileName(char* filename);
+	void GetPreCompHeader(uint32_t* header);
+	/** Reads the consumed flag, header, identifier, and payload size of the next circuit in the precomputation file */
+	BOOL ReadPreCompRecord(FILE* fp, BYTE* consumed, uint32_t* header, BYTE* id, uint64_t* payload);
+	/**
+	 Reads the vectors of the oldest unconsumed circuit from the precomputation file without consuming it.
+	 \param 	vecs 		vectors that are read
+	 \param 	matchid 	only read a circuit with the identifier m_vPreCompID, otherwise set m_vPreCompID to the
+	 	 	 	 	 	identifier of the circuit that was read
+	 \param 	recordpos 	position of the circuit in the file
+	 \return 	FALSE if the file has no such circuit or the circuit was stored for a different circuit
+	 */
+	BOOL ReadPreCompCircuit(vector<CBitVector*>& vecs, BOOL matchid, long* recordpos);
+	/** Marks the circuit at the given position of the precomputation file as consumed */
+	void ConsumePreCompCircuit(long recordpos);
 };
 
 #endif /* __YAOSHARING_H__ */
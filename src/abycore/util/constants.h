@@ -43,6 +43,19 @@
 #define DGK_CHANNEL DJN_CHANNEL
 #define OT_BASE_CHANNEL 0
 
+//Upper bound on the bytes that can be queued per channel in a SndThread before producers are blocked (backpressure)
+#define SND_QUEUE_MAX_BYTES (1ULL << 26)
+//Send priorities of channels in a SndThread. Pending messages of a lower priority are only sent if no higher priority message is queued
+#define SND_PRIO_HIGH 0
+#define SND_PRIO_NORMAL 1
+#define SND_PRIO_BULK 2
+#define SND_NUM_PRIOS 3
+
+//Minimum number of values a worker processes when the evaluation of a single SIMD gate is split among the workers of the thread pool.
+//Gates with less than twice as many values are evaluated by a single thread. Boolean sharing counts bits, Yao counts garbled tables
+#define SIMD_CHUNK_MIN_BITS (1 << 18)
+#define SIMD_CHUNK_MIN_TABLES (1 << 12)
+
 //Controls the number of OTs that are processed in one block. Lower values are better for lower latency networks.
 #define NUMOTBLOCKS 128
 #define BUFFER_OT_KEYS 128
@@ -114,6 +127,10 @@ enum e_gatetype {
 	G_SHARED_OUT = 0x09, /**< Enum for shared output gate, where the output is kept secret-shared between parties after the evaluation*/
 	G_TT = 0x0A, /**< Enum for computing an arbitrary truth table gate. Is needed for the 1ooN OT in BoolNonMTSharing */
 	G_SHARED_IN = 0x0B, /**< Enum for pre-shared input gate, where the parties dont secret-share (e.g. in outsourcing) */
+	G_MATMUL = 0x0C, /**< Enum for MATRIX-MULTIPLICATION gates that multiply two matrices using a matrix triple (Arithmeticsharing) */
+	G_DOT = 0x0D, /**< Enum for DOT-PRODUCT gates that sum up the products of two SIMD gates (Arithmeticsharing) */
+	G_WIDTH_CONV = 0x0E, /**< Enum for WIDTH-CONVERSION gates that reduce arithmetic shares to a smaller bit length (Arithmeticsharing) */
+	G_TRUNC = 0x0F, /**< Enum for TRUNCATION gates that locally shift fixed-point shares to the right (Arithmeticsharing) */
 	G_PRINT_VAL = 0x40, /**< Enum gate that reconstructs the shares and prints the plaintext value with the designated string */
 	G_ASSERT = 0x41, /**< Enum gate that reconstructs the shares and compares it to an provided input plaintext value */
 	G_COMBINE = 0x80, /**< Enum for COMBINER gates that combine multiple single-value gates to one multi-value gate  */
@@ -180,6 +197,7 @@ enum e_sharing {
 	S_YAO_REV= 3, /**< Enum for performing yao sharing with reverse roles to enable inter-party parallelization (see Buescher et al. USENIX'15)*/
 	S_LAST = 4, /**< Enum for indicating the last enum value. DO NOT PUT ANOTHER ENUM AFTER THIS ONE! !*/
 	S_BOOL_NO_MT = 5, /**< Enum for performing boolean sharing based on 1ooN OT */
+	S_ARITH_FIELD = 6, /**< Enum for performing arithmetic sharing over a prime field, see ABYParty::GetFieldSharing() */
 
 };
 
@@ -277,6 +295,8 @@ static string get_sharing_name(e_sharing s) {
 		return "Arith";
 	case S_BOOL_NO_MT:
 		return "1ooN Bool";
+	case S_ARITH_FIELD:
+		return "Arith Field";
 	default:
 		return "NN";
 	}
@@ -300,6 +320,10 @@ static string get_gate_type_name(e_gatetype g) {
 	case G_PERM: return "Permutation";
 	case G_COMBINEPOS: return "Combiner-Position";
 	case G_TT: return "Truth-Table";
+	case G_MATMUL: return "Matrix-Multiplication";
+	case G_DOT: return "Dot-Product";
+	case G_WIDTH_CONV: return "Width-Conversion";
+	case G_TRUNC: return "Truncation";
 	case G_ASSERT: return "Assertion";
 	case G_PRINT_VAL: return "Printer";
 	default: return "NN";
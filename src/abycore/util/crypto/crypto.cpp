@@ -120,6 +120,7 @@ void gen_rnd_bytes(prf_state_ctx* prf_state, uint8_t* resbuf, uint32_t nbytes) {
 }
 
 void crypto::gen_rnd(uint8_t* resbuf, uint32_t nbytes) {
+	CGrabLock grab(global_prf_lock);
 	gen_rnd_bytes(&global_prf_state, resbuf, nbytes);
 }
 
@@ -33,6 +33,7 @@
 #include "gmp-pk-crypto.h"
 #include "ecc-pk-crypto.h"
 #include "../socket.h"
+#include "../thread.h"
 
 #include "TedKrovetzAesNiWrapperC.h"
 #include "intrin_sequential_enc8.h"
@@ -131,6 +132,7 @@ private:
 	AES_KEY_CTX aes_enc_key;
 	AES_KEY_CTX aes_dec_key;
 	prf_state_ctx global_prf_state;
+	CLock global_prf_lock; //sharings that are evaluated concurrently draw randomness from the same PRF state
 
 	seclvl secparam;
 	uint8_t* aes_hash_in_buf;
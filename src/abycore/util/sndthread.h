@@ -20,12 +20,29 @@ struct snd_task {
 };
 
 
+/**
+ Thread that sends all messages of the channels that share a socket. Every channel has its own queue whose size is bounded by
+ SND_QUEUE_MAX_BYTES: a producer that tries to queue more data on a full channel is blocked until the data has been sent
+ (backpressure). Channels are served by priority (SND_PRIO_HIGH before SND_PRIO_NORMAL before SND_PRIO_BULK) and in a round-robin
+ manner within the same priority, such that latency-critical messages are not queued behind bulk setup data.
+ */
 class SndThread: public CThread {
 public:
 	SndThread(CSocket* sock) {
 		mysock = sock;
 		sndlock = new CLock();
 		send = new CEvent();
+		space = new CEvent();
+		m_nWaitingSnders = 0;
+		m_nMaxQueuedBytes = SND_QUEUE_MAX_BYTES;
+		for(uint32_t i = 0; i < MAX_NUM_COMM_CHANNELS; i++) {
+			m_vQueuedBytes[i] = 0;
+			m_vChannelPrio[i] = get_default_channel_priority(i);
+		}
+		for(uint32_t i = 0; i < SND_NUM_PRIOS; i++) {
+			m_vNumQueuedTasks[i] = 0;
+			m_vLastServed[i] = 0;
+		}
 	}
 	;
 
@@ -51,10 +68,7 @@ public:
 
 		//cout << "Adding a new task that is supposed to send " << task->bytelen << " bytes on channel " << (uint32_t) channelid  << endl;
 
-		sndlock->Lock();
-		send_tasks.push(task);
-		sndlock->Unlock();
-		send->Set();
+		push_task(task);
 	}
 
 
@@ -66,10 +80,7 @@ public:
 		task->snd_buf = (uint8_t*) malloc(sndbytes);
 		memcpy(task->snd_buf, sndbuf, task->bytelen);
 
-		sndlock->Lock();
-		send_tasks.push(task);
-		sndlock->Unlock();
-		send->Set();
+		push_task(task);
 		//cout << "Event set" << endl;
 
 	}
@@ -86,60 +97,141 @@ public:
 		task->bytelen = 1;
 		task->snd_buf = (uint8_t*) malloc(1);
 
-		sndlock->Lock();
-		send_tasks.push(task);
-		sndlock->Unlock();
-		send->Set();
+		push_task(task);
 #ifdef DEBUG_SEND_THREAD
 		cout << "Killing channel " << (uint32_t) task->channelid << endl;
 #endif
 	}
 
+	/**
+	 Set the maximum number of bytes that can be queued on a single channel before the producer is blocked.
+	 A message that is larger than this bound is still accepted once the queue of its channel is empty.
+	 */
+	void set_max_queued_bytes(uint64_t maxbytes) {
+		sndlock->Lock();
+		m_nMaxQueuedBytes = maxbytes;
+		sndlock->Unlock();
+		space->Set();
+	}
+
 	void ThreadMain() {
 		uint8_t channelid;
-		uint32_t iters;
 		snd_task* task;
 		bool run = true;
 		while(run) {
-			if(send_tasks.empty())
-				send->Wait();
-			//cout << "Awoken" << endl;
-
 			sndlock->Lock();
-			iters = send_tasks.size();
+			task = pop_next_task();
 			sndlock->Unlock();
 
-			while((iters--) && run) {
-				task = send_tasks.front();
-				send_tasks.pop();
-				channelid = task->channelid;
-				mysock->Send(&channelid, sizeof(uint8_t));
-				mysock->Send(&task->bytelen, sizeof(uint64_t));
-				if(task->bytelen > 0) {
-					mysock->Send(task->snd_buf, task->bytelen);
-				}
+			if(task == NULL) {
+				send->Wait();
+				continue;
+			}
+			//wake up producers that wait for space on the channel of this task
+			space->Set();
+
+			channelid = task->channelid;
+			mysock->Send(&channelid, sizeof(uint8_t));
+			mysock->Send(&task->bytelen, sizeof(uint64_t));
+			if(task->bytelen > 0) {
+				mysock->Send(task->snd_buf, task->bytelen);
+			}
 
 #ifdef DEBUG_SEND_THREAD
-				cout << "Sending on channel " <<  (uint32_t) channelid << " a message of " << task->bytelen << " bytes length" << endl;
+			cout << "Sending on channel " <<  (uint32_t) channelid << " a message of " << task->bytelen << " bytes length" << endl;
 #endif
 
-				free(task->snd_buf);
-				free(task);
+			free(task->snd_buf);
+			free(task);
 
-				if(channelid == ADMIN_CHANNEL) {
-					delete sndlock;
-					delete send;
-					run = false;
-				}
+			if(channelid == ADMIN_CHANNEL) {
+				delete sndlock;
+				delete send;
+				delete space;
+				run = false;
 			}
 		}
 	}
 	;
 private:
+	static uint8_t get_default_channel_priority(uint32_t channelid) {
+		if(channelid == ABY_PARTY_CHANNEL || channelid == OT_ADMIN_CHANNEL)
+			return SND_PRIO_HIGH;
+		if(channelid == ABY_SETUP_CHANNEL || channelid < DJN_CHANNEL)
+			return SND_PRIO_BULK;
+		return SND_PRIO_NORMAL;
+	}
+
+	//Queue a task on its channel and block while the channel holds more than m_nMaxQueuedBytes. End-of-channel signals
+	//and the kill task are never blocked.
+	void push_task(snd_task* task) {
+		uint8_t channelid = task->channelid;
+		sndlock->Lock();
+		if(task->bytelen > 0 && channelid != ADMIN_CHANNEL) {
+			bool waited = false;
+			while(!m_vSndTasks[channelid].empty() && m_vQueuedBytes[channelid] + task->bytelen > m_nMaxQueuedBytes) {
+				if(!waited) {
+					m_nWaitingSnders++;
+					waited = true;
+				}
+				sndlock->Unlock();
+				space->Wait();
+				sndlock->Lock();
+			}
+			if(waited) {
+				m_nWaitingSnders--;
+				//pass the wake-up on to other blocked producers, since space is an auto-reset event
+				if(m_nWaitingSnders > 0)
+					space->Set();
+			}
+		}
+		m_vSndTasks[channelid].push(task);
+		m_vQueuedBytes[channelid] += task->bytelen;
+		if(channelid != ADMIN_CHANNEL)
+			m_vNumQueuedTasks[m_vChannelPrio[channelid]]++;
+		sndlock->Unlock();
+		send->Set();
+	}
+
+	//Return the next task to be sent or NULL if no task is queued. Needs to be called with sndlock held.
+	//The kill task is only returned after all other queues have been flushed.
+	snd_task* pop_next_task() {
+		snd_task* task;
+		uint32_t channelid;
+		for(uint32_t p = 0; p < SND_NUM_PRIOS; p++) {
+			if(m_vNumQueuedTasks[p] == 0)
+				continue;
+			for(uint32_t i = 1; i <= MAX_NUM_COMM_CHANNELS; i++) {
+				channelid = (m_vLastServed[p] + i) % MAX_NUM_COMM_CHANNELS;
+				if(channelid == ADMIN_CHANNEL || m_vChannelPrio[channelid] != p || m_vSndTasks[channelid].empty())
+					continue;
+				task = m_vSndTasks[channelid].front();
+				m_vSndTasks[channelid].pop();
+				m_vQueuedBytes[channelid] -= task->bytelen;
+				m_vNumQueuedTasks[p]--;
+				m_vLastServed[p] = channelid;
+				return task;
+			}
+		}
+		if(!m_vSndTasks[ADMIN_CHANNEL].empty()) {
+			task = m_vSndTasks[ADMIN_CHANNEL].front();
+			m_vSndTasks[ADMIN_CHANNEL].pop();
+			return task;
+		}
+		return NULL;
+	}
+
 	CLock* sndlock;
 	CSocket* mysock;
 	CEvent* send;
-	std::queue<snd_task*> send_tasks;
+	CEvent* space;
+	std::queue<snd_task*> m_vSndTasks[MAX_NUM_COMM_CHANNELS];
+	uint64_t m_vQueuedBytes[MAX_NUM_COMM_CHANNELS];
+	uint8_t m_vChannelPrio[MAX_NUM_COMM_CHANNELS];
+	uint64_t m_vNumQueuedTasks[SND_NUM_PRIOS];
+	uint32_t m_vLastServed[SND_NUM_PRIOS];
+	uint64_t m_nMaxQueuedBytes;
+	uint32_t m_nWaitingSnders;
 };
 
 
@@ -0,0 +1,218 @@
+/**
+ \file 		threadpool.cpp
+ \author 	michael.zohner@ec-spride.de
+ \copyright	ABY - A Framework for Efficient Mixed-protocol Secure Two-party Computation
+			Copyright (C) 2015 Engineering Cryptographic Protocols Group, TU Darmstadt
+			This program is free software: you can redistribute it and/or modify
+			it under the terms of the GNU Affero General Public License as published
+			by the Free Software Foundation, either version 3 of the License, or
+			(at your option) any later version.
+			This program is distributed in the hope that it will be useful,
+			but WITHOUT ANY WARRANTY; without even the implied warranty of
+			MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+			GNU Affero General Public License for more details.
+			You should have received a copy of the GNU Affero General Public License
+			along with this program. If not, see <http://www.gnu.org/licenses/>.
+ \brief		Work-stealing thread pool implementation
+ */
+
+#include "threadpool.h"
+#include <unistd.h>
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+ThreadPool::ThreadPool(uint32_t nthreads, BOOL pinthreads) {
+	m_nThreads = nthreads > 0 ? nthreads : GetNumCores();
+	m_nNextQueue = 0;
+	m_nQueuedTasks = 0;
+	m_bStop = FALSE;
+
+	m_vQueues.resize(m_nThreads);
+	m_vQueueLocks.resize(m_nThreads);
+	m_vThreads.resize(m_nThreads);
+	for (uint32_t i = 0; i < m_nThreads; i++) {
+		m_vQueueLocks[i] = new CLock();
+	}
+	for (uint32_t i = 0; i < m_nThreads; i++) {
+		m_vThreads[i] = new CPoolWorkerThread(i, this, pinthreads);
+		m_vThreads[i]->Start();
+	}
+}
+
+ThreadPool::~ThreadPool() {
+	m_lock.Lock();
+	m_bStop = TRUE;
+	m_lock.Unlock();
+	for (uint32_t i = 0; i < m_nThreads; i++) {
+		m_vThreads[i]->m_evt.Set();
+	}
+	for (uint32_t i = 0; i < m_nThreads; i++) {
+		m_vThreads[i]->Wait();
+		delete m_vThreads[i];
+		delete m_vQueueLocks[i];
+	}
+}
+
+uint32_t ThreadPool::GetNumCores() {
+	long ncores = sysconf(_SC_NPROCESSORS_ONLN);
+	return ncores > 0 ? (uint32_t) ncores : 1;
+}
+
+void ThreadPool::Submit(CTaskGroup* group, pool_task_fct fct, void* arg) {
+	pool_task task;
+	task.fct = fct;
+	task.arg = arg;
+	task.group = group;
+
+	group->m_lock.Lock();
+	if (group->m_nPending == 0) {
+		group->m_bSuccess = TRUE;
+		group->m_evt.Reset();
+	}
+	group->m_nPending++;
+	group->m_lock.Unlock();
+
+	//count the task before it becomes visible, such that a worker that takes it cannot decrement the counter below zero
+	m_lock.Lock();
+	uint32_t queueid = m_nNextQueue;
+	m_nNextQueue = (m_nNextQueue + 1) % m_nThreads;
+	m_nQueuedTasks++;
+	m_lock.Unlock();
+
+	m_vQueueLocks[queueid]->Lock();
+	m_vQueues[queueid].push_back(task);
+	m_vQueueLocks[queueid]->Unlock();
+
+	//wake up the owner of the queue if it is idle, otherwise any idle worker that can steal the task
+	m_lock.Lock();
+	if (!m_vIdleThreads.empty()) {
+		uint32_t wakeid = m_vIdleThreads.back();
+		for (uint32_t i = 0; i < m_vIdleThreads.size(); i++) {
+			if (m_vIdleThreads[i] == queueid) {
+				wakeid = queueid;
+				m_vIdleThreads[i] = m_vIdleThreads.back();
+				break;
+			}
+		}
+		m_vIdleThreads.pop_back();
+		m_vThreads[wakeid]->m_evt.Set();
+	}
+	m_lock.Unlock();
+}
+
+BOOL ThreadPool::Wait(CTaskGroup* group) {
+	pool_task task;
+	for (;;) {
+		group->m_lock.Lock();
+		uint32_t pending = group->m_nPending;
+		group->m_lock.Unlock();
+		if (!pending)
+			break;
+
+		if (StealGroupTask(group, &task)) {
+			RunTask(&task);
+		} else {
+			//all remaining tasks of the group are being executed by workers
+			group->m_evt.Wait();
+		}
+	}
+	return group->m_bSuccess;
+}
+
+void ThreadPool::RunTask(pool_task* task) {
+	BOOL success = task->fct(task->arg);
+	CTaskGroup* group = task->group;
+
+	group->m_lock.Lock();
+	if (!success)
+		group->m_bSuccess = FALSE;
+	uint32_t pending = --group->m_nPending;
+	group->m_lock.Unlock();
+
+	if (!pending)
+		group->m_evt.Set();
+}
+
+//Take the newest task of the own queue or steal the oldest task of another queue
+BOOL ThreadPool::GetTask(uint32_t threadid, pool_task* task) {
+	BOOL found = FALSE;
+	for (uint32_t i = 0; i < m_nThreads && !found; i++) {
+		uint32_t queueid = (threadid + i) % m_nThreads;
+		m_vQueueLocks[queueid]->Lock();
+		if (!m_vQueues[queueid].empty()) {
+			if (i == 0) {
+				*task = m_vQueues[queueid].back();
+				m_vQueues[queueid].pop_back();
+			} else {
+				*task = m_vQueues[queueid].front();
+				m_vQueues[queueid].pop_front();
+			}
+			found = TRUE;
+		}
+		m_vQueueLocks[queueid]->Unlock();
+	}
+	if (found) {
+		m_lock.Lock();
+		m_nQueuedTasks--;
+		m_lock.Unlock();
+	}
+	return found;
+}
+
+BOOL ThreadPool::StealGroupTask(CTaskGroup* group, pool_task* task) {
+	BOOL found = FALSE;
+	for (uint32_t i = 0; i < m_nThreads && !found; i++) {
+		m_vQueueLocks[i]->Lock();
+		for (deque<pool_task>::iterator it = m_vQueues[i].begin(); it != m_vQueues[i].end(); it++) {
+			if (it->group == group) {
+				*task = *it;
+				m_vQueues[i].erase(it);
+				found = TRUE;
+				break;
+			}
+		}
+		m_vQueueLocks[i]->Unlock();
+	}
+	if (found) {
+		m_lock.Lock();
+		m_nQueuedTasks--;
+		m_lock.Unlock();
+	}
+	return found;
+}
+
+void ThreadPool::CPoolWorkerThread::ThreadMain() {
+#ifdef __linux__
+	if (m_bPin) {
+		cpu_set_t cpuset;
+		CPU_ZERO(&cpuset);
+		CPU_SET(threadid % GetNumCores(), &cpuset);
+		if (pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset) != 0) {
+			cerr << "Could not pin pool thread " << threadid << " to a core" << endl;
+		}
+	}
+#endif
+
+	pool_task task;
+	for (;;) {
+		if (m_pPool->GetTask(threadid, &task)) {
+			m_pPool->RunTask(&task);
+			continue;
+		}
+
+		m_pPool->m_lock.Lock();
+		if (m_pPool->m_bStop) {
+			m_pPool->m_lock.Unlock();
+			return;
+		}
+		if (m_pPool->m_nQueuedTasks > 0) {
+			//a task was queued after the queues were checked
+			m_pPool->m_lock.Unlock();
+			continue;
+		}
+		m_pPool->m_vIdleThreads.push_back(threadid);
+		m_pPool->m_lock.Unlock();
+		m_evt.Wait();
+	}
+}
@@ -0,0 +1,124 @@
+/**
+ \file 		threadpool.h
+ \author 	michael.zohner@ec-spride.de
+ \copyright	ABY - A Framework for Efficient Mixed-protocol Secure Two-party Computation
+			Copyright (C) 2015 Engineering Cryptographic Protocols Group, TU Darmstadt
+			This program is free software: you can redistribute it and/or modify
+			it under the terms of the GNU Affero General Public License as published
+			by the Free Software Foundation, either version 3 of the License, or
+			(at your option) any later version.
+			This program is distributed in the hope that it will be useful,
+			but WITHOUT ANY WARRANTY; without even the implied warranty of
+			MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+			GNU Affero General Public License for more details.
+			You should have received a copy of the GNU Affero General Public License
+			along with this program. If not, see <http://www.gnu.org/licenses/>.
+ \brief		Work-stealing thread pool that is shared by the setup and the online phase
+ */
+
+#ifndef __THREADPOOL_H__
+#define __THREADPOOL_H__
+
+#include "typedefs.h"
+#include "thread.h"
+#include <deque>
+#include <vector>
+
+using namespace std;
+
+/**
+ A set of tasks whose completion can be waited for with ThreadPool::Wait(). A task group may be re-used once Wait() returned,
+ but tasks of a group must not submit further tasks to the same group.
+ */
+class CTaskGroup {
+public:
+	CTaskGroup() :
+			m_nPending(0), m_bSuccess(TRUE) {
+	}
+	;
+private:
+	friend class ThreadPool;
+	uint32_t m_nPending;
+	BOOL m_bSuccess;
+	CLock m_lock;
+	CEvent m_evt;
+};
+
+/** Function that is executed by the thread pool, returns FALSE in case of an error */
+typedef BOOL (*pool_task_fct)(void* arg);
+
+struct pool_task {
+	pool_task_fct fct;
+	void* arg;
+	CTaskGroup* group;
+};
+
+/**
+ Thread pool with one task queue per worker. Tasks are distributed in a round-robin manner among the workers, which execute
+ the tasks in their own queue and steal tasks from the queues of the other workers once their own queue runs empty.
+ A thread that waits for a task group helps with executing the tasks of this group, such that waiting from within a task
+ (e.g., to split a large gate into smaller tasks) cannot run out of workers.
+ */
+class ThreadPool {
+public:
+	/**
+	 Constructor of the class.
+	 \param 	nthreads 	number of worker threads, 0 uses one thread per online core
+	 \param 	pinthreads 	whether worker i should be pinned to core i (modulo the number of cores)
+	 */
+	ThreadPool(uint32_t nthreads = 0, BOOL pinthreads = FALSE);
+	~ThreadPool();
+
+	/**
+	 Submit a task for asynchronous execution.
+	 \param 	group 	group whose completion can be waited for
+	 \param 	fct 	function that is executed
+	 \param 	arg 	argument that is passed to the function
+	 */
+	void Submit(CTaskGroup* group, pool_task_fct fct, void* arg);
+	/**
+	 Wait until all tasks of the group have been executed. The calling thread executes pending tasks of the group meanwhile.
+	 \return TRUE if all tasks of the group returned TRUE
+	 */
+	BOOL Wait(CTaskGroup* group);
+
+	uint32_t GetNumThreads() {
+		return m_nThreads;
+	}
+	;
+
+	/** Returns the number of online cores of this machine */
+	static uint32_t GetNumCores();
+
+private:
+	class CPoolWorkerThread: public CThread {
+	public:
+		CPoolWorkerThread(uint32_t id, ThreadPool* pool, BOOL pin) :
+				threadid(id), m_pPool(pool), m_bPin(pin) {
+		}
+		;
+		void ThreadMain();
+		uint32_t threadid;
+		ThreadPool* m_pPool;
+		BOOL m_bPin;
+		CEvent m_evt;
+	};
+
+	BOOL GetTask(uint32_t threadid, pool_task* task);
+	BOOL StealGroupTask(CTaskGroup* group, pool_task* task);
+	void RunTask(pool_task* task);
+
+	uint32_t m_nThreads;
+	uint32_t m_nNextQueue;
+	uint64_t m_nQueuedTasks;
+	BOOL m_bStop;
+
+	vector<CPoolWorkerThread*> m_vThreads;
+	vector<deque<pool_task> > m_vQueues; //task queue of each worker
+	vector<CLock*> m_vQueueLocks;
+	vector<uint32_t> m_vIdleThreads; //workers that wait for new tasks
+
+	CLock m_lock; //protects m_nNextQueue, m_nQueuedTasks, m_bStop, and m_vIdleThreads
+};
+
+#endif /* __THREADPOOL_H__ */
@@ -58,6 +58,7 @@ typedef BYTE UINT8_T;
 typedef USHORT UINT16_T;
 typedef UINT UINT32_T;
 typedef unsigned long long UINT64_T;
+typedef unsigned __int128 UINT128_T;
 typedef long long SINT64_T;
 
 typedef ULONG DWORD;
@@ -121,25 +121,9 @@ int32_t test_inner_product_circuit(e_role role, char* address, seclvl seclvl,
 }
 
 /*
- Constructs the inner product circuit. num multiplications and num additions.
+ Constructs the inner product circuit with a single dot product gate, which uses num multiplication triples and
+ accumulates the products without putting a gate for each product and addition.
  */
 share* BuildInnerProductCircuit(share *s_x, share *s_y, uint32_t num, ArithmeticCircuit *ac) {
-	uint32_t i;
-
-	// pairwise multiplication of all input values
-	s_x = ac->PutMULGate(s_x, s_y);
-
-	// split SIMD gate to separate wires (size many)
-	s_x = ac->PutSplitterGate(s_x);
-
-	// add up the individual multiplication results and store result on wire 0
-	// in arithmetic sharing ADD is for free, and does not add circuit depth, thus simple sequential adding
-	for (i = 1; i < num; i++) {
-		s_x->set_wire_id(0, ac->PutADDGate(s_x->get_wire_id(0), s_x->get_wire_id(i)));
-	}
-
-	// discard all wires, except the addition result
-	s_x->set_bitlength(1);
-
-	return s_x;
+	return ac->PutDotGate(s_x, s_y, num);
 }
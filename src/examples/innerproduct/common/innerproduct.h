@@ -49,9 +49,8 @@ int32_t test_inner_product_circuit(e_role role, char* address, seclvl seclvl,
  \param		s_y 		share of Y values
  \param 	num			the number of elements in the inner product
  \param		ac	 		Arithmetic Circuit object.
- \brief		This function is used to build and solve the Inner Product modulo 2^16. It computes the inner product by
- 	 	 	multiplying each value in x and y, and adding those multiplied results to evaluate the inner
- 	 	 	product. The addition is performed in a tree, thus with logarithmic depth.
+ \brief		This function is used to build and solve the Inner Product modulo 2^16. It computes the inner product with a
+ 	 	 	dot product gate, which multiplies each value in x and y and adds up the products in the same layer.
  */
 share* BuildInnerProductCircuit(share *s_x, share *s_y, uint32_t num, ArithmeticCircuit *ac);
 
@@ -31,16 +31,24 @@ int main(int argc, char** argv) {
 	uint32_t bitlen = 32, nvals = 65, secparam = 128, nthreads = 1, nelements=1024;
 	uint16_t port = 7766;
 	string address = "127.0.0.1";
-	bool verbose = false;
+	bool verbose = false, bench_construction = false;
 	int32_t test_op = -1;
 	e_mt_gen_alg mt_alg = MT_OT;
 	double epsilon = 1.2;
 	uint32_t num_test_runs = 5;
 
-	read_test_options(&argc, &argv, &role, &bitlen, &nvals, &secparam, &address, &port, &test_op, &num_test_runs, &mt_alg, &verbose);
+	read_test_options(&argc, &argv, &role, &bitlen, &nvals, &secparam, &address, &port, &test_op, &num_test_runs, &mt_alg, &verbose,
+			&bench_construction);
 
 	seclvl seclvl = get_sec_lvl(secparam);
 
+	if (bench_construction) {
+		//Measure the time for building the example circuits instead of running the tests
+		cout << "Benchmarking the construction of the example circuits" << endl;
+		bench_circuit_construction(role, (char*) address.c_str(), seclvl, nvals, nelements, bitlen, nthreads, mt_alg);
+		return 0;
+	}
+
 	run_tests(role, (char*) address.c_str(), seclvl, bitlen, nvals, nthreads, mt_alg, test_op, num_test_runs, verbose);
 
 	//Test the AES circuit
@@ -114,6 +122,23 @@ bool run_tests(e_role role, char* address, seclvl seclvl, uint32_t bitlen, uint3
 
 	test_standard_ops(test_ops, party, bitlen, num_test_runs, nops, role, verbose);
 	test_vector_ops(test_ops, party, bitlen, nvals, num_test_runs, nops, role, verbose);
+	test_compiled_circuit(party, bitlen, nvals, num_test_runs, role, verbose);
+	test_circuit_file(party, bitlen, nvals, role, verbose);
+	test_bristol_file(party, nvals, role, verbose);
+	test_simd_gate_from_file(party, nvals, role, verbose);
+	test_gate_deduplication(party, bitlen, nvals, role, verbose);
+	test_cost_estimate(party, bitlen, nvals, role, verbose);
+	test_mixed_circuit(party, nvals, role, verbose);
+	test_matrix_multiplication(party, role, verbose);
+	test_dot_product(party, nvals, role, verbose);
+	test_arith_widths(party, nvals, role, verbose);
+	test_arith_128(party, nvals, role, verbose);
+	test_field_sharing(party, nvals, role, verbose);
+	test_fixed_point(party, nvals, role, verbose);
+	test_y2a(party, nvals, role, verbose);
+	test_a2b_gmw(party, nvals, role, verbose);
+	test_yao_precomp(party, nvals, role, verbose);
+	test_yao_simd_views(party, nvals, role, verbose);
 
 	delete party;
 
@@ -472,8 +497,1183 @@ int32_t test_vector_ops(aby_ops_t* test_ops, ABYParty* party, uint32_t bitlen, u
 
 }
 
+//Build (a + b) * a once for each sharing and evaluate it repeatedly with fresh inputs, where Reset() keeps the gates
+int32_t test_compiled_circuit(ABYParty* party, uint32_t bitlen, uint32_t nvals, uint32_t num_test_runs, e_role role,
+		bool verbose) {
+	e_sharing testsharings[] = { S_BOOL, S_YAO, S_ARITH };
+	uint32_t ntestsharings = sizeof(testsharings) / sizeof(e_sharing);
+	uint32_t *avec, *bvec, *cvec, tmpbitlen, tmpnvals;
+	vector<Sharing*>& sharings = party->GetSharings();
+	vector<share*> shra(ntestsharings), shrb(ntestsharings), shrout(ntestsharings);
+	vector<uint32_t> ngates(ntestsharings);
+
+	avec = (uint32_t*) calloc(nvals, sizeof(uint32_t));
+	bvec = (uint32_t*) calloc(nvals, sizeof(uint32_t));
+
+	for (uint32_t i = 0; i < ntestsharings; i++) {
+		Circuit* circ = sharings[testsharings[i]]->GetCircuitBuildRoutine();
+		shra[i] = circ->PutSIMDINGate(nvals, avec, bitlen, SERVER);
+		shrb[i] = circ->PutSIMDINGate(nvals, bvec, bitlen, CLIENT);
+		shrout[i] = circ->PutOUTGate(circ->PutMULGate(circ->PutADDGate(shra[i], shrb[i]), shra[i]), ALL);
+	}
+	party->CompileCircuit();
+	for (uint32_t i = 0; i < ntestsharings; i++) {
+		ngates[i] = sharings[testsharings[i]]->GetCircuitBuildRoutine()->GetNumGates();
+	}
+
+	for (uint32_t r = 0; r < num_test_runs; r++) {
+		for (uint32_t j = 0; j < nvals; j++) {
+			avec[j] = (uint32_t) rand() % ((uint64_t) 1<<bitlen);
+			bvec[j] = (uint32_t) rand() % ((uint64_t) 1<<bitlen);
+		}
+		for (uint32_t i = 0; i < ntestsharings; i++) {
+			Circuit* circ = sharings[testsharings[i]]->GetCircuitBuildRoutine();
+			circ->SetINGateValues(role == SERVER ? shra[i] : shrb[i], role == SERVER ? avec : bvec);
+		}
+
+		party->ExecCircuit();
+
+		for (uint32_t i = 0; i < ntestsharings; i++) {
+			shrout[i]->get_clear_value_vec(&cvec, &tmpbitlen, &tmpnvals);
+			assert(tmpnvals == nvals);
+			for (uint32_t j = 0; j < nvals; j++) {
+				uint32_t verify = ((avec[j] + bvec[j]) * avec[j]) & (uint32_t) (((uint64_t) 1 << bitlen) - 1);
+				if (!verbose)
+					cout << "\t" << get_role_name(role) << " compiled circuit in " << get_sharing_name(testsharings[i])
+					<< ", run " << r << ": values[" << j << "]: a = " << avec[j] << ", b = " << bvec[j] << ", c = "
+					<< cvec[j] << ", verify = " << verify << endl;
+				assert(verify == cvec[j]);
+			}
+			free(cvec);
+		}
+		party->Reset();
+		//the gates are restored instead of cleared
+		for (uint32_t i = 0; i < ntestsharings; i++) {
+			assert(sharings[testsharings[i]]->GetCircuitBuildRoutine()->GetNumGates() == ngates[i]);
+		}
+	}
+
+	party->ReleaseCompiledCircuit();
+	party->Reset();
+	for (uint32_t i = 0; i < ntestsharings; i++) {
+		assert(sharings[testsharings[i]]->GetCircuitBuildRoutine()->GetNumGates() == 0);
+	}
+
+	free(avec);
+	free(bvec);
+
+	return 1;
+}
+
+//Write (a + b) * a for each sharing to a circuit file, check that a truncated copy is rejected, and load and evaluate the file
+int32_t test_circuit_file(ABYParty* party, uint32_t bitlen, uint32_t nvals, e_role role, bool verbose) {
+	e_sharing testsharings[] = { S_BOOL, S_YAO, S_ARITH };
+	uint32_t ntestsharings = sizeof(testsharings) / sizeof(e_sharing);
+	uint32_t *avec, *bvec, *cvec, tmpbitlen, tmpnvals;
+	vector<Sharing*>& sharings = party->GetSharings();
+	vector<share*> shra(ntestsharings), shrb(ntestsharings), shrout(ntestsharings);
+	vector<uint32_t> ngates(ntestsharings);
+	string filename = "abytest_circuit_" + get_role_name(role) + ".bin";
+	string truncname = "abytest_circuit_trunc_" + get_role_name(role) + ".bin";
+
+	avec = (uint32_t*) calloc(nvals, sizeof(uint32_t));
+	bvec = (uint32_t*) calloc(nvals, sizeof(uint32_t));
+
+	for (uint32_t i = 0; i < ntestsharings; i++) {
+		Circuit* circ = sharings[testsharings[i]]->GetCircuitBuildRoutine();
+		shra[i] = circ->PutSIMDINGate(nvals, avec, bitlen, SERVER);
+		shrb[i] = circ->PutSIMDINGate(nvals, bvec, bitlen, CLIENT);
+		shrout[i] = circ->PutOUTGate(circ->PutMULGate(circ->PutADDGate(shra[i], shrb[i]), shra[i]), ALL);
+	}
+	for (uint32_t i = 0; i < ntestsharings; i++) {
+		ngates[i] = sharings[testsharings[i]]->GetCircuitBuildRoutine()->GetNumGates();
+	}
+	BOOL written = party->WriteCircuit(filename.c_str());
+	assert(written);
+	party->Reset();
+
+	//a file that ends within the gate arrays is rejected and leaves the circuit empty
+	FILE* fp = fopen(filename.c_str(), "rb");
+	assert(fp);
+	fseek(fp, 0, SEEK_END);
+	long filebytes = ftell(fp);
+	vector<char> buf(filebytes);
+	fseek(fp, 0, SEEK_SET);
+	size_t nread = fread(buf.data(), 1, filebytes, fp);
+	assert(nread == (size_t) filebytes);
+	fclose(fp);
+	fp = fopen(truncname.c_str(), "wb");
+	assert(fp);
+	fwrite(buf.data(), 1, filebytes / 2, fp);
+	fclose(fp);
+	BOOL loaded = party->LoadCircuit(truncname.c_str());
+	assert(!loaded);
+	remove(truncname.c_str());
+	for (uint32_t i = 0; i < ntestsharings; i++) {
+		assert(sharings[testsharings[i]]->GetCircuitBuildRoutine()->GetNumGates() == 0);
+	}
+
+	loaded = party->LoadCircuit(filename.c_str());
+	assert(loaded);
+	remove(filename.c_str());
+	for (uint32_t i = 0; i < ntestsharings; i++) {
+		assert(sharings[testsharings[i]]->GetCircuitBuildRoutine()->GetNumGates() == ngates[i]);
+	}
+
+	for (uint32_t j = 0; j < nvals; j++) {
+		avec[j] = (uint32_t) rand() % ((uint64_t) 1<<bitlen);
+		bvec[j] = (uint32_t) rand() % ((uint64_t) 1<<bitlen);
+	}
+	for (uint32_t i = 0; i < ntestsharings; i++) {
+		Circuit* circ = sharings[testsharings[i]]->GetCircuitBuildRoutine();
+		circ->SetINGateValues(role == SERVER ? shra[i] : shrb[i], role == SERVER ? avec : bvec);
+	}
+
+	party->ExecCircuit();
+
+	for (uint32_t i = 0; i < ntestsharings; i++) {
+		shrout[i]->get_clear_value_vec(&cvec, &tmpbitlen, &tmpnvals);
+		assert(tmpnvals == nvals);
+		for (uint32_t j = 0; j < nvals; j++) {
+			uint32_t verify = ((avec[j] + bvec[j]) * avec[j]) & (uint32_t) (((uint64_t) 1 << bitlen) - 1);
+			if (!verbose)
+				cout << "\t" << get_role_name(role) << " loaded circuit in " << get_sharing_name(testsharings[i])
+				<< ": values[" << j << "]: a = " << avec[j] << ", b = " << bvec[j] << ", c = " << cvec[j]
+				<< ", verify = " << verify << endl;
+			assert(verify == cvec[j]);
+		}
+		free(cvec);
+	}
+	party->Reset();
+
+	free(avec);
+	free(bvec);
+
+	return 1;
+}
+
+//Import a small Bristol Fashion circuit that contains all supported gate types and evaluate it on single-bit SIMD inputs
+int32_t test_bristol_file(ABYParty* party, uint32_t nvals, e_role role, bool verbose) {
+	e_sharing testsharings[] = { S_BOOL, S_YAO };
+	uint32_t ntestsharings = sizeof(testsharings) / sizeof(e_sharing);
+	uint32_t noutputs = 5;
+	uint32_t *avec, *bvec, *cvec, tmpbitlen, tmpnvals;
+	vector<Sharing*>& sharings = party->GetSharings();
+	vector<vector<share*> > shrout(ntestsharings, vector<share*>(noutputs));
+	string filename = "abytest_bristol_" + get_role_name(role) + ".txt";
+	const char* bristol = "10 15\n2 1 1\n5 1 1 1 1 1\n\n"
+			"2 1 0 1 2 XOR\n2 1 0 1 3 AND\n1 1 0 4 INV\n1 1 1 5 EQ\n4 2 0 2 1 4 6 7 MAND\n"
+			"1 1 2 10 EQW\n2 1 3 7 11 XOR\n1 1 4 12 EQW\n2 1 5 0 13 XOR\n2 1 6 7 14 XOR\n";
+
+	FILE* fp = fopen(filename.c_str(), "w");
+	assert(fp);
+	fputs(bristol, fp);
+	fclose(fp);
+
+	avec = (uint32_t*) malloc(nvals * sizeof(uint32_t));
+	bvec = (uint32_t*) malloc(nvals * sizeof(uint32_t));
+	for (uint32_t j = 0; j < nvals; j++) {
+		avec[j] = (uint32_t) rand() & 0x01;
+		bvec[j] = (uint32_t) rand() & 0x01;
+	}
+
+	for (uint32_t i = 0; i < ntestsharings; i++) {
+		BooleanCircuit* circ = (BooleanCircuit*) sharings[testsharings[i]]->GetCircuitBuildRoutine();
+		vector<uint32_t> inputs(2);
+		inputs[0] = circ->PutSIMDINGate(nvals, avec, 1, SERVER)->get_wire_id(0);
+		inputs[1] = circ->PutSIMDINGate(nvals, bvec, 1, CLIENT)->get_wire_id(0);
+		vector<uint32_t> outputs = circ->PutGateFromBristolFile(filename, inputs, nvals);
+		assert(outputs.size() == noutputs);
+		for (uint32_t k = 0; k < noutputs; k++) {
+			shrout[i][k] = circ->PutOUTGate(new boolshare(vector<uint32_t>(1, outputs[k]), circ), ALL);
+		}
+	}
+	remove(filename.c_str());
+
+	party->ExecCircuit();
+
+	for (uint32_t i = 0; i < ntestsharings; i++) {
+		for (uint32_t k = 0; k < noutputs; k++) {
+			shrout[i][k]->get_clear_value_vec(&cvec, &tmpbitlen, &tmpnvals);
+			assert(tmpnvals == nvals);
+			for (uint32_t j = 0; j < nvals; j++) {
+				uint32_t verify;
+				switch (k) {
+				case 0: verify = avec[j] ^ bvec[j]; break;
+				case 2: case 3: verify = avec[j] ^ 0x01; break;
+				default: verify = bvec[j]; break;
+				}
+				if (!verbose)
+					cout << "\t" << get_role_name(role) << " Bristol circuit in " << get_sharing_name(testsharings[i])
+					<< ": output " << k << ", values[" << j << "]: a = " << avec[j] << ", b = " << bvec[j] << ", c = "
+					<< cvec[j] << ", verify = " << verify << endl;
+				assert(verify == cvec[j]);
+			}
+			free(cvec);
+		}
+	}
+	party->Reset();
+
+	free(avec);
+	free(bvec);
+
+	return 1;
+}
+
+//Instantiate a small .aby circuit once for nvals instances with single-bit inputs
+int32_t test_simd_gate_from_file(ABYParty* party, uint32_t nvals, e_role role, bool verbose) {
+	e_sharing testsharings[] = { S_BOOL, S_YAO };
+	uint32_t ntestsharings = sizeof(testsharings) / sizeof(e_sharing);
+	uint32_t noutputs = 4;
+	uint32_t *avec, *bvec, *cvec, tmpbitlen, tmpnvals;
+	vector<Sharing*>& sharings = party->GetSharings();
+	vector<vector<vector<share*> > > shrout(ntestsharings, vector<vector<share*> >(nvals, vector<share*>(noutputs)));
+	string filename = "abytest_circuit_" + get_role_name(role) + ".aby";
+
+	FILE* fp = fopen(filename.c_str(), "w");
+	assert(fp);
+	fputs("S 0\nC 1\nX 0 1 2\nA 0 1 3\nI 2 4\n1 5\nX 5 0 6\nO 2 3 4 6\n", fp);
+	fclose(fp);
+
+	avec = (uint32_t*) malloc(nvals * sizeof(uint32_t));
+	bvec = (uint32_t*) malloc(nvals * sizeof(uint32_t));
+	for (uint32_t j = 0; j < nvals; j++) {
+		avec[j] = (uint32_t) rand() & 0x01;
+		bvec[j] = (uint32_t) rand() & 0x01;
+	}
+
+	for (uint32_t i = 0; i < ntestsharings; i++) {
+		BooleanCircuit* circ = (BooleanCircuit*) sharings[testsharings[i]]->GetCircuitBuildRoutine();
+		vector<vector<uint32_t> > inputs(nvals, vector<uint32_t>(2));
+		for (uint32_t j = 0; j < nvals; j++) {
+			inputs[j][0] = circ->PutINGate((uint64_t) avec[j], SERVER);
+			inputs[j][1] = circ->PutINGate((uint64_t) bvec[j], CLIENT);
+		}
+		vector<vector<uint32_t> > outputs = circ->PutSIMDGateFromFile(filename, inputs);
+		assert(circ->GetInputLengthFromFile(filename) == 2);
+		for (uint32_t j = 0; j < nvals; j++) {
+			assert(outputs[j].size() == noutputs);
+			for (uint32_t k = 0; k < noutputs; k++) {
+				shrout[i][j][k] = circ->PutOUTGate(new boolshare(vector<uint32_t>(1, outputs[j][k]), circ), ALL);
+			}
+		}
+	}
+	remove(filename.c_str());
+
+	party->ExecCircuit();
+
+	for (uint32_t i = 0; i < ntestsharings; i++) {
+		for (uint32_t j = 0; j < nvals; j++) {
+			uint32_t verify[] = { avec[j] ^ bvec[j], avec[j] & bvec[j], (avec[j] ^ bvec[j]) ^ 0x01, avec[j] ^ 0x01 };
+			for (uint32_t k = 0; k < noutputs; k++) {
+				shrout[i][j][k]->get_clear_value_vec(&cvec, &tmpbitlen, &tmpnvals);
+				assert(tmpnvals == 1);
+				if (!verbose)
+					cout << "\t" << get_role_name(role) << " SIMD file circuit in " << get_sharing_name(testsharings[i])
+					<< ": instance " << j << ", output " << k << ": a = " << avec[j] << ", b = " << bvec[j] << ", c = "
+					<< cvec[0] << ", verify = " << verify[k] << endl;
+				assert(verify[k] == cvec[0]);
+				free(cvec);
+			}
+		}
+	}
+	party->Reset();
+
+	free(avec);
+	free(bvec);
+
+	return 1;
+}
+
+//Build (a op1 b) op2 a twice with swapped operands and check that the second copy is deduplicated
+int32_t test_gate_deduplication(ABYParty* party, uint32_t bitlen, uint32_t nvals, e_role role, bool verbose) {
+	e_sharing testsharings[] = { S_BOOL, S_YAO, S_ARITH };
+	uint32_t ntestsharings = sizeof(testsharings) / sizeof(e_sharing);
+	uint32_t *avec, *bvec, *cvec, tmpbitlen, tmpnvals, ngates;
+	vector<Sharing*>& sharings = party->GetSharings();
+	vector<share*> shrout(ntestsharings);
+
+	avec = (uint32_t*) malloc(nvals * sizeof(uint32_t));
+	bvec = (uint32_t*) malloc(nvals * sizeof(uint32_t));
+	for (uint32_t j = 0; j < nvals; j++) {
+		avec[j] = (uint32_t) rand() % ((uint64_t) 1<<bitlen);
+		bvec[j] = (uint32_t) rand() % ((uint64_t) 1<<bitlen);
+	}
+
+	party->SetGateDeduplication(TRUE);
+	for (uint32_t i = 0; i < ntestsharings; i++) {
+		Circuit* circ = sharings[testsharings[i]]->GetCircuitBuildRoutine();
+		share *shra, *shrb, *shrc, *shrd;
+		shra = circ->PutSIMDINGate(nvals, avec, bitlen, SERVER);
+		shrb = circ->PutSIMDINGate(nvals, bvec, bitlen, CLIENT);
+		if (testsharings[i] == S_ARITH) {
+			shrc = circ->PutMULGate(circ->PutADDGate(shra, shrb), shra);
+			ngates = circ->GetNumGates();
+			shrd = circ->PutMULGate(shra, circ->PutADDGate(shrb, shra));
+		} else {
+			shrc = circ->PutANDGate(circ->PutXORGate(shra, shrb), shra);
+			ngates = circ->GetNumGates();
+			shrd = circ->PutANDGate(shra, circ->PutXORGate(shrb, shra));
+		}
+		assert(shrd->get_wires() == shrc->get_wires());
+		assert(circ->GetNumGates() == ngates);
+		shrout[i] = circ->PutOUTGate(shrd, ALL);
+	}
+	party->SetGateDeduplication(FALSE);
+
+	party->ExecCircuit();
+
+	for (uint32_t i = 0; i < ntestsharings; i++) {
+		shrout[i]->get_clear_value_vec(&cvec, &tmpbitlen, &tmpnvals);
+		assert(tmpnvals == nvals);
+		for (uint32_t j = 0; j < nvals; j++) {
+			uint32_t verify = testsharings[i] == S_ARITH ? (avec[j] + bvec[j]) * avec[j] : (avec[j] ^ bvec[j]) & avec[j];
+			verify &= (uint32_t) (((uint64_t) 1 << bitlen) - 1);
+			if (!verbose)
+				cout << "\t" << get_role_name(role) << " deduplicated circuit in " << get_sharing_name(testsharings[i])
+				<< ": values[" << j << "]: a = " << avec[j] << ", b = " << bvec[j] << ", c = " << cvec[j]
+				<< ", verify = " << verify << endl;
+			assert(verify == cvec[j]);
+		}
+		free(cvec);
+	}
+	party->Reset();
+
+	free(avec);
+	free(bvec);
+
+	return 1;
+}
+
+//Predict the cost of (a + b) * a in each sharing and compare the non-linear operations to those of the execution
+int32_t test_cost_estimate(ABYParty* party, uint32_t bitlen, uint32_t nvals, e_role role, bool verbose) {
+	e_sharing testsharings[] = { S_BOOL, S_YAO, S_ARITH };
+	uint32_t ntestsharings = sizeof(testsharings) / sizeof(e_sharing);
+	uint32_t *avec, *bvec;
+	vector<Sharing*>& sharings = party->GetSharings();
+	vector<sharing_cost> costs;
+
+	avec = (uint32_t*) calloc(nvals, sizeof(uint32_t));
+	bvec = (uint32_t*) calloc(nvals, sizeof(uint32_t));
+
+	for (uint32_t i = 0; i < ntestsharings; i++) {
+		Circuit* circ = sharings[testsharings[i]]->GetCircuitBuildRoutine();
+		share* shra = circ->PutSIMDINGate(nvals, avec, bitlen, SERVER);
+		share* shrb = circ->PutSIMDINGate(nvals, bvec, bitlen, CLIENT);
+		circ->PutOUTGate(circ->PutMULGate(circ->PutADDGate(shra, shrb), shra), ALL);
+	}
+	layer_cost total = party->EstimateCost(costs);
+	if (!verbose)
+		party->PrintCostEstimate(1000, 1);
+	assert(total.rounds > 0 && total.onlinebits > 0);
+	assert(ABYParty::EstimateRuntime(total, 1000, 1) > 0);
+
+	party->ExecCircuit();
+
+	for (uint32_t i = 0; i < ntestsharings; i++) {
+		sharing_cost& cost = costs[testsharings[i]];
+		uint64_t nonlinops = 0, onlinebits = 0;
+		for (uint32_t l = 0; l < cost.layers.size(); l++) {
+			nonlinops += cost.layers[l].nonlinops;
+			onlinebits += cost.layers[l].onlinebits;
+		}
+		assert(nonlinops == cost.total.nonlinops && onlinebits == cost.total.onlinebits);
+		assert(cost.total.nonlinops == sharings[testsharings[i]]->GetNumNonLinearOperations());
+		assert(cost.total.rounds <= total.rounds);
+	}
+	party->Reset();
+
+	free(avec);
+	free(bvec);
+
+	return 1;
+}
+
+//Build c = a * b + a and d = max(c, b) with a MixedCircuit for a LAN and a WAN profile and verify the outputs
+int32_t test_mixed_circuit(ABYParty* party, uint32_t nvals, e_role role, bool verbose) {
+	double profiles[][2] = { { 10000, 0.2 }, { 100, 100 } };
+	uint32_t nprofiles = sizeof(profiles) / sizeof(profiles[0]);
+	uint64_t *avec, *bvec, *cvec, *dvec, mask;
+	uint32_t tmpbitlen, tmpnvals;
+
+	avec = (uint64_t*) malloc(nvals * sizeof(uint64_t));
+	bvec = (uint64_t*) malloc(nvals * sizeof(uint64_t));
+
+	for (uint32_t p = 0; p < nprofiles; p++) {
+		MixedCircuit mc(party, nvals);
+		mask = mc.GetBitLength() == 64 ? (uint64_t) -1 : ((uint64_t) 1 << mc.GetBitLength()) - 1;
+		for (uint32_t j = 0; j < nvals; j++) {
+			avec[j] = (((uint64_t) rand() << 32) | rand()) & mask;
+			bvec[j] = (((uint64_t) rand() << 32) | rand()) & mask;
+		}
+
+		uint32_t a = mc.PutSIMDINGate(avec, SERVER);
+		uint32_t b = mc.PutSIMDINGate(bvec, CLIENT);
+		uint32_t ab = mc.PutMULGate(a, b);
+		uint32_t c = mc.PutADDGate(ab, a);
+		uint32_t d = mc.PutMUXGate(c, b, mc.PutGTGate(c, b));
+		uint32_t outc = mc.PutOUTGate(c, ALL);
+		uint32_t outd = mc.PutOUTGate(d, ALL);
+		layer_cost cost = mc.BuildCircuit(profiles[p][0], profiles[p][1]);
+		assert(cost.rounds > 0);
+		assert(mc.GetSharing(d) != S_ARITH);
+		if (!verbose)
+			cout << "\t" << get_role_name(role) << " mixed circuit for " << profiles[p][0] << " Mbit/s and " << profiles[p][1]
+			<< " ms: MUL in " << get_sharing_name(mc.GetSharing(ab)) << ", ADD in " << get_sharing_name(mc.GetSharing(c))
+			<< ", MUX in " << get_sharing_name(mc.GetSharing(d)) << endl;
+
+		party->ExecCircuit();
+
+		mc.GetOutput(outc)->get_clear_value_vec(&cvec, &tmpbitlen, &tmpnvals);
+		assert(tmpnvals == nvals);
+		mc.GetOutput(outd)->get_clear_value_vec(&dvec, &tmpbitlen, &tmpnvals);
+		assert(tmpnvals == nvals);
+		for (uint32_t j = 0; j < nvals; j++) {
+			uint64_t verifyc = (avec[j] * bvec[j] + avec[j]) & mask;
+			uint64_t verifyd = max(verifyc, bvec[j]);
+			if (!verbose)
+				cout << "\t" << get_role_name(role) << " mixed circuit: values[" << j << "]: a = " << avec[j] << ", b = "
+				<< bvec[j] << ", c = " << cvec[j] << ", d = " << dvec[j] << ", verify = " << verifyc << ", " << verifyd << endl;
+			assert(verifyc == cvec[j] && verifyd == dvec[j]);
+		}
+		free(cvec);
+		free(dvec);
+		party->Reset();
+	}
+
+	free(avec);
+	free(bvec);
+
+	return 1;
+}
+
+//Multiply random matrices with a G_MATMUL gate, once with dimensions that exceed a block of the local multiplication
+int32_t test_matrix_multiplication(ABYParty* party, e_role role, bool verbose) {
+	uint32_t dims[][3] = { { 3, 5, 4 }, { 2, 70, 67 } };
+	uint32_t ndims = sizeof(dims) / sizeof(dims[0]);
+	uint64_t *avec, *bvec, *output, mask, verify;
+	uint32_t tmpbitlen, tmpnvals;
+	vector<Sharing*>& sharings = party->GetSharings();
+	ArithmeticCircuit* ac = (ArithmeticCircuit*) sharings[S_ARITH]->GetCircuitBuildRoutine();
+	uint32_t bitlen = ac->GetShareBitLen();
+
+	mask = bitlen == 64 ? (uint64_t) -1 : ((uint64_t) 1 << bitlen) - 1;
+
+	for (uint32_t d = 0; d < ndims; d++) {
+		uint32_t n = dims[d][0], m = dims[d][1], k = dims[d][2];
+		avec = (uint64_t*) malloc(n * m * sizeof(uint64_t));
+		bvec = (uint64_t*) malloc(m * k * sizeof(uint64_t));
+		for (uint32_t j = 0; j < n * m; j++)
+			avec[j] = (((uint64_t) rand() << 32) | rand()) & mask;
+		for (uint32_t j = 0; j < m * k; j++)
+			bvec[j] = (((uint64_t) rand() << 32) | rand()) & mask;
+
+		share* shra = ac->PutSIMDINGate(n * m, avec, bitlen, SERVER);
+		share* shrb = ac->PutSIMDINGate(m * k, bvec, bitlen, CLIENT);
+		share* shrres = ac->PutOUTGate(ac->PutMatMulGate(shra, shrb, n, m, k), ALL);
+
+		party->ExecCircuit();
+
+		shrres->get_clear_value_vec(&output, &tmpbitlen, &tmpnvals);
+		assert(tmpnvals == n * k);
+		for (uint32_t i = 0; i < n; i++) {
+			for (uint32_t j = 0; j < k; j++) {
+				verify = 0;
+				for (uint32_t t = 0; t < m; t++)
+					verify += avec[i * m + t] * bvec[t * k + j];
+				verify &= mask;
+				if (!verbose)
+					cout << "\t" << get_role_name(role) << " matmul " << n << "x" << m << "x" << k << ": result[" << i << "][" << j << "] = "
+					<< output[i * k + j] << ", verify = " << verify << endl;
+				assert(verify == output[i * k + j]);
+			}
+		}
+		party->Reset();
+
+		free(output);
+		delete shra;
+		delete shrb;
+		delete shrres;
+		free(avec);
+		free(bvec);
+	}
+
+	return 1;
+}
+
+//Compute a single dot product over all values and nvals dot products of length 4 with dot product gates
+int32_t test_dot_product(ABYParty* party, uint32_t nvals, e_role role, bool verbose) {
+	uint32_t dotlen = 4, len = nvals * dotlen;
+	uint64_t *avec, *bvec, *output, mask, verify;
+	uint32_t tmpbitlen, tmpnvals;
+	vector<Sharing*>& sharings = party->GetSharings();
+	ArithmeticCircuit* ac = (ArithmeticCircuit*) sharings[S_ARITH]->GetCircuitBuildRoutine();
+	uint32_t bitlen = ac->GetShareBitLen();
+
+	mask = bitlen == 64 ? (uint64_t) -1 : ((uint64_t) 1 << bitlen) - 1;
+	avec = (uint64_t*) malloc(len * sizeof(uint64_t));
+	bvec = (uint64_t*) malloc(len * sizeof(uint64_t));
+	for (uint32_t j = 0; j < len; j++) {
+		avec[j] = (((uint64_t) rand() << 32) | rand()) & mask;
+		bvec[j] = (((uint64_t) rand() << 32) | rand()) & mask;
+	}
+
+	share* shra = ac->PutSIMDINGate(len, avec, bitlen, SERVER);
+	share* shrb = ac->PutSIMDINGate(len, bvec, bitlen, CLIENT);
+	share* shrall = ac->PutOUTGate(ac->PutDotGate(shra, shrb), ALL);
+	share* shrvec = ac->PutOUTGate(ac->PutDotGate(shra, shrb, dotlen), ALL);
+
+	party->ExecCircuit();
+
+	shrall->get_clear_value_vec(&output, &tmpbitlen, &tmpnvals);
+	assert(tmpnvals == 1);
+	verify = 0;
+	for (uint32_t j = 0; j < len; j++)
+		verify += avec[j] * bvec[j];
+	verify &= mask;
+	if (!verbose)
+		cout << "\t" << get_role_name(role) << " dot product over " << len << " values: result = " << output[0] << ", verify = " << verify << endl;
+	assert(verify == output[0]);
+	free(output);
+
+	shrvec->get_clear_value_vec(&output, &tmpbitlen, &tmpnvals);
+	assert(tmpnvals == nvals);
+	for (uint32_t i = 0; i < nvals; i++) {
+		verify = 0;
+		for (uint32_t j = i * dotlen; j < (i + 1) * dotlen; j++)
+			verify += avec[j] * bvec[j];
+		verify &= mask;
+		if (!verbose)
+			cout << "\t" << get_role_name(role) << " dot product " << i << ": result = " << output[i] << ", verify = " << verify << endl;
+		assert(verify == output[i]);
+	}
+	free(output);
+	party->Reset();
+
+	delete shra;
+	delete shrb;
+	delete shrall;
+	delete shrvec;
+	free(avec);
+	free(bvec);
+
+	return 1;
+}
+
+//Multiply in a 16-bit ring, reduce 64-bit values to 16 bits, and extend the 16-bit product to 64 bits
+int32_t test_arith_widths(ABYParty* party, uint32_t nvals, e_role role, bool verbose) {
+	uint64_t *avec, *bvec, *xvec, *cvec, *output, verify;
+	uint32_t tmpbitlen, tmpnvals;
+	vector<Sharing*>& sharings = party->GetSharings();
+	ArithmeticCircuit* ac16 = (ArithmeticCircuit*) party->GetArithSharing(16)->GetCircuitBuildRoutine();
+	ArithmeticCircuit* ac64 = (ArithmeticCircuit*) party->GetArithSharing(64)->GetCircuitBuildRoutine();
+	Circuit* yc = sharings[S_YAO]->GetCircuitBuildRoutine();
+	Circuit* bc = sharings[S_BOOL]->GetCircuitBuildRoutine();
+
+	avec = (uint64_t*) malloc(nvals * sizeof(uint64_t));
+	bvec = (uint64_t*) malloc(nvals * sizeof(uint64_t));
+	xvec = (uint64_t*) malloc(nvals * sizeof(uint64_t));
+	cvec = (uint64_t*) malloc(nvals * sizeof(uint64_t));
+	for (uint32_t i = 0; i < nvals; i++) {
+		avec[i] = rand() & 0xFFFF;
+		bvec[i] = rand() & 0xFFFF;
+		xvec[i] = ((uint64_t) rand() << 32) | rand();
+		cvec[i] = ((uint64_t) rand() << 32) | rand();
+	}
+
+	share* shra = ac16->PutSIMDINGate(nvals, avec, 16, SERVER);
+	share* shrb = ac16->PutSIMDINGate(nvals, bvec, 16, CLIENT);
+	share* shrx = ac64->PutSIMDINGate(nvals, xvec, 64, SERVER);
+	share* shrc = ac64->PutSIMDINGate(nvals, cvec, 64, CLIENT);
+	share* shrprod = ac16->PutMULGate(shra, shrb);
+	share* shrtrunc = ac16->PutWidthConvGate(shrx);
+	share* shrext = ac64->PutWidthConvGate(shrprod, yc, bc);
+	share* shrextprod = ac64->PutMULGate(shrext, shrc);
+	share* shrprodout = ac16->PutOUTGate(shrprod, ALL);
+	share* shrtruncout = ac16->PutOUTGate(shrtrunc, ALL);
+	share* shrextout = ac64->PutOUTGate(shrextprod, ALL);
+
+	party->ExecCircuit();
+
+	shrprodout->get_clear_value_vec(&output, &tmpbitlen, &tmpnvals);
+	for (uint32_t i = 0; i < nvals; i++) {
+		verify = (avec[i] * bvec[i]) & 0xFFFF;
+		if (!verbose)
+			cout << "\t" << get_role_name(role) << " 16-bit MUL " << i << ": result = " << output[i] << ", verify = " << verify << endl;
+		assert(verify == output[i]);
+	}
+	free(output);
+
+	shrtruncout->get_clear_value_vec(&output, &tmpbitlen, &tmpnvals);
+	for (uint32_t i = 0; i < nvals; i++) {
+		verify = xvec[i] & 0xFFFF;
+		if (!verbose)
+			cout << "\t" << get_role_name(role) << " 64-to-16-bit " << i << ": result = " << output[i] << ", verify = " << verify << endl;
+		assert(verify == output[i]);
+	}
+	free(output);
+
+	shrextout->get_clear_value_vec(&output, &tmpbitlen, &tmpnvals);
+	for (uint32_t i = 0; i < nvals; i++) {
+		verify = ((avec[i] * bvec[i]) & 0xFFFF) * cvec[i];
+		if (!verbose)
+			cout << "\t" << get_role_name(role) << " 16-to-64-bit MUL " << i << ": result = " << output[i] << ", verify = " << verify << endl;
+		assert(verify == output[i]);
+	}
+	free(output);
+	party->Reset();
+
+	delete shra;
+	delete shrb;
+	delete shrx;
+	delete shrc;
+	delete shrprod;
+	delete shrtrunc;
+	delete shrext;
+	delete shrextprod;
+	delete shrprodout;
+	delete shrtruncout;
+	delete shrextout;
+	free(avec);
+	free(bvec);
+	free(xvec);
+	free(cvec);
+
+	return 1;
+}
+
+//Multiply and add 128-bit values and convert the result to Yao and back via Boolean sharing
+int32_t test_arith_128(ABYParty* party, uint32_t nvals, e_role role, bool verbose) {
+	UINT128_T *avec, *bvec, *output, verify;
+	uint32_t tmpbitlen, tmpnvals;
+	vector<Sharing*>& sharings = party->GetSharings();
+	ArithmeticCircuit* ac = (ArithmeticCircuit*) party->GetArithSharing(128)->GetCircuitBuildRoutine();
+	Circuit* yc = sharings[S_YAO]->GetCircuitBuildRoutine();
+	Circuit* bc = sharings[S_BOOL]->GetCircuitBuildRoutine();
+
+	avec = (UINT128_T*) malloc(nvals * sizeof(UINT128_T));
+	bvec = (UINT128_T*) malloc(nvals * sizeof(UINT128_T));
+	for (uint32_t i = 0; i < nvals; i++) {
+		avec[i] = ((UINT128_T) (((uint64_t) rand() << 32) | rand()) << 64) | (((uint64_t) rand() << 32) | rand());
+		bvec[i] = ((UINT128_T) (((uint64_t) rand() << 32) | rand()) << 64) | (((uint64_t) rand() << 32) | rand());
+	}
+
+	share* shra = ac->PutSIMDINGate(nvals, avec, 128, SERVER);
+	share* shrb = ac->PutSIMDINGate(nvals, bvec, 128, CLIENT);
+	share* shrmul = ac->PutMULGate(shra, shrb);
+	share* shrres = ac->PutADDGate(shrmul, shra);
+	share* shry = yc->PutA2YGate(shrres);
+	share* shrbool = bc->PutY2BGate(shry);
+	share* shrconv = ac->PutB2AGate(shrbool);
+	share* shrout = ac->PutOUTGate(shrres, ALL);
+	share* shrconvout = ac->PutOUTGate(shrconv, ALL);
+
+	party->ExecCircuit();
+
+	((arithshare*) shrout)->get_clear_value_vec(&output, &tmpbitlen, &tmpnvals);
+	assert(tmpbitlen == 128 && tmpnvals == nvals);
+	for (uint32_t i = 0; i < nvals; i++) {
+		verify = avec[i] * bvec[i] + avec[i];
+		if (!verbose)
+			cout << "\t" << get_role_name(role) << " 128-bit MUL-ADD " << i << ": result = " << (uint64_t) (output[i] >> 64) << ":" << (uint64_t) output[i]
+					<< ", verify = " << (uint64_t) (verify >> 64) << ":" << (uint64_t) verify << endl;
+		assert(verify == output[i]);
+	}
+	free(output);
+
+	((arithshare*) shrconvout)->get_clear_value_vec(&output, &tmpbitlen, &tmpnvals);
+	for (uint32_t i = 0; i < nvals; i++) {
+		verify = avec[i] * bvec[i] + avec[i];
+		if (!verbose)
+			cout << "\t" << get_role_name(role) << " 128-bit A2Y-Y2B-B2A " << i << ": result = " << (uint64_t) (output[i] >> 64) << ":"
+					<< (uint64_t) output[i] << ", verify = " << (uint64_t) (verify >> 64) << ":" << (uint64_t) verify << endl;
+		assert(verify == output[i]);
+	}
+	free(output);
+	party->Reset();
+
+	delete shra;
+	delete shrb;
+	delete shrmul;
+	delete shrres;
+	delete shry;
+	delete shrbool;
+	delete shrconv;
+	delete shrout;
+	delete shrconvout;
+	free(avec);
+	free(bvec);
+
+	return 1;
+}
+
+int32_t test_field_sharing(ABYParty* party, uint32_t nvals, e_role role, bool verbose) {
+	//the Mersenne prime 2^61 - 1
+	uint64_t prime = ((uint64_t) 1 << 61) - 1;
+	uint64_t *avec, *bvec, *output, verify;
+	uint32_t tmpbitlen, tmpnvals;
+	ArithmeticCircuit* fc = (ArithmeticCircuit*) party->GetFieldSharing(prime)->GetCircuitBuildRoutine();
+
+	avec = (uint64_t*) malloc(nvals * sizeof(uint64_t));
+	bvec = (uint64_t*) malloc(nvals * sizeof(uint64_t));
+	for (uint32_t i = 0; i < nvals; i++) {
+		//inputs are reduced modulo the prime
+		avec[i] = ((uint64_t) rand() << 32) | rand();
+		bvec[i] = ((uint64_t) rand() << 32) | rand();
+	}
+
+	share* shra = fc->PutSIMDINGate(nvals, avec, 64, SERVER);
+	share* shrb = fc->PutSIMDINGate(nvals, bvec, 64, CLIENT);
+	share* shrmul = fc->PutMULGate(shra, shrb);
+	share* shrsub = fc->PutSUBGate(shrmul, shra);
+	share* shrcons = fc->PutSIMDCONSGate(nvals, (UGATE_T) 5, 64);
+	share* shrres = fc->PutADDGate(shrsub, shrcons);
+	share* shrdot = fc->PutDotGate(shra, shrb);
+	share* shrout = fc->PutOUTGate(shrres, ALL);
+	share* shrdotout = fc->PutOUTGate(shrdot, ALL);
+
+	party->ExecCircuit();
+
+	((arithshare*) shrout)->get_clear_value_vec(&output, &tmpbitlen, &tmpnvals);
+	assert(tmpnvals == nvals);
+	UINT128_T dot = 0;
+	for (uint32_t i = 0; i < nvals; i++) {
+		UINT128_T a = avec[i] % prime, b = bvec[i] % prime;
+		verify = (uint64_t) ((a * b + prime - a + 5) % prime);
+		dot = (dot + a * b) % prime;
+		if (!verbose)
+			cout << "\t" << get_role_name(role) << " field MUL-SUB-ADD " << i << ": result = " << output[i] << ", verify = " << verify << endl;
+		assert(verify == output[i]);
+	}
+	free(output);
+
+	((arithshare*) shrdotout)->get_clear_value_vec(&output, &tmpbitlen, &tmpnvals);
+	assert(tmpnvals == 1);
+	if (!verbose)
+		cout << "\t" << get_role_name(role) << " field DOT: result = " << output[0] << ", verify = " << (uint64_t) dot << endl;
+	assert((uint64_t) dot == output[0]);
+	free(output);
+	party->Reset();
+
+	delete shra;
+	delete shrb;
+	delete shrmul;
+	delete shrsub;
+	delete shrcons;
+	delete shrres;
+	delete shrdot;
+	delete shrout;
+	delete shrdotout;
+	free(avec);
+	free(bvec);
+
+	return 1;
+}
+
+int32_t test_fixed_point(ABYParty* party, uint32_t nvals, e_role role, bool verbose) {
+	//signed fixed-point values with 16 fractional bits and an absolute value below 2^8 in 64-bit shares
+	uint32_t fracbits = 16;
+	uint64_t *avec, *bvec, *output;
+	int64_t verify, dot = 0;
+	uint32_t tmpbitlen, tmpnvals;
+	ArithmeticCircuit* ac = (ArithmeticCircuit*) party->GetArithSharing(64)->GetCircuitBuildRoutine();
+
+	avec = (uint64_t*) malloc(nvals * sizeof(uint64_t));
+	bvec = (uint64_t*) malloc(nvals * sizeof(uint64_t));
+	for (uint32_t i = 0; i < nvals; i++) {
+		avec[i] = (uint64_t) (int64_t) ((rand() % (1 << 24)) - (1 << 23));
+		bvec[i] = (uint64_t) (int64_t) ((rand() % (1 << 24)) - (1 << 23));
+	}
+
+	share* shra = ac->PutSIMDINGate(nvals, avec, 64, SERVER);
+	share* shrb = ac->PutSIMDINGate(nvals, bvec, 64, CLIENT);
+	share* shrmul = ac->PutMULGate(shra, shrb);
+	share* shrtrunc = ac->PutTruncGate(shrmul, fracbits);
+	share* shrfpmul = ac->PutFPMULGate(shra, shrb, fracbits);
+	share* shrfpdot = ac->PutFPDotGate(shra, shrb, fracbits);
+	share* shrtruncout = ac->PutOUTGate(shrtrunc, ALL);
+	share* shrfpmulout = ac->PutOUTGate(shrfpmul, ALL);
+	share* shrfpdotout = ac->PutOUTGate(shrfpdot, ALL);
+
+	party->ExecCircuit();
+
+	//the local truncation may be off by one in the last bit
+	uint64_t *truncout, *fpmulout;
+	((arithshare*) shrtruncout)->get_clear_value_vec(&truncout, &tmpbitlen, &tmpnvals);
+	((arithshare*) shrfpmulout)->get_clear_value_vec(&fpmulout, &tmpbitlen, &tmpnvals);
+	assert(tmpnvals == nvals);
+	for (uint32_t i = 0; i < nvals; i++) {
+		verify = ((int64_t) avec[i] * (int64_t) bvec[i]) >> fracbits;
+		dot += (int64_t) avec[i] * (int64_t) bvec[i];
+		if (!verbose)
+			cout << "\t" << get_role_name(role) << " FP MUL " << i << ": trunc = " << (int64_t) truncout[i] << ", fused = " << (int64_t) fpmulout[i]
+					<< ", verify = " << verify << endl;
+		assert(llabs((int64_t) truncout[i] - verify) <= 1);
+		assert(llabs((int64_t) fpmulout[i] - verify) <= 1);
+	}
+	free(truncout);
+	free(fpmulout);
+
+	((arithshare*) shrfpdotout)->get_clear_value_vec(&output, &tmpbitlen, &tmpnvals);
+	assert(tmpnvals == 1);
+	verify = dot >> fracbits;
+	if (!verbose)
+		cout << "\t" << get_role_name(role) << " FP DOT: result = " << (int64_t) output[0] << ", verify = " << verify << endl;
+	assert(llabs((int64_t) output[0] - verify) <= 1);
+	free(output);
+	party->Reset();
+
+	delete shra;
+	delete shrb;
+	delete shrmul;
+	delete shrtrunc;
+	delete shrfpmul;
+	delete shrfpdot;
+	delete shrtruncout;
+	delete shrfpmulout;
+	delete shrfpdotout;
+	free(avec);
+	free(bvec);
+
+	return 1;
+}
+
+//Convert Yao shares to arithmetic shares with the direct Y2A gate and with Y2B and B2A
+int32_t test_y2a(ABYParty* party, uint32_t nvals, e_role role, bool verbose) {
+	uint32_t *avec, *bvec, *output, *outputb2a, verify;
+	uint32_t tmpbitlen, tmpnvals;
+	vector<Sharing*>& sharings = party->GetSharings();
+	ArithmeticCircuit* ac = (ArithmeticCircuit*) party->GetArithSharing(32)->GetCircuitBuildRoutine();
+	Circuit* yc = sharings[S_YAO]->GetCircuitBuildRoutine();
+	Circuit* yrc = sharings[S_YAO_REV]->GetCircuitBuildRoutine();
+	Circuit* bc = sharings[S_BOOL]->GetCircuitBuildRoutine();
+
+	avec = (uint32_t*) malloc(nvals * sizeof(uint32_t));
+	bvec = (uint32_t*) malloc(nvals * sizeof(uint32_t));
+	for (uint32_t i = 0; i < nvals; i++) {
+		avec[i] = rand();
+		bvec[i] = rand();
+	}
+
+	share* shra = yc->PutSIMDINGate(nvals, avec, 32, SERVER);
+	share* shrb = yc->PutSIMDINGate(nvals, bvec, 32, CLIENT);
+	share* shrsum = yc->PutADDGate(shra, shrb);
+	share* shrra = yrc->PutSIMDINGate(nvals, avec, 32, SERVER);
+	share* shrrb = yrc->PutSIMDINGate(nvals, bvec, 32, CLIENT);
+	share* shrrsum = yrc->PutADDGate(shrra, shrrb);
+	share* shry2a = ac->PutY2AGate(shrsum);
+	share* shrry2a = ac->PutY2AGate(shrrsum);
+	share* shrbool = bc->PutY2BGate(shrsum);
+	share* shrb2a = ac->PutB2AGate(shrbool);
+	share* shrres = ac->PutMULGate(shry2a, shrry2a);
+	share* shrout = ac->PutOUTGate(shrres, ALL);
+	share* shrb2aout = ac->PutOUTGate(shrb2a, ALL);
+
+	party->ExecCircuit();
+
+	shrout->get_clear_value_vec(&output, &tmpbitlen, &tmpnvals);
+	shrb2aout->get_clear_value_vec(&outputb2a, &tmpbitlen, &tmpnvals);
+	for (uint32_t i = 0; i < nvals; i++) {
+		verify = (avec[i] + bvec[i]) * (avec[i] + bvec[i]);
+		if (!verbose)
+			cout << "\t" << get_role_name(role) << " Y2A " << i << ": result = " << output[i] << ", Y2B-B2A = " << outputb2a[i] << ", verify = " << verify << endl;
+		assert(verify == output[i]);
+		assert(avec[i] + bvec[i] == outputb2a[i]);
+	}
+	free(output);
+	free(outputb2a);
+	party->Reset();
+
+	delete shra;
+	delete shrb;
+	delete shrsum;
+	delete shrra;
+	delete shrrb;
+	delete shrrsum;
+	delete shry2a;
+	delete shrry2a;
+	delete shrbool;
+	delete shrb2a;
+	delete shrres;
+	delete shrout;
+	delete shrb2aout;
+	free(avec);
+	free(bvec);
+
+	return 1;
+}
+
+int32_t test_a2b_gmw(ABYParty* party, uint32_t nvals, e_role role, bool verbose) {
+	uint32_t *avec, *bvec, *outsum, *outprod, *outyao, verify;
+	uint32_t tmpbitlen, tmpnvals;
+	vector<Sharing*>& sharings = party->GetSharings();
+	Circuit* ac = party->GetArithSharing(32)->GetCircuitBuildRoutine();
+	Circuit* yc = sharings[S_YAO]->GetCircuitBuildRoutine();
+	BooleanCircuit* bc = (BooleanCircuit*) sharings[S_BOOL]->GetCircuitBuildRoutine();
+
+	avec = (uint32_t*) malloc(nvals * sizeof(uint32_t));
+	bvec = (uint32_t*) malloc(nvals * sizeof(uint32_t));
+	for (uint32_t i = 0; i < nvals; i++) {
+		avec[i] = rand();
+		bvec[i] = rand();
+	}
+
+	share* shra = ac->PutSIMDINGate(nvals, avec, 32, SERVER);
+	share* shrb = ac->PutSIMDINGate(nvals, bvec, 32, CLIENT);
+	//the sum is a local parent in the same layer, the product an interactive parent
+	share* shrsum = ac->PutADDGate(shra, shrb);
+	share* shrprod = ac->PutMULGate(shra, shrb);
+	share* shrboolsum = bc->PutA2BGate(shrsum);
+	share* shrboolprod = bc->PutA2BGate(shrprod);
+	share* shryaoprod = bc->PutA2BGate(shrprod, yc);
+	share* shrsumout = bc->PutOUTGate(shrboolsum, ALL);
+	share* shrprodout = bc->PutOUTGate(shrboolprod, ALL);
+	share* shryaoout = bc->PutOUTGate(shryaoprod, ALL);
+
+	party->ExecCircuit();
+
+	shrsumout->get_clear_value_vec(&outsum, &tmpbitlen, &tmpnvals);
+	shrprodout->get_clear_value_vec(&outprod, &tmpbitlen, &tmpnvals);
+	shryaoout->get_clear_value_vec(&outyao, &tmpbitlen, &tmpnvals);
+	for (uint32_t i = 0; i < nvals; i++) {
+		verify = avec[i] * bvec[i];
+		if (!verbose)
+			cout << "\t" << get_role_name(role) << " A2B " << i << ": sum = " << outsum[i] << ", product = " << outprod[i] << ", via Yao = "
+					<< outyao[i] << ", verify = " << verify << endl;
+		assert(avec[i] + bvec[i] == outsum[i]);
+		assert(verify == outprod[i]);
+		assert(verify == outyao[i]);
+	}
+	free(outsum);
+	free(outprod);
+	free(outyao);
+	party->Reset();
+
+	delete shra;
+	delete shrb;
+	delete shrsum;
+	delete shrprod;
+	delete shrboolsum;
+	delete shrboolprod;
+	delete shryaoprod;
+	delete shrsumout;
+	delete shrprodout;
+	delete shryaoout;
+	free(avec);
+	free(bvec);
+
+	return 1;
+}
+
+//Garble two instances of a circuit in advance, then evaluate both instances from the pool of precomputed circuits
+int32_t test_yao_precomp(ABYParty* party, uint32_t nvals, e_role role, bool verbose) {
+	uint32_t *avec, *bvec, *output, verify;
+	uint32_t tmpbitlen, tmpnvals;
+	uint32_t ninstances = 2;
+	vector<Sharing*>& sharings = party->GetSharings();
+	YaoSharing* ys = (YaoSharing*) sharings[S_YAO];
+	Circuit* yc = ys->GetCircuitBuildRoutine();
+
+	avec = (uint32_t*) malloc(nvals * sizeof(uint32_t));
+	bvec = (uint32_t*) malloc(nvals * sizeof(uint32_t));
+	assert(ys->GetNumPreCompCircuits() == 0);
+
+	//the last two runs store one more circuit, which only the client keeps, such that both parties fall back to garbling
+	for (uint32_t r = 0; r < 2 * ninstances + 2; r++) {
+		ys->SetPreCompPhaseValue(r < ninstances || r == 2 * ninstances ? ePreCompStore : ePreCompRead);
+		if (r == 2 * ninstances + 1 && role == SERVER)
+			remove("yao_pre_comp_server.dump");
+		for (uint32_t i = 0; i < nvals; i++) {
+			avec[i] = rand();
+			bvec[i] = rand();
+		}
+		share* shra = yc->PutSIMDINGate(nvals, avec, 32, SERVER);
+		share* shrb = yc->PutSIMDINGate(nvals, bvec, 32, CLIENT);
+		share* shrsum = yc->PutADDGate(shra, shrb);
+		share* shrres = yc->PutXORGate(shrsum, shrb);
+		share* shrout = yc->PutOUTGate(shrres, ALL);
+
+		party->ExecCircuit();
+
+		if (r < ninstances) {
+			assert(ys->GetNumPreCompCircuits() == r + 1);
+		} else if (r == 2 * ninstances) {
+			assert(ys->GetNumPreCompCircuits() == 1);
+		} else {
+			if (r < 2 * ninstances)
+				assert(ys->GetNumPreCompCircuits() == 2 * ninstances - r - 1);
+			else
+				assert(ys->GetNumPreCompCircuits() == (role == SERVER ? 0 : 1));
+			shrout->get_clear_value_vec(&output, &tmpbitlen, &tmpnvals);
+			for (uint32_t i = 0; i < nvals; i++) {
+				verify = (avec[i] + bvec[i]) ^ bvec[i];
+				if (!verbose)
+					cout << "\t" << get_role_name(role) << " precomputed Yao " << i << ": result = " << output[i] << ", verify = " << verify << endl;
+				assert(verify == output[i]);
+			}
+			free(output);
+		}
+		party->Reset();
+
+		delete shra;
+		delete shrb;
+		delete shrsum;
+		delete shrres;
+		delete shrout;
+	}
+	ys->SetPreCompPhaseValue(ePreCompDefault);
+	if (role == CLIENT)
+		remove("yao_pre_comp_client.dump");
+	free(avec);
+	free(bvec);
+
+	return 1;
+}
+
+//Rearrange SIMD values in Yao sharing with subsets that are prefixes or consist of runs of positions, and with repeaters
+int32_t test_yao_simd_views(ABYParty* party, uint32_t nvals, e_role role, bool verbose) {
+	uint32_t *avec, *bvec, *outprefix, *outruns, *outrep, *prefixpos, *runpos, verify;
+	uint32_t tmpbitlen, tmpnvals;
+	uint32_t nprefix = ceil_divide(nvals, 2);
+	Circuit* yc = party->GetSharings()[S_YAO]->GetCircuitBuildRoutine();
+
+	avec = (uint32_t*) malloc(nvals * sizeof(uint32_t));
+	bvec = (uint32_t*) malloc(nvals * sizeof(uint32_t));
+	prefixpos = (uint32_t*) malloc(nprefix * sizeof(uint32_t));
+	runpos = (uint32_t*) malloc(nvals * sizeof(uint32_t));
+	for (uint32_t i = 0; i < nvals; i++) {
+		avec[i] = rand();
+		bvec[i] = rand();
+		//swap the first and second half of the values, which yields two runs of positions
+		runpos[i] = (i + nvals - nprefix) % nvals;
+	}
+	for (uint32_t i = 0; i < nprefix; i++) {
+		prefixpos[i] = i;
+	}
+
+	share* shra = yc->PutSIMDINGate(nvals, avec, 32, SERVER);
+	share* shrb = yc->PutSIMDINGate(nvals, bvec, 32, CLIENT);
+	//the XOR is only used by the prefix subset, which can take over its keys
+	share* shrxor = yc->PutXORGate(shra, shrb);
+	share* shrsum = yc->PutADDGate(shra, shrb);
+	share* shrprefix = yc->PutSubsetGate(shrxor, prefixpos, nprefix);
+	share* shrruns = yc->PutSubsetGate(shrsum, runpos, nvals);
+	share* shrfirst = yc->PutSubsetGate(shrsum, runpos, 1);
+	share* shrrep = yc->PutRepeaterGate(nvals, shrfirst);
+	share* shrprefixout = yc->PutOUTGate(shrprefix, ALL);
+	share* shrrunsout = yc->PutOUTGate(shrruns, ALL);
+	share* shrrepout = yc->PutOUTGate(shrrep, ALL);
+
+	party->ExecCircuit();
+
+	shrprefixout->get_clear_value_vec(&outprefix, &tmpbitlen, &tmpnvals);
+	assert(tmpnvals == nprefix);
+	shrrunsout->get_clear_value_vec(&outruns, &tmpbitlen, &tmpnvals);
+	shrrepout->get_clear_value_vec(&outrep, &tmpbitlen, &tmpnvals);
+	for (uint32_t i = 0; i < nvals; i++) {
+		verify = avec[runpos[i]] + bvec[runpos[i]];
+		if (!verbose)
+			cout << "\t" << get_role_name(role) << " Yao SIMD views " << i << ": runs = " << outruns[i] << ", repeat = " << outrep[i]
+					<< ", verify = " << verify << endl;
+		assert(verify == outruns[i]);
+		assert(avec[runpos[0]] + bvec[runpos[0]] == outrep[i]);
+		if (i < nprefix)
+			assert((avec[i] ^ bvec[i]) == outprefix[i]);
+	}
+	free(outprefix);
+	free(outruns);
+	free(outrep);
+	party->Reset();
+
+	delete shra;
+	delete shrb;
+	delete shrxor;
+	delete shrsum;
+	delete shrprefix;
+	delete shrruns;
+	delete shrfirst;
+	delete shrrep;
+	delete shrprefixout;
+	delete shrrunsout;
+	delete shrrepout;
+	free(avec);
+	free(bvec);
+	free(prefixpos);
+	free(runpos);
+
+	return 1;
+}
+
+//Build the AES, SHA1, and SCS PSI circuits in Boolean sharing without evaluating them and print the construction times
+int32_t bench_circuit_construction(e_role role, char* address, seclvl seclvl, uint32_t nvals, uint32_t nelements, uint32_t bitlen,
+		uint32_t nthreads, e_mt_gen_alg mt_alg) {
+	ABYParty* party = new ABYParty(role, address, seclvl, bitlen, nthreads, mt_alg, 40000000);
+	vector<Sharing*>& sharings = party->GetSharings();
+	BooleanCircuit* circ = (BooleanCircuit*) sharings[S_BOOL]->GetCircuitBuildRoutine();
+	crypto* crypt = new crypto(seclvl.symbits, (uint8_t*) const_seed);
+	uint32_t aes_key_bits = crypt->get_aes_key_bytes() * 8;
+	uint32_t sha1_nvals = min(nvals, (uint32_t) 63);
+	uint32_t sha1bits_per_party = ABY_SHA1_INPUT_BITS / 2;
+	uint32_t nswapgates = estimateGates(nelements);
+	timespec tbegin, tend;
+	CBitVector aesin, aeskey, msgS, msgC;
+
+	//AES
+	aesin.Create(AES_BITS * nvals);
+	aeskey.CreateBytes(AES_EXP_KEY_BYTES);
+	aeskey.Copy((uint8_t*) AES_TEST_EXPANDED_KEY, 0, AES_EXP_KEY_BYTES);
+	clock_gettime(CLOCK_MONOTONIC, &tbegin);
+	share* s_in = circ->PutSIMDINGate(nvals, aesin.GetArr(), aes_key_bits, CLIENT);
+	share* s_key = circ->PutRepeaterGate(nvals, circ->PutINGate(aeskey.GetArr(), aes_key_bits * (AES_ROUNDS + 1), SERVER));
+	BuildAESCircuit(s_in, s_key, circ);
+	clock_gettime(CLOCK_MONOTONIC, &tend);
+	cout << "\t" << get_role_name(role) << " AES circuit with " << nvals << " values and " << circ->GetNumGates()
+			<< " gates built in " << getMillies(tbegin, tend) << " ms" << endl;
+	party->Reset();
+
+	//SHA1
+	uint8_t* plain_out = (uint8_t*) malloc(ABY_SHA1_OUTPUT_BYTES);
+	msgS.Create(sha1bits_per_party * sha1_nvals);
+	msgC.Create(sha1bits_per_party * sha1_nvals);
+	clock_gettime(CLOCK_MONOTONIC, &tbegin);
+	share* s_msgS = circ->PutSIMDINGate(sha1_nvals, msgS.GetArr(), sha1bits_per_party, SERVER);
+	share* s_msgC = circ->PutSIMDINGate(sha1_nvals, msgC.GetArr(), sha1bits_per_party, CLIENT);
+	BuildSHA1Circuit(s_msgS, s_msgC, msgS.GetArr(), msgC.GetArr(), plain_out, sha1_nvals, circ);
+	clock_gettime(CLOCK_MONOTONIC, &tend);
+	cout << "\t" << get_role_name(role) << " SHA1 circuit with " << sha1_nvals << " values and " << circ->GetNumGates()
+			<< " gates built in " << getMillies(tbegin, tend) << " ms" << endl;
+	party->Reset();
+	free(plain_out);
+
+	//SCS PSI
+	share** shr_server_set = (share**) malloc(sizeof(share*) * nelements);
+	share** shr_client_set = (share**) malloc(sizeof(share*) * nelements);
+	vector<uint32_t> selbits(nswapgates);
+	clock_gettime(CLOCK_MONOTONIC, &tbegin);
+	for (uint32_t i = 0; i < nelements; i++) {
+		shr_server_set[i] = circ->PutSIMDINGate(bitlen, i, 1, SERVER);
+		shr_client_set[i] = circ->PutSIMDINGate(bitlen, i, 1, CLIENT);
+	}
+	for (uint32_t i = 0; i < nswapgates; i++) {
+		selbits[i] = circ->PutINGate((uint32_t) 0, 1, SERVER)->get_wire_id(0);
+	}
+	BuildSCSPSICircuit(shr_server_set, shr_client_set, selbits, nelements, bitlen, circ, circ, 0);
+	clock_gettime(CLOCK_MONOTONIC, &tend);
+	cout << "\t" << get_role_name(role) << " SCS PSI circuit with " << nelements << " elements and " << circ->GetNumGates()
+			<< " gates built in " << getMillies(tbegin, tend) << " ms" << endl;
+	party->Reset();
+	free(shr_server_set);
+	free(shr_client_set);
+
+	delete crypt;
+	delete party;
+
+	return 1;
+}
+
 int32_t read_test_options(int32_t* argcp, char*** argvp, e_role* role, uint32_t* bitlen, uint32_t* nvals, uint32_t* secparam,
-		string* address, uint16_t* port, int32_t* test_op, uint32_t* num_test_runs, e_mt_gen_alg *mt_alg, bool* verbose) {
+		string* address, uint16_t* port, int32_t* test_op, uint32_t* num_test_runs, e_mt_gen_alg *mt_alg, bool* verbose,
+		bool* bench_construction) {
 
 	uint32_t int_role = 0, int_port = 0, int_mtalg = 0;
 	bool useffc = false;
@@ -483,7 +1683,9 @@ int32_t read_test_options(int32_t* argcp, char*** argvp, e_role* role, uint32_t*
 			(void*) address, T_STR, "a", "IP-address, default: localhost", false, false }, { (void*) &int_port, T_NUM, "p", "Port, default: 7766", false, false }, {
 			(void*) test_op, T_NUM, "t", "Single test (leave out for all operations), default: off", false, false }, { (void*) verbose, T_FLAG, "v",
 			"Do not print computation results, default: off", false, false }, {(void*) num_test_runs, T_NUM, "i", "Number of test runs for operation tests, default: 5",
-					false, false }, { (void*) &int_mtalg, T_NUM, "m", "Arithmetic MT gen algo [0: OT, 1: Paillier, 2: DGK], default: 0", false, false } };
+					false, false }, { (void*) &int_mtalg, T_NUM, "m", "Arithmetic MT gen algo [0: OT, 1: Paillier, 2: DGK], default: 0", false, false }, {
+			(void*) bench_construction, T_FLAG, "c", "Only benchmark the construction of the example circuits instead of running the tests, default: off",
+			false, false } };
 
 	if (!parse_options(argcp, argvp, options, sizeof(options) / sizeof(parsing_ctx))) {
 		print_usage(*argvp[0], options, sizeof(options) / sizeof(parsing_ctx));
@@ -25,6 +25,7 @@
 #include "../abycore/util/typedefs.h"
 #include "../abycore/util/crypto/crypto.h"
 #include "../abycore/aby/abyparty.h"
+#include "../abycore/aby/mixedcircuit.h"
 #include "../abycore/circuit/circuit.h"
 #include "../abycore/util/timer.h"
 #include "../abycore/util/parse_options.h"
@@ -41,7 +42,8 @@ bool run_tests(e_role role, char* address, seclvl seclvl, uint32_t bitlen, uint3
 		int32_t testop, uint32_t num_test_runs, bool verbose);
 
 int32_t read_test_options(int32_t* argcp, char*** argvp, e_role* role, uint32_t* bitlen, uint32_t* nreps, uint32_t* secparam,
-		string* address, uint16_t* port, int32_t* test_op, uint32_t* num_test_runs, e_mt_gen_alg *mt_alg, bool* verbose);
+		string* address, uint16_t* port, int32_t* test_op, uint32_t* num_test_runs, e_mt_gen_alg *mt_alg, bool* verbose,
+		bool* bench_construction);
 
 int32_t test_standard_ops(aby_ops_t* test_ops, ABYParty* party, uint32_t bitlen, uint32_t num_test_runs, uint32_t nops,
 		e_role role, bool verbose);
@@ -49,6 +51,38 @@ int32_t test_standard_ops(aby_ops_t* test_ops, ABYParty* party, uint32_t bitlen,
 int32_t test_vector_ops(aby_ops_t* test_ops, ABYParty* party, uint32_t bitlen, uint32_t nvals, uint32_t num_test_runs,
 		uint32_t nops, e_role role, bool verbose);
 
+int32_t test_compiled_circuit(ABYParty* party, uint32_t bitlen, uint32_t nvals, uint32_t num_test_runs, e_role role,
+		bool verbose);
+
+int32_t test_circuit_file(ABYParty* party, uint32_t bitlen, uint32_t nvals, e_role role, bool verbose);
+
+int32_t test_bristol_file(ABYParty* party, uint32_t nvals, e_role role, bool verbose);
+
+int32_t test_simd_gate_from_file(ABYParty* party, uint32_t nvals, e_role role, bool verbose);
+
+int32_t test_gate_deduplication(ABYParty* party, uint32_t bitlen, uint32_t nvals, e_role role, bool verbose);
+
+int32_t test_cost_estimate(ABYParty* party, uint32_t bitlen, uint32_t nvals, e_role role, bool verbose);
+
+int32_t test_mixed_circuit(ABYParty* party, uint32_t nvals, e_role role, bool verbose);
+
+int32_t test_matrix_multiplication(ABYParty* party, e_role role, bool verbose);
+
+int32_t test_dot_product(ABYParty* party, uint32_t nvals, e_role role, bool verbose);
+
+int32_t test_arith_widths(ABYParty* party, uint32_t nvals, e_role role, bool verbose);
+
+int32_t test_arith_128(ABYParty* party, uint32_t nvals, e_role role, bool verbose);
+int32_t test_field_sharing(ABYParty* party, uint32_t nvals, e_role role, bool verbose);
+int32_t test_fixed_point(ABYParty* party, uint32_t nvals, e_role role, bool verbose);
+int32_t test_y2a(ABYParty* party, uint32_t nvals, e_role role, bool verbose);
+int32_t test_a2b_gmw(ABYParty* party, uint32_t nvals, e_role role, bool verbose);
+int32_t test_yao_precomp(ABYParty* party, uint32_t nvals, e_role role, bool verbose);
+int32_t test_yao_simd_views(ABYParty* party, uint32_t nvals, e_role role, bool verbose);
+
+int32_t bench_circuit_construction(e_role role, char* address, seclvl seclvl, uint32_t nvals, uint32_t nelements, uint32_t bitlen,
+		uint32_t nthreads, e_mt_gen_alg mt_alg);
+
 string get_op_name(e_operation op);
 
 #endif /* MAINS_ABYTEST_H_ */